@@ -12,6 +12,8 @@
 # CaDiCaL_FOUND - system has CaDiCaL lib
 # CaDiCaL_INCLUDE_DIR - the CaDiCaL include directory
 # CaDiCaL_LIBRARIES - Libraries needed to use CaDiCaL
+# CaDiCaL_HAS_EXTERNAL_PROPAGATOR - CaDiCaL provides the external propagator
+#                                   interface (IPASIR-UP) of version 1.9
 
 include(deps-helper)
 
@@ -33,6 +35,50 @@ if(CaDiCaL_INCLUDE_DIR AND CaDiCaL_LIBRARIES)
   endif()
 
   check_system_version("CaDiCaL")
+
+  # The external propagator interface used for CaDiCaL as the main DPLL(T)
+  # SAT solver is only available (in this form) since version 1.9
+  include(CheckCXXSourceCompiles)
+  set(CMAKE_REQUIRED_INCLUDES "${CaDiCaL_INCLUDE_DIR}")
+  check_cxx_source_compiles(
+    "
+    #include <cadical.hpp>
+    class P : public CaDiCaL::ExternalPropagator
+    {
+     public:
+      void notify_assignment(int, bool) override {}
+      void notify_new_decision_level() override {}
+      void notify_backtrack(size_t) override {}
+      bool cb_check_found_model(const std::vector<int>&) override
+      {
+        return true;
+      }
+      int cb_decide() override { return 0; }
+      int cb_propagate() override { return 0; }
+      int cb_add_reason_clause_lit(int) override { return 0; }
+      bool cb_has_external_clause() override { return false; }
+      int cb_add_external_clause_lit() override { return 0; }
+    };
+    class L : public CaDiCaL::Learner
+    {
+     public:
+      bool learning(int) override { return false; }
+      void learn(int) override {}
+    };
+    int main()
+    {
+      CaDiCaL::Solver s;
+      P p;
+      L l;
+      s.connect_external_propagator(&p);
+      s.connect_learner(&l);
+      s.add_observed_var(1);
+      return 0;
+    }
+    "
+    CaDiCaL_HAS_EXTERNAL_PROPAGATOR
+  )
+  unset(CMAKE_REQUIRED_INCLUDES)
 endif()
 
 if(NOT CaDiCaL_FOUND_SYSTEM)
@@ -42,6 +88,8 @@ if(NOT CaDiCaL_FOUND_SYSTEM)
   fail_if_include_missing("sys/resource.h" "CaDiCaL")
 
   set(CaDiCaL_VERSION "1.2.1")
+  # does not have the external propagator interface
+  set(CaDiCaL_HAS_EXTERNAL_PROPAGATOR FALSE)
 
   # avoid configure script and instantiate the makefile manually the configure
   # scripts unnecessarily fails for cross compilation thus we do the bare
@@ -90,6 +138,7 @@ mark_as_advanced(CaDiCaL_FOUND)
 mark_as_advanced(CaDiCaL_FOUND_SYSTEM)
 mark_as_advanced(CaDiCaL_INCLUDE_DIR)
 mark_as_advanced(CaDiCaL_LIBRARIES)
+mark_as_advanced(CaDiCaL_HAS_EXTERNAL_PROPAGATOR)
 
 if(CaDiCaL_FOUND_SYSTEM)
   message(STATUS "Found CaDiCaL ${CaDiCaL_VERSION}: ${CaDiCaL_LIBRARIES}")
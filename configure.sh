@@ -58,6 +58,8 @@ The following flags enable optional packages (disable with --no-<option name>).
   --glpk                   use GLPK simplex solver
   --abc                    use the ABC AIG library
   --cadical                use the CaDiCaL SAT solver
+  --cadical-propagator     use CaDiCaL for the DPLL(T) search, requires
+                           CaDiCaL 1.9 or later (see --cadical-dir)
   --cryptominisat          use the CryptoMiniSat SAT solver
   --kissat                 use the Kissat SAT solver
   --poly                   use the LibPoly library
@@ -111,6 +113,7 @@ abc=default
 asan=default
 assertions=default
 cadical=default
+cadical_propagator=default
 cln=default
 comp_inc=default
 coverage=default
@@ -208,6 +211,9 @@ do
     --cadical) cadical=ON;;
     --no-cadical) cadical=OFF;;
 
+    --cadical-propagator) cadical_propagator=ON;;
+    --no-cadical-propagator) cadical_propagator=OFF;;
+
     --cln) cln=ON;;
     --no-cln) cln=OFF;;
 
@@ -405,6 +411,8 @@ cmake_opts=""
   && cmake_opts="$cmake_opts -DUSE_ABC=$abc"
 [ $cadical != default ] \
   && cmake_opts="$cmake_opts -DUSE_CADICAL=$cadical"
+[ $cadical_propagator != default ] \
+  && cmake_opts="$cmake_opts -DUSE_CADICAL_PROPAGATOR=$cadical_propagator"
 [ $cln != default ] \
   && cmake_opts="$cmake_opts -DUSE_CLN=$cln"
 [ $cryptominisat != default ] \
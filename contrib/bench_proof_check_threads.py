@@ -0,0 +1,147 @@
+#!/usr/bin/env python3
+#####################
+## bench_proof_check_threads.py
+## This file is part of the CVC4 project.
+## Copyright (c) 2009-2021 by the authors listed in the file AUTHORS
+## in the top-level source directory and their institutional affiliations.
+## All rights reserved.  See the file COPYING in the top-level source
+## directory for licensing information.
+##
+"""
+Benchmarks the checking of final proofs on several threads
+(--proof-check-threads) over the proof regressions, i.e., the unsat
+regressions that the regression runner also runs with --check-proofs.
+
+Every regression is solved once per number of threads with
+--check-proofs --stats, and the time spent in ProofChecker::checkProof
+(ProofCheckerStatistics::checkProofTime) is summed up.  Regressions that
+time out, fail or do not produce a proof are skipped.
+"""
+
+import argparse
+import os
+import re
+import shlex
+import subprocess
+import sys
+
+STATUS_REGEX = re.compile(r'set-info\s*:status\s*(sat|unsat)')
+STAT_REGEX = re.compile(
+    r'ProofCheckerStatistics::checkProofTime,\s*([0-9]+\.[0-9]+)')
+SKIP_OPTIONS = ['--no-check-proofs', '--no-produce-proofs', '--incremental']
+
+
+def get_regressions(regress_dir, levels):
+    """Returns the regressions of the given levels, as listed in the
+    CMakeLists.txt of `regress_dir`."""
+
+    with open(os.path.join(regress_dir, 'CMakeLists.txt')) as cmake_file:
+        content = cmake_file.read()
+    regressions = []
+    for level in levels:
+        match = re.search(r'set\(regress_{}_tests(.*?)\)'.format(level),
+                          content, re.DOTALL)
+        if not match:
+            sys.exit('no regressions of level {}'.format(level))
+        for line in match.group(1).splitlines():
+            line = line.split('#')[0].strip()
+            if line.endswith('.smt2'):
+                regressions.append(line)
+    return regressions
+
+
+def get_proof_command_line(path):
+    """Returns the command line options of the regression at `path` if it is
+    a proof regression, or None otherwise."""
+
+    with open(path) as benchmark_file:
+        lines = benchmark_file.readlines()
+    content = ''.join(lines)
+    expected = []
+    command_line = []
+    for line in lines:
+        if not line.startswith(';'):
+            continue
+        line = line[1:].strip()
+        if line.startswith('EXPECT:'):
+            expected.append(line[len('EXPECT:'):].strip())
+        elif line.startswith('COMMAND-LINE:') and not command_line:
+            command_line = shlex.split(line[len('COMMAND-LINE:'):])
+    if not expected:
+        expected = STATUS_REGEX.findall(content)
+    if expected != ['unsat'] or '(get-unsat-core)' in content:
+        return None
+    if any(opt in command_line for opt in SKIP_OPTIONS):
+        return None
+    return command_line
+
+
+def check_proof_time(cvc4_binary, path, command_line, threads, timeout):
+    """Solves the regression at `path` and returns the time spent in checking
+    its final proof with `threads` threads, or None if it failed."""
+
+    args = [cvc4_binary, '--check-proofs', '--stats',
+            '--proof-check-threads={}'.format(threads)] + command_line + [path]
+    try:
+        proc = subprocess.run(args,
+                              cwd=os.path.dirname(path),
+                              stdout=subprocess.PIPE,
+                              stderr=subprocess.PIPE,
+                              timeout=timeout)
+    except subprocess.TimeoutExpired:
+        return None
+    output = proc.stdout.decode()
+    match = STAT_REGEX.search(output + proc.stderr.decode())
+    if proc.returncode != 0 or 'unsat' not in output.split() or not match:
+        return None
+    return float(match.group(1))
+
+
+def main():
+    script_dir = os.path.dirname(os.path.realpath(__file__))
+    parser = argparse.ArgumentParser(
+        description='benchmark --proof-check-threads on the proof regressions')
+    parser.add_argument('cvc4_binary')
+    parser.add_argument('--regress-dir',
+                        default=os.path.join(script_dir, '..', 'test',
+                                             'regress'))
+    parser.add_argument('--levels', default='0',
+                        help='comma-separated regression levels (default: 0)')
+    parser.add_argument('--threads', default='1,2,4',
+                        help='comma-separated numbers of threads '
+                        '(default: 1,2,4)')
+    parser.add_argument('--timeout', type=float, default=60)
+    args = parser.parse_args()
+
+    threads = [int(t) for t in args.threads.split(',')]
+    regress_dir = os.path.realpath(args.regress_dir)
+    totals = dict((t, 0.0) for t in threads)
+    nchecked = 0
+    for regression in get_regressions(regress_dir, args.levels.split(',')):
+        path = os.path.join(regress_dir, regression)
+        command_line = get_proof_command_line(path)
+        if command_line is None:
+            continue
+        times = {}
+        for t in threads:
+            times[t] = check_proof_time(args.cvc4_binary, path, command_line,
+                                        t, args.timeout)
+            if times[t] is None:
+                break
+        if any(time is None for time in times.values()):
+            continue
+        nchecked += 1
+        for t in threads:
+            totals[t] += times[t]
+        print('{}: {}'.format(
+            regression,
+            ' '.join('{:.6f}'.format(times[t]) for t in threads)))
+
+    print('checked the final proofs of {} regressions'.format(nchecked))
+    for t in threads:
+        print('{} thread(s): {:.6f} s, speedup {:.2f}'.format(
+            t, totals[t], totals[threads[0]] / totals[t] if totals[t] else 0))
+
+
+if __name__ == '__main__':
+    main()
@@ -6568,6 +6568,25 @@ void Solver::blockModelValues(const std::vector<Term>& terms) const
   CVC4_API_TRY_CATCH_END;
 }
 
+std::vector<std::vector<Term>> Solver::getCubes(uint32_t depth) const
+{
+  NodeManagerScope scope(getNodeManager());
+  CVC4_API_TRY_CATCH_BEGIN;
+  //////// all checks before this line
+  std::vector<std::vector<Term>> res;
+  for (const std::vector<Node>& cube : d_smtEngine->getCubes(depth))
+  {
+    res.push_back(std::vector<Term>());
+    for (const Node& lit : cube)
+    {
+      res.back().push_back(Term(this, lit));
+    }
+  }
+  return res;
+  ////////
+  CVC4_API_TRY_CATCH_END;
+}
+
 void Solver::printInstantiations(std::ostream& out) const
 {
   NodeManagerScope scope(getNodeManager());
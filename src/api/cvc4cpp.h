@@ -3424,6 +3424,20 @@ class CVC4_EXPORT Solver
    */
   void blockModelValues(const std::vector<Term>& terms) const;
 
+  /**
+   * Split the current assertions into up to 2^depth cubes by lookahead in the
+   * SAT solver, for cube-and-conquer. The assertions are equivalent to the
+   * disjunction of the returned cubes, each of which is a conjunction of
+   * literals that can be passed to checkSatAssuming(). The assertions are
+   * unsatisfiable if no cube is returned.
+   * The literals are over the preprocessed assertions, and may contain
+   * internal symbols.
+   * Requires the minisat SAT solver (option 'sat-solver').
+   * @param depth the maximal number of splits along each branch
+   * @return the cubes
+   */
+  std::vector<std::vector<Term>> getCubes(uint32_t depth) const;
+
   /**
    * Print all instantiations made by the quantifiers module.
    * @param out the output stream
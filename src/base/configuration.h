@@ -100,6 +100,9 @@ public:
 
   static bool isBuiltWithCadical();
 
+  /** Can CaDiCaL run the main DPLL(T) search (--sat-solver=cadical)? */
+  static bool isBuiltWithCadicalPropagator();
+
   static bool isBuiltWithCryptominisat();
 
   static bool isBuiltWithKissat();
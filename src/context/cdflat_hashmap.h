@@ -0,0 +1,576 @@
+/*********************                                                        */
+/*! \file cdflat_hashmap.h
+ ** \verbatim
+ ** This file is part of the CVC4 project.
+ ** Copyright (c) 2009-2021 by the authors listed in the file AUTHORS
+ ** in the top-level source directory and their institutional affiliations.
+ ** All rights reserved.  See the file COPYING in the top-level source
+ ** directory for licensing information.\endverbatim
+ **
+ ** \brief A flat, open-addressing context-dependent map class.
+ **
+ ** A context-dependent map with the interface of CDHashMap<> that stores its
+ ** entries inline in one array instead of allocating a context object per
+ ** entry.  Requires that Key and Data be default constructible, copyable
+ ** and movable, and operator== for the key class.
+ **
+ ** See also:
+ **  CDHashMap : The general CD hash map, with stable element references.
+ **  CDInsertHashMap : An "insert-once" CD hash map.
+ **/
+
+#include "cvc4_private.h"
+
+#ifndef CVC4__CONTEXT__CDFLAT_HASHMAP_H
+#define CVC4__CONTEXT__CDFLAT_HASHMAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "base/check.h"
+#include "context/context.h"
+
+namespace CVC5 {
+namespace context {
+
+/**
+ * A context-dependent hash map that keeps its entries in a contiguous array,
+ * in insertion order, and indexes them with an open-addressing table (Robin
+ * Hood linear probing over buckets that hold a 32-bit hash and the index of
+ * the entry).  Lookups touch the bucket array and one entry, iteration is a
+ * linear scan of the entry array, and an insertion costs no allocation
+ * beyond the (amortized) growth of the two arrays.
+ *
+ * The map is backtracked with the undo log of its Context (see UndoRecord),
+ * at the granularity of entries: the insertion of a key at a level > 0 is
+ * undone by removing its entry, and the first change of an entry at a level
+ * is undone by restoring its previous value.  Unlike CDHashMap<>, the map
+ * supports erase(): at a level > 0, an erased entry stays in place as a
+ * tombstone that is skipped by lookups and iteration, and that pop() turns
+ * back into a live entry.  At level 0, erase() removes the entry for good.
+ *
+ * The interface is that of CDHashMap<>, so that a use site can switch
+ * between the two by changing the type, with the following differences:
+ * - operator[] returns an Element proxy by value instead of a reference to
+ *   a context object, which supports assignment, get() and conversion to
+ *   Data as the CDHashMap<> element does;
+ * - value_type is std::pair<Key, Data> (which iterators only expose as a
+ *   const reference), and entry references and iterators are invalidated by
+ *   insertions, like those of a std::vector;
+ * - removing an entry other than the last one (when a key inserted at a
+ *   deeper level is popped while a later insertAtContextLevelZero() entry
+ *   survives, or on erase() at level 0) moves the last entry into its place.
+ */
+template <class Key, class Data, class HashFcn = std::hash<Key> >
+class CDFlatHashMap
+{
+ public:
+  using value_type = std::pair<Key, Data>;
+
+ private:
+  /** An entry of the map */
+  struct Entry
+  {
+    value_type d_value;
+    /** The 32-bit hash of the key, as stored in its bucket */
+    uint32_t d_hash;
+    /** The level at which this entry was last changed (see UndoRecord) */
+    int d_level;
+    /** Whether this entry is a tombstone left by erase() */
+    bool d_erased;
+  };
+
+  /** A bucket; d_entry is the index of its entry plus one, 0 if empty */
+  struct Bucket
+  {
+    uint32_t d_hash;
+    uint32_t d_entry;
+  };
+
+  /** The state of an entry saved by logChange() */
+  struct SavedEntry
+  {
+    uint32_t d_index;
+    bool d_erased;
+    Data d_data;
+  };
+
+  /** The result of findBucket() if the key is not found */
+  static constexpr size_t NOT_FOUND = ~static_cast<size_t>(0);
+
+  /** The number of buckets allocated on the first insertion */
+  static constexpr size_t INITIAL_CAPACITY = 16;
+
+  /** The context of this map */
+  Context* d_context;
+  /** The entries, live ones and tombstones, in insertion order */
+  std::vector<Entry> d_entries;
+  /** The buckets; empty or of power-of-two size */
+  std::vector<Bucket> d_buckets;
+  /** The number of buckets minus one */
+  size_t d_mask;
+  /** 64 - log2(number of buckets), for Fibonacci hashing */
+  uint32_t d_shift;
+  /** The number of live entries */
+  size_t d_size;
+
+  /** The hash of k, folded to the 32 bits kept in buckets */
+  static uint32_t hash(const Key& k)
+  {
+    uint64_t h = HashFcn()(k);
+    return static_cast<uint32_t>(h ^ (h >> 32));
+  }
+
+  /** The bucket at which an entry with the given hash ideally lives */
+  size_t home(uint32_t hash) const
+  {
+    return static_cast<size_t>(
+        (static_cast<uint64_t>(hash) * UINT64_C(0x9e3779b97f4a7c15))
+        >> d_shift);
+  }
+
+  /** The probe distance of an entry with the given hash at bucket i */
+  size_t distance(uint32_t hash, size_t i) const
+  {
+    return (i - home(hash)) & d_mask;
+  }
+
+  /** Find the bucket of key k with the given hash, or return NOT_FOUND */
+  size_t findBucket(const Key& k, uint32_t hash) const
+  {
+    if (d_buckets.empty())
+    {
+      return NOT_FOUND;
+    }
+    for (size_t i = home(hash), dist = 0;; i = (i + 1) & d_mask, ++dist)
+    {
+      const Bucket& b = d_buckets[i];
+      if (b.d_entry == 0 || distance(b.d_hash, i) < dist)
+      {
+        return NOT_FOUND;
+      }
+      if (b.d_hash == hash && d_entries[b.d_entry - 1].d_value.first == k)
+      {
+        return i;
+      }
+    }
+  }
+
+  /** Find the bucket of the entry with the given index */
+  size_t findBucketOf(uint32_t index) const
+  {
+    for (size_t i = home(d_entries[index].d_hash);; i = (i + 1) & d_mask)
+    {
+      if (d_buckets[i].d_entry == index + 1)
+      {
+        return i;
+      }
+      Assert(d_buckets[i].d_entry != 0) << "entry is not in the table";
+    }
+  }
+
+  /** Insert a bucket; the table must have room and must not contain it */
+  void insertBucket(Bucket cur)
+  {
+    for (size_t i = home(cur.d_hash), dist = 0;; i = (i + 1) & d_mask, ++dist)
+    {
+      Bucket& b = d_buckets[i];
+      if (b.d_entry == 0)
+      {
+        b = cur;
+        return;
+      }
+      // Robin Hood: the entry closer to its home bucket yields its place
+      size_t bdist = distance(b.d_hash, i);
+      if (bdist < dist)
+      {
+        std::swap(b, cur);
+        dist = bdist;
+      }
+    }
+  }
+
+  /** Remove the bucket at i by shifting its successors back */
+  void eraseBucketAt(size_t i)
+  {
+    for (size_t next = (i + 1) & d_mask;
+         d_buckets[next].d_entry != 0
+         && distance(d_buckets[next].d_hash, next) != 0;
+         i = next, next = (next + 1) & d_mask)
+    {
+      d_buckets[i] = d_buckets[next];
+    }
+    d_buckets[i].d_entry = 0;
+  }
+
+  /** Grow the table if the next insertion would overload it */
+  void growIfNecessary()
+  {
+    size_t nbuckets = d_buckets.size();
+    if (4 * (d_entries.size() + 1) <= 3 * nbuckets)
+    {
+      return;
+    }
+    nbuckets = nbuckets == 0 ? INITIAL_CAPACITY : 2 * nbuckets;
+    d_buckets.assign(nbuckets, Bucket{0, 0});
+    d_mask = nbuckets - 1;
+    d_shift = 64;
+    for (size_t n = nbuckets; n > 1; n >>= 1)
+    {
+      --d_shift;
+    }
+    for (size_t i = 0, n = d_entries.size(); i < n; ++i)
+    {
+      insertBucket({d_entries[i].d_hash, static_cast<uint32_t>(i + 1)});
+    }
+  }
+
+  /** Append an entry for key k (which is not in the map) with data d */
+  uint32_t newEntry(const Key& k, uint32_t hash, const Data& d, int level)
+  {
+    growIfNecessary();
+    uint32_t index = static_cast<uint32_t>(d_entries.size());
+    d_entries.push_back(Entry{value_type(k, d), hash, level, false});
+    insertBucket({hash, index + 1});
+    ++d_size;
+    return index;
+  }
+
+  /**
+   * Remove the entry with the given index for good, moving the last entry
+   * into its place.
+   */
+  void removeEntry(uint32_t index)
+  {
+    eraseBucketAt(findBucketOf(index));
+    if (!d_entries[index].d_erased)
+    {
+      --d_size;
+    }
+    uint32_t last = static_cast<uint32_t>(d_entries.size() - 1);
+    if (index != last)
+    {
+      d_buckets[findBucketOf(last)].d_entry = index + 1;
+      d_entries[index] = std::move(d_entries[last]);
+    }
+    d_entries.pop_back();
+  }
+
+  /** Insert key k with data d at the current level */
+  uint32_t insertEntry(const Key& k, uint32_t hash, const Data& d)
+  {
+    int level = d_context->getLevel();
+    uint32_t index = newEntry(k, hash, d, level);
+    if (level > 0)
+    {
+      d_context->logUndo({&undoInsert, this, index, 0});
+    }
+    return index;
+  }
+
+  /** Log the entry with the given index if this is its first change */
+  void logChange(uint32_t index)
+  {
+    Entry& e = d_entries[index];
+    int level = d_context->getLevel();
+    if (e.d_level < level)
+    {
+      SavedEntry* saved =
+          new (d_context->getCMM()->newData(sizeof(SavedEntry)))
+              SavedEntry{index, e.d_erased, e.d_value.second};
+      d_context->logUndo(
+          {&undoChange, this, reinterpret_cast<uintptr_t>(saved), e.d_level});
+      e.d_level = level;
+    }
+  }
+
+  /** Set the data of the entry with the given index, reviving it if erased */
+  void setEntry(uint32_t index, const Data& d)
+  {
+    logChange(index);
+    Entry& e = d_entries[index];
+    e.d_value.second = d;
+    if (e.d_erased)
+    {
+      e.d_erased = false;
+      ++d_size;
+    }
+  }
+
+  /**
+   * The index of the (live or erased) entry of key k, inserting a new entry
+   * with default data if there is none.
+   */
+  uint32_t getEntry(const Key& k)
+  {
+    uint32_t h = hash(k);
+    size_t b = findBucket(k, h);
+    if (b == NOT_FOUND)
+    {
+      return insertEntry(k, h, Data());
+    }
+    uint32_t index = d_buckets[b].d_entry - 1;
+    if (d_entries[index].d_erased)
+    {
+      setEntry(index, Data());
+    }
+    return index;
+  }
+
+  static void undoInsert(const UndoRecord& r, bool apply)
+  {
+    if (apply)
+    {
+      static_cast<CDFlatHashMap*>(r.d_obj)->removeEntry(
+          static_cast<uint32_t>(r.d_old));
+    }
+  }
+
+  static void undoChange(const UndoRecord& r, bool apply)
+  {
+    SavedEntry* saved =
+        reinterpret_cast<SavedEntry*>(static_cast<uintptr_t>(r.d_old));
+    if (apply)
+    {
+      CDFlatHashMap* map = static_cast<CDFlatHashMap*>(r.d_obj);
+      Entry& e = map->d_entries[saved->d_index];
+      e.d_value.second = std::move(saved->d_data);
+      e.d_level = r.d_level;
+      if (e.d_erased != saved->d_erased)
+      {
+        e.d_erased = saved->d_erased;
+        if (e.d_erased)
+        {
+          --map->d_size;
+        }
+        else
+        {
+          ++map->d_size;
+        }
+      }
+    }
+    saved->~SavedEntry();
+  }
+
+  // no copy or assignment
+  CDFlatHashMap(const CDFlatHashMap&) = delete;
+  CDFlatHashMap& operator=(const CDFlatHashMap&) = delete;
+
+ public:
+  /**
+   * A reference to the entry of a key, as returned by operator[].  It stays
+   * valid across insertions, but not across the removal of entries.
+   */
+  class Element
+  {
+    CDFlatHashMap* d_map;
+    uint32_t d_index;
+
+   public:
+    Element(CDFlatHashMap* map, uint32_t index) : d_map(map), d_index(index)
+    {
+    }
+
+    void set(const Data& data) { d_map->setEntry(d_index, data); }
+
+    const Key& getKey() const { return getValue().first; }
+
+    const Data& get() const { return getValue().second; }
+
+    const value_type& getValue() const
+    {
+      return d_map->d_entries[d_index].d_value;
+    }
+
+    operator Data() const { return get(); }
+
+    const Data& operator=(const Data& data)
+    {
+      set(data);
+      return data;
+    }
+  }; /* class CDFlatHashMap<>::Element */
+
+  CDFlatHashMap(Context* context)
+      : d_context(context), d_mask(0), d_shift(64), d_size(0)
+  {
+  }
+
+  ~CDFlatHashMap() { clear(); }
+
+  void clear()
+  {
+    if (d_context->getUndoLogSize() > 0)
+    {
+      // the entries are gone for good, at all levels
+      d_context->forgetUndo(this);
+    }
+    d_entries.clear();
+    d_buckets.clear();
+    d_mask = 0;
+    d_shift = 64;
+    d_size = 0;
+  }
+
+  // The usual operators of map
+
+  size_t size() const { return d_size; }
+
+  bool empty() const { return d_size == 0; }
+
+  size_t count(const Key& k) const
+  {
+    size_t b = findBucket(k, hash(k));
+    return b != NOT_FOUND && !d_entries[d_buckets[b].d_entry - 1].d_erased;
+  }
+
+  // If a key is not present, a new entry is created and inserted
+  Element operator[](const Key& k) { return Element(this, getEntry(k)); }
+
+  bool insert(const Key& k, const Data& d)
+  {
+    uint32_t h = hash(k);
+    size_t b = findBucket(k, h);
+    if (b == NOT_FOUND)
+    {
+      insertEntry(k, h, d);
+      return true;
+    }
+    uint32_t index = d_buckets[b].d_entry - 1;
+    bool erased = d_entries[index].d_erased;
+    setEntry(index, d);
+    return erased;
+  }
+
+  /**
+   * Version of insert() that inserts data value d at context level zero, see
+   * CDHashMap<>::insertAtContextLevelZero().
+   *
+   * It is an error (checked via AlwaysAssert()) to
+   * insertAtContextLevelZero() a key that already is in the map, at any
+   * level (including a key that is erased at the current level only).
+   */
+  void insertAtContextLevelZero(const Key& k, const Data& d)
+  {
+    uint32_t h = hash(k);
+    AlwaysAssert(findBucket(k, h) == NOT_FOUND);
+    newEntry(k, h, d, 0);
+  }
+
+  /**
+   * Erase key k from the map, and return the number of erased entries (0 or
+   * 1).  The entry is restored when the current level is popped.
+   */
+  size_t erase(const Key& k)
+  {
+    size_t b = findBucket(k, hash(k));
+    if (b == NOT_FOUND)
+    {
+      return 0;
+    }
+    uint32_t index = d_buckets[b].d_entry - 1;
+    if (d_entries[index].d_erased)
+    {
+      return 0;
+    }
+    if (d_context->getLevel() == 0)
+    {
+      // no undo record can refer to the entry, so it can go right away
+      removeEntry(index);
+      return 1;
+    }
+    logChange(index);
+    d_entries[index].d_erased = true;
+    --d_size;
+    return 1;
+  }
+
+  class iterator
+  {
+    const Entry* d_it;
+    const Entry* d_end;
+
+    void skipErased()
+    {
+      while (d_it != d_end && d_it->d_erased)
+      {
+        ++d_it;
+      }
+    }
+
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = typename CDFlatHashMap::value_type;
+    using difference_type = ptrdiff_t;
+    using pointer = const value_type*;
+    using reference = const value_type&;
+
+    iterator(const Entry* p, const Entry* end) : d_it(p), d_end(end)
+    {
+      skipErased();
+    }
+
+    // Default constructor
+    iterator() : d_it(nullptr), d_end(nullptr) {}
+
+    // (Dis)equality
+    bool operator==(const iterator& i) const { return d_it == i.d_it; }
+    bool operator!=(const iterator& i) const { return d_it != i.d_it; }
+
+    // Dereference operators.
+    const value_type& operator*() const { return d_it->d_value; }
+    const value_type* operator->() const { return &d_it->d_value; }
+
+    // Prefix increment
+    iterator& operator++()
+    {
+      ++d_it;
+      skipErased();
+      return *this;
+    }
+
+    // Postfix increment
+    iterator operator++(int)
+    {
+      iterator i = *this;
+      ++*this;
+      return i;
+    }
+  }; /* class CDFlatHashMap<>::iterator */
+
+  typedef iterator const_iterator;
+
+  iterator begin() const
+  {
+    const Entry* end = d_entries.data() + d_entries.size();
+    return iterator(d_entries.data(), end);
+  }
+
+  iterator end() const
+  {
+    const Entry* end = d_entries.data() + d_entries.size();
+    return iterator(end, end);
+  }
+
+  iterator find(const Key& k) const
+  {
+    size_t b = findBucket(k, hash(k));
+    if (b == NOT_FOUND)
+    {
+      return end();
+    }
+    const Entry* end = d_entries.data() + d_entries.size();
+    const Entry* e = d_entries.data() + (d_buckets[b].d_entry - 1);
+    return e->d_erased ? iterator(end, end) : iterator(e, end);
+  }
+}; /* class CDFlatHashMap<> */
+
+}  // namespace context
+}  // namespace CVC5
+
+#endif /* CVC4__CONTEXT__CDFLAT_HASHMAP_H */
@@ -128,6 +128,30 @@ class CDOhash_map : public ContextObj {
   CDOhash_map* d_prev;
   CDOhash_map* d_next;
 
+  // If the map uses the undo log, the level at which the element was last
+  // changed or inserted, and -1 otherwise
+  int d_undoLevel;
+
+  // Remove this element from the map and from the list of its elements
+  void unlink()
+  {
+    Assert(d_map->d_map.find(getKey()) != d_map->d_map.end()
+           && (*d_map->d_map.find(getKey())).second == this);
+    d_map->d_map.erase(getKey());
+    if(d_map->d_first == this) {
+      Debug("gc") << "remove first-elem " << this << " from map " << d_map << " with next-elem " << d_next << std::endl;
+      if(d_next == this) {
+        Assert(d_prev == this);
+        d_map->d_first = NULL;
+      } else {
+        d_map->d_first = d_next;
+      }
+    } else {
+      Debug("gc") << "remove nonfirst-elem " << this << " from map " << d_map << std::endl;
+    }
+    d_next->d_prev = d_prev;
+    d_prev->d_next = d_next;
+  }
   ContextObj* save(ContextMemoryManager* pCMM) override
   {
     return new(pCMM) CDOhash_map(*this);
@@ -138,28 +162,12 @@ class CDOhash_map : public ContextObj {
     CDOhash_map* p = static_cast<CDOhash_map*>(data);
     if(d_map != NULL) {
       if(p->d_map == NULL) {
-        Assert(d_map->d_map.find(getKey()) != d_map->d_map.end()
-               && (*d_map->d_map.find(getKey())).second == this);
         // no longer in map (popped beyond first level in which it was)
-        d_map->d_map.erase(getKey());
+        unlink();
         // If we call deleteSelf() here, it re-enters restore().  So,
         // put it on a "trash heap" instead, for later deletion.
         //
         // FIXME multithreading
-        if(d_map->d_first == this) {
-          Debug("gc") << "remove first-elem " << this << " from map " << d_map << " with next-elem " << d_next << std::endl;
-          if(d_next == this) {
-            Assert(d_prev == this);
-            d_map->d_first = NULL;
-          } else {
-            d_map->d_first = d_next;
-          }
-        } else {
-          Debug("gc") << "remove nonfirst-elem " << this << " from map " << d_map << std::endl;
-        }
-        d_next->d_prev = d_prev;
-        d_prev->d_next = d_next;
-
         Debug("gc") << "CDHashMap<> trash push_back " << this << std::endl;
         // this->deleteSelf();
         enqueueToGarbageCollect();
@@ -181,7 +189,8 @@ class CDOhash_map : public ContextObj {
         d_value(Key(), other.d_value.second),
         d_map(other.d_map),
         d_prev(NULL),
-        d_next(NULL)
+        d_next(NULL),
+        d_undoLevel(-1)
   {
   }
   CDOhash_map& operator=(const CDOhash_map&) = delete;
@@ -192,9 +201,18 @@ class CDOhash_map : public ContextObj {
               const Key& key,
               const Data& data,
               bool atLevelZero = false)
-      : ContextObj(false, context), d_value(key, data), d_map(NULL)
+      : ContextObj(false, context),
+        d_value(key, data),
+        d_map(NULL),
+        d_undoLevel(-1)
   {
-    if(atLevelZero) {
+    if (map->d_undoLog)
+    {
+      // The map logs the insertion (see CDHashMap::logInsert()), and later
+      // changes of the data are logged by set().
+      d_undoLevel = 0;
+    }
+    else if(atLevelZero) {
       // "Initializing" map insertion: this entry will never be
       // removed from the map, it's inserted at level 0 as an
       // "initializing" element.  See
@@ -229,7 +247,14 @@ class CDOhash_map : public ContextObj {
   }
 
   void set(const Data& data) {
-    makeCurrent();
+    if (d_undoLevel < 0)
+    {
+      makeCurrent();
+    }
+    else
+    {
+      d_map->logSet(this);
+    }
     mutable_data() = data;
   }
 
@@ -276,6 +301,68 @@ class CDHashMap : public ContextObj {
   Element* d_first;
   Context* d_context;
 
+  // Whether this map is backtracked with the undo log of d_context, see
+  // BacktrackMode.  The records point to the map, so that clear() can
+  // release them in one pass over the log.
+  bool d_undoLog;
+
+  // The copy of the data of an element logged by logSet()
+  struct SavedData
+  {
+    Element* d_element;
+    Data d_data;
+  };
+
+  // Log the insertion of e, which is undone by removing e
+  void logInsert(Element* e)
+  {
+    int level = d_context->getLevel();
+    if (level > 0)
+    {
+      d_context->logUndo(
+          {&undoInsert, this, reinterpret_cast<uintptr_t>(e), 0});
+    }
+    e->d_undoLevel = level;
+  }
+
+  // Log the data of e if this is its first change at this level
+  void logSet(Element* e)
+  {
+    int level = d_context->getLevel();
+    if (e->d_undoLevel < level)
+    {
+      SavedData* saved = new (d_context->getCMM()->newData(sizeof(SavedData)))
+          SavedData{e, e->get()};
+      d_context->logUndo({&undoSet,
+                          this,
+                          reinterpret_cast<uintptr_t>(saved),
+                          e->d_undoLevel});
+      e->d_undoLevel = level;
+    }
+  }
+
+  static void undoInsert(const UndoRecord& r, bool apply)
+  {
+    if (apply)
+    {
+      Element* e = reinterpret_cast<Element*>(static_cast<uintptr_t>(r.d_old));
+      e->unlink();
+      e->d_map = nullptr;
+      e->deleteSelf();
+    }
+  }
+
+  static void undoSet(const UndoRecord& r, bool apply)
+  {
+    SavedData* saved =
+        reinterpret_cast<SavedData*>(static_cast<uintptr_t>(r.d_old));
+    if (apply)
+    {
+      saved->d_element->mutable_data() = saved->d_data;
+      saved->d_element->d_undoLevel = r.d_level;
+    }
+    saved->~SavedData();
+  }
   // Nothing to save; the elements take care of themselves
   ContextObj* save(ContextMemoryManager* pCMM) override
   {
@@ -291,8 +378,15 @@ class CDHashMap : public ContextObj {
   CDHashMap& operator=(const CDHashMap&) = delete;
 
 public:
-  CDHashMap(Context* context)
-    : ContextObj(context), d_map(), d_first(NULL), d_context(context) {}
+  CDHashMap(Context* context,
+            BacktrackMode mode = BacktrackMode::SAVE_RESTORE)
+      : ContextObj(context),
+        d_map(),
+        d_first(NULL),
+        d_context(context),
+        d_undoLog(mode == BacktrackMode::UNDO_LOG)
+  {
+  }
 
   ~CDHashMap() {
     Debug("gc") << "cdhashmap" << this << " disappearing, destroying..."
@@ -307,7 +401,11 @@ public:
     Debug("gc") << "clearing cdhashmap" << this << ", emptying trash"
                 << std::endl;
     Debug("gc") << "done emptying trash for " << this << std::endl;
-
+    if (d_undoLog)
+    {
+      // the elements are gone for good, at all levels
+      d_context->forgetUndo(this);
+    }
     for (auto& key_element_pair : d_map) {
       // mark it as being a destruction (short-circuit restore())
       Element* element = key_element_pair.second;
@@ -340,6 +438,10 @@ public:
     if(i == d_map.end()) {// create new object
       obj = new(true) Element(d_context, this, k, Data());
       d_map.insert(std::make_pair(k, obj));
+      if (d_undoLog)
+      {
+        logInsert(obj);
+      }
     } else {
       obj = (*i).second;
     }
@@ -352,6 +454,10 @@ public:
     if(i == d_map.end()) {// create new object
       Element* obj = new(true) Element(d_context, this, k, d);
       d_map.insert(std::make_pair(k, obj));
+      if (d_undoLog)
+      {
+        logInsert(obj);
+      }
       return true;
     } else {
       (*i).second->set(d);
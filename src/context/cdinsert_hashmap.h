@@ -258,6 +258,12 @@ protected:
        << "restore " << this << " level " << this->getContext()->getLevel()
        << " size back to " << this->d_size << std::endl;
   }
+
+  /**
+   * Implementation of ContextObj method discard: a saved copy owns nothing,
+   * and restoring from an older copy directly gives the same size.
+   */
+  bool discard(ContextObj* data) override { return true; }
 public:
 
  /**
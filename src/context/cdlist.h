@@ -94,6 +94,12 @@ private:
    */
   Allocator d_allocator;
 
+  /**
+   * The level at which d_size was last changed if this list uses the undo
+   * log, or -1 if it uses save() and restore().
+   */
+  int d_undoLevel;
+
 protected:
   /**
    * Private copy constructor used only by save().  d_list and
@@ -107,7 +113,8 @@ protected:
     d_callDestructor(false),
     d_sizeAlloc(0),
     d_cleanUp(l.d_cleanUp),
-    d_allocator(l.d_allocator) {
+    d_allocator(l.d_allocator),
+    d_undoLevel(-1) {
     Debug("cdlist") << "copy ctor: " << this
                     << " from " << &l
                     << " size " << d_size << std::endl;
@@ -157,6 +164,33 @@ private:
     }
   }
 
+  /** Log the current size if this is its first change at this level */
+  void logUndo()
+  {
+    Context* c = getContext();
+    int level = c->getLevel();
+    if (d_undoLevel < level)
+    {
+      c->logUndo({&CDList<T, CleanUp, Allocator>::undo,
+                  this,
+                  static_cast<uint64_t>(d_size),
+                  d_undoLevel});
+      d_undoLevel = level;
+    }
+  }
+
+  /** The undo function of the records logged by logUndo() */
+  static void undo(const UndoRecord& r, bool apply)
+  {
+    if (apply)
+    {
+      CDList<T, CleanUp, Allocator>* l =
+          static_cast<CDList<T, CleanUp, Allocator>*>(r.d_obj);
+      l->truncateList(static_cast<size_t>(r.d_old));
+      l->d_undoLevel = r.d_level;
+    }
+  }
+
   /**
    * Implementation of mandatory ContextObj method save: simply copies
    * the current size to a copy using the copy constructor (the
@@ -195,6 +229,13 @@ protected:
                    << std::endl;
   }
 
+  /**
+   * Implementation of ContextObj method discard: a saved copy owns nothing,
+   * and truncating to an older size directly removes the same elements in
+   * the same order as truncating in steps.
+   */
+  bool discard(ContextObj* data) override { return true; }
+
   /**
    * Given a size parameter smaller than d_size, truncateList()
    * removes the elements from the end of the list until d_size equals size.
@@ -221,25 +262,40 @@ protected:
 public:
 
   /**
-   * Main constructor: d_list starts as NULL, size is 0
+   * Main constructor: d_list starts as NULL, size is 0.  The list is
+   * backtracked as given by mode, see BacktrackMode.
    */
   CDList(Context* context,
          bool callDestructor = true,
          const CleanUp& cleanup = CleanUp(),
-         const Allocator& alloc = Allocator()) :
+         const Allocator& alloc = Allocator(),
+         BacktrackMode mode = BacktrackMode::SAVE_RESTORE) :
     ContextObj(context),
     d_list(NULL),
     d_size(0),
     d_callDestructor(callDestructor),
     d_sizeAlloc(0),
     d_cleanUp(cleanup),
-    d_allocator(alloc) {
+    d_allocator(alloc),
+    d_undoLevel(mode == BacktrackMode::UNDO_LOG ? 0 : -1) {
+  }
+
+  /**
+   * Constructor for a list that is backtracked as given by mode.
+   */
+  CDList(Context* context, BacktrackMode mode)
+      : CDList(context, true, CleanUp(), Allocator(), mode)
+  {
   }
 
   /**
    * Destructor: delete the list
    */
   ~CDList() {
+    if (d_undoLevel > 0)
+    {
+      getContext()->forgetUndo(this);
+    }
     this->destroy();
 
     if(this->d_callDestructor) {
@@ -272,7 +328,14 @@ public:
                     << " " << getContext()->getLevel()
                     << ": make-current, "
                     << "d_list == " << d_list << std::endl;
-    makeCurrent();
+    if (d_undoLevel < 0)
+    {
+      makeCurrent();
+    }
+    else
+    {
+      logUndo();
+    }
 
     Debug("cdlist") << "push_back " << this
                     << " " << getContext()->getLevel()
@@ -28,6 +28,10 @@ namespace context {
  * Most basic template for context-dependent objects.  Simply makes a copy
  * (using the copy constructor) of class T when saving, and copies it back
  * (using operator=) during restore.
+ *
+ * Alternatively, a CDO can be backtracked with the undo log of its context
+ * (see BacktrackMode): the first change at each level then logs the old value
+ * only.
  */
 template <class T>
 class CDO : public ContextObj {
@@ -37,13 +41,52 @@ class CDO : public ContextObj {
    */
   T d_data;
 
+  /**
+   * The level at which d_data was last changed if this CDO uses the undo log,
+   * or -1 if it uses save() and restore().
+   */
+  int d_undoLevel;
+
+  /** Log the current value if this is its first change at this level */
+  void logUndo()
+  {
+    Context* c = getContext();
+    int level = c->getLevel();
+    if (d_undoLevel < level)
+    {
+      c->logUndo({&CDO<T>::undo,
+                  this,
+                  UndoValue<T>::save(getCMM(), d_data),
+                  d_undoLevel});
+      d_undoLevel = level;
+    }
+  }
+
+  /** The undo function of the records logged by logUndo() */
+  static void undo(const UndoRecord& r, bool apply)
+  {
+    if (apply)
+    {
+      CDO<T>* p = static_cast<CDO<T>*>(r.d_obj);
+      UndoValue<T>::restore(r.d_old, p->d_data);
+      p->d_undoLevel = r.d_level;
+    }
+    else
+    {
+      UndoValue<T>::release(r.d_old);
+    }
+  }
+
 protected:
 
   /**
    * Copy constructor - it's private to ensure it is only used by save().
    * Basic CDO objects, cannot be copied-they have to be unique.
    */
-  CDO(const CDO<T>& cdo) : ContextObj(cdo), d_data(cdo.d_data) {}
+  CDO(const CDO<T>& cdo)
+      : ContextObj(cdo), d_data(cdo.d_data), d_undoLevel(cdo.d_undoLevel)
+  {
+  }
 
   /**
    * operator= for CDO is private to ensure CDO object is not copied.
@@ -77,6 +120,17 @@ protected:
     p->d_data.~T();
   }
 
+  /**
+   * Implementation of ContextObj method discard: the value restored does not
+   * depend on the current one, so a saved copy can be skipped by destroying
+   * its data.
+   */
+  bool discard(ContextObj* pContextObj) override
+  {
+    static_cast<CDO<T>*>(pContextObj)->d_data.~T();
+    return true;
+  }
+
 public:
 
   /**
@@ -85,7 +139,18 @@ public:
    */
   CDO(Context* context) :
     ContextObj(context),
-    d_data(T()) {
+    d_data(T()),
+    d_undoLevel(-1) {
+  }
+
+  /**
+   * Main constructor with an explicit backtracking mode, see BacktrackMode.
+   */
+  CDO(Context* context, BacktrackMode mode)
+      : ContextObj(context),
+        d_data(T()),
+        d_undoLevel(mode == BacktrackMode::UNDO_LOG ? 0 : -1)
+  {
   }
 
   /**
@@ -101,7 +166,8 @@ public:
    */
   CDO(bool allocatedInCMM, Context* context) :
     ContextObj(allocatedInCMM, context),
-    d_data(T()) {
+    d_data(T()),
+    d_undoLevel(-1) {
   }
 
   /**
@@ -112,11 +178,24 @@ public:
    */
   CDO(Context* context, const T& data) :
     ContextObj(context),
-    d_data(T()) {
+    d_data(T()),
+    d_undoLevel(-1) {
     makeCurrent();
     d_data = data;
   }
 
+  /**
+   * Constructor from object of type T with an explicit backtracking mode,
+   * see BacktrackMode.
+   */
+  CDO(Context* context, const T& data, BacktrackMode mode)
+      : ContextObj(context),
+        d_data(T()),
+        d_undoLevel(mode == BacktrackMode::UNDO_LOG ? 0 : -1)
+  {
+    set(data);
+  }
+
   /**
    * Constructor from object of type T.  Creates a ContextObj and sets the data
    * to the given data value.  Note that this value is only valid in the
@@ -132,7 +211,8 @@ public:
    */
   CDO(bool allocatedInCMM, Context* context, const T& data) :
     ContextObj(allocatedInCMM, context),
-    d_data(T()) {
+    d_data(T()),
+    d_undoLevel(-1) {
     makeCurrent();
     d_data = data;
   }
@@ -140,13 +220,27 @@ public:
   /**
    * Destructor - call destroy() method
    */
-  ~CDO() { destroy(); }
+  ~CDO()
+  {
+    if (d_undoLevel > 0)
+    {
+      getContext()->forgetUndo(this);
+    }
+    destroy();
+  }
 
   /**
-   * Set the data in the CDO.  First call makeCurrent.
+   * Set the data in the CDO.  First call makeCurrent (or log the old value).
    */
   void set(const T& data) {
-    makeCurrent();
+    if (d_undoLevel < 0)
+    {
+      makeCurrent();
+    }
+    else
+    {
+      logUndo();
+    }
     d_data = data;
   }
 
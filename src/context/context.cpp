@@ -37,6 +37,7 @@ Context::Context() : d_pCNOpre(NULL), d_pCNOpost(NULL) {
 Context::~Context() {
   // Delete all Scopes
   popto(0);
+  Assert(d_undoLog.empty()) << "changes at level 0 are never undone";
 
   // Delete the memory manager
   delete d_pCMM;
@@ -66,54 +67,106 @@ void Context::push() {
   d_pCMM->push();
 
   // Create a new top Scope
-  d_scopeList.push_back(new(d_pCMM) Scope(this, d_pCMM, getLevel()+1));
+  d_scopeList.push_back(new (d_pCMM) Scope(
+      this, d_pCMM, getLevel() + 1, d_undoLog.size()));
 }
 
 
 void Context::pop() {
   Assert(getLevel() > 0) << "Cannot pop below level 0";
+  popto(getLevel() - 1);
+}
+
+
+void Context::popto(int toLevel) {
+  if(toLevel < 0) toLevel = 0;
+  int npops = getLevel() - toLevel;
+  if (npops <= 0)
+  {
+    return;
+  }
 
   // Notify the (pre-pop) ContextNotifyObj objects
-  ContextNotifyObj* pCNO = d_pCNOpre;
-  while(pCNO != NULL) {
-    // pre-store the "next" pointer in case pCNO deletes itself on notify()
-    ContextNotifyObj* next = pCNO->d_pCNOnext;
-    pCNO->contextNotifyPop();
-    pCNO = next;
+  for (int i = 0; i < npops; ++i)
+  {
+    notifyPop(d_pCNOpre);
   }
 
-  // Grab the top Scope
-  Scope* pScope = d_scopeList.back();
+  // Pop scopes until toLevel is reached
+  while (toLevel < getLevel())
+  {
+    // Grab the top Scope
+    Scope* pScope = d_scopeList.back();
+
+    // Restore the previous Scope
+    d_scopeList.pop_back();
 
-  // Restore the previous Scope
-  d_scopeList.pop_back();
+    if (!pScope->isEmpty())
+    {
+      // Undo the changes logged in the top Scope; this is done before its
+      // memory region is popped, since the records may point into it
+      undoTo(pScope->d_undoMark);
 
-  // Restore all objects in the top Scope
-  delete pScope;
+      // Restore all objects in the top Scope, straight to their state at
+      // toLevel
+      pScope->restoreTo(toLevel);
+    }
+    delete pScope;
 
-  // Pop the memory region
-  d_pCMM->pop();
+    // Pop the memory region
+    d_pCMM->pop();
+  }
 
   // Notify the (post-pop) ContextNotifyObj objects
-  pCNO = d_pCNOpost;
-  while(pCNO != NULL) {
+  for (int i = 0; i < npops; ++i)
+  {
+    notifyPop(d_pCNOpost);
+  }
+
+  Trace("pushpop") << std::string(2 * getLevel(), ' ') << "} Pop [to "
+                   << getLevel() << "] " << this << std::endl;
+}
+
+
+void Context::notifyPop(ContextNotifyObj* pCNO)
+{
+  while (pCNO != NULL)
+  {
     // pre-store the "next" pointer in case pCNO deletes itself on notify()
     ContextNotifyObj* next = pCNO->d_pCNOnext;
     pCNO->contextNotifyPop();
     pCNO = next;
   }
-
-  Trace("pushpop") << std::string(2 * getLevel(), ' ') << "} Pop [to "
-                   << getLevel() << "] " << this << std::endl;
 }
 
 
-void Context::popto(int toLevel) {
-  // Pop scopes until there are none left or toLevel is reached
-  if(toLevel < 0) toLevel = 0;
-  while(toLevel < getLevel()) pop();
+void Context::undoTo(size_t mark)
+{
+  Assert(mark <= d_undoLog.size());
+  Debug("context") << "undo " << d_undoLog.size() - mark << " record(s)"
+                   << std::endl;
+  while (d_undoLog.size() > mark)
+  {
+    // pop the record first: undoing it may destroy objects, which then
+    // forget their remaining records
+    UndoRecord r = d_undoLog.back();
+    d_undoLog.pop_back();
+    r.d_undo(r, true);
+  }
 }
 
+void Context::forgetUndo(const void* obj)
+{
+  for (UndoRecord& r : d_undoLog)
+  {
+    if (r.d_obj == obj)
+    {
+      r.d_undo(r, false);
+      r.d_undo = undoNothing;
+      r.d_obj = nullptr;
+    }
+  }
+}
 
 void Context::addNotifyObjPre(ContextNotifyObj* pCNO) {
   // Insert pCNO at *front* of list
@@ -193,11 +246,27 @@ void ContextObj::update()
                    << *getContext() << std::endl;
 }
 
-ContextObj* ContextObj::restoreAndContinue()
+ContextObj* ContextObj::restoreAndContinue(int toLevel)
 {
   // Variable to hold next object in list
   ContextObj* pContextObjNext;
 
+  // Skip the saved copies of levels that are popped as well, if possible.
+  // Such a copy is in the list of its Scope in place of this object; unlink
+  // it, so that popping that Scope does not restore from it.
+  while (d_pContextObjRestore != NULL
+         && d_pContextObjRestore->getLevel() > toLevel
+         && discard(d_pContextObjRestore))
+  {
+    ContextObj* pSkipped = d_pContextObjRestore;
+    if (pSkipped->next() != NULL)
+    {
+      pSkipped->next()->prev() = pSkipped->prev();
+    }
+    *pSkipped->prev() = pSkipped->next();
+    d_pContextObjRestore = pSkipped->d_pContextObjRestore;
+  }
+
   // Check the restore pointer.  If NULL, this must be the bottom Scope
   if(d_pContextObjRestore == NULL) {
     // might not be bottom scope, since objects allocated in context
@@ -363,12 +432,12 @@ std::ostream& operator<<(std::ostream& out, const Scope& scope)
   return out << " --> NULL";
 }
 
-Scope::~Scope() {
+void Scope::restoreTo(int toLevel) {
   // Call restore() method on each ContextObj object in the list.
   // Note that it is the responsibility of restore() to return the
   // next item in the list.
   while (d_pContextObjList != NULL) {
-    d_pContextObjList = d_pContextObjList->restoreAndContinue();
+    d_pContextObjList = d_pContextObjList->restoreAndContinue(toLevel);
   }
 
   if (d_garbage) {
@@ -19,9 +19,14 @@
 #ifndef CVC4__CONTEXT__CONTEXT_H
 #define CVC4__CONTEXT__CONTEXT_H
 
+#include <climits>
+#include <cstdint>
 #include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <memory>
+#include <new>
+#include <type_traits>
 #include <typeinfo>
 #include <vector>
 
@@ -37,6 +42,99 @@ class Scope;
 class ContextObj;
 class ContextNotifyObj;
 
+/**
+ * How a context-dependent object (CDO, CDList, CDHashMap) is backtracked.
+ *
+ * SAVE_RESTORE: the first change of the object at each level saves a copy of
+ * the object in context memory (see ContextObj::save()), and pop() restores
+ * it from that copy (see ContextObj::restore()).
+ *
+ * UNDO_LOG: the first change of the object at each level appends a compact
+ * record of the overwritten value to the undo log of the Context (see
+ * UndoRecord), and pop() replays the records of the popped level in reverse.
+ * This avoids copying the whole object and the bookkeeping of the scope
+ * lists, which pays off for objects that change at many levels, e.g., the
+ * elements of a CDHashMap in a deep search.
+ */
+enum class BacktrackMode
+{
+  SAVE_RESTORE,
+  UNDO_LOG
+};
+
+/**
+ * A record of the undo log of a Context.  Calling d_undo(r, true) restores
+ * the value of the object d_obj that was overwritten when the record was
+ * logged; calling d_undo(r, false) only releases the record (see
+ * Context::forgetUndo()).  The overwritten value is stored in d_old, either
+ * directly if it fits, or as a pointer to a copy in context memory (which
+ * lives until the record is undone, since the record is undone when the
+ * level it was logged at is popped).
+ */
+struct UndoRecord
+{
+  /** The function undoing or releasing this record */
+  void (*d_undo)(const UndoRecord& r, bool apply);
+  /** The object that was changed */
+  void* d_obj;
+  /** The overwritten value, or a pointer to it */
+  uint64_t d_old;
+  /** The level at which the object was last changed before this change */
+  int d_level;
+};
+
+/**
+ * Storage of an overwritten value of type T in UndoRecord::d_old: values of
+ * trivially copyable types that fit are stored directly, other values are
+ * copied to context memory.
+ */
+template <class T>
+struct UndoValue
+{
+  static constexpr bool INLINE = std::is_trivially_copyable<T>::value
+                                 && sizeof(T) <= sizeof(uint64_t);
+
+  /** Store a copy of v, allocating in cmm if necessary */
+  static uint64_t save(ContextMemoryManager* cmm, const T& v)
+  {
+    uint64_t old = 0;
+    if constexpr (INLINE)
+    {
+      std::memcpy(&old, &v, sizeof(T));
+    }
+    else
+    {
+      T* p = new (cmm->newData(sizeof(T))) T(v);
+      old = reinterpret_cast<uintptr_t>(p);
+    }
+    return old;
+  }
+
+  /** Assign the stored copy to v and release it */
+  static void restore(uint64_t old, T& v)
+  {
+    if constexpr (INLINE)
+    {
+      std::memcpy(&v, &old, sizeof(T));
+    }
+    else
+    {
+      T* p = reinterpret_cast<T*>(static_cast<uintptr_t>(old));
+      v = *p;
+      p->~T();
+    }
+  }
+
+  /** Release the stored copy without using it */
+  static void release(uint64_t old)
+  {
+    if constexpr (!INLINE)
+    {
+      reinterpret_cast<T*>(static_cast<uintptr_t>(old))->~T();
+    }
+  }
+};
+
 /** Pretty-printing of Contexts (for debugging) */
 std::ostream& operator<<(std::ostream&, const Context&);
 
@@ -88,6 +186,21 @@ class Context {
    */
   ContextNotifyObj* d_pCNOpost;
 
+  /**
+   * The undo log of the objects backtracked with BacktrackMode::UNDO_LOG.
+   * The records logged at each level are above the undo mark of its Scope.
+   */
+  std::vector<UndoRecord> d_undoLog;
+
+  /** Undo the records of the undo log above mark, most recent first */
+  void undoTo(size_t mark);
+
+  /** Call contextNotifyPop() on each object of the list starting at pCNO */
+  static void notifyPop(ContextNotifyObj* pCNO);
+
+  /** An undo function that does nothing, for released records */
+  static void undoNothing(const UndoRecord& r, bool apply) {}
+
   friend std::ostream& operator<<(std::ostream&, const Context&);
 
   // disable copy, assignment
@@ -180,10 +293,32 @@ public:
   void pop();
 
   /**
-   * Pop all the way back to given level
+   * Pop all the way back to given level.  The levels are popped at once:
+   * the saved copies of objects that changed at several of the popped levels
+   * are skipped where possible (see ContextObj::discard()), so that each
+   * object is restored once, and scopes in which nothing changed cost next
+   * to nothing.  The ContextNotifyObj objects are notified once per popped
+   * level, the pre-pop ones before and the post-pop ones after all levels
+   * have been popped.
    */
   void popto(int toLevel);
 
+  /**
+   * Append r to the undo log: r is undone when the current level is popped.
+   * Objects should log a record only for the first change at each level.
+   */
+  void logUndo(const UndoRecord& r) { d_undoLog.push_back(r); }
+
+  /**
+   * Release the records of obj in the undo log, which must be done by an
+   * object that logged records when it is destroyed.  This takes time linear
+   * in the size of the undo log.
+   */
+  void forgetUndo(const void* obj);
+
+  /** Get the number of records in the undo log */
+  size_t getUndoLogSize() const { return d_undoLog.size(); }
+
   /**
    * Add pCNO to the list of objects notified before every pop
    */
@@ -260,6 +395,13 @@ class Scope {
    */
   std::unique_ptr<std::vector<ContextObj*>> d_garbage;
 
+  /**
+   * The size of the undo log of the Context when this Scope was created;
+   * the records above it are undone when this Scope is popped.
+   */
+  size_t d_undoMark;
+
+  friend class Context;
   friend std::ostream& operator<<(std::ostream&, const Scope&);
 
  public:
@@ -267,12 +409,16 @@ class Scope {
    * Constructor: Create a new Scope; set the level and the previous Scope
    * if any.
    */
-  Scope(Context* pContext, ContextMemoryManager* pCMM, int level)
+  Scope(Context* pContext,
+        ContextMemoryManager* pCMM,
+        int level,
+        size_t undoMark = 0)
       : d_pContext(pContext),
         d_pCMM(pCMM),
         d_level(level),
         d_pContextObjList(nullptr),
-        d_garbage()
+        d_garbage(),
+        d_undoMark(undoMark)
   {
   }
 
@@ -280,7 +426,24 @@ class Scope {
    * Destructor: Clears out all of the garbage and restore all of the objects
    * in ContextObjList.
    */
-  ~Scope();
+  ~Scope() { restoreTo(d_level - 1); }
+
+  /**
+   * Restore all of the objects in ContextObjList to their state at level
+   * toLevel < d_level, which may be below the previous Scope, and clear out
+   * all of the garbage.
+   */
+  void restoreTo(int toLevel);
+
+  /**
+   * Return true if no object changed in this Scope, so that popping it
+   * restores nothing.
+   */
+  bool isEmpty() const
+  {
+    return d_pContextObjList == nullptr && !d_garbage
+           && d_undoMark == d_pContext->getUndoLogSize();
+  }
 
   /**
    * Get the Context for this Scope
@@ -476,9 +639,10 @@ class ContextObj {
   /**
    * This method is called by Scope during a pop: it does the necessary work to
    * restore the object from its saved copy and then returns the next object in
-   * the list that needs to be restored.
+   * the list that needs to be restored.  Saved copies of levels above toLevel
+   * are skipped if the object can discard() them.
    */
-  ContextObj* restoreAndContinue();
+  ContextObj* restoreAndContinue(int toLevel = INT_MAX);
 
  protected:
   /**
@@ -493,6 +657,16 @@ class ContextObj {
    */
   virtual void restore(ContextObj* pContextObjRestore) = 0;
 
+  /**
+   * Release the saved copy pContextObjRestore without restoring from it and
+   * return true, or return false (the default) if that is not possible.
+   * Context::popto() discards the saved copies of the intermediate levels it
+   * pops, and restores the object only from the oldest one.  Subclasses may
+   * override this if restore() sets the object to a state that depends only
+   * on the saved copy, not on the current state of the object.
+   */
+  virtual bool discard(ContextObj* pContextObjRestore) { return false; }
+
   /**
    * This method checks if the object has been modified in this Scope
    * yet.  If not, it calls update().
@@ -660,7 +834,9 @@ class ContextObj {
  * and simply get a notification when a pop has occurred.  See
  * Context class for how to register a ContextNotifyObj with the
  * Context (you can choose to have notification come before or after
- * the ContextObj objects have been restored).
+ * the ContextObj objects have been restored).  Objects are notified once
+ * per popped level; when Context::popto() pops several levels, all
+ * notifications come before or after all levels have been restored.
  */
 class ContextNotifyObj {
 
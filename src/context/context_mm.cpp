@@ -14,13 +14,19 @@
  ** Implementation of Context Memory Manager
  **/
 
+#include <algorithm>
 #include <cstdlib>
 #include <deque>
+#include <iterator>
 #include <limits>
 #include <new>
 #include <ostream>
 #include <vector>
 
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
 #ifdef CVC4_VALGRIND
 #include <valgrind/memcheck.h>
 #endif /* CVC4_VALGRIND */
@@ -34,49 +40,121 @@ namespace context {
 
 #ifndef CVC4_DEBUG_CONTEXT_MEMORY_MANAGER
 
-void ContextMemoryManager::newChunk() {
+size_t ContextMemoryManager::getChunkSize(unsigned i)
+{
+  size_t size = minChunkSizeBytes;
+  if (i < numMinChunks)
+  {
+    return size;
+  }
+  for (unsigned n = (i - numMinChunks) / chunksPerDoubling + 1;
+       n > 0 && size < maxChunkSizeBytes;
+       --n)
+  {
+    size *= 2;
+  }
+  return std::min(size, maxChunkSizeBytes);
+}
+
+ContextMemoryManager::Chunk ContextMemoryManager::allocateChunk(size_t size)
+{
+  Chunk chunk = {nullptr, size};
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+  if (d_hugePages && size >= maxChunkSizeBytes)
+  {
+    // round up to whole huge pages, and align to them
+    chunk.d_size = (size + maxChunkSizeBytes - 1) / maxChunkSizeBytes
+                   * maxChunkSizeBytes;
+    void* data = nullptr;
+    if (posix_memalign(&data, maxChunkSizeBytes, chunk.d_size) == 0)
+    {
+      // only advice; the kernel may or may not use huge pages
+      madvise(data, chunk.d_size, MADV_HUGEPAGE);
+      chunk.d_data = static_cast<char*>(data);
+    }
+  }
+  else
+#endif
+  {
+    chunk.d_data = static_cast<char*>(malloc(size));
+  }
+  if (chunk.d_data == nullptr)
+  {
+    throw std::bad_alloc();
+  }
+  ++d_numChunkAllocations;
+  Debug("context") << "ContextMemoryManager: new chunk of " << chunk.d_size
+                   << " bytes" << std::endl;
+
+#ifdef CVC4_VALGRIND
+  VALGRIND_MAKE_MEM_NOACCESS(chunk.d_data, chunk.d_size);
+#endif /* CVC4_VALGRIND */
+  return chunk;
+}
+
+void ContextMemoryManager::newChunk(size_t size) {
 
   // Increment index to chunk list
   ++d_indexChunkList;
   Assert(d_chunkList.size() == d_indexChunkList)
       << "Index should be at the end of the list";
 
-  // Create new chunk if no free chunk available
-  if(d_freeChunks.empty()) {
-    d_chunkList.push_back((char*)malloc(chunkSizeBytes));
-    if(d_chunkList.back() == NULL) {
-      throw std::bad_alloc();
-    }
-
-#ifdef CVC4_VALGRIND
-    VALGRIND_MAKE_MEM_NOACCESS(d_chunkList.back(), chunkSizeBytes);
-#endif /* CVC4_VALGRIND */
+  // If there is a free chunk that is big enough, use the most recently
+  // freed one, so that smaller chunks are not left behind a big request
+  std::deque<Chunk>::reverse_iterator it = d_freeChunks.rbegin();
+  while (it != d_freeChunks.rend() && it->d_size < size)
+  {
+    ++it;
   }
-  // If there is a free chunk, use that
-  else {
-    d_chunkList.push_back(d_freeChunks.back());
-    d_freeChunks.pop_back();
+  if (it != d_freeChunks.rend())
+  {
+    d_chunkList.push_back(*it);
+    d_freeChunks.erase(std::next(it).base());
+    d_freeBytes -= d_chunkList.back().d_size;
+  }
+  // Create new chunk otherwise
+  else
+  {
+    d_chunkList.push_back(
+        allocateChunk(std::max(size, getChunkSize(d_indexChunkList))));
   }
+  d_activeBytes += d_chunkList.back().d_size;
+  d_highWaterBytes = std::max(d_highWaterBytes, d_activeBytes);
+
   // Set up the current chunk pointers
-  d_nextFree = d_chunkList.back();
-  d_endChunk = d_nextFree + chunkSizeBytes;
+  d_nextFree = d_chunkList.back().d_data;
+  d_endChunk = d_nextFree + d_chunkList.back().d_size;
 }
 
-
-ContextMemoryManager::ContextMemoryManager() : d_indexChunkList(0) {
-  // Create initial chunk
-  d_chunkList.push_back((char*)malloc(chunkSizeBytes));
-  d_nextFree = d_chunkList.back();
-  if(d_nextFree == NULL) {
-    throw std::bad_alloc();
+void ContextMemoryManager::trimFreeChunks()
+{
+  while (d_freeBytes > d_maxFreeBytes)
+  {
+    d_freeBytes -= d_freeChunks.front().d_size;
+    free(d_freeChunks.front().d_data);
+    d_freeChunks.pop_front();
   }
-  d_endChunk = d_nextFree + chunkSizeBytes;
+}
 
+ContextMemoryManager::ContextMemoryManager()
+    : d_indexChunkList(0),
+      d_maxFreeBytes(defaultMaxFreeBytes),
+      d_hugePages(false),
+      d_activeBytes(0),
+      d_freeBytes(0),
+      d_highWaterBytes(0),
+      d_numChunkAllocations(0)
+{
 #ifdef CVC4_VALGRIND
   VALGRIND_CREATE_MEMPOOL(this, 0, false);
-  VALGRIND_MAKE_MEM_NOACCESS(d_nextFree, chunkSizeBytes);
   d_allocations.push_back(std::vector<char*>());
 #endif /* CVC4_VALGRIND */
+
+  // Create initial chunk
+  d_chunkList.push_back(allocateChunk(minChunkSizeBytes));
+  d_nextFree = d_chunkList.back().d_data;
+  d_endChunk = d_nextFree + minChunkSizeBytes;
+  d_activeBytes = d_highWaterBytes = minChunkSizeBytes;
 }
 
 
@@ -85,13 +163,18 @@ ContextMemoryManager::~ContextMemoryManager() {
   VALGRIND_DESTROY_MEMPOOL(this);
 #endif /* CVC4_VALGRIND */
 
+  Debug("context") << "ContextMemoryManager: high-water mark "
+                   << d_highWaterBytes << " bytes, "
+                   << d_numChunkAllocations << " chunk allocations"
+                   << std::endl;
+
   // Delete all chunks
   while(!d_chunkList.empty()) {
-    free(d_chunkList.back());
+    free(d_chunkList.back().d_data);
     d_chunkList.pop_back();
   }
   while(!d_freeChunks.empty()) {
-    free(d_freeChunks.back());
+    free(d_freeChunks.back().d_data);
     d_freeChunks.pop_back();
   }
 }
@@ -103,10 +186,10 @@ void* ContextMemoryManager::newData(size_t size) {
   d_nextFree += size;
   // Check if the request is too big for the chunk
   if(d_nextFree > d_endChunk) {
-    newChunk();
+    newChunk(size);
     res = (void*)d_nextFree;
     d_nextFree += size;
-    AlwaysAssert(d_nextFree <= d_endChunk)
+    Assert(d_nextFree <= d_endChunk)
         << "Request is bigger than memory chunk size";
   }
   Debug("context") << "ContextMemoryManager::newData(" << size
@@ -153,21 +236,28 @@ void ContextMemoryManager::pop() {
 
   // Free all the new chunks since the last push
   while(d_indexChunkList > d_indexChunkListStack.back()) {
-    d_freeChunks.push_back(d_chunkList.back());
+    const Chunk& chunk = d_chunkList.back();
 #ifdef CVC4_VALGRIND
-    VALGRIND_MAKE_MEM_NOACCESS(d_chunkList.back(), chunkSizeBytes);
+    VALGRIND_MAKE_MEM_NOACCESS(chunk.d_data, chunk.d_size);
 #endif /* CVC4_VALGRIND */
+    d_activeBytes -= chunk.d_size;
+    d_freeBytes += chunk.d_size;
+    d_freeChunks.push_back(chunk);
     d_chunkList.pop_back();
     --d_indexChunkList;
   }
   d_indexChunkListStack.pop_back();
 
   // Delete excess free chunks
-  while(d_freeChunks.size() > maxFreeChunks) {
-    free(d_freeChunks.front());
-    d_freeChunks.pop_front();
-  }
+  trimFreeChunks();
+}
+
+void ContextMemoryManager::setMaxFreeBytes(size_t bytes)
+{
+  d_maxFreeBytes = bytes;
+  trimFreeChunks();
 }
+
 #else
 
 unsigned ContextMemoryManager::getMaxAllocationSize()
@@ -20,8 +20,11 @@
 #ifndef CVC4__CONTEXT__CONTEXT_MM_H
 #define CVC4__CONTEXT__CONTEXT_MM_H
 
+#include <cstddef>
+#include <cstdint>
 #ifndef CVC4_DEBUG_CONTEXT_MEMORY_MANAGER
 #include <deque>
+#include <limits>
 #endif
 #include <vector>
 
@@ -39,29 +42,59 @@ namespace context {
  * stack, and a new current region is created.  A subsequent call to pop
  * releases the new region and restores the top region from the stack.
  *
+ * Regions are made of chunks whose size adapts to the workload: the first
+ * 100 chunks are small, and beyond them the size doubles every few chunks
+ * that are in use at the same time, so that deep pushes with big saved
+ * objects do not go through a chunk per few objects, while shallow
+ * workloads do not hold on to big chunks.  Chunks released by pop are kept for reuse up to a cap on
+ * the retained bytes (see setMaxFreeBytes()), and can optionally be backed
+ * by transparent huge pages (see setHugePages()).
  */
 class ContextMemoryManager {
 
+  /** A chunk of memory and its size */
+  struct Chunk
+  {
+    char* d_data;
+    size_t d_size;
+  };
+
   /**
-   * Memory in regions is allocated in chunks.  This is the chunk size
+   * Memory in regions is allocated in chunks.  This is the size of the
+   * first chunks
    */
-  static const unsigned chunkSizeBytes = 16384;
+  static constexpr size_t minChunkSizeBytes = 16384;
+
+  /** The number of chunks in use before the chunks start to grow */
+  static constexpr size_t numMinChunks = 100;
 
   /**
-   * A list of free chunks is maintained.  This is the maximum number of
-   * free chunks.
+   * Beyond numMinChunks, the size of the chunks doubles every
+   * chunksPerDoubling chunks in use, up to maxChunkSizeBytes
    */
-  static const unsigned maxFreeChunks = 100;
+  static constexpr size_t chunksPerDoubling = 8;
+
+  /**
+   * The maximum size of a chunk, except for chunks holding a single bigger
+   * request.  This is the size of a huge page, see setHugePages().
+   */
+  static constexpr size_t maxChunkSizeBytes = 2 * 1024 * 1024;
+
+  /**
+   * The default maximum number of bytes in free chunks, see
+   * setMaxFreeBytes().  This is 100 chunks of the smallest size.
+   */
+  static constexpr size_t defaultMaxFreeBytes = numMinChunks * minChunkSizeBytes;
 
   /**
    * List of all chunks that are currently active
    */
-  std::vector<char*> d_chunkList;
+  std::vector<Chunk> d_chunkList;
 
   /**
    * Queue of free chunks (for best cache performance, LIFO order is used)
    */
-  std::deque<char*> d_freeChunks;
+  std::deque<Chunk> d_freeChunks;
 
   /**
    * Pointer to the beginning of available memory in the current chunk in
@@ -98,12 +131,40 @@ class ContextMemoryManager {
    */
   std::vector<unsigned> d_indexChunkListStack;
 
+  /** The maximum number of bytes in d_freeChunks */
+  size_t d_maxFreeBytes;
+
+  /** Whether chunks of maxChunkSizeBytes are backed by huge pages */
+  bool d_hugePages;
+
+  /** The number of bytes in d_chunkList */
+  uint64_t d_activeBytes;
+
+  /** The number of bytes in d_freeChunks */
+  uint64_t d_freeBytes;
+
+  /** The maximum value d_activeBytes has had */
+  uint64_t d_highWaterBytes;
+
+  /** The number of chunks allocated from the system */
+  uint64_t d_numChunkAllocations;
+
   /**
-   * Private method to grab a new chunk for the current region.  Uses chunk
-   * from d_freeChunks if available.  Creates a new one otherwise.  Sets the
-   * new chunk to be the current chunk.
+   * Private method to grab a new chunk of at least size bytes for the
+   * current region.  Uses the last chunk of d_freeChunks that is big enough
+   * if there is one.  Creates a new one otherwise.  Sets the new chunk to be the
+   * current chunk.
    */
-  void newChunk();
+  void newChunk(size_t size);
+
+  /** Get the size of a new chunk at index i of d_chunkList */
+  static size_t getChunkSize(unsigned i);
+
+  /** Allocate a chunk of at least size bytes from the system */
+  Chunk allocateChunk(size_t size);
+
+  /** Free excess chunks of d_freeChunks, oldest first */
+  void trimFreeChunks();
 
 #ifdef CVC4_VALGRIND
   /**
@@ -115,10 +176,11 @@ class ContextMemoryManager {
 
  public:
   /**
-   * Get the maximum allocation size for this memory manager.
+   * Get the maximum allocation size for this memory manager.  Requests
+   * bigger than the chunk size get a chunk of their own.
    */
   static unsigned getMaxAllocationSize() {
-    return chunkSizeBytes;
+    return std::numeric_limits<unsigned>::max();
   }
 
   /**
@@ -147,6 +209,34 @@ class ContextMemoryManager {
    */
   void pop();
 
+  /**
+   * Set the maximum number of bytes in chunks that pop keeps for reuse
+   * instead of returning them to the system.
+   */
+  void setMaxFreeBytes(size_t bytes);
+
+  /**
+   * Set whether chunks of the maximum chunk size are allocated aligned to
+   * huge pages and advised to be backed by transparent huge pages.  Only
+   * affects chunks allocated afterwards, and only has an effect on Linux.
+   */
+  void setHugePages(bool hugePages) { d_hugePages = hugePages; }
+
+  /** Get the number of bytes in chunks used by regions */
+  const uint64_t& getActiveBytes() const { return d_activeBytes; }
+
+  /** Get the number of bytes in chunks kept for reuse */
+  const uint64_t& getFreeBytes() const { return d_freeBytes; }
+
+  /** Get the maximum number of bytes that were in chunks used by regions */
+  const uint64_t& getHighWaterBytes() const { return d_highWaterBytes; }
+
+  /** Get the number of chunks that were allocated from the system */
+  const uint64_t& getNumChunkAllocations() const
+  {
+    return d_numChunkAllocations;
+  }
+
 };/* class ContextMemoryManager */
 
 #else /* CVC4_DEBUG_CONTEXT_MEMORY_MANAGER */
@@ -194,8 +284,18 @@ class ContextMemoryManager
     d_allocations.pop_back();
   }
 
+  void setMaxFreeBytes(size_t bytes) {}
+  void setHugePages(bool hugePages) {}
+
+  /** No accounting; all statistics are zero */
+  const uint64_t& getActiveBytes() const { return d_zero; }
+  const uint64_t& getFreeBytes() const { return d_zero; }
+  const uint64_t& getHighWaterBytes() const { return d_zero; }
+  const uint64_t& getNumChunkAllocations() const { return d_zero; }
+
  private:
   std::vector<std::vector<char*>> d_allocations;
+  uint64_t d_zero = 0;
 }; /* ContextMemoryManager */
 
 #endif /* CVC4_DEBUG_CONTEXT_MEMORY_MANAGER */
@@ -151,6 +151,12 @@ class DecisionEngine {
   SatValue getSatValue(TNode n) {
     return getSatValue(getSatLiteral(n));
   }
+  double getSatActivity(TNode n)
+  {
+    return hasSatLiteral(n)
+               ? d_satSolver->getActivity(getSatLiteral(n).getSatVariable())
+               : 0;
+  }
   Node getNode(SatLiteral l) {
     return d_cnfStream->getNode(l);
   }
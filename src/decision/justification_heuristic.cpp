@@ -41,11 +41,15 @@ JustificationHeuristic::JustificationHeuristic(CVC5::DecisionEngine* de,
       d_threshPrvsIndex(c, 0),
       d_helpfulness("decision::jh::helpfulness", 0),
       d_giveup("decision::jh::giveup", 0),
+      d_resumed("decision::jh::resumed", 0),
       d_timestat("decision::jh::time"),
       d_assertions(uc),
       d_skolemAssertions(uc),
       d_skolemCache(uc),
       d_visited(),
+      d_path(),
+      d_frontier(),
+      d_frontierIndex(0),
       d_visitedComputeSkolems(),
       d_curDecision(),
       d_curThreshold(0),
@@ -55,6 +59,7 @@ JustificationHeuristic::JustificationHeuristic(CVC5::DecisionEngine* de,
 {
   smtStatisticsRegistry()->registerStat(&d_helpfulness);
   smtStatisticsRegistry()->registerStat(&d_giveup);
+  smtStatisticsRegistry()->registerStat(&d_resumed);
   smtStatisticsRegistry()->registerStat(&d_timestat);
   Trace("decision") << "Justification heuristic enabled" << std::endl;
 }
@@ -63,6 +68,7 @@ JustificationHeuristic::~JustificationHeuristic()
 {
   smtStatisticsRegistry()->unregisterStat(&d_helpfulness);
   smtStatisticsRegistry()->unregisterStat(&d_giveup);
+  smtStatisticsRegistry()->unregisterStat(&d_resumed);
   smtStatisticsRegistry()->unregisterStat(&d_timestat);
 }
 
@@ -88,7 +94,6 @@ CVC5::prop::SatLiteral JustificationHeuristic::getNextThresh(
   Trace("decision") << "JustificationHeuristic::getNextThresh(stopSearch, "<<threshold<<")" << std::endl;
   TimerStat::CodeTimer codeTimer(d_timestat);
 
-  d_visited.clear();
   d_curThreshold = threshold;
 
   if(Trace.isOn("justified")) {
@@ -103,6 +108,21 @@ CVC5::prop::SatLiteral JustificationHeuristic::getNextThresh(
     }
   }
 
+  if (d_curThreshold == 0)
+  {
+    prop::SatLiteral litDecision = resumeFromFrontier();
+    if (litDecision != prop::undefSatLiteral)
+    {
+      Trace("decision") << "jh: splitting on " << litDecision
+                        << " (resumed)" << std::endl;
+      ++d_helpfulness;
+      ++d_resumed;
+      return litDecision;
+    }
+  }
+
+  d_path.clear();
+  d_visited.clear();
   for(unsigned i = getPrvsIndex(); i < d_assertions.size(); ++i) {
     Debug("decision") << "---" << std::endl << d_assertions[i] << std::endl;
 
@@ -118,6 +138,10 @@ CVC5::prop::SatLiteral JustificationHeuristic::getNextThresh(
     if (litDecision != prop::undefSatLiteral)
     {
       setPrvsIndex(i);
+      if (d_curThreshold == 0)
+      {
+        d_frontierIndex = i;
+      }
       Trace("decision") << "jh: splitting on " << litDecision << std::endl;
       ++d_helpfulness;
       return litDecision;
@@ -174,6 +198,68 @@ inline void computeXorIffDesiredValues(Kind k,
   }
 }
 
+SatLiteral JustificationHeuristic::resumeFromFrontier()
+{
+  d_path.clear();
+  d_visited.clear();
+  if (d_frontier.empty() || d_frontierIndex >= d_assertions.size()
+      || d_assertions[d_frontierIndex] != d_frontier[0].first)
+  {
+    // no decision yet, or its assertion was popped
+    return undefSatLiteral;
+  }
+
+  // Find the part of the frontier that the search would still take. The
+  // desired values are recomputed from the current assignment, which may have
+  // changed since the frontier was saved, e.g. by backtracking.
+  TNode node;
+  SatValue desiredVal = SAT_VALUE_TRUE;
+  size_t valid = 0;
+  for (; valid < d_frontier.size(); ++valid)
+  {
+    TNode child = d_frontier[valid].first;
+    SatValue childVal = d_frontier[valid].second;
+    if (valid > 0)
+    {
+      if (getDesiredChildValue(node, desiredVal, child) != childVal)
+      {
+        break;
+      }
+      if (isAtom(node))
+      {
+        d_visited.insert(child);
+      }
+    }
+    node = child;
+    desiredVal = childVal;
+    while (node.getKind() == kind::NOT)
+    {
+      desiredVal = invertValue(desiredVal);
+      node = node[0];
+    }
+    if (checkJustified(node) || tryGetSatValue(node) == invertValue(desiredVal))
+    {
+      break;
+    }
+  }
+
+  // Search below the valid nodes, deepest first. Once a node is justified,
+  // its parent has to look for another child to justify.
+  d_path.assign(d_frontier.begin(), d_frontier.begin() + valid);
+  d_curDecision = undefSatLiteral;
+  while (!d_path.empty())
+  {
+    std::pair<Node, SatValue> p = d_path.back();
+    d_path.pop_back();
+    if (findSplitterRec(p.first, p.second) == FOUND_SPLITTER)
+    {
+      return d_curDecision;
+    }
+    d_visited.erase(p.first);
+  }
+  return undefSatLiteral;
+}
+
 void JustificationHeuristic::addAssertion(TNode assertion)
 {
   // Save all assertions locally, including the assertions generated by term
@@ -360,6 +446,15 @@ TNode JustificationHeuristic::getChildByWeight(TNode n, int i, bool polarity) {
   }
 }
 
+double JustificationHeuristic::getActivityScore(TNode n, SatValue desiredVal)
+{
+  if (tryGetSatValue(n) == desiredVal)
+  {
+    return std::numeric_limits<double>::infinity();
+  }
+  return d_decisionEngine->getSatActivity(n);
+}
+
 SatValue JustificationHeuristic::tryGetSatValue(Node n)
 {
   Debug("decision") << "   "  << n << " has sat value " << " ";
@@ -409,8 +504,82 @@ void JustificationHeuristic::computeSkolems(TNode n, SkolemList& l)
   }
 }
 
+bool JustificationHeuristic::isAtom(TNode n)
+{
+  Kind k = n.getKind();
+  return (k == kind::BOOLEAN_TERM_VARIABLE)
+         || ((theory::kindToTheoryId(k) != theory::THEORY_BOOL)
+             && (k != kind::EQUAL || (!n[0].getType().isBoolean())));
+}
+
+SatValue JustificationHeuristic::getDesiredChildValue(TNode node,
+                                                      SatValue desiredVal,
+                                                      TNode child)
+{
+  if (isAtom(node))
+  {
+    // the definitions of the skolems of an atom must hold
+    const SkolemList l = getSkolems(node);
+    for (SkolemList::const_iterator i = l.begin(); i != l.end(); ++i)
+    {
+      if ((*i).second == child)
+      {
+        return SAT_VALUE_TRUE;
+      }
+    }
+    return SAT_VALUE_UNKNOWN;
+  }
+
+  switch (node.getKind())
+  {
+    case kind::AND:
+    case kind::OR: return desiredVal;
+
+    case kind::IMPLIES:
+      return child == node[0] ? invertValue(desiredVal) : desiredVal;
+
+    case kind::XOR:
+    case kind::EQUAL:
+    {
+      SatValue desiredVal1 = tryGetSatValue(node[0]);
+      SatValue desiredVal2 = tryGetSatValue(node[1]);
+      computeXorIffDesiredValues(
+          node.getKind(), desiredVal, desiredVal1, desiredVal2);
+      return child == node[0] ? desiredVal1 : desiredVal2;
+    }
+
+    case kind::ITE:
+    {
+      SatValue ifVal = tryGetSatValue(node[0]);
+      if (child == node[0])
+      {
+        return ifVal == SAT_VALUE_UNKNOWN
+                   ? getDesiredConditionValue(node, desiredVal)
+                   : ifVal;
+      }
+      if (ifVal == SAT_VALUE_UNKNOWN)
+      {
+        return SAT_VALUE_UNKNOWN;
+      }
+      return child == node[ifVal == SAT_VALUE_TRUE ? 1 : 2] ? desiredVal
+                                                            : SAT_VALUE_UNKNOWN;
+    }
+
+    default: return SAT_VALUE_UNKNOWN;
+  }
+}
+
 JustificationHeuristic::SearchResult
 JustificationHeuristic::findSplitterRec(TNode node, SatValue desiredVal)
+{
+  d_path.push_back(std::make_pair(node, desiredVal));
+  SearchResult ret = findSplitterNode(node, desiredVal);
+  d_path.pop_back();
+  return ret;
+}
+
+JustificationHeuristic::SearchResult
+JustificationHeuristic::findSplitterNode(TNode node, SatValue desiredVal)
 {
   /**
    * Main idea
@@ -467,10 +636,6 @@ JustificationHeuristic::findSplitterRec(TNode node, SatValue desiredVal)
   /* What type of node is this */
   Kind k = node.getKind();
   theory::TheoryId tId = theory::kindToTheoryId(k);
-  bool isAtom =
-     (k == kind::BOOLEAN_TERM_VARIABLE ) ||
-     ( (tId != theory::THEORY_BOOL) &&
-       (k != kind::EQUAL || (!node[0].getType().isBoolean())) );
 
   /* Some debugging stuff */
   Debug("decision::jh") << "kind = " << k << std::endl
@@ -481,7 +646,8 @@ JustificationHeuristic::findSplitterRec(TNode node, SatValue desiredVal)
   /**
    * If not in theory of booleans, check if this is something to split-on.
    */
-  if(isAtom) {
+  if (isAtom(node))
+  {
     // if node has embedded skolems due to term removal, resolve that first
     if (handleEmbeddedSkolems(node) == FOUND_SPLITTER) return FOUND_SPLITTER;
 
@@ -497,6 +663,10 @@ JustificationHeuristic::findSplitterRec(TNode node, SatValue desiredVal)
       SatVariable v =
         d_decisionEngine->getSatLiteral(node).getSatVariable();
       d_curDecision = SatLiteral(v, /* negated = */ desiredVal != SAT_VALUE_TRUE );
+      if (d_curThreshold == 0)
+      {
+        d_frontier = d_path;
+      }
       Trace("decision-node") << "[decision-node] requesting split on " << d_curDecision
                              << ", node: " << node
                              << ", polarity: " << (desiredVal == SAT_VALUE_TRUE ? "true" : "false") << std::endl;
@@ -573,15 +743,45 @@ JustificationHeuristic::handleAndOrEasy(TNode node, SatValue desiredVal)
 
   int numChildren = node.getNumChildren();
   SatValue desiredValInverted = invertValue(desiredVal);
-  for(int i = 0; i < numChildren; ++i) {
-    TNode curNode = getChildByWeight(node, i, desiredVal);
-    if ( tryGetSatValue(curNode) != desiredValInverted ) {
-      SearchResult ret = findSplitterRec(curNode, desiredVal);
-      if(ret != DONT_KNOW) {
+  if (options::decisionUseActivity())
+  {
+    std::vector<std::pair<double, TNode>> children;
+    for (int i = 0; i < numChildren; ++i)
+    {
+      TNode curNode = getChildByWeight(node, i, desiredVal);
+      if (tryGetSatValue(curNode) != desiredValInverted)
+      {
+        children.push_back(
+            std::make_pair(getActivityScore(curNode, desiredVal), curNode));
+      }
+    }
+    std::stable_sort(children.begin(),
+                     children.end(),
+                     [](const std::pair<double, TNode>& a,
+                        const std::pair<double, TNode>& b) {
+                       return a.first > b.first;
+                     });
+    for (const std::pair<double, TNode>& c : children)
+    {
+      SearchResult ret = findSplitterRec(c.second, desiredVal);
+      if (ret != DONT_KNOW)
+      {
         return ret;
       }
     }
   }
+  else
+  {
+    for(int i = 0; i < numChildren; ++i) {
+      TNode curNode = getChildByWeight(node, i, desiredVal);
+      if ( tryGetSatValue(curNode) != desiredValInverted ) {
+        SearchResult ret = findSplitterRec(curNode, desiredVal);
+        if(ret != DONT_KNOW) {
+          return ret;
+        }
+      }
+    }
+  }
   Assert(d_curThreshold != 0) << "handleAndOrEasy: No controlling input found";
   return DONT_KNOW;
 }
@@ -623,6 +823,13 @@ JustificationHeuristic::SearchResult JustificationHeuristic::handleBinaryEasy(TN
     std::swap(node1, node2);
     std::swap(desiredVal1, desiredVal2);
   }
+  if (options::decisionUseActivity()
+      && getActivityScore(node1, desiredVal1)
+             < getActivityScore(node2, desiredVal2))
+  {
+    std::swap(node1, node2);
+    std::swap(desiredVal1, desiredVal2);
+  }
 
   if ( tryGetSatValue(node1) != invertValue(desiredVal1) ) {
     SearchResult ret = findSplitterRec(node1, desiredVal1);
@@ -673,21 +880,7 @@ JustificationHeuristic::SearchResult JustificationHeuristic::handleITE(TNode nod
   //[0]: if, [1]: then, [2]: else
   SatValue ifVal = tryGetSatValue(node[0]);
   if (ifVal == SAT_VALUE_UNKNOWN) {
-    SatValue trueChildVal = tryGetSatValue(node[1]);
-    SatValue falseChildVal = tryGetSatValue(node[2]);
-    SatValue ifDesiredVal;
-
-    if(trueChildVal == desiredVal || falseChildVal == invertValue(desiredVal)) {
-      ifDesiredVal = SAT_VALUE_TRUE;
-    } else if(trueChildVal == invertValue(desiredVal) ||
-              falseChildVal == desiredVal ||
-              (options::decisionUseWeight() &&
-               getWeightPolarized(node[1], true) > getWeightPolarized(node[2], false))
-              ) {
-      ifDesiredVal = SAT_VALUE_FALSE;
-    } else {
-      ifDesiredVal = SAT_VALUE_TRUE;
-    }
+    SatValue ifDesiredVal = getDesiredConditionValue(node, desiredVal);
 
     if(findSplitterRec(node[0], ifDesiredVal) == FOUND_SPLITTER)
       return FOUND_SPLITTER;
@@ -711,6 +904,24 @@ JustificationHeuristic::SearchResult JustificationHeuristic::handleITE(TNode nod
   }// else (...ifVal...)
 }
 
+SatValue JustificationHeuristic::getDesiredConditionValue(TNode node,
+                                                          SatValue desiredVal)
+{
+  SatValue trueChildVal = tryGetSatValue(node[1]);
+  SatValue falseChildVal = tryGetSatValue(node[2]);
+
+  if(trueChildVal == desiredVal || falseChildVal == invertValue(desiredVal)) {
+    return SAT_VALUE_TRUE;
+  } else if(trueChildVal == invertValue(desiredVal) ||
+            falseChildVal == desiredVal ||
+            (options::decisionUseWeight() &&
+             getWeightPolarized(node[1], true) > getWeightPolarized(node[2], false))
+            ) {
+    return SAT_VALUE_FALSE;
+  }
+  return SAT_VALUE_TRUE;
+}
+
 JustificationHeuristic::SearchResult
 JustificationHeuristic::handleEmbeddedSkolems(TNode node)
 {
@@ -720,13 +931,13 @@ JustificationHeuristic::handleEmbeddedSkolems(TNode node)
   bool noSplitter = true;
   for (SkolemList::const_iterator i = l.begin(); i != l.end(); ++i)
   {
-    if(d_visited.find((*i).first) == d_visited.end()) {
-      d_visited.insert((*i).first);
+    if(d_visited.find((*i).second) == d_visited.end()) {
+      d_visited.insert((*i).second);
       SearchResult ret = findSplitterRec((*i).second, SAT_VALUE_TRUE);
+      d_visited.erase((*i).second);
       if (ret == FOUND_SPLITTER)
         return FOUND_SPLITTER;
       noSplitter = noSplitter && (ret == NO_SPLITTER);
-      d_visited.erase((*i).first);
     }
   }
   return noSplitter ? NO_SPLITTER : DONT_KNOW;
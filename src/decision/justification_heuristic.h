@@ -25,6 +25,7 @@
 
 #include <unordered_set>
 #include <utility>
+#include <vector>
 
 #include "context/cdhashmap.h"
 #include "context/cdhashset.h"
@@ -55,6 +56,7 @@ class JustificationHeuristic : public ITEDecisionStrategy {
                              std::pair<DecisionWeight, DecisionWeight>,
                              NodeHashFunction>
       WeightCache;
+  typedef std::vector<std::pair<Node, prop::SatValue> > SearchPath;
 
   // being 'justified' is monotonic with respect to decisions
   typedef context::CDHashSet<Node,NodeHashFunction> JustifiedSet;
@@ -66,6 +68,7 @@ class JustificationHeuristic : public ITEDecisionStrategy {
 
   IntStat d_helpfulness;
   IntStat d_giveup;
+  IntStat d_resumed;
   TimerStat d_timestat;
 
   /**
@@ -82,12 +85,26 @@ class JustificationHeuristic : public ITEDecisionStrategy {
   SkolemCache d_skolemCache;
 
   /**
-   * This is used to prevent infinite loop when trying to find a
-   * splitter. Can happen when exploring assertion corresponding to a
-   * term-ITE.
+   * The skolem definitions on the current search path. This is used to
+   * prevent infinite loop when trying to find a splitter. Can happen when
+   * exploring assertion corresponding to a term-ITE.
    */
   std::unordered_set<Node,NodeHashFunction> d_visited;
 
+  /**
+   * The arguments of the active calls of findSplitterRec(), from the
+   * assertion down to the current node.
+   */
+  SearchPath d_path;
+
+  /**
+   * The search path that led to the last decision (without threshold), and
+   * the index of its assertion. The next search resumes from its deepest
+   * node that still needs to be justified, see resumeFromFrontier().
+   */
+  SearchPath d_frontier;
+  unsigned d_frontierIndex;
+
   /**
    * Set to track visited nodes in a dfs search done in computeSkolems
    * function
@@ -140,12 +157,36 @@ private:
  /* getNext with an option to specify threshold */
  prop::SatLiteral getNextThresh(bool& stopSearch, DecisionWeight threshold);
 
+ /**
+  * Look for a splitter below the nodes of the frontier, starting from the
+  * deepest one that the search from its assertion would still visit with the
+  * same desired value, and moving up as they get justified. Returns
+  * undefSatLiteral if the frontier is justified up to its assertion.
+  */
+ prop::SatLiteral resumeFromFrontier();
+
  prop::SatLiteral findSplitter(TNode node, prop::SatValue desiredVal);
 
  /**
-  * Do all the hard work.
+  * Do all the hard work. Maintains d_path around findSplitterNode().
   */
  SearchResult findSplitterRec(TNode node, prop::SatValue value);
+ SearchResult findSplitterNode(TNode node, prop::SatValue value);
+
+ /**
+  * Get the value that the search wants child to have when it looks for a
+  * splitter in node with desired value desiredVal, or SAT_VALUE_UNKNOWN if it
+  * would not look into child in the current assignment. Here child is a child
+  * of node, or the definition of a skolem in node if node is an atom.
+  */
+ prop::SatValue getDesiredChildValue(TNode node,
+                                     prop::SatValue desiredVal,
+                                     TNode child);
+ /* The value the search wants for the unassigned condition of an ITE */
+ prop::SatValue getDesiredConditionValue(TNode node,
+                                         prop::SatValue desiredVal);
+ /* Whether the search splits on n, rather than looking into its children */
+ static bool isAtom(TNode n);
 
  /* Helper functions */
  void setJustified(TNode);
@@ -165,6 +206,13 @@ private:
     that. Otherwise an UNKNOWN */
  prop::SatValue tryGetSatValue(Node n);
 
+ /**
+  * How much the search prefers n to justify its parent with value desiredVal,
+  * with --decision-use-activity. Nodes that already have that value come
+  * first, then the ones with the highest activity in the SAT solver.
+  */
+ double getActivityScore(TNode n, prop::SatValue desiredVal);
+
  /* Get list of all term-ITEs for the atomic formula v */
  JustificationHeuristic::SkolemList getSkolems(TNode n);
 
@@ -34,6 +34,16 @@ bool AttributeManager::inGarbageCollection() const {
   return d_inGarbageCollection;
 }
 
+void AttributeManager::setDenseThreshold(size_t threshold)
+{
+  d_bools.setDenseThreshold(threshold);
+  d_ints.setDenseThreshold(threshold);
+  d_tnodes.setDenseThreshold(threshold);
+  d_nodes.setDenseThreshold(threshold);
+  d_types.setDenseThreshold(threshold);
+  d_strings.setDenseThreshold(threshold);
+}
+
 void AttributeManager::debugHook(int debugFlag) {
   /* DO NOT CHECK IN ANY CODE INTO THE DEBUG HOOKS!
    * debugHook() is an empty function for the purpose of debugging
@@ -44,12 +54,13 @@ void AttributeManager::debugHook(int debugFlag) {
 
 void AttributeManager::deleteAllAttributes(NodeValue* nv) {
   Assert(!inGarbageCollection());
+  // This cannot use nv as anything other than a pointer and its id!
   d_bools.erase(nv);
-  deleteFromTable(d_ints, nv);
-  deleteFromTable(d_tnodes, nv);
-  deleteFromTable(d_nodes, nv);
-  deleteFromTable(d_types, nv);
-  deleteFromTable(d_strings, nv);
+  d_ints.erase(nv);
+  d_tnodes.erase(nv);
+  d_nodes.erase(nv);
+  d_types.erase(nv);
+  d_strings.erase(nv);
 }
 
 void AttributeManager::deleteAllAttributes() {
@@ -46,7 +46,9 @@ namespace attr {
  * domain of an Attribute does not increase a Node's reference count.) To
  * achieve this special relationship with Nodes, Attributes are mapped by hash
  * tables (AttrHash<> and CDAttrHash<>) that live in the AttributeManager. The
- * AttributeManager is owned by the NodeManager.
+ * AttributeManager is owned by the NodeManager.  Frequently used attributes
+ * may instead be stored in dense columns indexed by node id, see AttrTable<>
+ * and AttributeManager::setDenseThreshold().
  *
  * Example:
  *
@@ -83,16 +85,10 @@ namespace attr {
 class AttributeManager {
 
   template <class T>
-  void deleteFromTable(AttrHash<T>& table, NodeValue* nv);
+  void deleteAllFromTable(AttrTable<T>& table);
 
   template <class T>
-  void deleteAllFromTable(AttrHash<T>& table);
-
-  template <class T>
-  void deleteAttributesFromTable(AttrHash<T>& table, const std::vector<uint64_t>& ids);
-
-  template <class T>
-  void reconstructTable(AttrHash<T>& table);
+  void deleteAttributesFromTable(AttrTable<T>& table, const std::vector<uint64_t>& ids);
 
   /**
    * getTable<> is a helper template that gets the right table from an
@@ -113,18 +109,18 @@ public:
   // IF YOU ADD ANY TABLES, don't forget to add them also to the
   // implementation of deleteAllAttributes().
 
-  /** Underlying hash table for boolean-valued attributes */
-  AttrHash<bool> d_bools;
-  /** Underlying hash table for integral-valued attributes */
-  AttrHash<uint64_t> d_ints;
-  /** Underlying hash table for node-valued attributes */
-  AttrHash<TNode> d_tnodes;
-  /** Underlying hash table for node-valued attributes */
-  AttrHash<Node> d_nodes;
-  /** Underlying hash table for types attributes */
-  AttrHash<TypeNode> d_types;
-  /** Underlying hash table for string-valued attributes */
-  AttrHash<std::string> d_strings;
+  /** Underlying table for boolean-valued attributes */
+  AttrTable<bool> d_bools;
+  /** Underlying table for integral-valued attributes */
+  AttrTable<uint64_t> d_ints;
+  /** Underlying table for node-valued attributes */
+  AttrTable<TNode> d_tnodes;
+  /** Underlying table for node-valued attributes */
+  AttrTable<Node> d_nodes;
+  /** Underlying table for types attributes */
+  AttrTable<TypeNode> d_types;
+  /** Underlying table for string-valued attributes */
+  AttrTable<std::string> d_strings;
 
   /**
    * Get a particular attribute on a particular node.
@@ -195,6 +191,15 @@ public:
    */
   bool inGarbageCollection() const ;
 
+  /**
+   * Store each attribute that is set on at least threshold nodes in a
+   * dense column indexed by node id instead of the hash table of its
+   * type (0 == only use hash tables).  For Boolean flags, which are
+   * packed per node, the threshold applies to the number of nodes with
+   * flags.  See AttrTable<>.
+   */
+  void setDenseThreshold(size_t threshold);
+
   /**
    * Determines the AttrTableId of an attribute.
    *
@@ -240,7 +245,7 @@ struct getTable;
 template <>
 struct getTable<bool, false> {
   static const AttrTableId id = AttrTableBool;
-  typedef AttrHash<bool> table_type;
+  typedef AttrTable<bool> table_type;
   static inline table_type& get(AttributeManager& am) {
     return am.d_bools;
   }
@@ -257,7 +262,7 @@ struct getTable<T,
                 typename std::enable_if<std::is_unsigned<T>::value>::type>
 {
   static const AttrTableId id = AttrTableUInt64;
-  typedef AttrHash<uint64_t> table_type;
+  typedef AttrTable<uint64_t> table_type;
   static inline table_type& get(AttributeManager& am) {
     return am.d_ints;
   }
@@ -270,7 +275,7 @@ struct getTable<T,
 template <>
 struct getTable<TNode, false> {
   static const AttrTableId id = AttrTableTNode;
-  typedef AttrHash<TNode> table_type;
+  typedef AttrTable<TNode> table_type;
   static inline table_type& get(AttributeManager& am) {
     return am.d_tnodes;
   }
@@ -283,7 +288,7 @@ struct getTable<TNode, false> {
 template <>
 struct getTable<Node, false> {
   static const AttrTableId id = AttrTableNode;
-  typedef AttrHash<Node> table_type;
+  typedef AttrTable<Node> table_type;
   static inline table_type& get(AttributeManager& am) {
     return am.d_nodes;
   }
@@ -296,7 +301,7 @@ struct getTable<Node, false> {
 template <>
 struct getTable<TypeNode, false> {
   static const AttrTableId id = AttrTableTypeNode;
-  typedef AttrHash<TypeNode> table_type;
+  typedef AttrTable<TypeNode> table_type;
   static inline table_type& get(AttributeManager& am) {
     return am.d_types;
   }
@@ -309,7 +314,7 @@ struct getTable<TypeNode, false> {
 template <>
 struct getTable<std::string, false> {
   static const AttrTableId id = AttrTableString;
-  typedef AttrHash<std::string> table_type;
+  typedef AttrTable<std::string> table_type;
   static inline table_type& get(AttributeManager& am) {
     return am.d_strings;
   }
@@ -335,14 +340,13 @@ AttributeManager::getAttribute(NodeValue* nv, const AttrKind&) const {
 
   const table_type& ah =
     getTable<value_type, AttrKind::context_dependent>::get(*this);
-  typename table_type::const_iterator i =
-    ah.find(std::make_pair(AttrKind::getId(), nv));
+  const auto* v = ah.find(AttrKind::getId(), nv);
 
-  if(i == ah.end()) {
+  if(v == nullptr) {
     return typename AttrKind::value_type();
   }
 
-  return mapping::convertBack((*i).second);
+  return mapping::convertBack(*v);
 }
 
 /* Helper template class for hasAttribute(), specialized based on
@@ -378,13 +382,12 @@ struct HasAttribute<true, AttrKind> {
 
     const table_type& ah =
       getTable<value_type, AttrKind::context_dependent>::get(*am);
-    typename table_type::const_iterator i =
-      ah.find(std::make_pair(AttrKind::getId(), nv));
+    const auto* v = ah.find(AttrKind::getId(), nv);
 
-    if(i == ah.end()) {
+    if(v == nullptr) {
       ret = AttrKind::default_value;
     } else {
-      ret = mapping::convertBack((*i).second);
+      ret = mapping::convertBack(*v);
     }
 
     return true;
@@ -406,14 +409,8 @@ struct HasAttribute<false, AttrKind> {
 
     const table_type& ah =
       getTable<value_type, AttrKind::context_dependent>::get(*am);
-    typename table_type::const_iterator i =
-      ah.find(std::make_pair(AttrKind::getId(), nv));
 
-    if(i == ah.end()) {
-      return false;
-    }
-
-    return true;
+    return ah.find(AttrKind::getId(), nv) != nullptr;
   }
 
   static inline bool getAttribute(const AttributeManager* am,
@@ -426,14 +423,13 @@ struct HasAttribute<false, AttrKind> {
 
     const table_type& ah =
       getTable<value_type, AttrKind::context_dependent>::get(*am);
-    typename table_type::const_iterator i =
-      ah.find(std::make_pair(AttrKind::getId(), nv));
+    const auto* v = ah.find(AttrKind::getId(), nv);
 
-    if(i == ah.end()) {
+    if(v == nullptr) {
       return false;
     }
 
-    ret = mapping::convertBack((*i).second);
+    ret = mapping::convertBack(*v);
 
     return true;
   }
@@ -466,24 +462,12 @@ AttributeManager::setAttribute(NodeValue* nv,
 
   table_type& ah =
       getTable<value_type, AttrKind::context_dependent>::get(*this);
-  ah[std::make_pair(AttrKind::getId(), nv)] = mapping::convert(value);
-}
-
-/** Search for the NodeValue in all attribute tables and remove it. */
-template <class T>
-inline void AttributeManager::deleteFromTable(AttrHash<T>& table,
-                                              NodeValue* nv) {
-  // This cannot use nv as anything other than a pointer!
-  const uint64_t last = attr::LastAttributeId<T, false>::getId();
-  for (uint64_t id = 0; id < last; ++id)
-  {
-    table.erase(std::make_pair(id, nv));
-  }
+  ah.set(AttrKind::getId(), nv, mapping::convert(value));
 }
 
 /** Remove all attributes from the table. */
 template <class T>
-inline void AttributeManager::deleteAllFromTable(AttrHash<T>& table) {
+inline void AttributeManager::deleteAllFromTable(AttrTable<T>& table) {
   Assert(!d_inGarbageCollection);
   d_inGarbageCollection = true;
   table.clear();
@@ -500,43 +484,9 @@ AttributeUniqueId AttributeManager::getAttributeId(const AttrKind& attr){
 }
 
 template <class T>
-void AttributeManager::deleteAttributesFromTable(AttrHash<T>& table, const std::vector<uint64_t>& ids){
-  d_inGarbageCollection = true;
-  typedef AttrHash<T> hash_t;
-
-  typename hash_t::iterator it = table.begin();
-  typename hash_t::iterator tmp;
-  typename hash_t::iterator it_end = table.end();
-
-  std::vector<uint64_t>::const_iterator begin_ids = ids.begin();
-  std::vector<uint64_t>::const_iterator end_ids = ids.end();
-
-  size_t initialSize = table.size();
-  while (it != it_end){
-    uint64_t id = (*it).first.first;
-
-    if(std::binary_search(begin_ids, end_ids, id)){
-      tmp = it;
-      ++it;
-      table.erase(tmp);
-    }else{
-      ++it;
-    }
-  }
-  d_inGarbageCollection = false;
-  static const size_t ReconstructShrinkRatio = 8;
-  if(initialSize/ReconstructShrinkRatio > table.size()){
-    reconstructTable(table);
-  }
-}
-
-template <class T>
-void AttributeManager::reconstructTable(AttrHash<T>& table){
+void AttributeManager::deleteAttributesFromTable(AttrTable<T>& table, const std::vector<uint64_t>& ids){
   d_inGarbageCollection = true;
-  typedef AttrHash<T> hash_t;
-  hash_t cpy;
-  cpy.insert(table.begin(), table.end());
-  cpy.swap(table);
+  table.eraseAttributes(ids);
   d_inGarbageCollection = false;
 }
 
@@ -546,12 +496,14 @@ void AttributeManager::reconstructTable(AttrHash<T>& table){
 template <class AttrKind>
 inline typename AttrKind::value_type
 NodeManager::getAttribute(expr::NodeValue* nv, const AttrKind&) const {
+  AttrGuard<true> guard(this);
   return d_attrManager->getAttribute(nv, AttrKind());
 }
 
 template <class AttrKind>
 inline bool NodeManager::hasAttribute(expr::NodeValue* nv,
                                       const AttrKind&) const {
+  AttrGuard<true> guard(this);
   return d_attrManager->hasAttribute(nv, AttrKind());
 }
 
@@ -559,6 +511,7 @@ template <class AttrKind>
 inline bool
 NodeManager::getAttribute(expr::NodeValue* nv, const AttrKind&,
                           typename AttrKind::value_type& ret) const {
+  AttrGuard<true> guard(this);
   return d_attrManager->getAttribute(nv, AttrKind(), ret);
 }
 
@@ -566,18 +519,21 @@ template <class AttrKind>
 inline void
 NodeManager::setAttribute(expr::NodeValue* nv, const AttrKind&,
                           const typename AttrKind::value_type& value) {
+  AttrGuard<false> guard(this);
   d_attrManager->setAttribute(nv, AttrKind(), value);
 }
 
 template <class AttrKind>
 inline typename AttrKind::value_type
 NodeManager::getAttribute(TNode n, const AttrKind&) const {
+  AttrGuard<true> guard(this);
   return d_attrManager->getAttribute(n.d_nv, AttrKind());
 }
 
 template <class AttrKind>
 inline bool
 NodeManager::hasAttribute(TNode n, const AttrKind&) const {
+  AttrGuard<true> guard(this);
   return d_attrManager->hasAttribute(n.d_nv, AttrKind());
 }
 
@@ -585,6 +541,7 @@ template <class AttrKind>
 inline bool
 NodeManager::getAttribute(TNode n, const AttrKind&,
                           typename AttrKind::value_type& ret) const {
+  AttrGuard<true> guard(this);
   return d_attrManager->getAttribute(n.d_nv, AttrKind(), ret);
 }
 
@@ -592,18 +549,21 @@ template <class AttrKind>
 inline void
 NodeManager::setAttribute(TNode n, const AttrKind&,
                           const typename AttrKind::value_type& value) {
+  AttrGuard<false> guard(this);
   d_attrManager->setAttribute(n.d_nv, AttrKind(), value);
 }
 
 template <class AttrKind>
 inline typename AttrKind::value_type
 NodeManager::getAttribute(TypeNode n, const AttrKind&) const {
+  AttrGuard<true> guard(this);
   return d_attrManager->getAttribute(n.d_nv, AttrKind());
 }
 
 template <class AttrKind>
 inline bool
 NodeManager::hasAttribute(TypeNode n, const AttrKind&) const {
+  AttrGuard<true> guard(this);
   return d_attrManager->hasAttribute(n.d_nv, AttrKind());
 }
 
@@ -611,6 +571,7 @@ template <class AttrKind>
 inline bool
 NodeManager::getAttribute(TypeNode n, const AttrKind&,
                           typename AttrKind::value_type& ret) const {
+  AttrGuard<true> guard(this);
   return d_attrManager->getAttribute(n.d_nv, AttrKind(), ret);
 }
 
@@ -618,6 +579,7 @@ template <class AttrKind>
 inline void
 NodeManager::setAttribute(TypeNode n, const AttrKind&,
                           const typename AttrKind::value_type& value) {
+  AttrGuard<false> guard(this);
   d_attrManager->setAttribute(n.d_nv, AttrKind(), value);
 }
 
@@ -23,7 +23,10 @@
 #ifndef CVC4__EXPR__ATTRIBUTE_INTERNALS_H
 #define CVC4__EXPR__ATTRIBUTE_INTERNALS_H
 
+#include <algorithm>
+#include <memory>
 #include <unordered_map>
+#include <vector>
 
 namespace CVC5 {
 namespace expr {
@@ -361,6 +364,17 @@ public:
   size_t size() const {
     return super::size();
   }
+
+  /** Call f(nv, word) for each node nv with flags, where word are its flags */
+  template <class F>
+  void forEachWord(F f) const
+  {
+    for (const std::pair<NodeValue* const, uint64_t>& entry :
+         static_cast<const super&>(*this))
+    {
+      f(entry.first, entry.second);
+    }
+  }
 };/* class AttrHash<bool> */
 
 }  // namespace attr
@@ -395,6 +409,452 @@ struct LastAttributeId {
 
 }  // namespace attr
 
+// DENSE ATTRIBUTE COLUMNS AND ATTRIBUTE TABLES ================================
+
+namespace attr {
+
+/**
+ * A "DenseColumn<value_type>" maps node ids (see NodeValue::getId()) to
+ * values of one attribute, by direct indexing rather than hashing.
+ *
+ * Node ids are handed out consecutively and never reused, so the column
+ * is split into pages of PAGE_SIZE consecutive ids.  A page is allocated
+ * when the first value in its range is set and released when its last
+ * value is erased, so that the ids of long-dead nodes do not hold on to
+ * memory.
+ */
+template <class value_type>
+class DenseColumn
+{
+ public:
+  static constexpr uint64_t PAGE_BITS = 8;
+  static constexpr uint64_t PAGE_SIZE = uint64_t(1) << PAGE_BITS;
+
+  DenseColumn() : d_size(0) {}
+
+  DenseColumn(const DenseColumn&) = delete;
+  DenseColumn& operator=(const DenseColumn&) = delete;
+
+  /** Return a pointer to the value for id, or nullptr if there is none. */
+  const value_type* find(uint64_t id) const
+  {
+    uint64_t p = id >> PAGE_BITS;
+    if (p >= d_pages.size() || d_pages[p] == nullptr)
+    {
+      return nullptr;
+    }
+    const Page& page = *d_pages[p];
+    uint64_t i = id & (PAGE_SIZE - 1);
+    return page.isPresent(i) ? &page.d_values[i] : nullptr;
+  }
+
+  /**
+   * Return a reference to the value for id, which is default-constructed
+   * if there is none yet.
+   */
+  value_type& operator[](uint64_t id)
+  {
+    uint64_t p = id >> PAGE_BITS;
+    if (p >= d_pages.size())
+    {
+      d_pages.resize(p + 1);
+    }
+    if (d_pages[p] == nullptr)
+    {
+      d_pages[p].reset(new Page());
+    }
+    Page& page = *d_pages[p];
+    uint64_t i = id & (PAGE_SIZE - 1);
+    if (!page.isPresent(i))
+    {
+      page.d_present[i >> 6] |= GetBitSet(i & 63);
+      ++page.d_count;
+      ++d_size;
+    }
+    return page.d_values[i];
+  }
+
+  /** Remove the value for id, if any.  Return true if there was one. */
+  bool erase(uint64_t id)
+  {
+    uint64_t p = id >> PAGE_BITS;
+    if (p >= d_pages.size() || d_pages[p] == nullptr)
+    {
+      return false;
+    }
+    Page& page = *d_pages[p];
+    uint64_t i = id & (PAGE_SIZE - 1);
+    if (!page.isPresent(i))
+    {
+      return false;
+    }
+    page.d_present[i >> 6] &= ~GetBitSet(i & 63);
+    // release the old value (e.g., the reference held by a Node) now
+    page.d_values[i] = value_type();
+    --d_size;
+    if (--page.d_count == 0)
+    {
+      d_pages[p].reset();
+    }
+    return true;
+  }
+
+  /** Remove all values */
+  void clear()
+  {
+    d_pages.clear();
+    d_size = 0;
+  }
+
+  /** The number of ids with a value */
+  size_t size() const { return d_size; }
+
+ private:
+  /** The values of PAGE_SIZE consecutive ids */
+  struct Page
+  {
+    Page() : d_present(), d_count(0) {}
+    bool isPresent(uint64_t i) const
+    {
+      return (d_present[i >> 6] & GetBitSet(i & 63)) != 0;
+    }
+    value_type d_values[PAGE_SIZE];
+    /** Bit i is set iff d_values[i] holds a value */
+    uint64_t d_present[PAGE_SIZE / 64];
+    /** The number of bits set in d_present */
+    uint32_t d_count;
+  };
+
+  /** The pages, indexed by id / PAGE_SIZE; nullptr if not allocated */
+  std::vector<std::unique_ptr<Page>> d_pages;
+  /** The number of ids with a value */
+  size_t d_size;
+};/* class DenseColumn<> */
+
+/**
+ * An "AttrTable<value_type>" stores all attributes whose table value
+ * type is value_type.  By default, it is an AttrHash<value_type>, keyed
+ * by pairs (attribute id, NodeValue*).
+ *
+ * If a dense threshold is set (see setDenseThreshold()), each attribute
+ * that is set on at least that many nodes gets its own DenseColumn,
+ * indexed by node id.  Lookups of such attributes avoid hashing and
+ * probing altogether, which pays off for the attributes on the hot
+ * paths (rewrite caches, type caches).  Rarely used attributes remain
+ * in the hash table.  Dense columns, once created, are kept until the
+ * attribute is deleted.
+ */
+template <class value_type>
+class AttrTable
+{
+ public:
+  AttrTable() : d_denseThreshold(0) {}
+
+  /**
+   * Return a pointer to the value of attribute id on nv, or nullptr if it
+   * is not set.
+   */
+  const value_type* find(uint64_t id, NodeValue* nv) const
+  {
+    if (id < d_columns.size() && d_columns[id] != nullptr)
+    {
+      return d_columns[id]->find(nv->getId());
+    }
+    typename AttrHash<value_type>::const_iterator i =
+        d_hash.find(std::make_pair(id, nv));
+    return i == d_hash.end() ? nullptr : &(*i).second;
+  }
+
+  /** Set the value of attribute id on nv */
+  void set(uint64_t id, NodeValue* nv, const value_type& value)
+  {
+    if (id < d_columns.size() && d_columns[id] != nullptr)
+    {
+      (*d_columns[id])[nv->getId()] = value;
+      return;
+    }
+    size_t size = d_hash.size();
+    d_hash[std::make_pair(id, nv)] = value;
+    if (d_denseThreshold > 0 && d_hash.size() != size)
+    {
+      if (id >= d_sparseCounts.size())
+      {
+        d_sparseCounts.resize(id + 1, 0);
+      }
+      if (++d_sparseCounts[id] >= d_denseThreshold)
+      {
+        makeDense(id);
+      }
+    }
+  }
+
+  /** Remove all attributes of nv, which must not be used except as key */
+  void erase(NodeValue* nv)
+  {
+    const uint64_t last = LastAttributeId<value_type, false>::getId();
+    for (uint64_t id = 0; id < last; ++id)
+    {
+      if (id < d_columns.size() && d_columns[id] != nullptr)
+      {
+        d_columns[id]->erase(nv->getId());
+      }
+      else if (d_hash.erase(std::make_pair(id, nv)) > 0
+               && id < d_sparseCounts.size())
+      {
+        --d_sparseCounts[id];
+      }
+    }
+  }
+
+  /** Remove the attributes with the given ids (sorted) from all nodes */
+  void eraseAttributes(const std::vector<uint64_t>& ids)
+  {
+    for (uint64_t id : ids)
+    {
+      if (id < d_columns.size())
+      {
+        d_columns[id].reset();
+      }
+      if (id < d_sparseCounts.size())
+      {
+        d_sparseCounts[id] = 0;
+      }
+    }
+
+    typedef AttrHash<value_type> hash_t;
+    typename hash_t::iterator it = d_hash.begin();
+    typename hash_t::iterator tmp;
+    typename hash_t::iterator it_end = d_hash.end();
+
+    size_t initialSize = d_hash.size();
+    while (it != it_end)
+    {
+      uint64_t id = (*it).first.first;
+      if (std::binary_search(ids.begin(), ids.end(), id))
+      {
+        tmp = it;
+        ++it;
+        d_hash.erase(tmp);
+      }
+      else
+      {
+        ++it;
+      }
+    }
+    static const size_t ReconstructShrinkRatio = 8;
+    if (initialSize / ReconstructShrinkRatio > d_hash.size())
+    {
+      hash_t cpy;
+      cpy.insert(d_hash.begin(), d_hash.end());
+      cpy.swap(d_hash);
+    }
+  }
+
+  /** Remove all attributes */
+  void clear()
+  {
+    d_hash.clear();
+    d_columns.clear();
+    d_sparseCounts.clear();
+  }
+
+  /**
+   * Set the number of nodes an attribute must be set on to get a dense
+   * column (0 disables the creation of dense columns).  Attributes that
+   * already reach the threshold are moved to dense columns immediately.
+   */
+  void setDenseThreshold(size_t threshold)
+  {
+    d_denseThreshold = threshold;
+    d_sparseCounts.clear();
+    if (threshold == 0)
+    {
+      return;
+    }
+    for (const auto& entry : d_hash)
+    {
+      uint64_t id = entry.first.first;
+      if (id >= d_sparseCounts.size())
+      {
+        d_sparseCounts.resize(id + 1, 0);
+      }
+      ++d_sparseCounts[id];
+    }
+    for (uint64_t id = 0; id < d_sparseCounts.size(); ++id)
+    {
+      if (d_sparseCounts[id] >= threshold)
+      {
+        makeDense(id);
+      }
+    }
+  }
+
+  /** Return true if attribute id is stored in a dense column */
+  bool isDense(uint64_t id) const
+  {
+    return id < d_columns.size() && d_columns[id] != nullptr;
+  }
+
+  /** The number of attribute values in the table */
+  size_t size() const
+  {
+    size_t size = d_hash.size();
+    for (const std::unique_ptr<DenseColumn<value_type>>& c : d_columns)
+    {
+      size += c == nullptr ? 0 : c->size();
+    }
+    return size;
+  }
+
+ private:
+  /** Move the values of attribute id from d_hash to a new dense column */
+  void makeDense(uint64_t id)
+  {
+    Assert(!isDense(id));
+    if (id >= d_columns.size())
+    {
+      d_columns.resize(id + 1);
+    }
+    DenseColumn<value_type>* column = new DenseColumn<value_type>();
+    d_columns[id].reset(column);
+    for (typename AttrHash<value_type>::iterator it = d_hash.begin();
+         it != d_hash.end();)
+    {
+      if ((*it).first.first == id)
+      {
+        (*column)[(*it).first.second->getId()] = std::move((*it).second);
+        it = d_hash.erase(it);
+      }
+      else
+      {
+        ++it;
+      }
+    }
+    d_sparseCounts[id] = 0;
+  }
+
+  /** The attributes that are not stored densely */
+  AttrHash<value_type> d_hash;
+  /** The dense columns, indexed by attribute id; nullptr if sparse */
+  std::vector<std::unique_ptr<DenseColumn<value_type>>> d_columns;
+  /**
+   * The number of values of each sparse attribute in d_hash, indexed by
+   * attribute id.  Only maintained if d_denseThreshold is positive.
+   */
+  std::vector<size_t> d_sparseCounts;
+  /** See setDenseThreshold() */
+  size_t d_denseThreshold;
+};/* class AttrTable<> */
+
+/**
+ * In the case of Boolean-valued attributes, all flags of a node are
+ * packed into one word (see AttrHash<bool>), so the table as a whole is
+ * either sparse or dense: once flags are set on at least the dense
+ * threshold many nodes, the words move to a single DenseColumn.
+ */
+template <>
+class AttrTable<bool>
+{
+ public:
+  AttrTable() : d_denseThreshold(0) {}
+
+  /**
+   * Return a pointer to the value of flag id on nv, or nullptr if no flag
+   * was ever set on nv.
+   */
+  const bool* find(uint64_t id, NodeValue* nv) const
+  {
+    if (d_column != nullptr)
+    {
+      const uint64_t* word = d_column->find(nv->getId());
+      return word == nullptr ? nullptr : boolPtr(*word & GetBitSet(id));
+    }
+    AttrHash<bool>::const_iterator i = d_hash.find(std::make_pair(id, nv));
+    return i == d_hash.end() ? nullptr : boolPtr((*i).second);
+  }
+
+  /** Set the value of flag id on nv */
+  void set(uint64_t id, NodeValue* nv, bool value)
+  {
+    if (d_column != nullptr)
+    {
+      uint64_t& word = (*d_column)[nv->getId()];
+      word = value ? (word | GetBitSet(id)) : (word & ~GetBitSet(id));
+      return;
+    }
+    d_hash[std::make_pair(id, nv)] = value;
+    if (d_denseThreshold > 0 && d_hash.size() >= d_denseThreshold)
+    {
+      makeDense();
+    }
+  }
+
+  /** Remove all flags of nv, which must not be used except as key */
+  void erase(NodeValue* nv)
+  {
+    if (d_column != nullptr)
+    {
+      d_column->erase(nv->getId());
+      return;
+    }
+    d_hash.erase(nv);
+  }
+
+  /** Remove all flags */
+  void clear()
+  {
+    d_hash.clear();
+    d_column.reset();
+  }
+
+  /** See AttrTable<>::setDenseThreshold() */
+  void setDenseThreshold(size_t threshold)
+  {
+    d_denseThreshold = threshold;
+    if (threshold > 0 && d_column == nullptr && d_hash.size() >= threshold)
+    {
+      makeDense();
+    }
+  }
+
+  /** Return true if the flags are stored in a dense column */
+  bool isDense() const { return d_column != nullptr; }
+
+  /** The number of nodes with flags in the table */
+  size_t size() const
+  {
+    return d_column == nullptr ? d_hash.size() : d_column->size();
+  }
+
+ private:
+  /** Get a pointer to a (static) bool of value b */
+  static const bool* boolPtr(bool b)
+  {
+    static const bool s_values[2] = {false, true};
+    return &s_values[b ? 1 : 0];
+  }
+
+  /** Move all words from d_hash to d_column */
+  void makeDense()
+  {
+    Assert(d_column == nullptr);
+    d_column.reset(new DenseColumn<uint64_t>());
+    d_hash.forEachWord([this](NodeValue* nv, uint64_t word) {
+      (*d_column)[nv->getId()] = word;
+    });
+    d_hash.clear();
+  }
+
+  /** The flags, unless stored densely */
+  AttrHash<bool> d_hash;
+  /** The flags, if stored densely */
+  std::unique_ptr<DenseColumn<uint64_t>> d_column;
+  /** See setDenseThreshold() */
+  size_t d_denseThreshold;
+};/* class AttrTable<bool> */
+
+}  // namespace attr
+
 // ATTRIBUTE DEFINITION ========================================================
 
 /**
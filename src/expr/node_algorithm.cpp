@@ -19,6 +19,7 @@
 
 #include "expr/attribute.h"
 #include "expr/dtype.h"
+#include "expr/node_traversal.h"
 
 namespace CVC5 {
 namespace expr {
@@ -30,8 +31,8 @@ bool hasSubterm(TNode n, TNode t, bool strict)
     return true;
   }
 
-  std::unordered_set<TNode, TNodeHashFunction> visited;
-  std::vector<TNode> toProcess;
+  NodeVisitMarker visited;
+  std::vector<TNode>& toProcess = visited.getStack();
 
   toProcess.push_back(n);
 
@@ -59,13 +60,8 @@ bool hasSubterm(TNode n, TNode t, bool strict)
       {
         return true;
       }
-      if (visited.find(child) != visited.end())
+      if (visited.markVisited(child))
       {
-        continue;
-      }
-      else
-      {
-        visited.insert(child);
         toProcess.push_back(child);
       }
     }
@@ -76,28 +72,26 @@ bool hasSubterm(TNode n, TNode t, bool strict)
 
 bool hasSubtermMulti(TNode n, TNode t)
 {
-  std::unordered_map<TNode, bool, TNodeHashFunction> visited;
+  NodeVisitMarker visited;
   std::unordered_map<TNode, bool, TNodeHashFunction> contains;
   std::unordered_map<TNode, bool, TNodeHashFunction>::iterator it;
-  std::vector<TNode> visit;
+  std::vector<TNode>& visit = visited.getStack();
   TNode cur;
   visit.push_back(n);
   do
   {
     cur = visit.back();
     visit.pop_back();
-    it = visited.find(cur);
 
-    if (it == visited.end())
+    if (visited.markVisited(cur))
     {
       if (cur == t)
       {
-        visited[cur] = true;
+        visited.markPostVisited(cur);
         contains[cur] = true;
       }
       else
       {
-        visited[cur] = false;
         visit.push_back(cur);
         for (const Node& cc : cur)
         {
@@ -105,7 +99,7 @@ bool hasSubtermMulti(TNode n, TNode t)
         }
       }
     }
-    else if (!it->second)
+    else if (!visited.isPostVisited(cur))
     {
       bool doesContain = false;
       for (const Node& cn : cur)
@@ -123,7 +117,7 @@ bool hasSubtermMulti(TNode n, TNode t)
         }
       }
       contains[cur] = doesContain;
-      visited[cur] = true;
+      visited.markPostVisited(cur);
     }
   } while (!visit.empty());
   return false;
@@ -131,17 +125,16 @@ bool hasSubtermMulti(TNode n, TNode t)
 
 bool hasSubtermKind(Kind k, Node n)
 {
-  std::unordered_set<TNode, TNodeHashFunction> visited;
-  std::vector<TNode> visit;
+  NodeVisitMarker visited;
+  std::vector<TNode>& visit = visited.getStack();
   TNode cur;
   visit.push_back(n);
   do
   {
     cur = visit.back();
     visit.pop_back();
-    if (visited.find(cur) == visited.end())
+    if (visited.markVisited(cur))
     {
-      visited.insert(cur);
       if (cur.getKind() == k)
       {
         return true;
@@ -162,21 +155,20 @@ bool hasSubtermKinds(const std::unordered_set<Kind, kind::KindHashFunction>& ks,
   {
     return false;
   }
-  std::unordered_set<TNode, TNodeHashFunction> visited;
-  std::vector<TNode> visit;
+  NodeVisitMarker visited;
+  std::vector<TNode>& visit = visited.getStack();
   TNode cur;
   visit.push_back(n);
   do
   {
     cur = visit.back();
     visit.pop_back();
-    if (visited.find(cur) == visited.end())
+    if (visited.markVisited(cur))
     {
       if (ks.find(cur.getKind()) != ks.end())
       {
         return true;
       }
-      visited.insert(cur);
       visit.insert(visit.end(), cur.begin(), cur.end());
     }
   } while (!visit.empty());
@@ -194,8 +186,8 @@ bool hasSubterm(TNode n, const std::vector<Node>& t, bool strict)
     return true;
   }
 
-  std::unordered_set<TNode, TNodeHashFunction> visited;
-  std::vector<TNode> toProcess;
+  NodeVisitMarker visited;
+  std::vector<TNode>& toProcess = visited.getStack();
 
   toProcess.push_back(n);
 
@@ -223,13 +215,8 @@ bool hasSubterm(TNode n, const std::vector<Node>& t, bool strict)
       {
         return true;
       }
-      if (visited.find(child) != visited.end())
-      {
-        continue;
-      }
-      else
+      if (visited.markVisited(child))
       {
-        visited.insert(child);
         toProcess.push_back(child);
       }
     }
@@ -337,8 +324,8 @@ bool getFreeVariablesScope(TNode n,
                            std::unordered_set<TNode, TNodeHashFunction>& scope,
                            bool computeFv)
 {
-  std::unordered_set<TNode, TNodeHashFunction> visited;
-  std::vector<TNode> visit;
+  NodeVisitMarker visited;
+  std::vector<TNode>& visit = visited.getStack();
   TNode cur;
   visit.push_back(n);
   do
@@ -350,11 +337,8 @@ bool getFreeVariablesScope(TNode n,
     {
       continue;
     }
-    std::unordered_set<TNode, TNodeHashFunction>::iterator itv =
-        visited.find(cur);
-    if (itv == visited.end())
+    if (visited.markVisited(cur))
     {
-      visited.insert(cur);
       if (cur.getKind() == kind::BOUND_VARIABLE)
       {
         if (scope.find(cur) == scope.end())
@@ -406,17 +390,15 @@ bool getFreeVariablesScope(TNode n,
 
 bool getVariables(TNode n, std::unordered_set<TNode, TNodeHashFunction>& vs)
 {
-  std::unordered_set<TNode, TNodeHashFunction> visited;
-  std::vector<TNode> visit;
+  NodeVisitMarker visited;
+  std::vector<TNode>& visit = visited.getStack();
   TNode cur;
   visit.push_back(n);
   do
   {
     cur = visit.back();
     visit.pop_back();
-    std::unordered_set<TNode, TNodeHashFunction>::iterator itv =
-        visited.find(cur);
-    if (itv == visited.end())
+    if (visited.markVisited(cur))
     {
       if (cur.isVar())
       {
@@ -426,7 +408,6 @@ bool getVariables(TNode n, std::unordered_set<TNode, TNodeHashFunction>& vs)
       {
         visit.insert(visit.end(), cur.begin(), cur.end());
       }
-      visited.insert(cur);
     }
   } while (!visit.empty());
 
@@ -435,8 +416,27 @@ bool getVariables(TNode n, std::unordered_set<TNode, TNodeHashFunction>& vs)
 
 void getSymbols(TNode n, std::unordered_set<Node, NodeHashFunction>& syms)
 {
-  std::unordered_set<TNode, TNodeHashFunction> visited;
-  getSymbols(n, syms, visited);
+  NodeVisitMarker visited;
+  std::vector<TNode>& visit = visited.getStack();
+  TNode cur;
+  visit.push_back(n);
+  do
+  {
+    cur = visit.back();
+    visit.pop_back();
+    if (visited.markVisited(cur))
+    {
+      if (cur.isVar() && cur.getKind() != kind::BOUND_VARIABLE)
+      {
+        syms.insert(cur);
+      }
+      if (cur.hasOperator())
+      {
+        visit.push_back(cur.getOperator());
+      }
+      visit.insert(visit.end(), cur.begin(), cur.end());
+    }
+  } while (!visit.empty());
 }
 
 void getSymbols(TNode n,
@@ -471,17 +471,16 @@ void getKindSubterms(TNode n,
                      bool topLevel,
                      std::unordered_set<Node, NodeHashFunction>& ts)
 {
-  std::unordered_set<TNode, TNodeHashFunction> visited;
-  std::vector<TNode> visit;
+  NodeVisitMarker visited;
+  std::vector<TNode>& visit = visited.getStack();
   TNode cur;
   visit.push_back(n);
   do
   {
     cur = visit.back();
     visit.pop_back();
-    if (visited.find(cur) == visited.end())
+    if (visited.markVisited(cur))
     {
-      visited.insert(cur);
       if (cur.getKind() == k)
       {
         ts.insert(cur);
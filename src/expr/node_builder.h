@@ -77,8 +77,9 @@
  **         decrement them again on destruction.  The existing
  **         NodeManager pool entry is returned.
  **
- **   1(b). A new heap-allocated NodeValue must be constructed and all
- **         settings and children from d_inlineNv copied into it.
+ **   1(b). A new NodeValue must be allocated by the NodeManager (see
+ **         NodeManager::allocateNodeValue()) and all settings and
+ **         children from d_inlineNv copied into it.
  **         This new NodeValue is put into the NodeManager's pool.
  **         The NodeBuilder is marked as "used" and the number of
  **         children in d_inlineNv set to zero so that we don't
@@ -94,12 +95,15 @@
  **         cause any problems.  The existing NodeManager pool entry
  **         is returned.
  **
- **   2(b). The heap-allocated d_nv is "cropped" to the correct size
+ **   2(b). If the NodeManager slab-allocates NodeValues of this size,
+ **         the contents of d_nv are moved into a new NodeValue from
+ **         the NodeManager and d_nv is freed.  Otherwise, the
+ **         heap-allocated d_nv is "cropped" to the correct size
  **         (based on the number of children it _actually_ has).  d_nv
  **         is repointed to d_inlineNv so that destruction of the
- **         NodeBuilder doesn't cause any problems, and the (old)
- **         value it had is placed into the NodeManager's pool and
- **         returned in a Node wrapper.
+ **         NodeBuilder doesn't cause any problems, and the resulting
+ **         value is placed into the NodeManager's pool and returned
+ **         in a Node wrapper.
  **
  ** NOTE IN 1(b) AND 2(b) THAT we can NOT create Node wrapper
  ** temporary for the NodeValue in the NodeBuilder<>::operator Node()
@@ -933,16 +937,12 @@ expr::NodeValue* NodeBuilder<nchild_thresh>::constructNV() {
            "no children permitted";
 
     // we have to copy the inline NodeValue out
-    expr::NodeValue* nv = (expr::NodeValue*)
-      std::malloc(sizeof(expr::NodeValue));
-    if(nv == NULL) {
-      throw std::bad_alloc();
-    }
+    expr::NodeValue* nv = d_nm->allocateNodeValue(0);
     // there are no children, so we don't have to worry about
     // reference counts in this case.
     nv->d_nchildren = 0;
     nv->d_kind = d_nv->d_kind;
-    nv->d_id = d_nm->next_id++;// FIXME multithreading
+    nv->d_id = d_nm->newNodeValueId();
     nv->d_rc = 0;
     setUsed();
     if(Debug.isOn("gc")) {
@@ -1011,15 +1011,11 @@ expr::NodeValue* NodeBuilder<nchild_thresh>::constructNV() {
        * reference count. */
 
       // create the canonical expression value for this node
-      expr::NodeValue* nv = (expr::NodeValue*)
-        std::malloc(sizeof(expr::NodeValue) +
-                    ( sizeof(expr::NodeValue*) * d_inlineNv.d_nchildren ));
-      if(nv == NULL) {
-        throw std::bad_alloc();
-      }
+      expr::NodeValue* nv =
+          d_nm->allocateNodeValue(d_inlineNv.d_nchildren);
       nv->d_nchildren = d_inlineNv.d_nchildren;
       nv->d_kind = d_inlineNv.d_kind;
-      nv->d_id = d_nm->next_id++;// FIXME multithreading
+      nv->d_id = d_nm->newNodeValueId();
       nv->d_rc = 0;
 
       std::copy(d_inlineNv.d_children,
@@ -1030,7 +1026,7 @@ expr::NodeValue* NodeBuilder<nchild_thresh>::constructNV() {
       setUsed();
 
       //poolNv = nv;
-      d_nm->poolInsert(nv);
+      nv = d_nm->poolInsert(nv);
       if(Debug.isOn("gc")) {
         Debug("gc") << "creating node value " << nv
                     << " [" << nv->d_id << "]: ";
@@ -1064,22 +1060,41 @@ expr::NodeValue* NodeBuilder<nchild_thresh>::constructNV() {
       /* Subcase (b) The Node under construction is NOT already in the
        * NodeManager's pool. */
 
-      /* 2(b). The heap-allocated d_nv is "cropped" to the correct
-       * size (based on the number of children it _actually_ has).
-       * d_nv is repointed to d_inlineNv so that destruction of the
-       * NodeBuilder doesn't cause any problems, and the (old) value
-       * it had is placed into the NodeManager's pool and returned in
-       * a Node wrapper. */
-
-      crop();
-      expr::NodeValue* nv = d_nv;
-      nv->d_id = d_nm->next_id++;// FIXME multithreading
+      /* 2(b). If the NodeManager keeps NodeValues with this many
+       * children in its slab allocator, the children of d_nv are
+       * moved (with their reference counts) into a new slab-allocated
+       * NodeValue and the heap-allocated d_nv is freed.  Otherwise,
+       * the heap-allocated d_nv is "cropped" to the correct size
+       * (based on the number of children it _actually_ has).  d_nv is
+       * repointed to d_inlineNv so that destruction of the
+       * NodeBuilder doesn't cause any problems, and the resulting
+       * value is placed into the NodeManager's pool and returned in a
+       * Node wrapper. */
+
+      expr::NodeValue* nv;
+      if (expr::NodeValueAllocator::hasSizeClass(d_nv->d_nchildren))
+      {
+        nv = d_nm->allocateNodeValue(d_nv->d_nchildren);
+        nv->d_nchildren = d_nv->d_nchildren;
+        nv->d_kind = d_nv->d_kind;
+        nv->d_rc = 0;
+        std::copy(d_nv->d_children,
+                  d_nv->d_children + d_nv->d_nchildren,
+                  nv->d_children);
+        free(d_nv);
+      }
+      else
+      {
+        crop();
+        nv = d_nv;
+      }
+      nv->d_id = d_nm->newNodeValueId();
       d_nv = &d_inlineNv;
       d_nvMaxChildren = nchild_thresh;
       setUsed();
 
       //poolNv = nv;
-      d_nm->poolInsert(nv);
+      nv = d_nm->poolInsert(nv);
       Debug("gc") << "creating node value " << nv
                   << " [" << nv->d_id << "]: " << *nv << "\n";
       return nv;
@@ -1113,16 +1128,12 @@ expr::NodeValue* NodeBuilder<nchild_thresh>::constructNV() const {
            "no children permitted";
 
     // we have to copy the inline NodeValue out
-    expr::NodeValue* nv = (expr::NodeValue*)
-      std::malloc(sizeof(expr::NodeValue));
-    if(nv == NULL) {
-      throw std::bad_alloc();
-    }
+    expr::NodeValue* nv = d_nm->allocateNodeValue(0);
     // there are no children, so we don't have to worry about
     // reference counts in this case.
     nv->d_nchildren = 0;
     nv->d_kind = d_nv->d_kind;
-    nv->d_id = d_nm->next_id++;// FIXME multithreading
+    nv->d_id = d_nm->newNodeValueId();
     nv->d_rc = 0;
     Debug("gc") << "creating node value " << nv
                 << " [" << nv->d_id << "]: " << *nv << "\n";
@@ -1188,15 +1199,11 @@ expr::NodeValue* NodeBuilder<nchild_thresh>::constructNV() const {
        * count. */
 
       // create the canonical expression value for this node
-      expr::NodeValue* nv = (expr::NodeValue*)
-        std::malloc(sizeof(expr::NodeValue) +
-                    ( sizeof(expr::NodeValue*) * d_inlineNv.d_nchildren ));
-      if(nv == NULL) {
-        throw std::bad_alloc();
-      }
+      expr::NodeValue* nv =
+          d_nm->allocateNodeValue(d_inlineNv.d_nchildren);
       nv->d_nchildren = d_inlineNv.d_nchildren;
       nv->d_kind = d_inlineNv.d_kind;
-      nv->d_id = d_nm->next_id++;// FIXME multithreading
+      nv->d_id = d_nm->newNodeValueId();
       nv->d_rc = 0;
 
       std::copy(d_inlineNv.d_children,
@@ -1210,7 +1217,7 @@ expr::NodeValue* NodeBuilder<nchild_thresh>::constructNV() const {
       }
 
       //poolNv = nv;
-      d_nm->poolInsert(nv);
+      nv = d_nm->poolInsert(nv);
       Debug("gc") << "creating node value " << nv
                   << " [" << nv->d_id << "]: " << *nv << "\n";
       return nv;
@@ -1242,15 +1249,10 @@ expr::NodeValue* NodeBuilder<nchild_thresh>::constructNV() const {
        * decremented to match at NodeBuilder destruction time. */
 
       // create the canonical expression value for this node
-      expr::NodeValue* nv = (expr::NodeValue*)
-        std::malloc(sizeof(expr::NodeValue) +
-                    ( sizeof(expr::NodeValue*) * d_nv->d_nchildren ));
-      if(nv == NULL) {
-        throw std::bad_alloc();
-      }
+      expr::NodeValue* nv = d_nm->allocateNodeValue(d_nv->d_nchildren);
       nv->d_nchildren = d_nv->d_nchildren;
       nv->d_kind = d_nv->d_kind;
-      nv->d_id = d_nm->next_id++;// FIXME multithreading
+      nv->d_id = d_nm->newNodeValueId();
       nv->d_rc = 0;
 
       std::copy(d_nv->d_children,
@@ -1264,7 +1266,7 @@ expr::NodeValue* NodeBuilder<nchild_thresh>::constructNV() const {
       }
 
       //poolNv = nv;
-      d_nm->poolInsert(nv);
+      nv = d_nm->poolInsert(nv);
       Debug("gc") << "creating node value " << nv
                   << " [" << nv->d_id << "]: " << *nv << "\n";
       return nv;
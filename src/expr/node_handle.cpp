@@ -0,0 +1,74 @@
+/*********************                                                        */
+/*! \file node_handle.cpp
+ ** \verbatim
+ ** This file is part of the CVC4 project.
+ ** Copyright (c) 2009-2021 by the authors listed in the file AUTHORS
+ ** in the top-level source directory and their institutional affiliations.
+ ** All rights reserved.  See the file COPYING in the top-level source
+ ** directory for licensing information.\endverbatim
+ **
+ ** \brief Compact 32-bit handles for nodes
+ **
+ ** Compact 32-bit handles for nodes, and the table of the NodeManager that
+ ** maps them to NodeValues.
+ **/
+
+#include "expr/node_handle.h"
+
+namespace CVC5 {
+namespace expr {
+
+NodeHandleTable::NodeHandleTable() : d_size(0)
+{
+  for (std::atomic<std::atomic<NodeValue*>*>& bucket : d_buckets)
+  {
+    bucket.store(nullptr, std::memory_order_relaxed);
+  }
+  // index 0 is the null handle, which is not counted in d_size
+  getEntry(0).store(&NodeValue::null(), std::memory_order_relaxed);
+}
+
+NodeHandleTable::~NodeHandleTable()
+{
+  for (std::atomic<std::atomic<NodeValue*>*>& bucket : d_buckets)
+  {
+    delete[] bucket.load(std::memory_order_relaxed);
+  }
+}
+
+std::atomic<NodeValue*>* NodeHandleTable::allocateBucket(uint32_t b)
+{
+  std::atomic<NodeValue*>* bucket =
+      new std::atomic<NodeValue*>[firstBucketSize << b]();
+  std::atomic<NodeValue*>* expected = nullptr;
+  if (!d_buckets[b].compare_exchange_strong(expected, bucket))
+  {
+    delete[] bucket;
+    return expected;
+  }
+  return bucket;
+}
+
+void NodeHandleTable::eraseInternal(const NodeValue* nv)
+{
+  if (nv->getId() > std::numeric_limits<uint32_t>::max())
+  {
+    return;
+  }
+  uint32_t i = static_cast<uint32_t>(nv->getId());
+  uint32_t b = bucketOf(i);
+  std::atomic<NodeValue*>* bucket =
+      d_buckets[b].load(std::memory_order_acquire);
+  if (bucket != nullptr
+      && bucket[i + firstBucketSize - bucketStart(b)].load(
+             std::memory_order_relaxed)
+             == nv)
+  {
+    bucket[i + firstBucketSize - bucketStart(b)].store(
+        nullptr, std::memory_order_relaxed);
+    d_size.fetch_sub(1, std::memory_order_relaxed);
+  }
+}
+
+}  // namespace expr
+}  // namespace CVC5
@@ -0,0 +1,180 @@
+/*********************                                                        */
+/*! \file node_handle.h
+ ** \verbatim
+ ** This file is part of the CVC4 project.
+ ** Copyright (c) 2009-2021 by the authors listed in the file AUTHORS
+ ** in the top-level source directory and their institutional affiliations.
+ ** All rights reserved.  See the file COPYING in the top-level source
+ ** directory for licensing information.\endverbatim
+ **
+ ** \brief Compact 32-bit handles for nodes
+ **
+ ** Compact 32-bit handles for nodes, and the table of the NodeManager that
+ ** maps them to NodeValues.
+ **/
+
+#include "cvc4_private.h"
+
+/* circular dependency; force node_value.h first */
+#include "expr/node_value.h"
+
+#ifndef CVC4__EXPR__NODE_HANDLE_H
+#define CVC4__EXPR__NODE_HANDLE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+#include "base/check.h"
+
+namespace CVC5 {
+
+/**
+ * A compact, non-reference-counted reference to a node: a 32-bit index into
+ * the node table of the NodeManager that created it (see
+ * NodeManager::mkHandle() and NodeManager::getNode()).  The index is the id
+ * of the node.
+ *
+ * A NodeHandle is half the size of a TNode, so that large vectors and lists
+ * of node references (e.g., the function terms of TheoryUF) take up half
+ * the memory.  Like a TNode, it does not keep its node alive; it must not be
+ * used once the node has been garbage collected.  Since node ids are never
+ * reused, the handle of a collected node does not refer to another node.
+ *
+ * The null handle (index 0) refers to the null node.
+ */
+class NodeHandle
+{
+ public:
+  NodeHandle() : d_index(0) {}
+  explicit NodeHandle(uint32_t index) : d_index(index) {}
+
+  /** Get the index of this handle in the node table */
+  uint32_t getIndex() const { return d_index; }
+  /** Return true if this is the handle of the null node */
+  bool isNull() const { return d_index == 0; }
+
+  bool operator==(NodeHandle h) const { return d_index == h.d_index; }
+  bool operator!=(NodeHandle h) const { return d_index != h.d_index; }
+  /** Handles are ordered by index, i.e., by the ids of their nodes */
+  bool operator<(NodeHandle h) const { return d_index < h.d_index; }
+
+ private:
+  uint32_t d_index;
+}; /* class NodeHandle */
+
+static_assert(sizeof(NodeHandle) == sizeof(uint32_t),
+              "a NodeHandle must be a plain 32-bit index");
+
+struct NodeHandleHashFunction
+{
+  size_t operator()(NodeHandle h) const { return h.getIndex(); }
+}; /* struct NodeHandleHashFunction */
+
+namespace expr {
+
+/**
+ * The node table of a NodeManager, which maps NodeHandles to NodeValues.
+ *
+ * The table is indexed by node id.  It is split into buckets of doubling
+ * size, which are allocated the first time a node with an id in their range
+ * gets a handle, and which never move.  Hence, looking up a handle is two
+ * loads, and the table may be read and written by several threads at once
+ * without locks (see NodeManager::enableConcurrentMode()).
+ */
+class NodeHandleTable
+{
+ public:
+  NodeHandleTable();
+  ~NodeHandleTable();
+
+  NodeHandleTable(const NodeHandleTable&) = delete;
+  NodeHandleTable& operator=(const NodeHandleTable&) = delete;
+
+  /** Get the handle of nv, entering nv in the table if necessary */
+  NodeHandle getHandle(NodeValue* nv)
+  {
+    AlwaysAssert(nv->getId() <= std::numeric_limits<uint32_t>::max())
+        << "out of node handles";
+    uint32_t index = static_cast<uint32_t>(nv->getId());
+    std::atomic<NodeValue*>& entry = getEntry(index);
+    if (entry.load(std::memory_order_acquire) == nullptr)
+    {
+      NodeValue* expected = nullptr;
+      if (entry.compare_exchange_strong(expected, nv))
+      {
+        d_size.fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+    return NodeHandle(index);
+  }
+
+  /** Get the NodeValue the (valid) handle h refers to */
+  NodeValue* get(NodeHandle h) const
+  {
+    uint32_t b = bucketOf(h.getIndex());
+    std::atomic<NodeValue*>* bucket =
+        d_buckets[b].load(std::memory_order_acquire);
+    Assert(bucket != nullptr) << "invalid node handle";
+    NodeValue* nv = bucket[h.getIndex() + firstBucketSize - bucketStart(b)]
+                        .load(std::memory_order_acquire);
+    Assert(nv != nullptr) << "invalid node handle";
+    return nv;
+  }
+
+  /** Release the handle of nv, if any; called when nv is reclaimed */
+  void erase(const NodeValue* nv)
+  {
+    if (d_size.load(std::memory_order_relaxed) > 0)
+    {
+      eraseInternal(nv);
+    }
+  }
+
+  /** Get the number of nodes that have a handle */
+  size_t size() const { return d_size.load(std::memory_order_relaxed); }
+
+ private:
+  /** log2 of the size of the first bucket */
+  static constexpr uint32_t firstBucketBits = 10;
+  static constexpr uint64_t firstBucketSize = uint64_t(1) << firstBucketBits;
+  /** The number of buckets needed for all 32-bit indices */
+  static constexpr uint32_t numBuckets = 32 - firstBucketBits + 1;
+
+  /** Get the bucket of index i; bucket b holds firstBucketSize << b entries */
+  static uint32_t bucketOf(uint32_t i)
+  {
+    return 63 - __builtin_clzll(i + firstBucketSize) - firstBucketBits;
+  }
+  /** Get the first index of bucket b, plus firstBucketSize */
+  static uint64_t bucketStart(uint32_t b) { return firstBucketSize << b; }
+
+  /** Get the entry of index i, allocating its bucket if necessary */
+  std::atomic<NodeValue*>& getEntry(uint32_t i)
+  {
+    uint32_t b = bucketOf(i);
+    std::atomic<NodeValue*>* bucket =
+        d_buckets[b].load(std::memory_order_acquire);
+    if (__builtin_expect(bucket == nullptr, false))
+    {
+      bucket = allocateBucket(b);
+    }
+    return bucket[i + firstBucketSize - bucketStart(b)];
+  }
+
+  /** Allocate bucket b, unless another thread did so first */
+  std::atomic<NodeValue*>* allocateBucket(uint32_t b);
+
+  void eraseInternal(const NodeValue* nv);
+
+  /** The buckets of the table, or null if not allocated yet */
+  std::atomic<std::atomic<NodeValue*>*> d_buckets[numBuckets];
+  /** The number of nodes in the table, not counting the null node */
+  std::atomic<size_t> d_size;
+}; /* class NodeHandleTable */
+
+}  // namespace expr
+}  // namespace CVC5
+
+#endif /* CVC4__EXPR__NODE_HANDLE_H */
@@ -18,6 +18,7 @@
 #include "expr/node_manager.h"
 
 #include <algorithm>
+#include <chrono>
 #include <sstream>
 #include <stack>
 #include <utility>
@@ -33,6 +34,8 @@
 #include "expr/skolem_manager.h"
 #include "expr/type_checker.h"
 #include "util/resource_manager.h"
+#include "util/statistics_registry.h"
+#include "util/stats_histogram.h"
 
 using namespace std;
 using namespace CVC5::expr;
@@ -40,6 +43,7 @@ using namespace CVC5::expr;
 namespace CVC5 {
 
 thread_local NodeManager* NodeManager::s_current = NULL;
+thread_local std::vector<NodeManager*> NodeManager::s_entered;
 
 namespace {
 
@@ -83,8 +87,57 @@ struct NVReclaim {
   }
 };
 
+/**
+ * Records the duration of a zombie reclamation pause in a histogram, on
+ * destruction.  Pauses are bucketed by the number of bits of their duration
+ * in microseconds, i.e., bucket k holds pauses of [2^(k-1), 2^k) us.
+ */
+struct GcPauseTimer
+{
+  IntegralHistogramStat<int64_t>& d_histogram;
+  std::chrono::steady_clock::time_point d_start;
+
+  GcPauseTimer(IntegralHistogramStat<int64_t>& histogram)
+      : d_histogram(histogram), d_start(std::chrono::steady_clock::now())
+  {
+  }
+
+  ~GcPauseTimer()
+  {
+    uint64_t us = std::chrono::duration_cast<std::chrono::microseconds>(
+                      std::chrono::steady_clock::now() - d_start)
+                      .count();
+    int64_t bucket = 0;
+    for (; us > 0; us >>= 1)
+    {
+      ++bucket;
+    }
+    d_histogram << bucket;
+  }
+};
+
 } // namespace
 
+struct NodeManager::GcStatistics
+{
+  GcStatistics()
+      : d_pauseTimes("expr::NodeManager::gcPauseLog2Micros"),
+        d_reclaimedYoung("expr::NodeManager::gcReclaimedYoung", 0),
+        d_reclaimedOld("expr::NodeManager::gcReclaimedOld", 0),
+        d_promotions("expr::NodeManager::gcPromotions", 0)
+  {
+  }
+  /** Histogram of reclamation pauses, see GcPauseTimer */
+  IntegralHistogramStat<int64_t> d_pauseTimes;
+  /** Number of zombies of the young generation reclaimed */
+  IntStat d_reclaimedYoung;
+  /** Number of zombies of the old generation (or of any, if not
+   * incremental) reclaimed */
+  IntStat d_reclaimedOld;
+  /** Number of promotions of the young generation */
+  IntStat d_promotions;
+};
+
 namespace attr {
   struct LambdaBoundVarListTag { };
   }  // namespace attr
@@ -95,10 +148,14 @@ typedef expr::Attribute<attr::LambdaBoundVarListTag, Node> LambdaBoundVarListAtt
 NodeManager::NodeManager()
     : d_skManager(new SkolemManager),
       d_bvManager(new BoundVarManager),
+      d_concurrent(false),
       next_id(0),
       d_attrManager(new expr::attr::AttributeManager()),
       d_nodeUnderDeletion(nullptr),
       d_inReclaimZombies(false),
+      d_youngBoundary(0),
+      d_reclaimBudget(0),
+      d_gcStats(new GcStatistics),
       d_abstractValueCount(0),
       d_skolemCounter(0)
 {
@@ -202,6 +259,10 @@ NodeManager::~NodeManager() {
 
   NodeManagerScope nms(this);
 
+  // All threads are done with this NodeManager by now.  The node values are
+  // freed from the unsynchronized pool below.
+  disableConcurrentMode();
+
   // Destroy skolem and bound var manager before cleaning up attributes and
   // zombies
   d_skManager = nullptr;
@@ -234,8 +295,8 @@ NodeManager::~NodeManager() {
   std::vector<NodeValue*> order = TopologicalSort(d_maxedOut);
   d_maxedOut.clear();
 
-  while (!d_zombies.empty() || !order.empty()) {
-    if (d_zombies.empty()) {
+  while (hasZombies() || !order.empty()) {
+    if (!hasZombies()) {
       // Delete the maxed out nodes in toplogical order once we know
       // there are no additional zombies, or other nodes to worry about.
       Assert(!order.empty());
@@ -255,15 +316,10 @@ NodeManager::~NodeManager() {
 
   if(Debug.isOn("gc:leaks")) {
     Debug("gc:leaks") << "still in pool:" << endl;
-    for(NodeValuePool::const_iterator i = d_nodeValuePool.begin(),
-          iend = d_nodeValuePool.end();
-        i != iend;
-        ++i) {
-      Debug("gc:leaks") << "  " << *i
-                        << " id=" << (*i)->d_id
-                        << " rc=" << (*i)->d_rc
-                        << " " << **i << endl;
-    }
+    d_nodeValuePool.forEach([](NodeValue* nv) {
+      Debug("gc:leaks") << "  " << nv << " id=" << nv->d_id
+                        << " rc=" << nv->d_rc << " " << *nv << endl;
+    });
     Debug("gc:leaks") << ":end:" << endl;
   }
 
@@ -274,6 +330,7 @@ NodeManager::~NodeManager() {
 
 const DType& NodeManager::getDTypeForIndex(size_t index) const
 {
+  ConcurrentGuard guard(this);
   // if this assertion fails, it is likely due to not managing datatypes
   // properly w.r.t. multiple NodeManagers.
   Assert(index < d_dtypes.size());
@@ -281,10 +338,12 @@ const DType& NodeManager::getDTypeForIndex(size_t index) const
 }
 
 void NodeManager::reclaimZombies() {
-  // FIXME multithreading
+  // in concurrent mode, this is only called in quiescent states, see
+  // leaveConcurrently()
   Assert(!d_attrManager->inGarbageCollection());
 
-  Debug("gc") << "reclaiming " << d_zombies.size() << " zombie(s)!\n";
+  Debug("gc") << "reclaiming " << d_zombies.size() + d_youngZombies.size()
+              << " zombie(s)!\n";
 
   // during reclamation, reclaimZombies() is never supposed to be called
   Assert(!d_inReclaimZombies)
@@ -293,6 +352,7 @@ void NodeManager::reclaimZombies() {
   // whether exit is normal or exceptional, the Reclaim dtor is called
   // and ensures that d_inReclaimZombies is set back to false.
   ScopedBool r(d_inReclaimZombies);
+  GcPauseTimer pause(d_gcStats->d_pauseTimes);
 
   // We copy the set away and clear the NodeManager's set of zombies.
   // This is because reclaimZombie() decrements the RC of the
@@ -308,12 +368,17 @@ void NodeManager::reclaimZombies() {
   // iterator, causing a crash.  So we need to copy the set away.
 
   vector<NodeValue*> zombies;
-  zombies.reserve(d_zombies.size());
-  remove_copy_if(d_zombies.begin(),
-                 d_zombies.end(),
-                 back_inserter(zombies),
-                 NodeValueReferenceCountNonZero());
-  d_zombies.clear();
+  zombies.reserve(d_zombies.size() + d_youngZombies.size());
+  for (NodeValueIDSet* zs : {&d_youngZombies, &d_zombies})
+  {
+    remove_copy_if(zs->begin(),
+                   zs->end(),
+                   back_inserter(zombies),
+                   NodeValueReferenceCountNonZero());
+    zs->clear();
+  }
+  // all nodes alive now belong to the old generation
+  d_youngBoundary = next_id;
 
 #ifdef _LIBCPP_VERSION
   NodeValue* last = NULL;
@@ -333,57 +398,242 @@ void NodeManager::reclaimZombies() {
 
     // collect ONLY IF still zero
     if(nv->d_rc == 0) {
-      if(Debug.isOn("gc")) {
-        Debug("gc") << "deleting node value " << nv
-                    << " [" << nv->d_id << "]: ";
-        nv->printAst(Debug("gc"));
-        Debug("gc") << endl;
-      }
+      reclaimZombie(nv);
+      ++d_gcStats->d_reclaimedOld;
+    }
+  }
+}/* NodeManager::reclaimZombies() */
 
-      // remove from the pool
-      kind::MetaKind mk = nv->getMetaKind();
-      if(mk != kind::metakind::VARIABLE && mk != kind::metakind::NULLARY_OPERATOR) {
-        poolRemove(nv);
-      }
+void NodeManager::reclaimZombiesIncrementally()
+{
+  Assert(d_reclaimBudget > 0);
+  Assert(!d_attrManager->inGarbageCollection());
+  Assert(!d_inReclaimZombies)
+      << "NodeManager::reclaimZombiesIncrementally() not re-entrant!";
 
-      // whether exit is normal or exceptional, the NVReclaim dtor is
-      // called and ensures that d_nodeUnderDeletion is set back to
-      // NULL.
-      NVReclaim rc(d_nodeUnderDeletion);
-      d_nodeUnderDeletion = nv;
-
-      // remove attributes
-      { // notify listeners of deleted node
-        TNode n;
-        n.d_nv = nv;
-        nv->d_rc = 1; // so that TNode doesn't assert-fail
-        for (NodeManagerListener* listener : d_listeners)
-        {
-          listener->nmNotifyDeleteNode(n);
-        }
-        // this would mean that one of the listeners stowed away
-        // a reference to this node!
-        Assert(nv->d_rc == 1);
-      }
-      nv->d_rc = 0;
-      d_attrManager->deleteAllAttributes(nv);
-
-      // decr ref counts of children
-      nv->decrRefCounts();
-      if(mk == kind::metakind::CONSTANT) {
-        // Destroy (call the destructor for) the C++ type representing
-        // the constant in this NodeValue.  This is needed for
-        // e.g. CVC5::Rational, since it has a gmp internal
-        // representation that mallocs memory and should be cleaned
-        // up.  (This won't delete a pointer value if used as a
-        // constant, but then, you should probably use a smart-pointer
-        // type for a constant payload.)
-        kind::metakind::deleteNodeValueConstant(nv);
-      }
-      free(nv);
+  Debug("gc") << "reclaiming at most " << d_reclaimBudget << " of "
+              << d_youngZombies.size() << " young and " << d_zombies.size()
+              << " old zombie(s)!\n";
+
+  ScopedBool r(d_inReclaimZombies);
+  GcPauseTimer pause(d_gcStats->d_pauseTimes);
+
+  // Unlike in reclaimZombies(), we take the zombies out of the sets one
+  // by one.  Zombies created by reclaimZombie() are inserted into the
+  // sets while we process them, which is safe since we do not keep
+  // iterators across calls to reclaimZombie().
+  size_t budget = d_reclaimBudget;
+  while (budget > 0 && !d_youngZombies.empty())
+  {
+    NodeValue* nv = *d_youngZombies.begin();
+    d_youngZombies.erase(d_youngZombies.begin());
+    if (nv->d_rc == 0)
+    {
+      reclaimZombie(nv);
+      ++d_gcStats->d_reclaimedYoung;
+      --budget;
     }
   }
-}/* NodeManager::reclaimZombies() */
+  if (d_youngZombies.empty())
+  {
+    // the surviving young nodes are promoted to the old generation
+    d_youngBoundary = next_id;
+    ++d_gcStats->d_promotions;
+  }
+  if (d_zombies.size() <= 5000)
+  {
+    return;
+  }
+  while (budget > 0 && !d_zombies.empty())
+  {
+    NodeValue* nv = *d_zombies.begin();
+    d_zombies.erase(d_zombies.begin());
+    if (nv->d_rc == 0)
+    {
+      reclaimZombie(nv);
+      ++d_gcStats->d_reclaimedOld;
+      --budget;
+    }
+  }
+}
+
+void NodeManager::reclaimZombie(NodeValue* nv)
+{
+  Assert(nv->d_rc == 0);
+  if(Debug.isOn("gc")) {
+    Debug("gc") << "deleting node value " << nv
+                << " [" << nv->d_id << "]: ";
+    nv->printAst(Debug("gc"));
+    Debug("gc") << endl;
+  }
+
+  // remove from the pool
+  kind::MetaKind mk = nv->getMetaKind();
+  if(mk != kind::metakind::VARIABLE && mk != kind::metakind::NULLARY_OPERATOR) {
+    poolRemove(nv);
+  }
+
+  // whether exit is normal or exceptional, the NVReclaim dtor is
+  // called and ensures that d_nodeUnderDeletion is set back to
+  // NULL.
+  NVReclaim rc(d_nodeUnderDeletion);
+  d_nodeUnderDeletion = nv;
+
+  // remove attributes
+  { // notify listeners of deleted node
+    TNode n;
+    n.d_nv = nv;
+    nv->d_rc = 1; // so that TNode doesn't assert-fail
+    for (NodeManagerListener* listener : d_listeners)
+    {
+      listener->nmNotifyDeleteNode(n);
+    }
+    // this would mean that one of the listeners stowed away
+    // a reference to this node!
+    Assert(nv->d_rc == 1);
+  }
+  nv->d_rc = 0;
+  d_attrManager->deleteAllAttributes(nv);
+  d_handleTable.erase(nv);
+
+  // decr ref counts of children
+  nv->decrRefCounts();
+  if(mk == kind::metakind::CONSTANT) {
+    // Destroy (call the destructor for) the C++ type representing
+    // the constant in this NodeValue.  This is needed for
+    // e.g. CVC5::Rational, since it has a gmp internal
+    // representation that mallocs memory and should be cleaned
+    // up.  (This won't delete a pointer value if used as a
+    // constant, but then, you should probably use a smart-pointer
+    // type for a constant payload.)
+    kind::metakind::deleteNodeValueConstant(nv);
+  }
+  deallocateNodeValue(nv);
+}
+
+void NodeManager::discardNodeValue(NodeValue* nv)
+{
+  Assert(d_concurrent);
+  // nv was never visible to other threads
+  Assert(nv->d_rc == 0);
+  if (nv->getMetaKind() == kind::metakind::CONSTANT)
+  {
+    kind::metakind::deleteNodeValueConstant(nv);
+  }
+  else
+  {
+    nv->decrRefCounts();
+  }
+  deallocateNodeValue(nv);
+}
+
+void NodeManager::enableConcurrentMode()
+{
+  if (d_concurrent)
+  {
+    return;
+  }
+  NodeManagerScope nms(this);
+  if (hasZombies())
+  {
+    reclaimZombies();
+  }
+  std::vector<NodeValue*> nvs;
+  nvs.reserve(d_nodeValuePool.size());
+  d_nodeValuePool.forEach([&nvs](NodeValue* nv) { nvs.push_back(nv); });
+  d_sharedPool.reset(new expr::ShardedNodeValuePool);
+  for (NodeValue* nv : nvs)
+  {
+    d_nodeValuePool.erase(nv);
+    d_sharedPool->insert(nv);
+  }
+  Debug("gc") << "NodeManager " << this << ": concurrent mode with "
+              << nvs.size() << " pooled node values" << std::endl;
+  ++NodeValue::s_numConcurrent;
+  d_concurrent = true;
+}
+
+void NodeManager::disableConcurrentMode()
+{
+  if (!d_concurrent)
+  {
+    return;
+  }
+  std::vector<NodeValue*> nvs;
+  nvs.reserve(d_sharedPool->size());
+  d_sharedPool->forEach([&nvs](NodeValue* nv) { nvs.push_back(nv); });
+  for (NodeValue* nv : nvs)
+  {
+    d_sharedPool->erase(nv);
+    d_nodeValuePool.insert(nv);
+  }
+  d_sharedPool.reset();
+  Debug("gc") << "NodeManager " << this << ": left concurrent mode with "
+              << nvs.size() << " pooled node values" << std::endl;
+  --NodeValue::s_numConcurrent;
+  d_concurrent = false;
+}
+
+bool NodeManager::enterConcurrently()
+{
+  if (std::find(s_entered.begin(), s_entered.end(), this) != s_entered.end())
+  {
+    return false;
+  }
+  d_activeMutex.lock_shared();
+  s_entered.push_back(this);
+  return true;
+}
+
+void NodeManager::leaveConcurrently()
+{
+  s_entered.erase(std::find(s_entered.begin(), s_entered.end(), this));
+  d_activeMutex.unlock_shared();
+  if (!d_concurrent || !d_activeMutex.try_lock())
+  {
+    // the NodeManager is being destroyed, or other threads are inside it
+    return;
+  }
+  std::unique_lock<std::shared_mutex> lock(d_activeMutex, std::adopt_lock);
+  // No other thread holds a node value that is not referenced by a Node,
+  // so the zombies can be reclaimed as in the single-threaded case.
+  // Zombies created by reclaimZombies() are reclaimed in the next round.
+  while (hasZombies() && !d_attrManager->inGarbageCollection())
+  {
+    reclaimZombies();
+  }
+}
+
+void NodeManager::setZombieReclamationBudget(size_t budget)
+{
+  if (d_concurrent)
+  {
+    // zombies are reclaimed in quiescent states, see leaveConcurrently()
+    return;
+  }
+  // Move the young zombies to the old generation and make all existing
+  // nodes old, so that no node value can end up in both sets.
+  d_zombies.insert(d_youngZombies.begin(), d_youngZombies.end());
+  d_youngZombies.clear();
+  d_youngBoundary = next_id;
+  d_reclaimBudget = budget;
+}
+
+void NodeManager::registerStatistics(StatisticsRegistry* reg)
+{
+  reg->registerStat(&d_gcStats->d_pauseTimes);
+  reg->registerStat(&d_gcStats->d_reclaimedYoung);
+  reg->registerStat(&d_gcStats->d_reclaimedOld);
+  reg->registerStat(&d_gcStats->d_promotions);
+}
+
+void NodeManager::unregisterStatistics(StatisticsRegistry* reg)
+{
+  reg->unregisterStat(&d_gcStats->d_pauseTimes);
+  reg->unregisterStat(&d_gcStats->d_reclaimedYoung);
+  reg->unregisterStat(&d_gcStats->d_reclaimedOld);
+  reg->unregisterStat(&d_gcStats->d_promotions);
+}
 
 std::vector<NodeValue*> NodeManager::TopologicalSort(
     const std::vector<NodeValue*>& roots) {
@@ -504,6 +754,7 @@ TypeNode NodeManager::getType(TNode n, bool check)
 }
 
 Node NodeManager::mkSkolem(const std::string& prefix, const TypeNode& type, const std::string& comment, int flags) {
+  ConcurrentGuard guard(this);
   Node n = NodeBuilder<0>(this, kind::SKOLEM);
   setAttribute(n, TypeAttr(), type);
   setAttribute(n, TypeCheckedAttr(), true);
@@ -568,6 +819,7 @@ std::vector<TypeNode> NodeManager::mkMutualDatatypeTypes(
     const std::set<TypeNode>& unresolvedTypes,
     uint32_t flags)
 {
+  ConcurrentGuard guard(this);
   NodeManagerScope nms(this);
   std::map<std::string, TypeNode> nameResolutions;
   std::vector<TypeNode> dtts;
@@ -801,6 +1053,7 @@ TypeNode NodeManager::mkFunctionType(const std::vector<TypeNode>& argTypes,
 }
 
 TypeNode NodeManager::mkTupleType(const std::vector<TypeNode>& types) {
+  ConcurrentGuard guard(this);
   std::vector< TypeNode > ts;
   Debug("tuprec-debug") << "Make tuple type : ";
   for (unsigned i = 0; i < types.size(); ++ i) {
@@ -813,6 +1066,7 @@ TypeNode NodeManager::mkTupleType(const std::vector<TypeNode>& types) {
 }
 
 TypeNode NodeManager::mkRecordType(const Record& rec) {
+  ConcurrentGuard guard(this);
   return d_rt_cache.getRecordType( this, rec );
 }
 
@@ -823,17 +1077,22 @@ void NodeManager::reclaimAllZombies(){
 /** Reclaim zombies while there are more than k nodes in the pool (if possible).*/
 void NodeManager::reclaimZombiesUntil(uint32_t k){
   if(safeToReclaimZombies()){
-    while(poolSize() >= k && !d_zombies.empty()){
+    while(poolSize() >= k && hasZombies()){
       reclaimZombies();
     }
   }
 }
 
 size_t NodeManager::poolSize() const{
+  if (d_concurrent)
+  {
+    return d_sharedPool->size();
+  }
   return d_nodeValuePool.size();
 }
 
 TypeNode NodeManager::mkSort(uint32_t flags) {
+  ConcurrentGuard guard(this);
   NodeBuilder<1> nb(this, kind::SORT_TYPE);
   Node sortTag = NodeBuilder<0>(this, kind::SORT_TAG);
   nb << sortTag;
@@ -845,6 +1104,7 @@ TypeNode NodeManager::mkSort(uint32_t flags) {
 }
 
 TypeNode NodeManager::mkSort(const std::string& name, uint32_t flags) {
+  ConcurrentGuard guard(this);
   NodeBuilder<1> nb(this, kind::SORT_TYPE);
   Node sortTag = NodeBuilder<0>(this, kind::SORT_TAG);
   nb << sortTag;
@@ -859,6 +1119,7 @@ TypeNode NodeManager::mkSort(const std::string& name, uint32_t flags) {
 TypeNode NodeManager::mkSort(TypeNode constructor,
                                     const std::vector<TypeNode>& children,
                                     uint32_t flags) {
+  ConcurrentGuard guard(this);
   Assert(constructor.getKind() == kind::SORT_TYPE
          && constructor.getNumChildren() == 0)
       << "expected a sort constructor";
@@ -886,6 +1147,7 @@ TypeNode NodeManager::mkSortConstructor(const std::string& name,
                                         size_t arity,
                                         uint32_t flags)
 {
+  ConcurrentGuard guard(this);
   Assert(arity > 0);
   NodeBuilder<> nb(this, kind::SORT_TYPE);
   Node sortTag = NodeBuilder<0>(this, kind::SORT_TAG);
@@ -901,6 +1163,7 @@ TypeNode NodeManager::mkSortConstructor(const std::string& name,
 
 Node NodeManager::mkVar(const std::string& name, const TypeNode& type)
 {
+  ConcurrentGuard guard(this);
   Node n = NodeBuilder<0>(this, kind::VARIABLE);
   setAttribute(n, TypeAttr(), type);
   setAttribute(n, TypeCheckedAttr(), true);
@@ -913,6 +1176,7 @@ Node NodeManager::mkVar(const std::string& name, const TypeNode& type)
 
 Node* NodeManager::mkVarPtr(const std::string& name, const TypeNode& type)
 {
+  ConcurrentGuard guard(this);
   Node* n = NodeBuilder<0>(this, kind::VARIABLE).constructNodePtr();
   setAttribute(*n, TypeAttr(), type);
   setAttribute(*n, TypeCheckedAttr(), true);
@@ -1044,6 +1308,7 @@ Node NodeManager::mkChain(Kind kind, const std::vector<Node>& children)
 
 Node NodeManager::mkVar(const TypeNode& type)
 {
+  ConcurrentGuard guard(this);
   Node n = NodeBuilder<0>(this, kind::VARIABLE);
   setAttribute(n, TypeAttr(), type);
   setAttribute(n, TypeCheckedAttr(), true);
@@ -1055,6 +1320,7 @@ Node NodeManager::mkVar(const TypeNode& type)
 
 Node* NodeManager::mkVarPtr(const TypeNode& type)
 {
+  ConcurrentGuard guard(this);
   Node* n = NodeBuilder<0>(this, kind::VARIABLE).constructNodePtr();
   setAttribute(*n, TypeAttr(), type);
   setAttribute(*n, TypeCheckedAttr(), true);
@@ -1093,6 +1359,7 @@ Node NodeManager::mkBooleanTermVariable() {
 }
 
 Node NodeManager::mkNullaryOperator(const TypeNode& type, Kind k) {
+  ConcurrentGuard guard(this);
   std::map< TypeNode, Node >::iterator it = d_unique_vars[k].find( type );
   if( it==d_unique_vars[k].end() ){
     Node n = NodeBuilder<0>(this, k).constructNode();
@@ -1129,6 +1396,7 @@ Node NodeManager::mkBag(const TypeNode& t, const TNode n, const TNode m)
 }
 
 Node NodeManager::mkAbstractValue(const TypeNode& type) {
+  ConcurrentGuard guard(this);
   Node n = mkConst(AbstractValue(++d_abstractValueCount));
   n.setAttribute(TypeAttr(), type);
   n.setAttribute(TypeCheckedAttr(), true);
@@ -1136,14 +1404,22 @@ Node NodeManager::mkAbstractValue(const TypeNode& type) {
 }
 
 bool NodeManager::safeToReclaimZombies() const{
-  // FIXME multithreading
-  return !d_inReclaimZombies && !d_attrManager->inGarbageCollection();
+  // in concurrent mode, zombies are only reclaimed in quiescent states, see
+  // leaveConcurrently()
+  return !d_concurrent && !d_inReclaimZombies
+         && !d_attrManager->inGarbageCollection();
 }
 
 void NodeManager::deleteAttributes(const std::vector<const expr::attr::AttributeUniqueId*>& ids){
+  AttrGuard<false> guard(this);
   d_attrManager->deleteAttributes(ids);
 }
 
+void NodeManager::setDenseAttributeThreshold(size_t threshold)
+{
+  d_attrManager->setDenseThreshold(threshold);
+}
+
 void NodeManager::debugHook(int debugFlag){
   // For debugging purposes only, DO NOT CHECK IN ANY CODE!
 }
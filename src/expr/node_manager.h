@@ -26,6 +26,11 @@
 #ifndef CVC4__NODE_MANAGER_H
 #define CVC4__NODE_MANAGER_H
 
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <shared_mutex>
 #include <vector>
 #include <string>
 #include <unordered_set>
@@ -34,6 +39,9 @@
 #include "expr/kind.h"
 #include "expr/metakind.h"
 #include "expr/node_value.h"
+#include "expr/node_handle.h"
+#include "expr/node_value_allocator.h"
+#include "expr/node_value_pool.h"
 
 namespace CVC5 {
 
@@ -43,6 +51,7 @@ class Solver;
 
 class ResourceManager;
 class SkolemManager;
+class StatisticsRegistry;
 class BoundVarManager;
 
 class DType;
@@ -106,23 +115,65 @@ class NodeManager
     bool operator()(expr::NodeValue* nv) { return nv->d_rc > 0; }
   };
 
-  typedef std::unordered_set<expr::NodeValue*,
-                             expr::NodeValuePoolHashFunction,
-                             expr::NodeValuePoolEq> NodeValuePool;
   typedef std::unordered_set<expr::NodeValue*,
                              expr::NodeValueIDHashFunction,
                              expr::NodeValueIDEquality> NodeValueIDSet;
 
   static thread_local NodeManager* s_current;
 
+  /**
+   * The NodeManagers in concurrent mode that the current thread is inside
+   * of, i.e., for which it holds d_activeMutex, see NodeManagerScope.
+   */
+  static thread_local std::vector<NodeManager*> s_entered;
+
+  /**
+   * The slab allocator for the NodeValues of this NodeManager.  This must
+   * be declared before all members that (indirectly) hold NodeValues, so
+   * that it outlives them.
+   */
+  expr::NodeValueAllocator d_nvAllocator;
+
   /** The skolem manager */
   std::unique_ptr<SkolemManager> d_skManager;
   /** The bound variable manager */
   std::unique_ptr<BoundVarManager> d_bvManager;
 
-  NodeValuePool d_nodeValuePool;
+  expr::NodeValuePool d_nodeValuePool;
+
+  /** The table of the nodes that have a NodeHandle */
+  expr::NodeHandleTable d_handleTable;
 
-  size_t next_id;
+  /**
+   * True if this NodeManager may be used by several threads at once, see
+   * enableConcurrentMode().  In this mode, d_sharedPool replaces
+   * d_nodeValuePool and the mutexes below protect the state of the
+   * NodeManager.
+   */
+  bool d_concurrent;
+  /** The pool used in concurrent mode */
+  std::unique_ptr<expr::ShardedNodeValuePool> d_sharedPool;
+  /** Protects d_nvAllocator in concurrent mode */
+  std::mutex d_allocMutex;
+  /** Protects d_maxedOut in concurrent mode */
+  std::mutex d_maxedOutMutex;
+  /** Protects the zombie sets in concurrent mode */
+  std::mutex d_zombieMutex;
+  /**
+   * Held shared by every thread that is inside a NodeManagerScope of this
+   * NodeManager in concurrent mode, and exclusively while its zombies are
+   * reclaimed.
+   */
+  std::shared_mutex d_activeMutex;
+  /** Protects the attribute tables in concurrent mode */
+  mutable std::shared_mutex d_attrMutex;
+  /**
+   * Protects the remaining state (listeners, datatypes, type caches,
+   * counters) in concurrent mode.
+   */
+  mutable std::recursive_mutex d_mutex;
+
+  std::atomic<uint64_t> next_id;
 
   expr::attr::AttributeManager* d_attrManager;
 
@@ -148,9 +199,40 @@ class NodeManager
    * The set of zombie nodes.  We may want to revisit this design, as
    * we might like to delete nodes in least-recently-used order.  But
    * we also need to avoid processing a zombie twice.
+   *
+   * If incremental reclamation is enabled (d_reclaimBudget > 0), this
+   * set only holds the zombies of the old generation, see
+   * d_youngZombies.
    */
   NodeValueIDSet d_zombies;
 
+  /**
+   * The zombies of the young generation, i.e., with an id of at least
+   * d_youngBoundary.  This set is only used if incremental reclamation
+   * is enabled.  Nodes that die shortly after their creation (e.g.,
+   * temporaries of the rewriter) end up here and are reclaimed in
+   * small, frequent steps, before the zombies of the old generation.
+   */
+  NodeValueIDSet d_youngZombies;
+
+  /**
+   * Nodes with an id of at least this value belong to the young
+   * generation.  Once all young zombies are reclaimed, the surviving
+   * young nodes are promoted to the old generation by setting this to
+   * next_id.
+   */
+  uint64_t d_youngBoundary;
+
+  /**
+   * The maximal number of zombies reclaimed per reclamation step, or 0
+   * if all zombies are reclaimed at once.
+   */
+  size_t d_reclaimBudget;
+
+  /** Statistics on zombie reclamation */
+  struct GcStatistics;
+  std::unique_ptr<GcStatistics> d_gcStats;
+
   /**
    * NodeValues with maxed out reference counts. These live as long as the
    * NodeManager. They have a custom deallocation procedure at the very end.
@@ -240,12 +322,64 @@ class NodeManager
   inline expr::NodeValue* poolLookup(expr::NodeValue* nv) const;
 
   /**
-   * Insert a NodeValue into the NodeManager's pool.
+   * Insert a NodeValue into the NodeManager's pool and return the
+   * canonical NodeValue.
    *
    * It is an error to insert a NodeValue already in the pool.
-   * Enquire first with poolLookup().
+   * Enquire first with poolLookup().  In concurrent mode, another
+   * thread may however insert an equal NodeValue between the lookup
+   * and the insertion.  In this case, nv is freed and the NodeValue of
+   * the other thread is returned.  Otherwise, the result is nv.
+   */
+  inline expr::NodeValue* poolInsert(expr::NodeValue* nv);
+
+  /** Get the id for a new NodeValue */
+  inline uint64_t newNodeValueId();
+
+  /** Free nv, which lost the race for insertion in the pool */
+  void discardNodeValue(expr::NodeValue* nv);
+
+  /**
+   * A scoped lock of d_mutex, which is only taken in concurrent mode.
    */
-  inline void poolInsert(expr::NodeValue* nv);
+  class ConcurrentGuard
+  {
+   public:
+    ConcurrentGuard(const NodeManager* nm)
+        : d_lock(nm->d_mutex, std::defer_lock)
+    {
+      if (nm->d_concurrent)
+      {
+        d_lock.lock();
+      }
+    }
+
+   private:
+    std::unique_lock<std::recursive_mutex> d_lock;
+  };
+
+  /**
+   * A scoped shared (template argument true) or exclusive lock of the
+   * attribute tables, which is only taken in concurrent mode.
+   */
+  template <bool shared>
+  class AttrGuard
+  {
+   public:
+    AttrGuard(const NodeManager* nm) : d_lock(nm->d_attrMutex, std::defer_lock)
+    {
+      if (nm->d_concurrent)
+      {
+        d_lock.lock();
+      }
+    }
+
+   private:
+    typename std::conditional<shared,
+                              std::shared_lock<std::shared_mutex>,
+                              std::unique_lock<std::shared_mutex>>::type
+        d_lock;
+  };
 
   /**
    * Remove a NodeValue from the NodeManager's pool.
@@ -255,6 +389,22 @@ class NodeManager
    */
   inline void poolRemove(expr::NodeValue* nv);
 
+  /**
+   * Allocate uninitialized memory for a NodeValue with nchildren children
+   * (counting the operator of parameterized kinds).  NodeValues of size
+   * classes known to d_nvAllocator are carved out of its slabs, larger ones
+   * are malloc'ed.  CONSTANT NodeValues are not allocated with this method.
+   *
+   * @throws bad_alloc if the allocation fails
+   */
+  inline expr::NodeValue* allocateNodeValue(uint32_t nchildren);
+
+  /**
+   * Free the memory of the given NodeValue, which must have been allocated
+   * with allocateNodeValue() or, if it is a CONSTANT, with malloc().
+   */
+  inline void deallocateNodeValue(expr::NodeValue* nv);
+
   /**
    * Determine if nv is currently being deleted by the NodeManager.
    */
@@ -266,7 +416,23 @@ class NodeManager
    * Register a NodeValue as a zombie.
    */
   inline void markForDeletion(expr::NodeValue* nv) {
+    if (d_concurrent)
+    {
+      // Other threads may still look nv up in the pool and revive it, so
+      // it is only reclaimed once no thread uses this NodeManager, see
+      // leaveConcurrently().
+      std::lock_guard<std::mutex> lock(d_zombieMutex);
+      d_zombies.insert(nv);
+      return;
+    }
     Assert(nv->d_rc == 0);
+    // `d_youngZombies` and `d_zombies` never share a node value, since
+    // the generation of a node value only depends on its id and
+    // d_youngBoundary, and the latter only changes while
+    // `d_youngZombies` is empty.
+    NodeValueIDSet& zombies =
+        (d_reclaimBudget > 0 && nv->d_id >= d_youngBoundary) ? d_youngZombies
+                                                              : d_zombies;
 
     // if d_reclaiming is set, make sure we don't call
     // reclaimZombies(), because it's already running.
@@ -282,13 +448,21 @@ class NodeManager
     // already contains a node value with the same id as `nv`, but the pointers
     // are different, then the wrong `NodeManager` was in scope for one of the
     // two nodes when it reached refcount zero.
-    Assert(d_zombies.find(nv) == d_zombies.end() || *d_zombies.find(nv) == nv);
+    Assert(zombies.find(nv) == zombies.end() || *zombies.find(nv) == nv);
 
-    d_zombies.insert(nv);
+    zombies.insert(nv);
 
     if(safeToReclaimZombies()) {
-      if(d_zombies.size() > 5000) {
-        reclaimZombies();
+      if (d_reclaimBudget == 0)
+      {
+        if (d_zombies.size() > 5000)
+        {
+          reclaimZombies();
+        }
+      }
+      else if (d_youngZombies.size() > 500 || d_zombies.size() > 5000)
+      {
+        reclaimZombiesIncrementally();
       }
     }
   }
@@ -303,6 +477,12 @@ class NodeManager
       Debug("gc") << "marking node value " << nv
                   << " [" << nv->d_id << "]: as maxed out" << std::endl;
     }
+    if (d_concurrent)
+    {
+      std::lock_guard<std::mutex> lock(d_maxedOutMutex);
+      d_maxedOut.push_back(nv);
+      return;
+    }
     d_maxedOut.push_back(nv);
   }
 
@@ -311,6 +491,41 @@ class NodeManager
    */
   void reclaimZombies();
 
+  /**
+   * Reclaim at most d_reclaimBudget zombies, starting with the young
+   * generation.  Zombies of the old generation are only reclaimed if
+   * there are more than 5000 of them.  Zombies that are created in the
+   * cascade of reference count decrements are left for later steps.
+   */
+  void reclaimZombiesIncrementally();
+
+  /**
+   * Reclaim the zombie nv: remove it from the pool, notify listeners,
+   * delete its attributes, decrement the reference counts of its
+   * children and free it.
+   */
+  void reclaimZombie(expr::NodeValue* nv);
+
+  /**
+   * Enter this NodeManager in concurrent mode: the current thread takes
+   * d_activeMutex shared, unless it already holds it.  Return true if it
+   * did.
+   */
+  bool enterConcurrently();
+
+  /**
+   * Leave this NodeManager after enterConcurrently() returned true.  If no
+   * other thread is inside the NodeManager, this is a quiescent state: no
+   * thread can revive a zombie, so all zombies are reclaimed.
+   */
+  void leaveConcurrently();
+
+  /** Return true if there are zombies (of any generation) */
+  bool hasZombies() const
+  {
+    return !d_zombies.empty() || !d_youngZombies.empty();
+  }
+
   /**
    * It is safe to collect zombies.
    */
@@ -386,9 +601,15 @@ class NodeManager
   SkolemManager* getSkolemManager() { return d_skManager.get(); }
   /** Get this node manager's bound variable manager */
   BoundVarManager* getBoundVarManager() { return d_bvManager.get(); }
+  /** Get this node manager's NodeValue allocator (for statistics) */
+  const expr::NodeValueAllocator& getNodeValueAllocator() const
+  {
+    return d_nvAllocator;
+  }
 
   /** Subscribe to NodeManager events */
   void subscribeEvents(NodeManagerListener* listener) {
+    ConcurrentGuard guard(this);
     Assert(std::find(d_listeners.begin(), d_listeners.end(), listener)
            == d_listeners.end())
         << "listener already subscribed";
@@ -397,6 +618,7 @@ class NodeManager
 
   /** Unsubscribe from NodeManager events */
   void unsubscribeEvents(NodeManagerListener* listener) {
+    ConcurrentGuard guard(this);
     std::vector<NodeManagerListener*>::iterator elt = std::find(d_listeners.begin(), d_listeners.end(), listener);
     Assert(elt != d_listeners.end()) << "listener not subscribed";
     d_listeners.erase(elt);
@@ -1085,9 +1307,84 @@ class NodeManager
   /** Size of the node pool. */
   size_t poolSize() const;
 
+  /**
+   * Set the maximal number of zombies reclaimed in one step.  If budget is
+   * positive, zombies are reclaimed incrementally and by generation (see
+   * reclaimZombiesIncrementally()), which bounds the pauses caused by
+   * garbage collection.  If it is 0 (the default), all zombies are
+   * reclaimed at once whenever there are more than 5000 of them.
+   *
+   * This is a setting of the whole node manager.  It is set by the SmtEngine
+   * of the api::Solver that owns the node manager, and not by the internal
+   * subsolvers that share it.  It has no effect in concurrent mode, see
+   * enableConcurrentMode().
+   */
+  void setZombieReclamationBudget(size_t budget);
+
+  /** Register the garbage collection statistics with the given registry */
+  void registerStatistics(StatisticsRegistry* reg);
+  /** Unregister the garbage collection statistics from the given registry */
+  void unregisterStatistics(StatisticsRegistry* reg);
+
   /** Deletes a list of attributes from the NM's AttributeManager.*/
   void deleteAttributes(const std::vector< const expr::attr::AttributeUniqueId* >& ids);
 
+  /**
+   * Store each attribute that is set on at least threshold nodes in a dense
+   * column indexed by node id rather than in a hash table (0 == only use
+   * hash tables), see AttributeManager::setDenseThreshold().  Like the
+   * zombie reclamation budget, this is only set by the solver that owns the
+   * node manager.
+   */
+  void setDenseAttributeThreshold(size_t threshold);
+
+  /**
+   * Make this NodeManager safe to use from several threads at once, e.g.,
+   * by several api::Solver instances that share their terms, or by the
+   * threads of ProofChecker::checkProof().  This must be called before the
+   * NodeManager is shared.
+   *
+   * In concurrent mode, the pool is sharded and locked (see
+   * expr::ShardedNodeValuePool), and accesses to attributes and to the
+   * other state of the NodeManager are serialized.  Reference counts are
+   * changed under a lock (see expr::NodeValue::incShared()).  Zombies are
+   * not reclaimed right away, since another thread may look them up in
+   * the pool and revive them.  Their reclamation is deferred to the next
+   * quiescent state, i.e., until a thread leaves its outermost
+   * NodeManagerScope of this NodeManager and no other thread is inside
+   * one.  Hence, every thread must use the NodeManager inside a
+   * NodeManagerScope, and the calling thread should leave its current
+   * NodeManagerScope, or enter a new one, before other threads use the
+   * NodeManager.
+   */
+  void enableConcurrentMode();
+
+  /**
+   * Leave concurrent mode, see enableConcurrentMode().  This must only be
+   * called once no other thread uses the NodeManager.
+   */
+  void disableConcurrentMode();
+
+  /** Return true if this NodeManager is in concurrent mode */
+  bool isConcurrent() const { return d_concurrent; }
+
+  /**
+   * Get the compact handle of n, see NodeHandle.  The handle remains valid
+   * as long as n is alive.
+   */
+  NodeHandle mkHandle(TNode n) { return d_handleTable.getHandle(n.d_nv); }
+
+  /** Get the node the (valid) handle h refers to */
+  TNode getNode(NodeHandle h) const
+  {
+    TNode n;
+    n.d_nv = d_handleTable.get(h);
+    return n;
+  }
+
+  /** Get the number of nodes that currently have a handle */
+  size_t numHandles() const { return d_handleTable.size(); }
+
   /**
    * This function gives developers a hook into the NodeManager.
    * This can be changed in node_manager.cpp without recompiling most of cvc4.
@@ -1121,14 +1418,30 @@ class NodeManager
 class NodeManagerScope {
   /** The old NodeManager, to be restored on destruction. */
   NodeManager* d_oldNodeManager;
+  /**
+   * The NodeManager in concurrent mode that this scope entered, if it is its
+   * outermost scope on this thread, or null, see
+   * NodeManager::enterConcurrently().
+   */
+  NodeManager* d_entered;
 public:
- NodeManagerScope(NodeManager* nm) : d_oldNodeManager(NodeManager::s_current)
+ NodeManagerScope(NodeManager* nm)
+     : d_oldNodeManager(NodeManager::s_current), d_entered(nullptr)
  {
+   if (nm != nullptr && __builtin_expect(nm->d_concurrent, false)
+       && nm->enterConcurrently())
+   {
+     d_entered = nm;
+   }
    NodeManager::s_current = nm;
    Debug("current") << "node manager scope: " << NodeManager::s_current << "\n";
   }
 
   ~NodeManagerScope() {
+    if (__builtin_expect(d_entered != nullptr, false))
+    {
+      d_entered->leaveConcurrently();
+    }
     NodeManager::s_current = d_oldNodeManager;
     Debug("current") << "node manager scope: "
                      << "returning to " << NodeManager::s_current << "\n";
@@ -1182,25 +1495,86 @@ inline TypeNode NodeManager::mkTesterType(TypeNode domain) {
 }
 
 inline expr::NodeValue* NodeManager::poolLookup(expr::NodeValue* nv) const {
-  NodeValuePool::const_iterator find = d_nodeValuePool.find(nv);
-  if(find == d_nodeValuePool.end()) {
-    return NULL;
-  } else {
-    return *find;
+  if (__builtin_expect(d_concurrent, false))
+  {
+    return d_sharedPool->find(nv);
   }
+  return d_nodeValuePool.find(nv);
 }
 
-inline void NodeManager::poolInsert(expr::NodeValue* nv) {
-  Assert(d_nodeValuePool.find(nv) == d_nodeValuePool.end())
-      << "NodeValue already in the pool!";
-  d_nodeValuePool.insert(nv);// FIXME multithreading
+inline expr::NodeValue* NodeManager::poolInsert(expr::NodeValue* nv) {
+  if (__builtin_expect(d_concurrent, false))
+  {
+    expr::NodeValue* res = d_sharedPool->insert(nv);
+    if (res != nv)
+    {
+      discardNodeValue(nv);
+    }
+    return res;
+  }
+  d_nodeValuePool.insert(nv);
+  return nv;
 }
 
 inline void NodeManager::poolRemove(expr::NodeValue* nv) {
-  Assert(d_nodeValuePool.find(nv) != d_nodeValuePool.end())
-      << "NodeValue is not in the pool!";
+  if (__builtin_expect(d_concurrent, false))
+  {
+    d_sharedPool->erase(nv);
+    return;
+  }
+  d_nodeValuePool.erase(nv);
+}
+
+inline uint64_t NodeManager::newNodeValueId()
+{
+  if (__builtin_expect(d_concurrent, false))
+  {
+    return next_id.fetch_add(1, std::memory_order_relaxed);
+  }
+  uint64_t id = next_id.load(std::memory_order_relaxed);
+  next_id.store(id + 1, std::memory_order_relaxed);
+  return id;
+}
 
-  d_nodeValuePool.erase(nv);// FIXME multithreading
+inline expr::NodeValue* NodeManager::allocateNodeValue(uint32_t nchildren)
+{
+  if (expr::NodeValueAllocator::hasSizeClass(nchildren))
+  {
+    if (__builtin_expect(d_concurrent, false))
+    {
+      std::lock_guard<std::mutex> lock(d_allocMutex);
+      return static_cast<expr::NodeValue*>(d_nvAllocator.allocate(nchildren));
+    }
+    return static_cast<expr::NodeValue*>(d_nvAllocator.allocate(nchildren));
+  }
+  expr::NodeValue* nv = static_cast<expr::NodeValue*>(std::malloc(
+      sizeof(expr::NodeValue) + sizeof(expr::NodeValue*) * nchildren));
+  if (nv == nullptr)
+  {
+    throw std::bad_alloc();
+  }
+  return nv;
+}
+
+inline void NodeManager::deallocateNodeValue(expr::NodeValue* nv)
+{
+  // CONSTANTs are malloc'ed in mkConstInternal(), since their size depends
+  // on the payload type and not on the number of children
+  if (nv->getMetaKind() != kind::metakind::CONSTANT
+      && expr::NodeValueAllocator::hasSizeClass(nv->d_nchildren))
+  {
+    if (__builtin_expect(d_concurrent, false))
+    {
+      std::lock_guard<std::mutex> lock(d_allocMutex);
+      d_nvAllocator.deallocate(nv, nv->d_nchildren);
+      return;
+    }
+    d_nvAllocator.deallocate(nv, nv->d_nchildren);
+  }
+  else
+  {
+    std::free(nv);
+  }
 }
 
 }  // namespace CVC5
@@ -1560,13 +1934,13 @@ NodeClass NodeManager::mkConstInternal(const T& val) {
 
   nv->d_nchildren = 0;
   nv->d_kind = kind::metakind::ConstantMap<T>::kind;
-  nv->d_id = next_id++;// FIXME multithreading
+  nv->d_id = newNodeValueId();
   nv->d_rc = 0;
 
   //OwningTheory::mkConst(val);
   new (&nv->d_children) T(val);
 
-  poolInsert(nv);
+  nv = poolInsert(nv);
   if(Debug.isOn("gc")) {
     Debug("gc") << "creating node value " << nv
                 << " [" << nv->d_id << "]: ";
@@ -14,10 +14,128 @@
 
 #include "node_traversal.h"
 
+#include <algorithm>
 #include <functional>
+#include <limits>
 
 namespace CVC5 {
 
+namespace {
+
+/** The upper bound on the number of idle workspaces kept per thread */
+constexpr size_t MAX_POOLED_WORKSPACES = 16;
+
+}  // namespace
+
+NodeVisitMarker::NodeVisitMarker() : d_ws(acquire()) {}
+
+NodeVisitMarker::~NodeVisitMarker()
+{
+  if (d_ws != nullptr)
+  {
+    release(d_ws);
+  }
+}
+
+NodeVisitMarker::NodeVisitMarker(const NodeVisitMarker& other)
+    : d_ws(acquire())
+{
+  *this = other;
+}
+
+NodeVisitMarker& NodeVisitMarker::operator=(const NodeVisitMarker& other)
+{
+  if (this == &other)
+  {
+    return *this;
+  }
+  if (d_ws == nullptr)
+  {
+    d_ws = acquire();
+  }
+  else
+  {
+    d_ws->nextEpoch();
+  }
+  for (uint64_t id : other.d_ws->d_marked)
+  {
+    // keep the pre- or post-visited state
+    uint32_t offset = other.d_ws->get(id) - other.d_ws->d_epoch;
+    d_ws->slot(id) = d_ws->d_epoch + offset;
+  }
+  d_ws->d_marked = other.d_ws->d_marked;
+  d_ws->d_stack = other.d_ws->d_stack;
+  return *this;
+}
+
+NodeVisitMarker::NodeVisitMarker(NodeVisitMarker&& other) : d_ws(other.d_ws)
+{
+  other.d_ws = nullptr;
+}
+
+NodeVisitMarker& NodeVisitMarker::operator=(NodeVisitMarker&& other)
+{
+  std::swap(d_ws, other.d_ws);
+  return *this;
+}
+
+std::vector<std::unique_ptr<NodeVisitMarker::Workspace>>&
+NodeVisitMarker::getPool()
+{
+  // destroyed when the thread exits
+  static thread_local std::vector<std::unique_ptr<Workspace>> pool;
+  return pool;
+}
+
+NodeVisitMarker::Workspace* NodeVisitMarker::acquire()
+{
+  auto& pool = getPool();
+  if (pool.empty())
+  {
+    return new Workspace();
+  }
+  Workspace* ws = pool.back().release();
+  pool.pop_back();
+  return ws;
+}
+
+void NodeVisitMarker::release(Workspace* ws)
+{
+  auto& pool = getPool();
+  if (pool.size() >= MAX_POOLED_WORKSPACES)
+  {
+    delete ws;
+    return;
+  }
+  ws->nextEpoch();
+  pool.emplace_back(ws);
+}
+
+size_t NodeVisitMarker::getNumPooledWorkspaces() { return getPool().size(); }
+
+void NodeVisitMarker::Workspace::newPage(uint64_t p)
+{
+  if (p >= d_pages.size())
+  {
+    d_pages.resize(p + 1);
+  }
+  // stamps of fresh pages are 0, i.e., below any epoch
+  d_pages[p].reset(new uint32_t[PAGE_SIZE]());
+}
+
+void NodeVisitMarker::Workspace::nextEpoch()
+{
+  if (d_epoch >= std::numeric_limits<uint32_t>::max() - 4)
+  {
+    // the stamps would wrap around; start from scratch
+    d_pages.clear();
+    d_epoch = 0;
+  }
+  d_epoch += 2;
+  d_marked.clear();
+  d_stack.clear();
+}
+
 NodeDfsIterator::NodeDfsIterator(TNode n,
                                  VisitOrder order,
                                  std::function<bool(TNode)> skipIf)
@@ -90,8 +208,7 @@ void NodeDfsIterator::advanceToNextVisit()
   while (!d_stack.empty())
   {
     TNode back = d_stack.back();
-    auto visitEntry = d_visited.find(back);
-    if (visitEntry == d_visited.end())
+    if (!d_visited.isVisited(back))
     {
       // if we haven't pre-visited this node, pre-visit it
       if (d_skipIf(back))
@@ -100,7 +217,7 @@ void NodeDfsIterator::advanceToNextVisit()
         d_stack.pop_back();
         continue;
       }
-      d_visited[back] = false;
+      d_visited.markVisited(back);
       d_current = back;
       // Use integer underflow to reverse-iterate
       for (size_t n = back.getNumChildren(), i = n - 1; i < n; --i)
@@ -112,7 +229,7 @@ void NodeDfsIterator::advanceToNextVisit()
         return;
       }
     }
-    else if (d_order == VisitOrder::PREORDER || visitEntry->second)
+    else if (d_order == VisitOrder::PREORDER || d_visited.isPostVisited(back))
     {
       // if we're previsiting or we've already post-visited this node: skip it
       d_stack.pop_back();
@@ -120,7 +237,7 @@ void NodeDfsIterator::advanceToNextVisit()
     else
     {
       // otherwise, this is a post-visit
-      visitEntry->second = true;
+      d_visited.markPostVisited(back);
       d_current = back;
       d_stack.pop_back();
       return;
@@ -17,14 +17,142 @@
 #ifndef CVC4__EXPR__NODE_TRAVERSAL_H
 #define CVC4__EXPR__NODE_TRAVERSAL_H
 
+#include <cstdint>
 #include <iterator>
-#include <unordered_map>
+#include <memory>
 #include <vector>
 
 #include "expr/node.h"
 
 namespace CVC5 {
 
+/**
+ * The visited set of a DAG traversal, for the traversal loops in
+ * node_algorithm.cpp and NodeDfsIterator.
+ *
+ * Rather than hashing nodes into a fresh std::unordered_set, a marker stamps
+ * node ids in a paged array with the number of the current traversal (its
+ * epoch), so that marking and testing a node are two array accesses, and
+ * starting a new traversal is an increment of the epoch.  A node is marked
+ * either as pre-visited or as post-visited.  The marker also provides a
+ * stack for the traversal.
+ *
+ * The arrays and the stack are recycled across traversals through a pool of
+ * workspaces per thread, so that a traversal does not allocate once its
+ * thread has done a few traversals of similar size.  Markers can be nested
+ * (each takes its own workspace from the pool) and used from several
+ * threads.
+ */
+class NodeVisitMarker
+{
+ public:
+  NodeVisitMarker();
+  ~NodeVisitMarker();
+  /** Copying a marker copies its marks and its stack */
+  NodeVisitMarker(const NodeVisitMarker& other);
+  NodeVisitMarker& operator=(const NodeVisitMarker& other);
+  NodeVisitMarker(NodeVisitMarker&& other);
+  NodeVisitMarker& operator=(NodeVisitMarker&& other);
+
+  /** Return true if n is marked as pre- or post-visited */
+  bool isVisited(TNode n) const
+  {
+    return d_ws->get(n.getId()) >= d_ws->d_epoch;
+  }
+  /** Return true if n is marked as post-visited */
+  bool isPostVisited(TNode n) const
+  {
+    return d_ws->get(n.getId()) == d_ws->d_epoch + 1;
+  }
+  /**
+   * Mark n as pre-visited, unless it is marked already.  Return true if n
+   * was not marked before.
+   */
+  bool markVisited(TNode n)
+  {
+    uint32_t& stamp = d_ws->slot(n.getId());
+    if (stamp >= d_ws->d_epoch)
+    {
+      return false;
+    }
+    stamp = d_ws->d_epoch;
+    d_ws->d_marked.push_back(n.getId());
+    return true;
+  }
+  /** Mark the pre-visited node n as post-visited */
+  void markPostVisited(TNode n)
+  {
+    uint32_t& stamp = d_ws->slot(n.getId());
+    Assert(stamp == d_ws->d_epoch);
+    stamp = d_ws->d_epoch + 1;
+  }
+
+  /** Get the (initially empty) stack of this traversal */
+  std::vector<TNode>& getStack() { return d_ws->d_stack; }
+
+  /** Remove all marks and clear the stack */
+  void clear() { d_ws->nextEpoch(); }
+
+  /** Get the number of workspaces in the pool of this thread */
+  static size_t getNumPooledWorkspaces();
+
+ private:
+  /** The arrays and stack of a marker */
+  struct Workspace
+  {
+    /** The number of stamps per page is 2^PAGE_BITS */
+    static constexpr uint32_t PAGE_BITS = 12;
+    static constexpr uint64_t PAGE_SIZE = uint64_t(1) << PAGE_BITS;
+
+    Workspace() : d_epoch(0) { nextEpoch(); }
+
+    /** Get the stamp of id (0 if it was never stamped) */
+    uint32_t get(uint64_t id) const
+    {
+      uint64_t p = id >> PAGE_BITS;
+      return p < d_pages.size() && d_pages[p] != nullptr
+                 ? d_pages[p][id & (PAGE_SIZE - 1)]
+                 : 0;
+    }
+    /** Get the stamp of id for writing */
+    uint32_t& slot(uint64_t id)
+    {
+      uint64_t p = id >> PAGE_BITS;
+      if (__builtin_expect(p >= d_pages.size() || d_pages[p] == nullptr, false))
+      {
+        newPage(p);
+      }
+      return d_pages[p][id & (PAGE_SIZE - 1)];
+    }
+    /** Allocate page p, which does not exist yet */
+    void newPage(uint64_t p);
+    /** Start a new traversal */
+    void nextEpoch();
+
+    /** The pages of stamps, indexed by node id */
+    std::vector<std::unique_ptr<uint32_t[]>> d_pages;
+    /**
+     * The stamp of pre-visited nodes; post-visited nodes have stamp
+     * d_epoch + 1, and nodes with a smaller stamp are not marked.
+     */
+    uint32_t d_epoch;
+    /** The ids marked in the current epoch, for copying the marks */
+    std::vector<uint64_t> d_marked;
+    /** The stack of the traversal */
+    std::vector<TNode> d_stack;
+  };
+
+  /** Take a workspace from the pool of this thread, or make a new one */
+  static Workspace* acquire();
+  /** Return ws to the pool of this thread */
+  static void release(Workspace* ws);
+  /** Get the pool of idle workspaces of this thread */
+  static std::vector<std::unique_ptr<Workspace>>& getPool();
+
+  /** The workspace of this marker; nullptr if it was moved from */
+  Workspace* d_ws;
+}; /* class NodeVisitMarker */
+
 /**
  * Enum that represents an order in which nodes are visited.
  */
@@ -94,10 +222,11 @@ class NodeDfsIterator
   std::vector<TNode> d_stack;
 
   // Whether (and how) we've visited a node.
-  // Absent if we haven't visited it.
-  // Set to `false` if we've already pre-visited it (enqueued its children).
-  // Set to `true` if we've also already post-visited it.
-  std::unordered_map<TNode, bool, TNodeHashFunction> d_visited;
+  // Unmarked if we haven't visited it.
+  // Marked as pre-visited if we've already pre-visited it (enqueued its
+  // children).
+  // Marked as post-visited if we've also already post-visited it.
+  NodeVisitMarker d_visited;
 
   // The visit order that this iterator is using
   VisitOrder d_order;
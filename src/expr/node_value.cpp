@@ -20,10 +20,12 @@
 #include "expr/node_value.h"
 
 #include <sstream>
+#include <thread>
 
 #include "expr/kind.h"
 #include "expr/metakind.h"
 #include "expr/node.h"
+#include "expr/node_manager.h"
 #include "options/base_options.h"
 #include "options/language.h"
 #include "options/options.h"
@@ -34,6 +36,77 @@ using namespace std;
 namespace CVC5 {
 namespace expr {
 
+namespace {
+
+/** A spin lock of the reference counts of shared node values */
+struct alignas(64) RefCountLock
+{
+  std::atomic_flag d_flag = ATOMIC_FLAG_INIT;
+};
+
+/** The number of reference count locks, see NodeValue::incShared() */
+constexpr size_t numRefCountLocks = 256;
+RefCountLock refCountLocks[numRefCountLocks];
+
+/** A scoped lock of the reference count of a node value */
+class RefCountLockGuard
+{
+ public:
+  RefCountLockGuard(const NodeValue* nv)
+      : d_flag(refCountLocks[(reinterpret_cast<uintptr_t>(nv) >> 4)
+                             % numRefCountLocks]
+                   .d_flag)
+  {
+    while (d_flag.test_and_set(std::memory_order_acquire))
+    {
+      std::this_thread::yield();
+    }
+  }
+  ~RefCountLockGuard() { d_flag.clear(std::memory_order_release); }
+
+ private:
+  std::atomic_flag& d_flag;
+};
+
+}  // namespace
+
+std::atomic<uint32_t> NodeValue::s_numConcurrent(0);
+
+void NodeValue::incShared()
+{
+  {
+    RefCountLockGuard guard(this);
+    if (d_rc == MAX_RC || ++d_rc < MAX_RC)
+    {
+      return;
+    }
+  }
+  Assert(NodeManager::currentNM() != NULL)
+      << "No current NodeManager on incrementing of NodeValue: "
+         "maybe a public CVC4 interface function is missing a "
+         "NodeManagerScope ?";
+  NodeManager::currentNM()->markRefCountMaxedOut(this);
+}
+
+void NodeValue::decShared()
+{
+  {
+    RefCountLockGuard guard(this);
+    if (d_rc == MAX_RC || --d_rc > 0)
+    {
+      return;
+    }
+  }
+  // Another thread may revive this node value before it is marked for
+  // deletion; the NodeManager only reclaims zombies with a reference count
+  // of 0 when no other thread uses it.
+  Assert(NodeManager::currentNM() != NULL)
+      << "No current NodeManager on destruction of NodeValue: "
+         "maybe a public CVC4 interface function is missing a "
+         "NodeManagerScope ?";
+  NodeManager::currentNM()->markForDeletion(this);
+}
+
 string NodeValue::toString() const {
   stringstream ss;
 
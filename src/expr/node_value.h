@@ -26,6 +26,7 @@
 #ifndef CVC4__EXPR__NODE_VALUE_H
 #define CVC4__EXPR__NODE_VALUE_H
 
+#include <atomic>
 #include <iterator>
 #include <string>
 
@@ -301,6 +302,21 @@ class NodeValue
   void inc();
   void dec();
 
+  /**
+   * inc() and dec() for node values that may be shared between threads:
+   * the reference count is changed under a lock picked by the address of
+   * the node value, since a bitfield cannot be updated atomically.
+   */
+  void incShared();
+  void decShared();
+
+  /**
+   * The number of NodeManagers in concurrent mode (see
+   * NodeManager::enableConcurrentMode()).  While it is positive, inc() and
+   * dec() use incShared() and decShared().
+   */
+  static std::atomic<uint32_t> s_numConcurrent;
+
   /** Decrement ref counts of children */
   inline void decrRefCounts();
 
@@ -420,7 +436,12 @@ inline void NodeValue::inc() {
   Assert(!isBeingDeleted())
       << "NodeValue is currently being deleted "
          "and increment is being called on it. Don't Do That!";
-  // FIXME multithreading
+  if (__builtin_expect(s_numConcurrent.load(std::memory_order_relaxed) > 0,
+                       false))
+  {
+    incShared();
+    return;
+  }
   if (__builtin_expect((d_rc < MAX_RC - 1), true)) {
     ++d_rc;
   } else if (__builtin_expect((d_rc == MAX_RC - 1), false)) {
@@ -434,7 +455,12 @@ inline void NodeValue::inc() {
 }
 
 inline void NodeValue::dec() {
-  // FIXME multithreading
+  if (__builtin_expect(s_numConcurrent.load(std::memory_order_relaxed) > 0,
+                       false))
+  {
+    decShared();
+    return;
+  }
   if(__builtin_expect( ( d_rc < MAX_RC ), true )) {
     --d_rc;
     if(__builtin_expect( ( d_rc == 0 ), false )) {
@@ -0,0 +1,91 @@
+/*********************                                                        */
+/*! \file node_value_allocator.cpp
+ ** \verbatim
+ ** This file is part of the CVC4 project.
+ ** Copyright (c) 2009-2021 by the authors listed in the file AUTHORS
+ ** in the top-level source directory and their institutional affiliations.
+ ** All rights reserved.  See the file COPYING in the top-level source
+ ** directory for licensing information.\endverbatim
+ **
+ ** \brief A size-class slab allocator for NodeValues
+ **
+ ** A size-class slab allocator for NodeValues, owned by the NodeManager.
+ **/
+
+#include "expr/node_value_allocator.h"
+
+#include <cstdlib>
+#include <new>
+
+#include "base/output.h"
+#include "expr/node_value.h"
+
+namespace CVC5 {
+namespace expr {
+
+NodeValueAllocator::NodeValueAllocator()
+    : d_totalLive(0), d_totalCapacity(0), d_totalSlabBytes(0)
+{
+  for (uint32_t i = 0; i < NUM_SIZE_CLASSES; ++i)
+  {
+    d_freeLists[i] = nullptr;
+    d_numLive[i] = 0;
+    d_capacity[i] = 0;
+  }
+}
+
+NodeValueAllocator::~NodeValueAllocator()
+{
+  Debug("gc") << "NodeValueAllocator: releasing " << d_slabs.size()
+              << " slab(s), " << d_totalLive << " NodeValue(s) still live"
+              << std::endl;
+  for (void* slab : d_slabs)
+  {
+    std::free(slab);
+  }
+}
+
+size_t NodeValueAllocator::getSlotSize(uint32_t nchildren)
+{
+  static_assert(sizeof(NodeValue) >= sizeof(FreeSlot),
+                "a free slot must fit into an empty NodeValue");
+  static_assert(sizeof(NodeValue) % alignof(NodeValue*) == 0,
+                "NodeValue children must be suitably aligned");
+  return sizeof(NodeValue) + sizeof(NodeValue*) * nchildren;
+}
+
+NodeValueAllocator::FreeSlot* NodeValueAllocator::newSlab(uint32_t nchildren)
+{
+  Assert(d_freeLists[nchildren] == nullptr);
+  size_t slotSize = getSlotSize(nchildren);
+  size_t nslots = SLAB_SIZE_BYTES / slotSize;
+  Assert(nslots > 0);
+
+  char* slab = static_cast<char*>(std::malloc(nslots * slotSize));
+  if (slab == nullptr)
+  {
+    throw std::bad_alloc();
+  }
+  d_slabs.push_back(slab);
+
+  // thread the slots in address order, so that consecutive allocations
+  // from a fresh slab are adjacent in memory
+  FreeSlot* head = nullptr;
+  for (size_t i = nslots; i > 0; --i)
+  {
+    FreeSlot* slot = reinterpret_cast<FreeSlot*>(slab + (i - 1) * slotSize);
+    slot->d_next = head;
+    head = slot;
+  }
+  d_freeLists[nchildren] = head;
+
+  d_capacity[nchildren] += nslots;
+  d_totalCapacity += nslots;
+  d_totalSlabBytes += nslots * slotSize;
+  Debug("gc") << "NodeValueAllocator: new slab for size class " << nchildren
+              << " (" << nslots << " slots)" << std::endl;
+  return head;
+}
+
+}  // namespace expr
+}  // namespace CVC5
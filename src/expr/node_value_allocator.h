@@ -0,0 +1,155 @@
+/*********************                                                        */
+/*! \file node_value_allocator.h
+ ** \verbatim
+ ** This file is part of the CVC4 project.
+ ** Copyright (c) 2009-2021 by the authors listed in the file AUTHORS
+ ** in the top-level source directory and their institutional affiliations.
+ ** All rights reserved.  See the file COPYING in the top-level source
+ ** directory for licensing information.\endverbatim
+ **
+ ** \brief A size-class slab allocator for NodeValues
+ **
+ ** A size-class slab allocator for NodeValues, owned by the NodeManager.
+ **/
+
+#include "cvc4_private.h"
+
+#ifndef CVC4__EXPR__NODE_VALUE_ALLOCATOR_H
+#define CVC4__EXPR__NODE_VALUE_ALLOCATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "base/check.h"
+
+namespace CVC5 {
+namespace expr {
+
+class NodeValue;
+
+/**
+ * A slab allocator for NodeValues with few children.
+ *
+ * NodeValues are grouped into size classes by their number of children
+ * (i.e., by d_nchildren, which includes the operator of parameterized
+ * kinds).  Each size class carves fixed-size slots out of large slabs and
+ * keeps a free list of the slots that were handed back, so that creating
+ * and reclaiming a NodeValue is a pointer swap in the common case rather
+ * than a round-trip through the general-purpose allocator.  Slots are
+ * recycled within their size class and slabs are only released when the
+ * allocator is destroyed, i.e., with the owning NodeManager.
+ *
+ * NodeValues with NUM_SIZE_CLASSES or more children and CONSTANT NodeValues
+ * (whose size depends on the payload type) are not handled by this class.
+ */
+class NodeValueAllocator
+{
+ public:
+  /** The number of size classes; class i holds NodeValues with i children */
+  static constexpr uint32_t NUM_SIZE_CLASSES = 16;
+  /** The size of a slab in bytes */
+  static constexpr size_t SLAB_SIZE_BYTES = 64 * 1024;
+
+  NodeValueAllocator();
+  ~NodeValueAllocator();
+
+  NodeValueAllocator(const NodeValueAllocator&) = delete;
+  NodeValueAllocator& operator=(const NodeValueAllocator&) = delete;
+
+  /** Return true if NodeValues with nchildren children are slab-allocated */
+  static bool hasSizeClass(uint32_t nchildren)
+  {
+    return nchildren < NUM_SIZE_CLASSES;
+  }
+
+  /**
+   * Allocate uninitialized memory for a NodeValue with nchildren children.
+   * Requires hasSizeClass(nchildren).
+   *
+   * @throws bad_alloc if a new slab cannot be allocated
+   */
+  void* allocate(uint32_t nchildren)
+  {
+    Assert(hasSizeClass(nchildren));
+    FreeSlot* slot = d_freeLists[nchildren];
+    if (__builtin_expect(slot == nullptr, false))
+    {
+      slot = newSlab(nchildren);
+    }
+    d_freeLists[nchildren] = slot->d_next;
+    ++d_numLive[nchildren];
+    ++d_totalLive;
+    return slot;
+  }
+
+  /**
+   * Return the memory of a NodeValue with nchildren children, previously
+   * obtained from allocate(nchildren), to the free list of its size class.
+   */
+  void deallocate(void* p, uint32_t nchildren)
+  {
+    Assert(hasSizeClass(nchildren));
+    Assert(d_numLive[nchildren] > 0);
+    FreeSlot* slot = static_cast<FreeSlot*>(p);
+    slot->d_next = d_freeLists[nchildren];
+    d_freeLists[nchildren] = slot;
+    --d_numLive[nchildren];
+    --d_totalLive;
+  }
+
+  /** Get the number of live NodeValues in size class nchildren */
+  uint64_t getNumLive(uint32_t nchildren) const
+  {
+    Assert(hasSizeClass(nchildren));
+    return d_numLive[nchildren];
+  }
+  /** Get the number of slots (live or free) in size class nchildren */
+  uint64_t getCapacity(uint32_t nchildren) const
+  {
+    Assert(hasSizeClass(nchildren));
+    return d_capacity[nchildren];
+  }
+  /** Get the total number of live slab-allocated NodeValues */
+  const uint64_t& getTotalLive() const { return d_totalLive; }
+  /** Get the total number of slots over all size classes */
+  const uint64_t& getTotalCapacity() const { return d_totalCapacity; }
+  /** Get the total number of bytes held in slabs */
+  const uint64_t& getTotalSlabBytes() const { return d_totalSlabBytes; }
+
+  /** Get the size of a slot in size class nchildren, in bytes */
+  static size_t getSlotSize(uint32_t nchildren);
+
+ private:
+  /** An unused slot, linked into the free list of its size class */
+  struct FreeSlot
+  {
+    FreeSlot* d_next;
+  };
+
+  /**
+   * Allocate a new slab for size class nchildren, thread its slots into the
+   * (empty) free list of that class and return the head of the list.
+   */
+  FreeSlot* newSlab(uint32_t nchildren);
+
+  /** The free lists, one per size class */
+  FreeSlot* d_freeLists[NUM_SIZE_CLASSES];
+  /** The number of live NodeValues, per size class */
+  uint64_t d_numLive[NUM_SIZE_CLASSES];
+  /** The number of slots, per size class */
+  uint64_t d_capacity[NUM_SIZE_CLASSES];
+  /** The sum of d_numLive */
+  uint64_t d_totalLive;
+  /** The sum of d_capacity */
+  uint64_t d_totalCapacity;
+  /** The total number of bytes allocated for slabs */
+  uint64_t d_totalSlabBytes;
+  /** All slabs allocated so far */
+  std::vector<void*> d_slabs;
+}; /* class NodeValueAllocator */
+
+}  // namespace expr
+}  // namespace CVC5
+
+#endif /* CVC4__EXPR__NODE_VALUE_ALLOCATOR_H */
@@ -0,0 +1,185 @@
+/*********************                                                        */
+/*! \file node_value_pool.cpp
+ ** \verbatim
+ ** This file is part of the CVC4 project.
+ ** Copyright (c) 2009-2021 by the authors listed in the file AUTHORS
+ ** in the top-level source directory and their institutional affiliations.
+ ** All rights reserved.  See the file COPYING in the top-level source
+ ** directory for licensing information.\endverbatim
+ **
+ ** \brief The hash-consing table of the NodeManager
+ **
+ ** An open-addressing hash table of NodeValues used by the NodeManager for
+ ** hash-consing.
+ **/
+
+#include "expr/node_value_pool.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "base/output.h"
+
+namespace CVC5 {
+namespace expr {
+
+NodeValuePool::NodeValuePool() : d_migrated(0), d_oldSize(0), d_size(0)
+{
+  d_table.allocate(INITIAL_CAPACITY);
+}
+
+NodeValuePool::~NodeValuePool()
+{
+  d_table.release();
+  d_old.release();
+}
+
+void NodeValuePool::insert(NodeValue* nv, size_t hash)
+{
+  Assert(hash == nv->poolHash());
+  Assert(find(nv, hash) == nullptr) << "NodeValue already in the pool!";
+  migrate();
+  growIfNecessary();
+  d_table.insert(nv, hash);
+  ++d_size;
+}
+
+void NodeValuePool::erase(const NodeValue* nv, size_t hash)
+{
+  Assert(hash == nv->poolHash());
+  size_t i = d_table.findExact(nv, hash);
+  if (i != NOT_FOUND)
+  {
+    d_table.eraseAt(i);
+  }
+  else
+  {
+    // the old table is left untouched apart from markers, see migrate()
+    i = d_old.d_buckets == nullptr ? NOT_FOUND : d_old.findExact(nv, hash);
+    Assert(i != NOT_FOUND) << "NodeValue is not in the pool!";
+    d_old.d_buckets[i].d_nv = moved();
+    --d_oldSize;
+  }
+  --d_size;
+  migrate();
+}
+
+void NodeValuePool::growIfNecessary()
+{
+  size_t nbuckets = d_table.d_mask + 1;
+  if (4 * (d_size - d_oldSize + 1) <= 3 * nbuckets)
+  {
+    return;
+  }
+  // By the choice of MIGRATION_STEP, the previous migration is finished at
+  // this point.  Complete it anyway if that is not the case.
+  while (d_old.d_buckets != nullptr)
+  {
+    migrate();
+  }
+  Debug("gc") << "NodeValuePool: growing from " << nbuckets << " to "
+              << 2 * nbuckets << " buckets (" << d_size << " entries)"
+              << std::endl;
+  d_old = d_table;
+  d_table = Table();
+  d_table.allocate(2 * nbuckets);
+  d_migrated = 0;
+  d_oldSize = d_size;
+}
+
+void NodeValuePool::migrate()
+{
+  if (d_old.d_buckets == nullptr)
+  {
+    return;
+  }
+  size_t end = std::min(d_migrated + MIGRATION_STEP, d_old.d_mask + 1);
+  for (; d_migrated < end && d_oldSize > 0; ++d_migrated)
+  {
+    Bucket& b = d_old.d_buckets[d_migrated];
+    if (b.d_nv != nullptr && !isMoved(b.d_nv))
+    {
+      d_table.insert(b.d_nv, b.d_hash);
+      b.d_nv = moved();
+      --d_oldSize;
+    }
+  }
+  if (d_oldSize == 0)
+  {
+    d_old.release();
+  }
+}
+
+size_t NodeValuePool::Table::findExact(const NodeValue* nv, size_t hash) const
+{
+  for (size_t i = home(hash), dist = 0;; i = (i + 1) & d_mask, ++dist)
+  {
+    const Bucket& b = d_buckets[i];
+    if (b.d_nv == nullptr || distance(b.d_hash, i) < dist)
+    {
+      return NOT_FOUND;
+    }
+    if (b.d_nv == nv)
+    {
+      return i;
+    }
+  }
+}
+
+void NodeValuePool::Table::insert(NodeValue* nv, size_t hash)
+{
+  Bucket cur = {hash, nv};
+  for (size_t i = home(hash), dist = 0;; i = (i + 1) & d_mask, ++dist)
+  {
+    Bucket& b = d_buckets[i];
+    if (b.d_nv == nullptr)
+    {
+      b = cur;
+      return;
+    }
+    // Robin Hood: the entry closer to its home bucket yields its place
+    size_t bdist = distance(b.d_hash, i);
+    if (bdist < dist)
+    {
+      std::swap(b, cur);
+      dist = bdist;
+    }
+  }
+}
+
+void NodeValuePool::Table::eraseAt(size_t i)
+{
+  for (size_t next = (i + 1) & d_mask;
+       d_buckets[next].d_nv != nullptr
+       && distance(d_buckets[next].d_hash, next) != 0;
+       i = next, next = (next + 1) & d_mask)
+  {
+    d_buckets[i] = d_buckets[next];
+  }
+  d_buckets[i].d_nv = nullptr;
+}
+
+void NodeValuePool::Table::allocate(size_t nbuckets)
+{
+  Assert(d_buckets == nullptr);
+  Assert(nbuckets > 1 && (nbuckets & (nbuckets - 1)) == 0)
+      << "number of buckets must be a power of two";
+  d_buckets = new Bucket[nbuckets]();
+  d_mask = nbuckets - 1;
+  d_shift = 64;
+  for (size_t n = nbuckets; n > 1; n >>= 1)
+  {
+    --d_shift;
+  }
+}
+
+void NodeValuePool::Table::release()
+{
+  delete[] d_buckets;
+  d_buckets = nullptr;
+  d_mask = 0;
+  d_shift = 64;
+}
+
+}  // namespace expr
+}  // namespace CVC5
@@ -0,0 +1,339 @@
+/*********************                                                        */
+/*! \file node_value_pool.h
+ ** \verbatim
+ ** This file is part of the CVC4 project.
+ ** Copyright (c) 2009-2021 by the authors listed in the file AUTHORS
+ ** in the top-level source directory and their institutional affiliations.
+ ** All rights reserved.  See the file COPYING in the top-level source
+ ** directory for licensing information.\endverbatim
+ **
+ ** \brief The hash-consing table of the NodeManager
+ **
+ ** An open-addressing hash table of NodeValues used by the NodeManager for
+ ** hash-consing.
+ **/
+
+#include "cvc4_private.h"
+
+/* circular dependency; force node_value.h first */
+#include "expr/node_value.h"
+
+#ifndef CVC4__EXPR__NODE_VALUE_POOL_H
+#define CVC4__EXPR__NODE_VALUE_POOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+#include "base/check.h"
+#include "expr/metakind.h"
+
+namespace CVC5 {
+namespace expr {
+
+/**
+ * The pool of NodeValues of a NodeManager.
+ *
+ * This is an open-addressing hash table with Robin Hood linear probing.
+ * Each bucket stores the pool hash of its NodeValue next to the pointer, so
+ * probing compares hashes in a contiguous array and only dereferences
+ * NodeValues whose hash matches the one looked up.  Removal uses backward
+ * shifting, so no tombstones accumulate in the table.
+ *
+ * When the table grows, it is not rehashed in one go: a table of twice the
+ * size is allocated and the buckets of the old table are migrated a few at a
+ * time on each subsequent insert() and erase().  While a migration is in
+ * progress, lookups consult both tables.  Migrated and erased entries of the
+ * old table are left behind as "moved" markers that keep their hash, so that
+ * probing in the old table remains correct.
+ *
+ * Lookups use NodeValuePoolEq, and hence accept "non-inlined" constants (see
+ * NodeManager::poolLookup()).
+ */
+class NodeValuePool
+{
+ public:
+  NodeValuePool();
+  ~NodeValuePool();
+
+  NodeValuePool(const NodeValuePool&) = delete;
+  NodeValuePool& operator=(const NodeValuePool&) = delete;
+
+  /**
+   * Return the NodeValue in the pool that is equal to nv, or nullptr if there
+   * is none.
+   */
+  NodeValue* find(const NodeValue* nv) const
+  {
+    return find(nv, nv->poolHash());
+  }
+
+  /** As above, for a NodeValue with the given pool hash */
+  NodeValue* find(const NodeValue* nv, size_t hash) const
+  {
+    NodeValue* res = d_table.find(nv, hash);
+    if (res == nullptr && d_old.d_buckets != nullptr)
+    {
+      res = d_old.find(nv, hash);
+    }
+    return res;
+  }
+
+  /** Insert nv into the pool.  Requires that no equal NodeValue is in it. */
+  void insert(NodeValue* nv) { insert(nv, nv->poolHash()); }
+  /** As above, for a NodeValue with the given pool hash */
+  void insert(NodeValue* nv, size_t hash);
+
+  /** Remove nv (this very pointer) from the pool.  Requires that it is in. */
+  void erase(const NodeValue* nv) { erase(nv, nv->poolHash()); }
+  /** As above, for a NodeValue with the given pool hash */
+  void erase(const NodeValue* nv, size_t hash);
+
+  /** Get the number of NodeValues in the pool */
+  size_t size() const { return d_size; }
+
+  /** Get the number of buckets of the (current) table */
+  size_t capacity() const { return d_table.d_mask + 1; }
+
+  /** Return true if a migration from a smaller table is in progress */
+  bool isMigrating() const { return d_old.d_buckets != nullptr; }
+
+  /** Call f on every NodeValue in the pool, in no particular order */
+  template <class F>
+  void forEach(F f) const
+  {
+    d_table.forEach(f);
+    d_old.forEach(f);
+  }
+
+ private:
+  /** A bucket; d_nv is nullptr if the bucket is empty */
+  struct Bucket
+  {
+    size_t d_hash;
+    NodeValue* d_nv;
+  };
+
+  /** A power-of-two sized array of buckets */
+  struct Table
+  {
+    Bucket* d_buckets = nullptr;
+    size_t d_mask = 0;
+    /** 64 - log2(number of buckets), for Fibonacci hashing */
+    uint32_t d_shift = 64;
+
+    /** The bucket at which an entry with the given hash ideally lives */
+    size_t home(size_t hash) const
+    {
+      return static_cast<size_t>(
+          (static_cast<uint64_t>(hash) * UINT64_C(0x9e3779b97f4a7c15))
+          >> d_shift);
+    }
+    /** The probe distance of an entry with the given hash at bucket i */
+    size_t distance(size_t hash, size_t i) const
+    {
+      return (i - home(hash)) & d_mask;
+    }
+
+    NodeValue* find(const NodeValue* nv, size_t hash) const
+    {
+      if (d_buckets == nullptr)
+      {
+        return nullptr;
+      }
+      NodeValuePoolEq eq;
+      for (size_t i = home(hash), dist = 0;; i = (i + 1) & d_mask, ++dist)
+      {
+        const Bucket& b = d_buckets[i];
+        if (b.d_nv == nullptr || distance(b.d_hash, i) < dist)
+        {
+          return nullptr;
+        }
+        if (b.d_hash == hash && !isMoved(b.d_nv) && eq(nv, b.d_nv))
+        {
+          return b.d_nv;
+        }
+      }
+    }
+
+    /**
+     * Find the bucket holding exactly nv (compared by pointer), or return
+     * NOT_FOUND if there is none.
+     */
+    size_t findExact(const NodeValue* nv, size_t hash) const;
+
+    /** Insert nv; the table must have room and must not contain it */
+    void insert(NodeValue* nv, size_t hash);
+
+    /** Remove the entry at bucket i by shifting its successors back */
+    void eraseAt(size_t i);
+
+    void allocate(size_t nbuckets);
+    void release();
+
+    template <class F>
+    void forEach(F f) const
+    {
+      if (d_buckets == nullptr)
+      {
+        return;
+      }
+      for (size_t i = 0; i <= d_mask; ++i)
+      {
+        NodeValue* nv = d_buckets[i].d_nv;
+        if (nv != nullptr && !isMoved(nv))
+        {
+          f(nv);
+        }
+      }
+    }
+  };
+
+  /** Grow the table if the next insertion would overload it */
+  void growIfNecessary();
+  /** Migrate up to MIGRATION_STEP buckets from d_old to d_table */
+  void migrate();
+
+  /** Return the marker left in buckets of d_old whose entry was removed */
+  static NodeValue* moved() { return reinterpret_cast<NodeValue*>(1); }
+  /** Return true if nv is the marker returned by moved() */
+  static bool isMoved(const NodeValue* nv)
+  {
+    return reinterpret_cast<uintptr_t>(nv) == 1;
+  }
+
+  /** The result of Table::findExact() if the NodeValue is not found */
+  static constexpr size_t NOT_FOUND = ~static_cast<size_t>(0);
+
+  /** The initial number of buckets */
+  static constexpr size_t INITIAL_CAPACITY = 1024;
+  /**
+   * The number of buckets of the old table migrated per insert() and
+   * erase().  With a maximum load factor of 3/4, any value above 4/3
+   * guarantees that migration finishes before the new table needs to grow.
+   */
+  static constexpr size_t MIGRATION_STEP = 8;
+
+  /** The table into which new entries are inserted */
+  Table d_table;
+  /** The table being migrated into d_table, if any */
+  Table d_old;
+  /** The next bucket of d_old to migrate */
+  size_t d_migrated;
+  /** The number of (non-moved) entries in d_old */
+  size_t d_oldSize;
+  /** The total number of entries in the pool */
+  size_t d_size;
+}; /* class NodeValuePool */
+
+/**
+ * A pool of NodeValues that is safe to use from several threads at once.
+ *
+ * The pool is split into NUM_SHARDS NodeValuePools, each protected by its
+ * own mutex.  The shard of a NodeValue is picked from its pool hash, so
+ * threads creating unrelated nodes rarely contend for the same lock.  Used
+ * by NodeManagers in concurrent mode, see
+ * NodeManager::enableConcurrentMode().
+ */
+class ShardedNodeValuePool
+{
+ public:
+  static constexpr uint32_t SHARD_BITS = 6;
+  static constexpr size_t NUM_SHARDS = size_t(1) << SHARD_BITS;
+
+  ShardedNodeValuePool() = default;
+  ShardedNodeValuePool(const ShardedNodeValuePool&) = delete;
+  ShardedNodeValuePool& operator=(const ShardedNodeValuePool&) = delete;
+
+  /** See NodeValuePool::find() */
+  NodeValue* find(const NodeValue* nv) const
+  {
+    size_t hash = nv->poolHash();
+    const Shard& s = shard(hash);
+    std::lock_guard<std::mutex> lock(s.d_mutex);
+    return s.d_pool.find(nv, hash);
+  }
+
+  /**
+   * Insert nv into the pool unless an equal NodeValue is already in it,
+   * which can happen if another thread created the same node since nv was
+   * looked up.  Return the NodeValue that is in the pool afterwards, i.e.,
+   * either nv or the one inserted by the other thread.
+   */
+  NodeValue* insert(NodeValue* nv)
+  {
+    size_t hash = nv->poolHash();
+    Shard& s = shard(hash);
+    std::lock_guard<std::mutex> lock(s.d_mutex);
+    NodeValue* res = s.d_pool.find(nv, hash);
+    if (res == nullptr)
+    {
+      s.d_pool.insert(nv, hash);
+      res = nv;
+    }
+    return res;
+  }
+
+  /** See NodeValuePool::erase() */
+  void erase(const NodeValue* nv)
+  {
+    size_t hash = nv->poolHash();
+    Shard& s = shard(hash);
+    std::lock_guard<std::mutex> lock(s.d_mutex);
+    s.d_pool.erase(nv, hash);
+  }
+
+  /** Get the number of NodeValues in the pool */
+  size_t size() const
+  {
+    size_t size = 0;
+    for (const Shard& s : d_shards)
+    {
+      std::lock_guard<std::mutex> lock(s.d_mutex);
+      size += s.d_pool.size();
+    }
+    return size;
+  }
+
+  /** Call f on every NodeValue in the pool, in no particular order */
+  template <class F>
+  void forEach(F f) const
+  {
+    for (const Shard& s : d_shards)
+    {
+      std::lock_guard<std::mutex> lock(s.d_mutex);
+      s.d_pool.forEach(f);
+    }
+  }
+
+ private:
+  /** A shard, aligned to avoid false sharing between the locks */
+  struct alignas(64) Shard
+  {
+    mutable std::mutex d_mutex;
+    NodeValuePool d_pool;
+  };
+
+  /**
+   * The shard for the given pool hash.  This uses a different multiplier
+   * than NodeValuePool::Table::home(), so that the entries of a shard
+   * still spread over all of its buckets.
+   */
+  Shard& shard(size_t hash)
+  {
+    return d_shards[(static_cast<uint64_t>(hash)
+                     * UINT64_C(0xc2b2ae3d27d4eb4f))
+                    >> (64 - SHARD_BITS)];
+  }
+  const Shard& shard(size_t hash) const
+  {
+    return const_cast<ShardedNodeValuePool*>(this)->shard(hash);
+  }
+
+  Shard d_shards[NUM_SHARDS];
+}; /* class ShardedNodeValuePool */
+
+}  // namespace expr
+}  // namespace CVC5
+
+#endif /* CVC4__EXPR__NODE_VALUE_POOL_H */
@@ -14,8 +14,16 @@
 
 #include "expr/proof_checker.h"
 
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
 #include "expr/proof_node.h"
 #include "expr/skolem_manager.h"
+#include "options/options.h"
 #include "options/proof_options.h"
 #include "smt/smt_statistics_registry.h"
 
@@ -77,16 +85,19 @@ Node ProofRuleChecker::mkKindNode(Kind k)
 
 ProofCheckerStatistics::ProofCheckerStatistics()
     : d_ruleChecks("ProofCheckerStatistics::ruleChecks"),
-    d_totalRuleChecks("ProofCheckerStatistics::totalRuleChecks", 0)
+    d_totalRuleChecks("ProofCheckerStatistics::totalRuleChecks", 0),
+    d_checkProofTime("ProofCheckerStatistics::checkProofTime")
 {
   smtStatisticsRegistry()->registerStat(&d_ruleChecks);
   smtStatisticsRegistry()->registerStat(&d_totalRuleChecks);
+  smtStatisticsRegistry()->registerStat(&d_checkProofTime);
 }
 
 ProofCheckerStatistics::~ProofCheckerStatistics()
 {
   smtStatisticsRegistry()->unregisterStat(&d_ruleChecks);
   smtStatisticsRegistry()->unregisterStat(&d_totalRuleChecks);
+  smtStatisticsRegistry()->unregisterStat(&d_checkProofTime);
 }
 
 Node ProofChecker::check(ProofNode* pn, Node expected)
@@ -153,6 +164,344 @@ Node ProofChecker::check(
   return res;
 }
 
+namespace {
+
+/**
+ * The state shared by the threads of ProofChecker::checkProof.  Steps are
+ * identified by their index in the (post-order) list of proof nodes.
+ */
+class ProofCheckSchedule
+{
+ public:
+  ProofCheckSchedule(const std::vector<ProofNode*>& nodes,
+                     const std::vector<std::vector<uint32_t>>& parents,
+                     const std::vector<uint32_t>& numChildren,
+                     const std::vector<bool>& reentrant,
+                     uint32_t numThreads)
+      : d_parents(parents),
+        d_reentrant(reentrant),
+        d_pending(new std::atomic<uint32_t>[nodes.size()]),
+        d_queues(numThreads),
+        d_remaining(nodes.size()),
+        d_failed(false),
+        d_failStep(0)
+  {
+    for (size_t i = 0, nnodes = nodes.size(); i < nnodes; ++i)
+    {
+      d_pending[i] = numChildren[i];
+      if (numChildren[i] == 0)
+      {
+        push(0, i);
+      }
+    }
+  }
+
+  /**
+   * Get the next step for thread w to check, returning false if there is
+   * none at the moment.  Thread 0 (the calling thread) first takes the steps
+   * that only it may check.  Each thread then takes the most recently readied
+   * step of its own queue, and otherwise steals the oldest step of another
+   * thread.
+   */
+  bool pop(uint32_t w, uint32_t& step)
+  {
+    if (w == 0 && popFront(d_mainQueue, step))
+    {
+      return true;
+    }
+    {
+      WorkQueue& q = d_queues[w];
+      std::lock_guard<std::mutex> lock(q.d_mutex);
+      if (!q.d_steps.empty())
+      {
+        step = q.d_steps.back();
+        q.d_steps.pop_back();
+        return true;
+      }
+    }
+    for (size_t i = 1, nqueues = d_queues.size(); i < nqueues; ++i)
+    {
+      if (popFront(d_queues[(w + i) % nqueues], step))
+      {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /** Called by thread w when step was checked successfully */
+  void finish(uint32_t w, uint32_t step)
+  {
+    for (uint32_t p : d_parents[step])
+    {
+      if (d_pending[p].fetch_sub(1) == 1)
+      {
+        push(w, p);
+      }
+    }
+    d_remaining.fetch_sub(1);
+  }
+
+  /** Called when step is invalid, the first failure is reported */
+  void fail(uint32_t step, const std::string& msg)
+  {
+    std::lock_guard<std::mutex> lock(d_failMutex);
+    if (!d_failed.load())
+    {
+      d_failStep = step;
+      d_failMsg = msg;
+      d_failed.store(true);
+    }
+  }
+
+  /** Return true if all steps are checked, or if one has failed */
+  bool isDone() const { return d_remaining.load() == 0 || d_failed.load(); }
+  /** Return true if a step has failed */
+  bool hasFailed() const { return d_failed.load(); }
+  /** Get the step that failed first and its error message */
+  uint32_t getFailedStep() const { return d_failStep; }
+  const std::string& getFailureMessage() const { return d_failMsg; }
+
+ private:
+  /** A queue of ready steps, aligned to avoid false sharing */
+  struct alignas(64) WorkQueue
+  {
+    std::mutex d_mutex;
+    std::deque<uint32_t> d_steps;
+  };
+
+  /** Make step ready, in the queue of thread w if it is reentrant */
+  void push(uint32_t w, uint32_t step)
+  {
+    WorkQueue& q = d_reentrant[step] ? d_queues[w] : d_mainQueue;
+    std::lock_guard<std::mutex> lock(q.d_mutex);
+    q.d_steps.push_back(step);
+  }
+
+  static bool popFront(WorkQueue& q, uint32_t& step)
+  {
+    std::lock_guard<std::mutex> lock(q.d_mutex);
+    if (q.d_steps.empty())
+    {
+      return false;
+    }
+    step = q.d_steps.front();
+    q.d_steps.pop_front();
+    return true;
+  }
+
+  const std::vector<std::vector<uint32_t>>& d_parents;
+  const std::vector<bool>& d_reentrant;
+  /** The number of unchecked children of each step */
+  std::unique_ptr<std::atomic<uint32_t>[]> d_pending;
+  /** The ready steps of each thread */
+  std::vector<WorkQueue> d_queues;
+  /** The ready steps that are not reentrant, for thread 0 */
+  WorkQueue d_mainQueue;
+  /** The number of steps left to check */
+  std::atomic<size_t> d_remaining;
+  std::atomic<bool> d_failed;
+  std::mutex d_failMutex;
+  uint32_t d_failStep;
+  std::string d_failMsg;
+};
+
+/**
+ * Puts a node manager in concurrent mode for the lifetime of this object,
+ * unless it already is.
+ */
+class ConcurrentModeScope
+{
+ public:
+  ConcurrentModeScope(NodeManager* nm)
+      : d_nm(nm), d_enabled(!nm->isConcurrent())
+  {
+    if (d_enabled)
+    {
+      d_nm->enableConcurrentMode();
+    }
+  }
+  ~ConcurrentModeScope()
+  {
+    if (d_enabled)
+    {
+      d_nm->disableConcurrentMode();
+    }
+  }
+
+ private:
+  NodeManager* d_nm;
+  bool d_enabled;
+};
+
+}  // namespace
+
+bool ProofChecker::checkProof(ProofNode* pn,
+                              uint32_t numThreads,
+                              std::ostream& out)
+{
+  CodeTimer checkTimer(d_stats.d_checkProofTime);
+  // collect the steps of pn in post-order, which is a topological order
+  std::vector<ProofNode*> nodes;
+  std::unordered_map<ProofNode*, uint32_t> index;
+  std::vector<std::pair<ProofNode*, bool>> visit;
+  visit.emplace_back(pn, false);
+  do
+  {
+    std::pair<ProofNode*, bool> cur = visit.back();
+    visit.pop_back();
+    if (cur.second)
+    {
+      index[cur.first] = nodes.size();
+      nodes.push_back(cur.first);
+    }
+    else if (index.find(cur.first) == index.end())
+    {
+      // mark as pre-visited; the index is overwritten when post-visiting
+      index[cur.first] = 0;
+      visit.emplace_back(cur.first, true);
+      for (const std::shared_ptr<ProofNode>& c : cur.first->getChildren())
+      {
+        Assert(c != nullptr);
+        if (index.find(c.get()) == index.end())
+        {
+          visit.emplace_back(c.get(), false);
+        }
+      }
+    }
+  } while (!visit.empty());
+  size_t nnodes = nodes.size();
+  Trace("pfcheck") << "ProofChecker::checkProof: " << nnodes << " steps, "
+                   << numThreads << " thread(s)" << std::endl;
+  // record stats
+  for (ProofNode* cur : nodes)
+  {
+    if (cur->getRule() != PfRule::ASSUME)
+    {
+      d_stats.d_ruleChecks << cur->getRule();
+      ++d_stats.d_totalRuleChecks;
+    }
+  }
+
+  if (numThreads <= 1 || nnodes < 2)
+  {
+    for (ProofNode* cur : nodes)
+    {
+      std::stringstream ss;
+      if (!checkStep(cur, ss))
+      {
+        out << ss.str();
+        return false;
+      }
+    }
+    return true;
+  }
+
+  std::vector<std::vector<uint32_t>> parents(nnodes);
+  std::vector<uint32_t> numChildren(nnodes);
+  std::vector<bool> reentrant(nnodes);
+  for (uint32_t i = 0; i < nnodes; ++i)
+  {
+    const std::vector<std::shared_ptr<ProofNode>>& cs = nodes[i]->getChildren();
+    numChildren[i] = cs.size();
+    for (const std::shared_ptr<ProofNode>& c : cs)
+    {
+      parents[index[c.get()]].push_back(i);
+    }
+    PfRule id = nodes[i]->getRule();
+    ProofRuleChecker* prc = getCheckerFor(id);
+    reentrant[i] =
+        id == PfRule::ASSUME || (prc != nullptr && prc->isReentrant());
+  }
+  ProofCheckSchedule sched(nodes, parents, numChildren, reentrant, numThreads);
+  // The checkers construct nodes, so the node manager is in concurrent mode
+  // while the workers run.  This thread stays inside of it until they are
+  // done, so that no zombie is reclaimed before.
+  NodeManager* nm = NodeManager::currentNM();
+  ConcurrentModeScope cms(nm);
+  NodeManagerScope nms(nm);
+  Options* opts = Options::current();
+  auto work = [this, &sched, &nodes, &reentrant, nm, opts](uint32_t w) {
+    NodeManagerScope wnms(nm);
+    Options::OptionsScope os(opts);
+    uint32_t step;
+    while (!sched.isDone())
+    {
+      if (!sched.pop(w, step))
+      {
+        std::this_thread::yield();
+        continue;
+      }
+      Assert(w == 0 || reentrant[step])
+          << "only reentrant checkers may run on the workers";
+      std::stringstream ss;
+      bool valid;
+      try
+      {
+        valid = checkStep(nodes[step], ss);
+      }
+      catch (const Exception& e)
+      {
+        ss << e.toString();
+        valid = false;
+      }
+      if (valid)
+      {
+        sched.finish(w, step);
+      }
+      else
+      {
+        sched.fail(step, ss.str());
+      }
+    }
+  };
+  std::vector<std::thread> workers;
+  for (uint32_t w = 1; w < numThreads; ++w)
+  {
+    workers.emplace_back(work, w);
+  }
+  work(0);
+  for (std::thread& t : workers)
+  {
+    t.join();
+  }
+  if (sched.hasFailed())
+  {
+    Trace("pfcheck") << "ProofChecker::checkProof: failed step "
+                     << nodes[sched.getFailedStep()]->getRule() << std::endl;
+    out << sched.getFailureMessage();
+    return false;
+  }
+  return true;
+}
+
+bool ProofChecker::checkStep(ProofNode* pn, std::stringstream& out)
+{
+  PfRule id = pn->getRule();
+  Node res = pn->getResult();
+  const std::vector<Node>& args = pn->getArguments();
+  if (id == PfRule::ASSUME)
+  {
+    if (args.size() != 1 || args[0] != res)
+    {
+      out << "assumption does not match its conclusion " << res << std::endl;
+      return false;
+    }
+    return true;
+  }
+  std::vector<Node> cchildren;
+  for (const std::shared_ptr<ProofNode>& pc : pn->getChildren())
+  {
+    cchildren.push_back(pc->getResult());
+  }
+  if (checkInternal(id, cchildren, args, res, out, true, true).isNull())
+  {
+    out << "when checking step " << id << " proving " << res << std::endl;
+    return false;
+  }
+  return true;
+}
+
 Node ProofChecker::checkDebug(PfRule id,
                               const std::vector<Node>& cchildren,
                               const std::vector<Node>& args,
@@ -23,6 +23,7 @@
 #include "expr/proof_rule.h"
 #include "util/statistics_registry.h"
 #include "util/stats_histogram.h"
+#include "util/stats_timer.h"
 
 namespace CVC5 {
 
@@ -69,6 +70,14 @@ class ProofRuleChecker
   /** Register all rules owned by this rule checker into pc. */
   virtual void registerTo(ProofChecker* pc) {}
 
+  /**
+   * Return true if check may be called from several threads at once, which
+   * holds for checkers that only construct nodes and keep no state of their
+   * own (in particular, do not rewrite).  Steps of other checkers are checked
+   * on the calling thread by ProofChecker::checkProof.
+   */
+  virtual bool isReentrant() const { return false; }
+
  protected:
   /**
    * This checks a single step in a proof.
@@ -96,6 +105,8 @@ class ProofCheckerStatistics
   IntegralHistogramStat<PfRule> d_ruleChecks;
   /** Total number of rule checks */
   IntStat d_totalRuleChecks;
+  /** Time spent in checkProof */
+  TimerStat d_checkProofTime;
 };
 
 /** A class for checking proofs */
@@ -150,6 +161,27 @@ class ProofChecker
                   const std::vector<Node>& args,
                   Node expected = Node::null(),
                   const char* traceTag = "");
+  /**
+   * Check every step of the proof pn, i.e., that each proof node below pn
+   * (including pn) proves its conclusion from the conclusions of its
+   * children.  Unlike check, this does not assume that the children were
+   * checked when they were constructed.
+   *
+   * Independent steps are checked in parallel by numThreads threads: the
+   * proof is scheduled bottom-up, a step becoming ready as soon as all of its
+   * children are checked, and idle threads steal ready steps from the others.
+   * Steps whose checker is not reentrant (see ProofRuleChecker::isReentrant)
+   * or that are trusted are checked by the calling thread.  Since the
+   * checkers construct nodes, the current NodeManager is put in concurrent
+   * mode while the threads run (see NodeManager::enableConcurrentMode()),
+   * unless it already is.  No other thread may use it in the meantime.
+   *
+   * @param pn The proof to check
+   * @param numThreads The number of threads to use, including the calling one
+   * @param out The stream on which the first failing step is reported
+   * @return true if all steps of pn are valid
+   */
+  bool checkProof(ProofNode* pn, uint32_t numThreads, std::ostream& out);
   /** Indicate that psc is the checker for proof rule id */
   void registerChecker(PfRule id, ProofRuleChecker* psc);
   /**
@@ -200,6 +232,11 @@ class ProofChecker
                      std::stringstream& out,
                      bool useTrustedChecker,
                      bool enableOutput);
+  /**
+   * Check the step of proof node pn against its conclusion, assuming its
+   * children are valid. Used by checkProof, does not record statistics.
+   */
+  bool checkStep(ProofNode* pn, std::stringstream& out);
 };
 
 }  // namespace CVC5
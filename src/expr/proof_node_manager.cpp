@@ -15,6 +15,7 @@
 #include "expr/proof_node_manager.h"
 
 #include <sstream>
+#include <utility>
 
 #include "expr/proof.h"
 #include "expr/proof_checker.h"
@@ -22,13 +23,14 @@
 #include "expr/proof_node_algorithm.h"
 #include "options/proof_options.h"
 #include "theory/rewriter.h"
+#include "util/hash.h"
 
 using namespace CVC5::kind;
 
 namespace CVC5 {
 
 ProofNodeManager::ProofNodeManager(ProofChecker* pc)
-    : d_checker(pc)
+    : d_checker(pc), d_hashCons(false), d_stepsSweepSize(1024)
 {
   d_true = NodeManager::currentNM()->mkConst(true);
 }
@@ -41,6 +43,24 @@ std::shared_ptr<ProofNode> ProofNodeManager::mkNode(
 {
   Trace("pnm") << "ProofNodeManager::mkNode " << id << " {" << expected.getId()
                << "} " << expected << "\n";
+  size_t h = 0;
+  if (d_hashCons)
+  {
+    h = hashStep(id, children, args);
+    auto range = d_steps.equal_range(h);
+    for (auto it = range.first; it != range.second; ++it)
+    {
+      std::shared_ptr<ProofNode> pn = it->second.lock();
+      // the conclusion is determined by the step, so that a proof node that
+      // is not the expected one would not check either
+      if (pn != nullptr && isStep(pn.get(), id, children, args)
+          && (expected.isNull() || pn->getResult() == expected))
+      {
+        Trace("pnm") << "...reuse existing proof node" << std::endl;
+        return pn;
+      }
+    }
+  }
   Node res = checkInternal(id, children, args, expected);
   if (res.isNull())
   {
@@ -51,6 +71,19 @@ std::shared_ptr<ProofNode> ProofNodeManager::mkNode(
   std::shared_ptr<ProofNode> pn =
       std::make_shared<ProofNode>(id, children, args);
   pn->d_proven = res;
+  if (d_hashCons)
+  {
+    if (d_steps.size() >= d_stepsSweepSize)
+    {
+      // remove the entries of proof nodes that were deleted
+      for (auto it = d_steps.begin(); it != d_steps.end();)
+      {
+        it = it->second.expired() ? d_steps.erase(it) : std::next(it);
+      }
+      d_stepsSweepSize = std::max<size_t>(1024, 2 * d_steps.size());
+    }
+    d_steps.emplace(h, pn);
+  }
   return pn;
 }
 
@@ -352,8 +385,119 @@ bool ProofNodeManager::updateNodeInternal(
   }
 
   // we update its value
+  if (!d_steps.empty())
+  {
+    forgetStep(pn);
+  }
   pn->setValue(id, children, args);
   return true;
 }
 
+void ProofNodeManager::setHashConsing(bool enable)
+{
+  d_hashCons = enable;
+  if (!enable)
+  {
+    d_steps.clear();
+  }
+}
+
+size_t ProofNodeManager::hashStep(
+    PfRule id,
+    const std::vector<std::shared_ptr<ProofNode>>& children,
+    const std::vector<Node>& args)
+{
+  uint64_t h = fnv1a::fnv1a_64(static_cast<uint64_t>(id));
+  for (const std::shared_ptr<ProofNode>& c : children)
+  {
+    h = fnv1a::fnv1a_64(reinterpret_cast<uintptr_t>(c.get()), h);
+  }
+  for (const Node& a : args)
+  {
+    h = fnv1a::fnv1a_64(a.getId(), h);
+  }
+  return static_cast<size_t>(h);
+}
+
+bool ProofNodeManager::isStep(
+    const ProofNode* pn,
+    PfRule id,
+    const std::vector<std::shared_ptr<ProofNode>>& children,
+    const std::vector<Node>& args)
+{
+  return pn->getRule() == id && pn->getChildren() == children
+         && pn->getArguments() == args;
+}
+
+void ProofNodeManager::forgetStep(ProofNode* pn)
+{
+  auto range = d_steps.equal_range(
+      hashStep(pn->getRule(), pn->getChildren(), pn->getArguments()));
+  for (auto it = range.first; it != range.second; ++it)
+  {
+    if (it->second.lock().get() == pn)
+    {
+      d_steps.erase(it);
+      return;
+    }
+  }
+}
+
+size_t ProofNodeManager::compact(std::shared_ptr<ProofNode> pn)
+{
+  // the canonical proof node of each proof node visited so far
+  std::unordered_map<ProofNode*, std::shared_ptr<ProofNode>> canon;
+  // the canonical proof nodes, keyed by the hash of their proof step
+  std::unordered_multimap<size_t, std::shared_ptr<ProofNode>> steps;
+  size_t merged = 0;
+  std::vector<std::shared_ptr<ProofNode>> visit;
+  visit.push_back(pn);
+  do
+  {
+    std::shared_ptr<ProofNode> cur = visit.back();
+    auto it = canon.find(cur.get());
+    if (it == canon.end())
+    {
+      // pre-visit: the canonical node is set when post-visiting
+      canon[cur.get()] = nullptr;
+      visit.insert(visit.end(), cur->d_children.begin(), cur->d_children.end());
+      continue;
+    }
+    visit.pop_back();
+    if (it->second != nullptr)
+    {
+      continue;
+    }
+    // post-visit: point to the canonical children, then look for an equal
+    // canonical node
+    for (std::shared_ptr<ProofNode>& c : cur->d_children)
+    {
+      Assert(canon.find(c.get()) != canon.end() && canon[c.get()] != nullptr);
+      c = canon[c.get()];
+    }
+    size_t h = hashStep(cur->d_rule, cur->d_children, cur->d_args);
+    std::shared_ptr<ProofNode> res;
+    auto range = steps.equal_range(h);
+    for (auto its = range.first; its != range.second; ++its)
+    {
+      if (its->second->getResult() == cur->getResult()
+          && isStep(its->second.get(), cur->d_rule, cur->d_children, cur->d_args))
+      {
+        res = its->second;
+        ++merged;
+        break;
+      }
+    }
+    if (res == nullptr)
+    {
+      res = cur;
+      steps.emplace(h, cur);
+    }
+    canon[cur.get()] = res;
+  } while (!visit.empty());
+  Trace("pnm") << "ProofNodeManager::compact: merged " << merged << " of "
+               << canon.size() << " proof nodes" << std::endl;
+  return merged;
+}
+
 }  // namespace CVC5
@@ -17,6 +17,8 @@
 #ifndef CVC4__EXPR__PROOF_NODE_MANAGER_H
 #define CVC4__EXPR__PROOF_NODE_MANAGER_H
 
+#include <memory>
+#include <unordered_map>
 #include <vector>
 
 #include "expr/node.h"
@@ -46,9 +48,10 @@ class ProofNode;
  * node.
  *
  * Notice that ProofNode objects are mutable, and hence this class does not
- * cache the results of mkNode. A version of this class that caches
- * immutable version of ProofNode objects could be built as an extension
- * or layer on top of this class.
+ * cache the results of mkNode by default. If hash-consing is enabled (see
+ * setHashConsing), mkNode returns the existing proof node for a proof step
+ * that was made before and is still alive. Independently, compact merges the
+ * structurally identical proof nodes of an already built proof.
  */
 class ProofNodeManager
 {
@@ -158,6 +161,28 @@ class ProofNodeManager
   bool updateNode(ProofNode* pn, ProofNode* pnr);
   /** Get the underlying proof checker */
   ProofChecker* getChecker() const;
+  /**
+   * Enable or disable hash-consing of the proof nodes made by mkNode. If
+   * enabled, mkNode returns the proof node made for the same rule, children
+   * (compared by pointer) and arguments by a previous call, if it is still
+   * alive, without checking the step again. Since proof nodes are mutable,
+   * this should only be used if the proof nodes are not updated while they
+   * are shared; a proof node that is updated via updateNode is no longer
+   * returned by mkNode.
+   */
+  void setHashConsing(bool enable);
+  /** Is hash-consing enabled? */
+  bool isHashConsing() const { return d_hashCons; }
+  /**
+   * Merge the structurally identical proof nodes of the proof pn, i.e., make
+   * all references to proof nodes with the same rule, arguments, conclusion
+   * and (merged) children point to one of them. This updates the children
+   * of the proof nodes of pn in place.
+   *
+   * @param pn The proof to compact.
+   * @return the number of proof nodes that were merged into another one.
+   */
+  size_t compact(std::shared_ptr<ProofNode> pn);
 
  private:
   /** The (optional) proof checker */
@@ -190,6 +215,29 @@ class ProofNodeManager
       const std::vector<std::shared_ptr<ProofNode>>& children,
       const std::vector<Node>& args,
       bool needsCheck);
+  /** Whether mkNode does hash-consing, see setHashConsing */
+  bool d_hashCons;
+  /**
+   * The proof nodes made by mkNode while hash-consing, keyed by the hash of
+   * their proof step (see hashStep).
+   */
+  std::unordered_multimap<size_t, std::weak_ptr<ProofNode>> d_steps;
+  /** The size of d_steps at which its expired entries are removed */
+  size_t d_stepsSweepSize;
+  /** Hash the proof step with the given rule, children and arguments */
+  static size_t hashStep(PfRule id,
+                         const std::vector<std::shared_ptr<ProofNode>>& children,
+                         const std::vector<Node>& args);
+  /**
+   * Return true if pn is the proof step with the given rule, children
+   * (compared by pointer) and arguments.
+   */
+  static bool isStep(const ProofNode* pn,
+                     PfRule id,
+                     const std::vector<std::shared_ptr<ProofNode>>& children,
+                     const std::vector<Node>& args);
+  /** Remove pn from d_steps, if it is there */
+  void forgetStep(ProofNode* pn);
 };
 
 }  // namespace CVC5
@@ -20,6 +20,42 @@
 
 namespace CVC5 {
 
+namespace {
+
+/**
+ * Replace each node of ns by the result of substituting ss for vs in it,
+ * with one cache for all of them.
+ */
+void substituteAll(std::vector<Node>& ns,
+                   const std::vector<Node>& vs,
+                   const std::vector<Node>& ss,
+                   bool doRewrite)
+{
+  // Seeding the cache with the substitution makes each lookup a single
+  // hash probe.  As for Node::substitute, the first occurrence of a term
+  // in vs takes precedence.
+  std::unordered_map<TNode, TNode, TNodeHashFunction> cache;
+  for (size_t i = 0, nvs = vs.size(); i < nvs; i++)
+  {
+    cache.emplace(vs[i], ss[i]);
+  }
+  // The cache refers to subterms of the inputs and of the results, so
+  // they must be kept alive until all nodes are processed.
+  std::vector<Node> inputs(ns);
+  std::vector<Node> results;
+  results.reserve(ns.size());
+  for (const Node& n : inputs)
+  {
+    results.push_back(n.substitute(cache));
+  }
+  for (size_t i = 0, nns = ns.size(); i < nns; i++)
+  {
+    ns[i] = doRewrite ? theory::Rewriter::rewrite(results[i]) : results[i];
+  }
+}
+
+}  // namespace
+
 bool Subs::empty() const { return d_vars.empty(); }
 
 size_t Subs::size() const { return d_vars.size(); }
@@ -114,28 +150,32 @@ Node Subs::rapply(Node n, bool doRewrite) const
   return ns;
 }
 
-void Subs::applyToRange(Subs& s, bool doRewrite) const
+void Subs::apply(std::vector<Node>& ns, bool doRewrite) const
 {
   if (d_vars.empty())
   {
     return;
   }
-  for (size_t i = 0, ns = s.d_subs.size(); i < ns; i++)
-  {
-    s.d_subs[i] = apply(s.d_subs[i], doRewrite);
-  }
+  substituteAll(ns, d_vars, d_subs, doRewrite);
 }
 
-void Subs::rapplyToRange(Subs& s, bool doRewrite) const
+void Subs::rapply(std::vector<Node>& ns, bool doRewrite) const
 {
   if (d_vars.empty())
   {
     return;
   }
-  for (size_t i = 0, ns = s.d_subs.size(); i < ns; i++)
-  {
-    s.d_subs[i] = rapply(s.d_subs[i], doRewrite);
-  }
+  substituteAll(ns, d_subs, d_vars, doRewrite);
+}
+
+void Subs::applyToRange(Subs& s, bool doRewrite) const
+{
+  apply(s.d_subs, doRewrite);
+}
+
+void Subs::rapplyToRange(Subs& s, bool doRewrite) const
+{
+  rapply(s.d_subs, doRewrite);
 }
 
 Node Subs::getEquality(size_t i) const
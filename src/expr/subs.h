@@ -56,6 +56,13 @@ class Subs
   Node apply(Node n, bool doRewrite = false) const;
   /** Return the result of the reverse of this substitution on n */
   Node rapply(Node n, bool doRewrite = false) const;
+  /**
+   * Apply this substitution to each node of ns, in place.  The nodes share
+   * one cache, so common subterms are substituted once.
+   */
+  void apply(std::vector<Node>& ns, bool doRewrite = false) const;
+  /** Apply the reverse of this substitution to each node of ns, in place */
+  void rapply(std::vector<Node>& ns, bool doRewrite = false) const;
   /** Apply this substitution to all nodes in the range of s */
   void applyToRange(Subs& s, bool doRewrite = false) const;
   /** Apply the reverse of this substitution to all nodes in the range of s */
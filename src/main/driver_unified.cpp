@@ -31,6 +31,7 @@
 #include "main/command_executor.h"
 #include "main/interactive_shell.h"
 #include "main/main.h"
+#include "main/portfolio.h"
 #include "main/signal_handlers.h"
 #include "main/time_limit.h"
 #include "options/options.h"
@@ -190,6 +191,7 @@ int runCvc4(int argc, char* argv[], Options& opts) {
   pExecutor = std::make_unique<CommandExecutor>(opts);
 
   int returnValue = 0;
+  bool portfolio = opts.getPortfolioJobs() > 1 || opts.getCubeDepth() > 0;
   {
     // notify SmtEngine that we are starting to parse
     pExecutor->getSmtEngine()->notifyStartParsing(filenameStr);
@@ -202,6 +204,12 @@ int runCvc4(int argc, char* argv[], Options& opts) {
         throw Exception(
             "--tear-down-incremental doesn't work in interactive mode");
       }
+      if (portfolio)
+      {
+        throw Exception(
+            "--portfolio-jobs and --cube-depth don't work in interactive "
+            "mode");
+      }
       if(!opts.wasSetByUserIncrementalSolving()) {
         cmd.reset(new SetOptionCommand("incremental", "true"));
         cmd->setMuted(true);
@@ -238,6 +246,12 @@ int runCvc4(int argc, char* argv[], Options& opts) {
         }
       }
     } else if( opts.getTearDownIncremental() > 0) {
+      if (portfolio)
+      {
+        throw Exception(
+            "--portfolio-jobs and --cube-depth don't work with "
+            "--tear-down-incremental");
+      }
       if(!opts.getIncrementalSolving() && opts.getTearDownIncremental() > 1) {
         // For tear-down-incremental values greater than 1, need incremental
         // on too.
@@ -424,8 +438,29 @@ int runCvc4(int argc, char* argv[], Options& opts) {
       }
 
       std::unique_ptr<Parser> parser(parserBuilder.build());
+      if (portfolio)
+      {
+        if (opts.getCubeDepth() == 0 && opts.getIncrementalSolving())
+        {
+          throw Exception("--portfolio-jobs doesn't work with --incremental");
+        }
+        // parse everything here, the workers execute the commands
+        std::vector<std::unique_ptr<Command>> commands;
+        while (true)
+        {
+          cmd.reset(parser->nextCommand());
+          if (cmd == nullptr) break;
+          bool quit = dynamic_cast<QuitCommand*>(cmd.get()) != nullptr;
+          commands.push_back(std::move(cmd));
+          if (quit) break;
+        }
+        int code = opts.getCubeDepth() > 0
+                       ? runCubeAndConquer(*pExecutor, commands, opts)
+                       : runPortfolio(*pExecutor, commands, opts);
+        status = code == 0;
+      }
       bool interrupted = false;
-      while (status)
+      while (status && !portfolio)
       {
         if (interrupted) {
           (*opts.getOut()) << CommandInterrupted();
@@ -470,7 +505,11 @@ int runCvc4(int argc, char* argv[], Options& opts) {
 #endif /* CVC4_COMPETITION_MODE */
 
     totalTime.reset();
-    pExecutor->flushOutputStreams();
+    if (!portfolio)
+    {
+      // the statistics of the workers are part of their output
+      pExecutor->flushOutputStreams();
+    }
 
 #ifdef CVC4_DEBUG
     if(opts.getEarlyExit() && opts.wasSetByUserEarlyExit()) {
@@ -0,0 +1,724 @@
+/*********************                                                        */
+/*! \file portfolio.cpp
+ ** \verbatim
+ ** This file is part of the CVC4 project.
+ ** Copyright (c) 2009-2021 by the authors listed in the file AUTHORS
+ ** in the top-level source directory and their institutional affiliations.
+ ** All rights reserved.  See the file COPYING in the top-level source
+ ** directory for licensing information.\endverbatim
+ **
+ ** \brief The parallel modes of the driver.
+ **
+ ** The portfolio mode that is enabled by the --portfolio-jobs option, and the
+ ** cube-and-conquer mode that is enabled by the --cube-depth option.
+ **/
+
+#include "main/portfolio.h"
+
+#ifndef __WIN32__
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif /* ! __WIN32__ */
+
+#ifdef __linux__
+#include <sys/prctl.h>
+#endif /* __linux__ */
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <iostream>
+#include <set>
+#include <string>
+#include <utility>
+
+#include "base/exception.h"
+#include "base/output.h"
+#include "expr/symbol_manager.h"
+#include "main/command_executor.h"
+#include "options/language.h"
+#include "prop/shared_clause_channel.h"
+
+namespace CVC5 {
+namespace main {
+
+#ifndef __WIN32__
+
+namespace {
+
+/**
+ * The options of the workers other than the first one, which are cycled
+ * through. Every worker also gets its own SAT random seed. Only the SAT search
+ * is varied, so that all workers preprocess the input in the same way, which
+ * is what makes their learned clauses valid for each other.
+ */
+const std::vector<std::vector<std::pair<std::string, std::string>>>
+    s_workerOptions = {
+        {},
+        {{"random-frequency", "0.02"}},
+        {{"sat-chrono", "true"}},
+        {{"restart-int-base", "50"}, {"restart-int-inc", "2"}},
+};
+
+/** The state of a worker, in memory shared with the driver */
+struct WorkerState
+{
+  /** Whether the worker found a sat or unsat answer */
+  std::atomic<bool> d_conclusive;
+  /** Whether the worker could not decide a cube of cube-and-conquer */
+  std::atomic<bool> d_unknown;
+};
+
+/** The cubes of cube-and-conquer, in memory shared with the driver */
+struct CubeQueue
+{
+  /** The index of the next cube to solve */
+  std::atomic<uint32_t> d_next;
+  /** Whether a worker found a satisfiable cube */
+  std::atomic<bool> d_sat;
+};
+
+/** Allocate size bytes of zero-initialized memory shared with forks */
+void* mapShared(size_t size)
+{
+  void* memory = mmap(nullptr,
+                      size,
+                      PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_ANONYMOUS,
+                      -1,
+                      0);
+  if (memory == MAP_FAILED)
+  {
+    throw Exception("cannot allocate shared memory for the worker processes");
+  }
+  return memory;
+}
+
+/** Flush all output, before forking or exiting */
+void flushOutput(Options& opts)
+{
+  opts.flushOut();
+  std::cout.flush();
+  std::cerr.flush();
+  fflush(stdout);
+  fflush(stderr);
+}
+
+/** Print an error like the driver does */
+void printError(Options& opts, const std::string& msg)
+{
+  if (language::isOutputLang_smt2(opts.getOutputLanguage()))
+  {
+    *opts.getOut() << "(error \"" << msg << "\")" << std::endl;
+  }
+  else
+  {
+    *opts.getErr() << "(error \"" << msg << "\")" << std::endl;
+  }
+}
+
+/** Copy the contents of the file f to out */
+void copyFile(FILE* f, std::ostream& out)
+{
+  char buf[4096];
+  rewind(f);
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0)
+  {
+    out.write(buf, n);
+  }
+  out.flush();
+}
+
+/**
+ * The worker processes, whose output goes to temporary files until the driver
+ * decides which output to print.
+ */
+class Workers
+{
+ public:
+  Workers(Options& opts) : d_opts(opts), d_numRunning(0) {}
+  ~Workers()
+  {
+    stop();
+    for (size_t i = 0, size = d_pids.size(); i < size; ++i)
+    {
+      fclose(d_outs[i]);
+      fclose(d_errs[i]);
+    }
+  }
+
+  /**
+   * Fork a worker. Returns true in the worker process, whose output is
+   * redirected to its files, and false in the driver.
+   */
+  bool fork()
+  {
+    FILE* out = tmpfile();
+    FILE* err = tmpfile();
+    if (out == nullptr || err == nullptr)
+    {
+      throw Exception("cannot create the output files of the workers");
+    }
+    d_outs.push_back(out);
+    d_errs.push_back(err);
+    // buffered output would be written by every worker otherwise
+    flushOutput(d_opts);
+    pid_t pid = ::fork();
+    if (pid < 0)
+    {
+      throw Exception("cannot fork a worker process");
+    }
+    if (pid == 0)
+    {
+#ifdef __linux__
+      // do not outlive the driver, e.g., when it hits the time limit
+      prctl(PR_SET_PDEATHSIG, SIGKILL);
+#endif /* __linux__ */
+      dup2(fileno(out), STDOUT_FILENO);
+      dup2(fileno(err), STDERR_FILENO);
+      return true;
+    }
+    d_pids.push_back(pid);
+    d_exitCodes.push_back(1);
+    d_running.push_back(true);
+    ++d_numRunning;
+    return false;
+  }
+
+  /** Get the number of workers that are still running */
+  size_t getNumRunning() const { return d_numRunning; }
+
+  /**
+   * Wait for a worker to exit. Returns its index, or -1 if there is no
+   * worker left.
+   */
+  int wait()
+  {
+    while (d_numRunning > 0)
+    {
+      int wstatus;
+      pid_t pid = ::wait(&wstatus);
+      if (pid < 0)
+      {
+        if (errno == EINTR)
+        {
+          continue;
+        }
+        return -1;
+      }
+      for (size_t i = 0, size = d_pids.size(); i < size; ++i)
+      {
+        if (d_pids[i] == pid && d_running[i])
+        {
+          d_running[i] = false;
+          --d_numRunning;
+          d_exitCodes[i] = WIFEXITED(wstatus) ? WEXITSTATUS(wstatus) : 1;
+          return i;
+        }
+      }
+    }
+    return -1;
+  }
+
+  /** Kill the workers that are still running */
+  void stop()
+  {
+    for (size_t i = 0, size = d_pids.size(); i < size; ++i)
+    {
+      if (d_running[i])
+      {
+        kill(d_pids[i], SIGKILL);
+        waitpid(d_pids[i], nullptr, 0);
+        d_running[i] = false;
+      }
+    }
+    d_numRunning = 0;
+  }
+
+  /** Get the exit code of worker i, which has exited */
+  int getExitCode(size_t i) const { return d_exitCodes[i]; }
+
+  /** Print the output of worker i, which has exited */
+  void printOutput(size_t i)
+  {
+    copyFile(d_outs[i], *d_opts.getOut());
+    copyFile(d_errs[i], *d_opts.getErr());
+  }
+
+  /** Print the error output of worker i, which has exited */
+  void printErrors(size_t i) { copyFile(d_errs[i], *d_opts.getErr()); }
+
+ private:
+  /** The options of the driver */
+  Options& d_opts;
+  /** The process ids of the workers */
+  std::vector<pid_t> d_pids;
+  /** The files of the standard output of the workers */
+  std::vector<FILE*> d_outs;
+  /** The files of the error output of the workers */
+  std::vector<FILE*> d_errs;
+  /** The exit codes of the workers that exited */
+  std::vector<int> d_exitCodes;
+  /** Whether the workers are running */
+  std::vector<bool> d_running;
+  /** The number of workers that are running */
+  size_t d_numRunning;
+};
+
+/**
+ * Run the worker with the given index of the portfolio in the current
+ * (forked) process, and exit.
+ */
+[[noreturn]] void runPortfolioWorker(
+    uint32_t worker,
+    uint64_t boundary,
+    CommandExecutor& executor,
+    std::vector<std::unique_ptr<Command>>& commands,
+    Options& opts,
+    WorkerState& state)
+{
+  bool status = true;
+  try
+  {
+    api::Solver* solver = executor.getSolver();
+    if (worker > 0)
+    {
+      solver->setOption("random-seed", std::to_string(worker));
+      for (const std::pair<std::string, std::string>& option :
+           s_workerOptions[worker % s_workerOptions.size()])
+      {
+        solver->setOption(option.first, option.second);
+      }
+    }
+    prop::SharedClauseChannel::attach(worker, boundary);
+
+    for (std::unique_ptr<Command>& cmd : commands)
+    {
+      status = executor.doCommand(cmd);
+      if (!status || cmd->interrupted()
+          || dynamic_cast<QuitCommand*>(cmd.get()) != nullptr)
+      {
+        break;
+      }
+    }
+    api::Result result = executor.getResult();
+    state.d_conclusive = status
+                         && (result.isSat() || result.isUnsat()
+                             || result.isEntailed() || result.isNotEntailed());
+    executor.flushOutputStreams();
+  }
+  catch (Exception& e)
+  {
+    printError(opts, e.getMessage());
+    status = false;
+  }
+  catch (std::exception& e)
+  {
+    printError(opts, e.what());
+    status = false;
+  }
+  flushOutput(opts);
+  // exit without running the destructors of the driver's objects
+  _exit(status ? 0 : 1);
+}
+
+/**
+ * Run a worker of cube-and-conquer in the current (forked) process, and
+ * exit. The worker solves the cubes of the queue until one of them is
+ * satisfiable, in which case it prints sat and runs the commands after the
+ * check-sat command. It writes the indices in assertions of the unsat cores
+ * of the unsatisfiable cubes to the file cores.
+ */
+[[noreturn]] void runCubeWorker(
+    CommandExecutor& executor,
+    const std::vector<std::vector<api::Term>>& cubes,
+    const std::vector<api::Term>& assertions,
+    std::vector<std::unique_ptr<Command>>::iterator suffix,
+    std::vector<std::unique_ptr<Command>>::iterator end,
+    Options& opts,
+    CubeQueue& queue,
+    WorkerState& state,
+    FILE* cores)
+{
+  bool status = true;
+  try
+  {
+    api::Solver* solver = executor.getSolver();
+    bool produceCores = solver->getOption("produce-unsat-cores") == "true";
+    while (!queue.d_sat)
+    {
+      uint32_t i = queue.d_next++;
+      if (i >= cubes.size())
+      {
+        break;
+      }
+      api::Result result = solver->checkSatAssuming(cubes[i]);
+      Notice() << "cube-and-conquer: cube " << i << " is " << result
+               << std::endl;
+      if (result.isSat())
+      {
+        queue.d_sat = true;
+        state.d_conclusive = true;
+        *opts.getOut() << result << std::endl;
+        if (opts.getDumpModels())
+        {
+          std::unique_ptr<Command> cmd(new GetModelCommand());
+          status = executor.doCommand(cmd);
+        }
+        for (; suffix != end && status; ++suffix)
+        {
+          status = executor.doCommand(*suffix);
+          if ((*suffix)->interrupted()
+              || dynamic_cast<QuitCommand*>(suffix->get()) != nullptr)
+          {
+            break;
+          }
+        }
+        break;
+      }
+      if (!result.isUnsat())
+      {
+        state.d_unknown = true;
+      }
+      else if (produceCores)
+      {
+        for (const api::Term& t : solver->getUnsatCore())
+        {
+          std::vector<api::Term>::const_iterator it =
+              std::find(assertions.begin(), assertions.end(), t);
+          if (it != assertions.end())
+          {
+            uint32_t index = it - assertions.begin();
+            fwrite(&index, sizeof(index), 1, cores);
+          }
+        }
+      }
+    }
+    fflush(cores);
+    executor.flushOutputStreams();
+  }
+  catch (Exception& e)
+  {
+    printError(opts, e.getMessage());
+    status = false;
+  }
+  catch (std::exception& e)
+  {
+    printError(opts, e.what());
+    status = false;
+  }
+  flushOutput(opts);
+  // exit without running the destructors of the driver's objects
+  _exit(status ? 0 : 1);
+}
+
+/** Print the unsat core like the get-unsat-core command does */
+void printUnsatCore(std::ostream& out,
+                    api::Solver* solver,
+                    SymbolManager* sm,
+                    const std::vector<api::Term>& core)
+{
+  out << "(" << std::endl;
+  if (solver->getOption("dump-unsat-cores-full") == "true")
+  {
+    for (const api::Term& t : core)
+    {
+      out << t << std::endl;
+    }
+  }
+  else
+  {
+    std::vector<std::string> names;
+    sm->getExpressionNames(core, names, true);
+    for (const std::string& name : names)
+    {
+      out << name << std::endl;
+    }
+  }
+  out << ")" << std::endl;
+}
+
+/**
+ * Do the cubes cover all assignments, i.e., is their disjunction valid? The
+ * cubes of api::Solver::getCubes() are pairwise contradictory conjunctions of
+ * literals over distinct atoms, so they cover all assignments iff the sum of
+ * 2^-|cube| over the cubes is 1. This is not the case if a cube that
+ * propagation refutes was dropped, or a cube contains failed literals, whose
+ * negations are implied by the assertions rather than valid.
+ */
+bool coverAllAssignments(const std::vector<std::vector<api::Term>>& cubes)
+{
+  size_t maxSize = 0;
+  for (const std::vector<api::Term>& cube : cubes)
+  {
+    maxSize = std::max(maxSize, cube.size());
+  }
+  if (cubes.empty() || maxSize >= 64)
+  {
+    return false;
+  }
+  uint64_t sum = 0;
+  for (const std::vector<api::Term>& cube : cubes)
+  {
+    sum += uint64_t(1) << (maxSize - cube.size());
+  }
+  return sum == uint64_t(1) << maxSize;
+}
+
+}  // namespace
+
+int runPortfolio(CommandExecutor& executor,
+                 std::vector<std::unique_ptr<Command>>& commands,
+                 Options& opts)
+{
+  uint32_t numWorkers = opts.getPortfolioJobs();
+  api::Solver* solver = executor.getSolver();
+  // The nodes created so far, i.e., the parsed terms, have the same ids in
+  // all workers. A fresh constant gets the first id that may differ.
+  uint64_t boundary = solver->mkConst(solver->getBooleanSort()).getId();
+  prop::SharedClauseChannel::create();
+
+  WorkerState* states = static_cast<WorkerState*>(
+      mapShared(numWorkers * sizeof(WorkerState)));
+  Workers workers(opts);
+  for (uint32_t i = 0; i < numWorkers; ++i)
+  {
+    if (workers.fork())
+    {
+      runPortfolioWorker(i, boundary, executor, commands, opts, states[i]);
+    }
+  }
+
+  // wait for the first conclusive worker
+  int winner = -1;
+  int i;
+  while (winner < 0 && (i = workers.wait()) >= 0)
+  {
+    if (states[i].d_conclusive)
+    {
+      winner = i;
+    }
+  }
+  workers.stop();
+  if (winner < 0)
+  {
+    winner = 0;
+  }
+  Notice() << "portfolio: printing the output of worker " << winner
+           << std::endl;
+  workers.printOutput(winner);
+  munmap(states, numWorkers * sizeof(WorkerState));
+  return workers.getExitCode(winner);
+}
+
+int runCubeAndConquer(CommandExecutor& executor,
+                      std::vector<std::unique_ptr<Command>>& commands,
+                      Options& opts)
+{
+  std::vector<std::unique_ptr<Command>>::iterator checkSat = commands.end();
+  for (std::vector<std::unique_ptr<Command>>::iterator it = commands.begin();
+       it != commands.end();
+       ++it)
+  {
+    Command* cmd = it->get();
+    if (dynamic_cast<CheckSatCommand*>(cmd) != nullptr
+        && checkSat == commands.end())
+    {
+      checkSat = it;
+    }
+    else if (dynamic_cast<CheckSatCommand*>(cmd) != nullptr
+             || dynamic_cast<CheckSatAssumingCommand*>(cmd) != nullptr
+             || dynamic_cast<QueryCommand*>(cmd) != nullptr
+             || dynamic_cast<PushCommand*>(cmd) != nullptr
+             || dynamic_cast<PopCommand*>(cmd) != nullptr
+             || dynamic_cast<ResetCommand*>(cmd) != nullptr
+             || dynamic_cast<ResetAssertionsCommand*>(cmd) != nullptr)
+    {
+      throw Exception(
+          "--cube-depth requires an input with a single check-sat command");
+    }
+  }
+  if (checkSat == commands.end())
+  {
+    throw Exception(
+        "--cube-depth requires an input with a single check-sat command");
+  }
+
+  // the workers solve several cubes each
+  api::Solver* solver = executor.getSolver();
+  solver->setOption("incremental", "true");
+  for (std::vector<std::unique_ptr<Command>>::iterator it = commands.begin();
+       it != checkSat;
+       ++it)
+  {
+    if (!executor.doCommand(*it) || (*it)->interrupted())
+    {
+      return 1;
+    }
+    if (dynamic_cast<QuitCommand*>(it->get()) != nullptr)
+    {
+      return 0;
+    }
+  }
+  std::vector<api::Term> assertions = solver->getAssertions();
+  std::vector<std::vector<api::Term>> cubes =
+      solver->getCubes(opts.getCubeDepth());
+  Notice() << "cube-and-conquer: " << cubes.size() << " cubes" << std::endl;
+
+  size_t numWorkers = std::min<size_t>(opts.getPortfolioJobs(), cubes.size());
+  CubeQueue* queue = static_cast<CubeQueue*>(mapShared(sizeof(CubeQueue)));
+  WorkerState* states = static_cast<WorkerState*>(
+      mapShared(std::max<size_t>(numWorkers, 1) * sizeof(WorkerState)));
+  std::vector<FILE*> cores;
+  Workers workers(opts);
+  for (size_t i = 0; i < numWorkers; ++i)
+  {
+    cores.push_back(tmpfile());
+    if (cores.back() == nullptr)
+    {
+      throw Exception("cannot create the unsat core files of the workers");
+    }
+    if (workers.fork())
+    {
+      runCubeWorker(executor,
+                    cubes,
+                    assertions,
+                    checkSat + 1,
+                    commands.end(),
+                    opts,
+                    *queue,
+                    states[i],
+                    cores[i]);
+    }
+  }
+
+  // wait for a satisfiable cube, or for all cubes
+  int winner = -1;
+  bool unknown = false;
+  int i;
+  while (winner < 0 && (i = workers.wait()) >= 0)
+  {
+    if (states[i].d_conclusive)
+    {
+      winner = i;
+    }
+    else if (states[i].d_unknown || workers.getExitCode(i) != 0)
+    {
+      unknown = true;
+      workers.printErrors(i);
+    }
+  }
+  workers.stop();
+
+  int exitCode = 0;
+  if (winner >= 0)
+  {
+    Notice() << "cube-and-conquer: printing the output of worker " << winner
+             << std::endl;
+    workers.printOutput(winner);
+    exitCode = workers.getExitCode(winner);
+  }
+  else
+  {
+    // all cubes are unsatisfiable, or some are unknown
+    *opts.getOut() << (unknown ? "unknown" : "unsat") << std::endl;
+    bool printCore = !unknown
+                     && solver->getOption("produce-unsat-cores") == "true";
+    std::vector<api::Term> coreTerms;
+    if (printCore && coverAllAssignments(cubes))
+    {
+      // the union of the unsat cores of the cubes is an unsat core, since it
+      // is unsatisfiable in conjunction with each cube, and the disjunction
+      // of the cubes is valid
+      std::set<uint32_t> core;
+      for (FILE* f : cores)
+      {
+        rewind(f);
+        uint32_t index;
+        while (fread(&index, sizeof(index), 1, f) == 1)
+        {
+          core.insert(index);
+        }
+      }
+      for (uint32_t index : core)
+      {
+        coreTerms.push_back(assertions[index]);
+      }
+    }
+    else if (printCore)
+    {
+      // the cubes only cover the models of all assertions, so the union of
+      // their unsat cores need not be unsatisfiable, solve without cubes
+      Notice() << "cube-and-conquer: computing the unsat core without cubes"
+               << std::endl;
+      if (solver->checkSat().isUnsat())
+      {
+        coreTerms = solver->getUnsatCore();
+      }
+      else
+      {
+        coreTerms = assertions;
+      }
+    }
+    if (printCore && opts.getDumpUnsatCores())
+    {
+      printUnsatCore(
+          *opts.getOut(), solver, executor.getSymbolManager(), coreTerms);
+    }
+    // the commands after the check-sat command, whose result this process
+    // does not have unless it is an unsat core
+    for (std::vector<std::unique_ptr<Command>>::iterator it = checkSat + 1;
+         it != commands.end();
+         ++it)
+    {
+      if (printCore && dynamic_cast<GetUnsatCoreCommand*>(it->get()) != nullptr)
+      {
+        printUnsatCore(
+            *opts.getOut(), solver, executor.getSymbolManager(), coreTerms);
+        continue;
+      }
+      if (!executor.doCommand(*it))
+      {
+        exitCode = 1;
+        break;
+      }
+      if ((*it)->interrupted()
+          || dynamic_cast<QuitCommand*>(it->get()) != nullptr)
+      {
+        break;
+      }
+    }
+  }
+  for (FILE* f : cores)
+  {
+    fclose(f);
+  }
+  munmap(queue, sizeof(CubeQueue));
+  munmap(states, std::max<size_t>(numWorkers, 1) * sizeof(WorkerState));
+  return exitCode;
+}
+
+#else /* ! __WIN32__ */
+
+int runPortfolio(CommandExecutor& executor,
+                 std::vector<std::unique_ptr<Command>>& commands,
+                 Options& opts)
+{
+  throw Exception("--portfolio-jobs is not supported on Windows");
+}
+
+int runCubeAndConquer(CommandExecutor& executor,
+                      std::vector<std::unique_ptr<Command>>& commands,
+                      Options& opts)
+{
+  throw Exception("--cube-depth is not supported on Windows");
+}
+
+#endif /* ! __WIN32__ */
+
+}  // namespace main
+}  // namespace CVC5
@@ -0,0 +1,73 @@
+/*********************                                                        */
+/*! \file portfolio.h
+ ** \verbatim
+ ** This file is part of the CVC4 project.
+ ** Copyright (c) 2009-2021 by the authors listed in the file AUTHORS
+ ** in the top-level source directory and their institutional affiliations.
+ ** All rights reserved.  See the file COPYING in the top-level source
+ ** directory for licensing information.\endverbatim
+ **
+ ** \brief The parallel modes of the driver.
+ **
+ ** The portfolio mode that is enabled by the --portfolio-jobs option, and the
+ ** cube-and-conquer mode that is enabled by the --cube-depth option.
+ **/
+
+#ifndef CVC4__MAIN__PORTFOLIO_H
+#define CVC4__MAIN__PORTFOLIO_H
+
+#include <memory>
+#include <vector>
+
+#include "options/options.h"
+#include "smt/command.h"
+
+namespace CVC5 {
+namespace main {
+
+class CommandExecutor;
+
+/**
+ * Executes the parsed commands in --portfolio-jobs worker processes, which
+ * are forked from this one and so share the commands and the symbols they
+ * refer to. The first worker runs the configuration given by the user, the
+ * others vary its random seed and SAT search heuristics. The workers exchange
+ * short learned clauses through a prop::SharedClauseChannel.
+ *
+ * The output of the first worker that finds a sat or unsat answer is printed,
+ * and the other workers are killed. If no worker finds one, the output of the
+ * first worker is printed.
+ *
+ * The executor must not have executed any command that initializes its
+ * SmtEngine, since the workers set their options.
+ *
+ * @return the exit code of the worker whose output is printed
+ */
+int runPortfolio(CommandExecutor& executor,
+                 std::vector<std::unique_ptr<Command>>& commands,
+                 Options& opts);
+
+/**
+ * Executes the parsed commands by cube-and-conquer. The commands before the
+ * single check-sat command are executed in this process, and the assertions
+ * are then split into up to 2^--cube-depth cubes by lookahead (see
+ * api::Solver::getCubes()). Up to --portfolio-jobs worker processes solve the
+ * cubes with checkSatAssuming().
+ *
+ * If a cube is satisfiable, the output of its worker, which executes the
+ * commands after the check-sat command, is printed. Otherwise the input is
+ * unsat (or unknown if some cube is), and this process executes the commands
+ * after the check-sat command. It answers get-unsat-core with the union of the
+ * unsat cores of the cubes if the cubes cover all assignments, and otherwise
+ * with the unsat core of a solve without cubes in this process.
+ *
+ * @return the exit code of the mode
+ */
+int runCubeAndConquer(CommandExecutor& executor,
+                      std::vector<std::unique_ptr<Command>>& commands,
+                      Options& opts);
+
+}  // namespace main
+}  // namespace CVC5
+
+#endif /* CVC4__MAIN__PORTFOLIO_H */
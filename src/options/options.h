@@ -153,6 +153,7 @@ public:
   options::InstFormatMode getInstFormatMode() const;
   OutputLanguage getOutputLanguage() const;
   bool getUfHo() const;
+  unsigned getCubeDepth() const;
   bool getDumpInstantiations() const;
   bool getDumpModels() const;
   bool getDumpProofs() const;
@@ -167,6 +168,7 @@ public:
   bool getLanguageHelp() const;
   bool getMemoryMap() const;
   bool getParseOnly() const;
+  unsigned getPortfolioJobs() const;
   bool getProduceModels() const;
   bool getSegvSpin() const;
   bool getSemanticChecks() const;
@@ -35,6 +35,7 @@
 #include "options/didyoumean.h"
 #include "options/language.h"
 #include "options/option_exception.h"
+#include "options/prop_options.h"
 #include "options/smt_options.h"
 #include "options/theory_options.h"
 
@@ -161,6 +162,22 @@ void OptionsHandler::checkBvSatSolver(std::string option, SatSolverMode m)
   }
 }
 
+void OptionsHandler::checkCDCLTSatSolver(std::string option,
+                                         CDCLTSatSolverMode m)
+{
+#ifndef CVC4_USE_CADICAL_PROPAGATOR
+  if (m == CDCLTSatSolverMode::CADICAL)
+  {
+    std::stringstream ss;
+    ss << "option `" << option
+       << "' requires a build of CVC4 against CaDiCaL 1.9 or later; this "
+          "binary was not built with support for the CaDiCaL external "
+          "propagator";
+    throw OptionException(ss.str());
+  }
+#endif /* CVC4_USE_CADICAL_PROPAGATOR */
+}
+
 void OptionsHandler::checkBitblastMode(std::string option, BitblastMode m)
 {
   if (m == options::BitblastMode::LAZY)
@@ -347,6 +364,8 @@ void OptionsHandler::showConfiguration(std::string option) {
   print_config_cond("cln", Configuration::isBuiltWithCln());
   print_config_cond("glpk", Configuration::isBuiltWithGlpk());
   print_config_cond("cadical", Configuration::isBuiltWithCadical());
+  print_config_cond("cadical-propagator",
+                    Configuration::isBuiltWithCadicalPropagator());
   print_config_cond("cryptominisat", Configuration::isBuiltWithCryptominisat());
   print_config_cond("gmp", Configuration::isBuiltWithGmp());
   print_config_cond("kissat", Configuration::isBuiltWithKissat());
@@ -54,6 +54,10 @@ OutputLanguage Options::getOutputLanguage() const {
 
 bool Options::getUfHo() const { return (*this)[options::ufHo]; }
 
+unsigned Options::getCubeDepth() const{
+  return (*this)[options::cubeDepth];
+}
+
 bool Options::getDumpInstantiations() const{
   return (*this)[options::dumpInstantiations];
 }
@@ -112,6 +116,10 @@ bool Options::getParseOnly() const{
   return (*this)[options::parseOnly];
 }
 
+unsigned Options::getPortfolioJobs() const{
+  return (*this)[options::portfolioJobs];
+}
+
 bool Options::getProduceModels() const{
   return (*this)[options::produceModels];
 }
@@ -32,6 +32,7 @@ BVMinisatSatSolver::BVMinisatSatSolver(StatisticsRegistry* registry, context::Co
   d_lastPropagation(mainSatContext, 0),
   d_statistics(registry, name)
 {
+  d_minisat->setDratWriter(DratWriter::create(name));
   d_statistics.init(d_minisat.get());
 }
 
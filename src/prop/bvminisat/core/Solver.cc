@@ -246,6 +246,10 @@ bool Solver::addClause_(vec<Lit>& ps, ClauseId& id)
     }
 
     ps.shrink(i - j);
+    if (d_drat && i != j)
+    {
+      d_drat->addDerived(ps);
+    }
 
     clause_added = true;
 
@@ -304,7 +308,19 @@ void Solver::removeClause(CRef cr) {
   Clause& clause = ca[cr];
   detachClause(cr);
   // Don't leave pointers to free'd memory!
-  if (locked(clause)) vardata[var(clause[0])].reason = CRef_Undef;
+  if (locked(clause))
+  {
+    if (d_drat && level(var(clause[0])) == 0)
+    {
+      // keep the propagated literal in the proof
+      d_drat->addDerivedUnit(toInt(clause[0]));
+    }
+    vardata[var(clause[0])].reason = CRef_Undef;
+  }
+  if (d_drat)
+  {
+    d_drat->deleteClause(clause);
+  }
   clause.mark(1);
   ca.free(cr);
 }
@@ -943,6 +959,10 @@ lbool Solver::search(int nof_conflicts, UIP uip)
 
       learnt_clause.clear();
       analyze(confl, learnt_clause, backtrack_level, uip);
+      if (d_drat)
+      {
+        d_drat->addDerived(learnt_clause);
+      }
 
       Lit p = learnt_clause[0];
       // bool assumption = marker[var(p)] == 2;
@@ -1176,7 +1196,14 @@ lbool Solver::solve_()
 
     ccmin_mode = 0;
 
-    if (!ok) return l_False;
+    if (!ok)
+    {
+      if (d_drat)
+      {
+        d_drat->addEmpty();
+      }
+      return l_False;
+    }
 
     solves++;
 
@@ -1211,6 +1238,15 @@ lbool Solver::solve_()
     }else if (status == l_False && conflict.size() == 0)
         ok = false;
 
+    if (d_drat)
+    {
+      if (!ok)
+      {
+        d_drat->addEmpty();
+      }
+      d_drat->flush();
+    }
+
     return status;
 }
 
@@ -1406,6 +1442,21 @@ void ClauseAllocator::reloc(CRef& cr, ClauseAllocator& to)
 }
 
 void Solver::setNotify(Notify* toNotify) { d_notify = toNotify; }
+
+void Solver::setDratWriter(std::unique_ptr<CVC5::prop::DratWriter> drat)
+{
+  Assert(clauses.size() == 0 && learnts.size() == 0);
+  d_drat = std::move(drat);
+  if (d_drat)
+  {
+    // the constants are asserted without clauses
+    vec<Lit> unit;
+    unit.push(mkLit(varTrue, false));
+    d_drat->addInput(unit);
+    unit[0] = mkLit(varFalse, true);
+    d_drat->addInput(unit);
+  }
+}
 bool Solver::withinBudget(ResourceManager::Resource r) const
 {
   AlwaysAssert(d_notify);
@@ -26,6 +26,7 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 #include "base/check.h"
 #include "context/context.h"
 #include "proof/clause_id.h"
+#include "prop/drat_writer.h"
 #include "prop/bvminisat/core/SolverTypes.h"
 #include "prop/bvminisat/mtl/Alg.h"
 #include "prop/bvminisat/mtl/Heap.h"
@@ -88,6 +89,10 @@ private:
     /** False constant */
     Var varFalse;
 
+protected:
+    /** The writer of the streaming DRAT proof, if any */
+    std::unique_ptr<CVC5::prop::DratWriter> d_drat;
+
 public:
 
     // Constructor/Destructor:
@@ -97,6 +102,12 @@ public:
 
  void setNotify(Notify* toNotify);
 
+ /**
+  * Stream a DRAT proof with the given writer from now on. Must be called
+  * before any clause is added.
+  */
+ void setDratWriter(std::unique_ptr<CVC5::prop::DratWriter> drat);
+
  // Problem specification:
  //
  Var newVar(bool polarity = true,
@@ -474,7 +485,15 @@ inline void Solver::checkGarbage(double gf){
 
 // NOTE: enqueue does not set the ok flag! (only public methods do)
 inline bool     Solver::enqueue         (Lit p, CRef from)      { return value(p) != l_Undef ? value(p) != l_False : (uncheckedEnqueue(p, from), true); }
-inline bool     Solver::addClause       (const vec<Lit>& ps, ClauseId& id)    { ps.copyTo(add_tmp); return addClause_(add_tmp, id); }
+inline bool     Solver::addClause       (const vec<Lit>& ps, ClauseId& id)
+{
+  if (d_drat)
+  {
+    d_drat->addInput(ps);
+  }
+  ps.copyTo(add_tmp);
+  return addClause_(add_tmp, id);
+}
 inline bool     Solver::addEmptyClause  ()                      { add_tmp.clear(); ClauseId tmp; return addClause_(add_tmp, tmp); }
 inline bool     Solver::addClause       (Lit p, ClauseId& id)                 { add_tmp.clear(); add_tmp.push(p); return addClause_(add_tmp, id); }
 inline bool     Solver::addClause       (Lit p, Lit q, ClauseId& id)          { add_tmp.clear(); add_tmp.push(p); add_tmp.push(q); return addClause_(add_tmp, id); }
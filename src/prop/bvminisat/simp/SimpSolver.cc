@@ -151,8 +151,16 @@ lbool SimpSolver::solve_(bool do_simp, bool turn_off_simp)
 
     if (result == l_True)
         result = Solver::solve_();
-    else if (verbosity >= 1)
-        printf("===============================================================================\n");
+    else
+    {
+        if (verbosity >= 1)
+            printf("===============================================================================\n");
+        if (d_drat)
+        {
+            // simplification found the clauses unsatisfiable
+            d_drat->addEmpty();
+        }
+    }
 
     if (do_simp)
         // Unfreeze the assumptions that were frozen:
@@ -231,6 +239,10 @@ bool SimpSolver::strengthenClause(CRef cr, Lit l)
   // implemented) if (!find(subsumption_queue, &clause))
   subsumption_queue.insert(cr);
 
+  if (d_drat)
+  {
+    d_drat->addStrengthened(clause, l);
+  }
   if (clause.size() == 2)
   {
     removeClause(cr);
@@ -238,6 +250,10 @@ bool SimpSolver::strengthenClause(CRef cr, Lit l)
   }
   else
   {
+    if (d_drat)
+    {
+      d_drat->deleteClause(clause);
+    }
     detachClause(cr, true);
     clause.strengthen(l);
     attachClause(cr);
@@ -569,10 +585,20 @@ bool SimpSolver::eliminateVar(Var v)
     mkElimClause(elimclauses, ~mkLit(v));
   }
 
-    for (int i = 0; i < cls.size(); i++) removeClause(cls[i]);
-
     // Produce clauses in cross product:
     vec<Lit>& resolvent = add_tmp;
+    if (d_drat)
+    {
+      // the resolvents must be in the proof before their antecedents are
+      // deleted
+      for (int i = 0; i < pos.size(); i++)
+        for (int j = 0; j < neg.size(); j++)
+          if (merge(ca[pos[i]], ca[neg[j]], v, resolvent))
+            d_drat->addDerived(resolvent);
+    }
+
+    for (int i = 0; i < cls.size(); i++) removeClause(cls[i]);
+
     for (int i = 0; i < pos.size(); i++)
       for (int j = 0; j < neg.size(); j++) {
         ClauseId id = -1;
@@ -615,6 +641,10 @@ bool SimpSolver::substitute(Var v, Lit x)
       Lit p = clause[j];
       subst_clause.push(var(p) == v ? x ^ sign(p) : p);
     }
+    if (d_drat)
+    {
+      d_drat->addDerived(subst_clause);
+    }
 
     removeClause(cls[i]);
     ClauseId id;
@@ -196,7 +196,15 @@ inline void SimpSolver::updateElimHeap(Var v) {
     elim_heap.update(v);
 }
 
-inline bool SimpSolver::addClause    (const vec<Lit>& ps, ClauseId& id)    { ps.copyTo(add_tmp); return addClause_(add_tmp, id); }
+inline bool SimpSolver::addClause    (const vec<Lit>& ps, ClauseId& id)
+{
+  if (d_drat)
+  {
+    d_drat->addInput(ps);
+  }
+  ps.copyTo(add_tmp);
+  return addClause_(add_tmp, id);
+}
 inline bool SimpSolver::addEmptyClause()                     { add_tmp.clear(); ClauseId id; return addClause_(add_tmp, id); }
 inline bool SimpSolver::addClause    (Lit p, ClauseId& id)                 { add_tmp.clear(); add_tmp.push(p); return addClause_(add_tmp, id); }
 inline bool SimpSolver::addClause    (Lit p, Lit q, ClauseId& id)          { add_tmp.clear(); add_tmp.push(p); add_tmp.push(q); return addClause_(add_tmp, id); }
@@ -11,14 +11,20 @@
  **
  ** \brief Wrapper for CaDiCaL SAT Solver.
  **
- ** Implementation of the CaDiCaL SAT solver for CVC4 (bitvectors).
+ ** Implementation of the CaDiCaL SAT solver for CVC4 (bitvectors), and of
+ ** CaDiCaL as the SAT solver of the DPLL(T) search.
  **/
 
 #include "prop/cadical.h"
 
 #ifdef CVC4_USE_CADICAL
 
+#include <deque>
+
 #include "base/check.h"
+#include "options/option_exception.h"
+#include "prop/theory_proxy.h"
+#include "theory/theory.h"
 
 namespace CVC5 {
 namespace prop {
@@ -64,6 +70,7 @@ CadicalSolver::CadicalSolver(StatisticsRegistry* registry,
       d_inSatMode(false),
       d_statistics(registry, name)
 {
+  d_drat = DratWriter::create("prop::cadical" + name, false);
 }
 
 void CadicalSolver::init()
@@ -72,6 +79,18 @@ void CadicalSolver::init()
   d_false = newVar();
 
   d_solver->set("quiet", 1);  // CaDiCaL is verbose by default
+  if (d_drat)
+  {
+    // the proof must be traced from the first clause on
+    d_solver->set("binary", d_drat->isBinary());
+    if (!d_solver->trace_proof(d_drat->getProofPath().c_str()))
+    {
+      throw OptionException("cannot open DRAT proof file "
+                            + d_drat->getProofPath());
+    }
+    addDratInput({SatLiteral(d_true)});
+    addDratInput({SatLiteral(d_false, true)});
+  }
   d_solver->add(toCadicalVar(d_true));
   d_solver->add(0);
   d_solver->add(-toCadicalVar(d_false));
@@ -80,8 +99,23 @@ void CadicalSolver::init()
 
 CadicalSolver::~CadicalSolver() {}
 
+void CadicalSolver::addDratInput(const SatClause& clause)
+{
+  // CaDiCaL variables start with index 1 in the proof as well
+  std::vector<int> lits;
+  for (const SatLiteral& lit : clause)
+  {
+    lits.push_back(2 * (lit.getSatVariable() - 1) + lit.isNegated());
+  }
+  d_drat->addInput(lits);
+}
+
 ClauseId CadicalSolver::addClause(SatClause& clause, bool removable)
 {
+  if (d_drat)
+  {
+    addDratInput(clause);
+  }
   for (const SatLiteral& lit : clause)
   {
     d_solver->add(toCadicalLit(lit));
@@ -117,6 +151,11 @@ SatValue CadicalSolver::solve()
   SatValue res = toSatValue(d_solver->solve());
   d_inSatMode = (res == SAT_VALUE_TRUE);
   ++d_statistics.d_numSatCalls;
+  if (d_drat)
+  {
+    d_drat->flush();
+    d_solver->flush_proof_trace();
+  }
   return res;
 }
 
@@ -137,6 +176,11 @@ SatValue CadicalSolver::solve(const std::vector<SatLiteral>& assumptions)
   SatValue res = toSatValue(d_solver->solve());
   d_inSatMode = (res == SAT_VALUE_TRUE);
   ++d_statistics.d_numSatCalls;
+  if (d_drat)
+  {
+    d_drat->flush();
+    d_solver->flush_proof_trace();
+  }
   return res;
 }
 
@@ -199,6 +243,672 @@ CadicalSolver::Statistics::~Statistics() {
   d_registry->unregisterStat(&d_solveTime);
 }
 
+#ifdef CVC4_USE_CADICAL_PROPAGATOR
+
+namespace {
+
+SatLiteral toSatLiteral(CadicalLit lit)
+{
+  return SatLiteral(std::abs(lit), lit < 0);
+}
+
+}  // namespace
+
+/**
+ * The external propagator through which CaDiCaL runs the DPLL(T) search of a
+ * CadicalCDCLTSolver.
+ *
+ * It keeps its own copy of the assignment of the (observed) variables, by
+ * decision level, which answers the value() queries of the theories and the
+ * decision engine during the search.  Chronological backtracking is disabled
+ * in CaDiCaL, so that every assignment belongs to the current decision level,
+ * except for literals that CaDiCaL fixes at the root level while deeper in
+ * the search.  These stay assigned on backtracking and are asserted to the
+ * theories again at the level backtracked to.
+ *
+ * As a learner, it counts the conflicts of CaDiCaL, i.e., its learned
+ * clauses, which are the resource of CadicalCDCLTSolver::solve().
+ */
+class CadicalPropagator : public CaDiCaL::ExternalPropagator,
+                          public CaDiCaL::Learner
+{
+ public:
+  CadicalPropagator(TheoryProxy* proxy,
+                    context::Context* context,
+                    CaDiCaL::Solver& solver,
+                    CadicalCDCLTSolver::Statistics& stats)
+      : d_proxy(proxy),
+        d_context(context),
+        d_solver(solver),
+        d_stats(stats),
+        d_baseLevel(0),
+        d_nextPropagation(0),
+        d_checkNeeded(true),
+        d_reasonIndex(0),
+        d_inReason(false),
+        d_nextClauseLit(0)
+  {
+  }
+
+  void notify_assignment(int lit, bool is_fixed) override
+  {
+    VarInfo& info = d_varInfo[std::abs(lit)];
+    if (!info.d_active)
+    {
+      return;
+    }
+    if (is_fixed)
+    {
+      info.d_fixed = true;
+    }
+    if (info.d_assignment != 0)
+    {
+      // a literal that is fixed after it was assigned
+      Assert(info.d_assignment == lit);
+      return;
+    }
+    info.d_assignment = lit;
+    d_assignments.push_back(lit);
+    d_checkNeeded = true;
+    if (info.d_theoryAtom)
+    {
+      d_proxy->enqueueTheoryLiteral(toSatLiteral(lit));
+    }
+  }
+
+  void notify_new_decision_level() override
+  {
+    d_context->push();
+    d_levelStart.push_back(d_assignments.size());
+  }
+
+  void notify_backtrack(size_t level) override
+  {
+    // CaDiCaL also notifies backtracks below levels we already left, e.g.,
+    // after resetTrail()
+    if (level >= d_levelStart.size())
+    {
+      return;
+    }
+    ++d_stats.d_numBacktracks;
+    size_t start = d_levelStart[level];
+    std::vector<int> fixed;
+    for (size_t i = start, size = d_assignments.size(); i < size; ++i)
+    {
+      int lit = d_assignments[i];
+      VarInfo& info = d_varInfo[std::abs(lit)];
+      if (info.d_fixed)
+      {
+        fixed.push_back(lit);
+      }
+      else
+      {
+        info.d_assignment = 0;
+      }
+    }
+    d_assignments.resize(start);
+    d_context->popto(d_context->getLevel() - (d_levelStart.size() - level));
+    d_levelStart.resize(level);
+    d_propagations.clear();
+    d_nextPropagation = 0;
+    d_checkNeeded = true;
+
+    // Root-level literals fixed deeper in the search stay assigned
+    for (int lit : fixed)
+    {
+      d_assignments.push_back(lit);
+      if (d_varInfo[std::abs(lit)].d_theoryAtom)
+      {
+        d_proxy->enqueueTheoryLiteral(toSatLiteral(lit));
+      }
+    }
+
+    // Register variables that have not been registered yet
+    for (size_t i = d_varsToRegister.size();
+         i > 0 && d_varsToRegister[i - 1].second > level;
+         --i)
+    {
+      d_varsToRegister[i - 1].second = level;
+      d_proxy->variableNotify(d_varsToRegister[i - 1].first);
+    }
+
+    if (level <= d_baseLevel)
+    {
+      d_proxy->notifyRestart();
+    }
+    d_proxy->spendResource(ResourceManager::Resource::SatConflictStep);
+  }
+
+  bool cb_check_found_model(const std::vector<int>& model) override
+  {
+    // Clauses that CaDiCaL has not picked up yet must be added first
+    if (!d_newClauses.empty())
+    {
+      return false;
+    }
+    do
+    {
+      d_proxy->theoryCheck(theory::Theory::EFFORT_FULL);
+      d_checkNeeded = false;
+      // Propagations are turned into clauses, since the search is over
+      SatClause propagated;
+      d_proxy->theoryPropagate(propagated);
+      for (const SatLiteral& lit : propagated)
+      {
+        if (value(lit) != SAT_VALUE_TRUE)
+        {
+          addExplanation(lit);
+        }
+      }
+      if (!d_newClauses.empty())
+      {
+        return false;
+      }
+    } while (d_proxy->theoryNeedCheck());
+    return true;
+  }
+
+  int cb_decide() override
+  {
+    SatLiteral lit = d_proxy->getNextTheoryDecisionRequest();
+    while (lit != undefSatLiteral)
+    {
+      if (value(lit) == SAT_VALUE_UNKNOWN)
+      {
+        return toCadicalLit(lit);
+      }
+      lit = d_proxy->getNextTheoryDecisionRequest();
+    }
+    bool stopSearch = false;
+    lit = d_proxy->getNextDecisionEngineRequest(stopSearch);
+    if (!stopSearch && lit != undefSatLiteral
+        && value(lit) == SAT_VALUE_UNKNOWN)
+    {
+      return toCadicalLit(lit);
+    }
+    return 0;
+  }
+
+  int cb_propagate() override
+  {
+    if (d_nextPropagation == d_propagations.size() && d_checkNeeded)
+    {
+      d_checkNeeded = false;
+      d_proxy->theoryCheck(theory::Theory::EFFORT_STANDARD);
+      SatClause propagated;
+      d_proxy->theoryPropagate(propagated);
+      d_propagations.clear();
+      d_nextPropagation = 0;
+      for (const SatLiteral& lit : propagated)
+      {
+        d_propagations.push_back(toCadicalLit(lit));
+      }
+    }
+    while (d_nextPropagation < d_propagations.size())
+    {
+      int lit = d_propagations[d_nextPropagation++];
+      SatValue val = value(toSatLiteral(lit));
+      if (val == SAT_VALUE_UNKNOWN)
+      {
+        ++d_stats.d_numTheoryPropagations;
+        return lit;
+      }
+      if (val == SAT_VALUE_FALSE)
+      {
+        // conflict in theory propagation: add the explanation as a clause
+        addExplanation(toSatLiteral(lit));
+      }
+    }
+    return 0;
+  }
+
+  int cb_add_reason_clause_lit(int propagated_lit) override
+  {
+    if (!d_inReason)
+    {
+      SatClause explanation;
+      d_proxy->explainPropagation(toSatLiteral(propagated_lit), explanation);
+      d_reason.clear();
+      for (const SatLiteral& lit : explanation)
+      {
+        d_reason.push_back(toCadicalLit(lit));
+      }
+      if (d_activationLit != 0)
+      {
+        d_reason.push_back(-d_activationLit);
+      }
+      d_reasonIndex = 0;
+      d_inReason = true;
+    }
+    if (d_reasonIndex < d_reason.size())
+    {
+      return d_reason[d_reasonIndex++];
+    }
+    d_inReason = false;
+    return 0;
+  }
+
+  bool cb_has_external_clause() override { return !d_newClauses.empty(); }
+
+  int cb_add_external_clause_lit() override
+  {
+    Assert(!d_newClauses.empty());
+    const std::vector<int>& clause = d_newClauses.front();
+    if (d_nextClauseLit < clause.size())
+    {
+      return clause[d_nextClauseLit++];
+    }
+    d_newClauses.pop_front();
+    d_nextClauseLit = 0;
+    ++d_stats.d_numLemmas;
+    return 0;
+  }
+
+  bool learning(int size) override
+  {
+    ++d_stats.d_numConflicts;
+    // the literals of the learned clause are not needed
+    return false;
+  }
+
+  void learn(int lit) override {}
+
+  /** Add (and observe) a new variable */
+  void addVar(SatVariable var, bool isTheoryAtom, bool preRegister)
+  {
+    if (d_varInfo.size() <= var)
+    {
+      d_varInfo.resize(var + 1);
+    }
+    d_varInfo[var].d_theoryAtom = isTheoryAtom;
+    d_varInfo[var].d_active = true;
+    d_solver.add_observed_var(var);
+    // If the variable is introduced at non-zero level, we need to
+    // reintroduce it on backtracks
+    if (preRegister && !d_levelStart.empty())
+    {
+      d_varsToRegister.emplace_back(var, d_levelStart.size());
+    }
+  }
+
+  /** Stop tracking the variable var, which belongs to a popped user level */
+  void removeVar(SatVariable var)
+  {
+    d_varInfo[var] = VarInfo();
+    d_solver.remove_observed_var(var);
+  }
+
+  /** Queue clause to be added to CaDiCaL from the next callback */
+  void addClause(std::vector<int>&& clause)
+  {
+    d_newClauses.push_back(std::move(clause));
+  }
+
+  /** Clauses queued but not picked up by CaDiCaL before solve() returned */
+  std::deque<std::vector<int>>& getNewClauses()
+  {
+    d_nextClauseLit = 0;
+    return d_newClauses;
+  }
+
+  /** Get the value of lit in the current assignment */
+  SatValue value(SatLiteral lit) const
+  {
+    SatVariable var = lit.getSatVariable();
+    if (var >= d_varInfo.size() || d_varInfo[var].d_assignment == 0)
+    {
+      return SAT_VALUE_UNKNOWN;
+    }
+    return (d_varInfo[var].d_assignment > 0) != lit.isNegated()
+               ? SAT_VALUE_TRUE
+               : SAT_VALUE_FALSE;
+  }
+
+  /** Set the activation literal of the current user level (0 for none) */
+  void setActivationLit(int lit) { d_activationLit = lit; }
+
+  /**
+   * Set the number of assumptions of the next search, whose decision levels
+   * CaDiCaL backtracks to on restarts.
+   */
+  void setBaseLevel(size_t level) { d_baseLevel = level; }
+
+  /** Backtrack to the root level of the search */
+  void resetTrail()
+  {
+    notify_backtrack(0);
+    d_varsToRegister.clear();
+  }
+
+ private:
+  /** Add the explanation of the propagated literal lit as a clause */
+  void addExplanation(SatLiteral lit)
+  {
+    SatClause explanation;
+    d_proxy->explainPropagation(lit, explanation);
+    std::vector<int> clause;
+    for (const SatLiteral& l : explanation)
+    {
+      clause.push_back(toCadicalLit(l));
+    }
+    if (d_activationLit != 0)
+    {
+      clause.push_back(-d_activationLit);
+    }
+    addClause(std::move(clause));
+  }
+
+  struct VarInfo
+  {
+    /** The literal of the variable that is true, or 0 if unassigned */
+    int d_assignment = 0;
+    bool d_fixed = false;
+    bool d_theoryAtom = false;
+    /** False for variables created at popped user levels */
+    bool d_active = false;
+  };
+
+  TheoryProxy* d_proxy;
+  context::Context* d_context;
+  CaDiCaL::Solver& d_solver;
+  CadicalCDCLTSolver::Statistics& d_stats;
+
+  std::vector<VarInfo> d_varInfo;
+  /** The assigned literals, in the order of assignment */
+  std::vector<int> d_assignments;
+  /** The size of d_assignments at the start of each decision level */
+  std::vector<size_t> d_levelStart;
+  /** The number of assumptions of the current search */
+  size_t d_baseLevel;
+  /** Variables to re-register on backtracking, with their levels */
+  std::vector<std::pair<SatVariable, size_t>> d_varsToRegister;
+
+  /** The theory propagations that are not yet handed to CaDiCaL */
+  std::vector<int> d_propagations;
+  size_t d_nextPropagation;
+  /** Whether the theories have to be checked before the next propagation */
+  bool d_checkNeeded;
+
+  /** The reason clause being handed to CaDiCaL */
+  std::vector<int> d_reason;
+  size_t d_reasonIndex;
+  bool d_inReason;
+
+  /** The clauses (lemmas) to hand to CaDiCaL */
+  std::deque<std::vector<int>> d_newClauses;
+  /** The index of the next literal of the first clause of d_newClauses */
+  size_t d_nextClauseLit;
+
+  /** The activation literal of the current user level, or 0 */
+  int d_activationLit = 0;
+};
+
+CadicalCDCLTSolver::CadicalCDCLTSolver(StatisticsRegistry* registry)
+    : d_solver(new CaDiCaL::Solver()),
+      d_context(nullptr),
+      // Note: CaDiCaL variables start with index 1 rather than 0 since negated
+      //       literals are represented as the negation of the index.
+      d_nextVarIdx(1),
+      d_inSearch(false),
+      d_ok(true),
+      d_lastResult(SAT_VALUE_UNKNOWN),
+      d_statistics(registry)
+{
+}
+
+CadicalCDCLTSolver::~CadicalCDCLTSolver()
+{
+  if (d_propagator)
+  {
+    d_solver->disconnect_learner();
+    d_solver->disconnect_external_propagator();
+  }
+}
+
+void CadicalCDCLTSolver::initialize(context::Context* context,
+                                    TheoryProxy* theoryProxy,
+                                    context::UserContext* userContext,
+                                    ProofNodeManager* pnm)
+{
+  AlwaysAssert(pnm == nullptr)
+      << "CaDiCaL as the DPLL(T) SAT solver does not support proofs";
+  d_context = context;
+  d_solver->set("quiet", 1);  // CaDiCaL is verbose by default
+  // The theories are notified of assignments by decision level, which
+  // requires non-chronological backtracking and a trail that is not reused
+  // across solve() calls.
+  d_solver->set("chrono", 0);
+  d_solver->set("ilb", 0);
+  d_solver->set("ilbassumptions", 0);
+  d_propagator.reset(
+      new CadicalPropagator(theoryProxy, context, *d_solver, d_statistics));
+  d_solver->connect_external_propagator(d_propagator.get());
+  d_solver->connect_learner(d_propagator.get());
+
+  d_true = newVar();
+  d_false = newVar();
+  d_solver->add(toCadicalVar(d_true));
+  d_solver->add(0);
+  d_solver->add(-toCadicalVar(d_false));
+  d_solver->add(0);
+}
+
+ClauseId CadicalCDCLTSolver::addClause(SatClause& clause, bool removable)
+{
+  std::vector<int> lits;
+  for (const SatLiteral& lit : clause)
+  {
+    lits.push_back(toCadicalLit(lit));
+  }
+  if (!d_activationLits.empty())
+  {
+    lits.push_back(-d_activationLits.back());
+  }
+  ++d_statistics.d_numClauses;
+  if (d_inSearch)
+  {
+    // CaDiCaL only accepts new clauses from the propagator during the search
+    d_propagator->addClause(std::move(lits));
+  }
+  else
+  {
+    for (int lit : lits)
+    {
+      d_solver->add(lit);
+    }
+    d_solver->add(0);
+  }
+  return ClauseIdError;
+}
+
+ClauseId CadicalCDCLTSolver::addXorClause(SatClause& clause,
+                                          bool rhs,
+                                          bool removable)
+{
+  Unreachable() << "CaDiCaL does not support adding XOR clauses.";
+}
+
+SatVariable CadicalCDCLTSolver::newVar(bool isTheoryAtom,
+                                       bool preRegister,
+                                       bool canErase)
+{
+  ++d_statistics.d_numVariables;
+  SatVariable var = d_nextVarIdx++;
+  d_propagator->addVar(var, isTheoryAtom, preRegister);
+  return var;
+}
+
+SatVariable CadicalCDCLTSolver::trueVar() { return d_true; }
+
+SatVariable CadicalCDCLTSolver::falseVar() { return d_false; }
+
+SatValue CadicalCDCLTSolver::solve()
+{
+  TimerStat::CodeTimer codeTimer(d_statistics.d_solveTime);
+  for (int lit : d_activationLits)
+  {
+    d_solver->assume(lit);
+  }
+  d_propagator->setBaseLevel(d_activationLits.size());
+  d_inSearch = true;
+  int res = d_solver->solve();
+  d_inSearch = false;
+  ++d_statistics.d_numSatCalls;
+
+  // Lemmas that CaDiCaL did not ask for anymore are added for the next call
+  std::deque<std::vector<int>>& pending = d_propagator->getNewClauses();
+  for (const std::vector<int>& clause : pending)
+  {
+    for (int lit : clause)
+    {
+      d_solver->add(lit);
+    }
+    d_solver->add(0);
+  }
+  pending.clear();
+
+  d_lastResult = toSatValue(res);
+  if (d_lastResult == SAT_VALUE_FALSE)
+  {
+    d_ok = false;
+  }
+  return d_lastResult;
+}
+
+SatValue CadicalCDCLTSolver::solve(long unsigned int& resource)
+{
+  Trace("limit") << "SatSolver::solve(): have limit of " << resource
+                 << " conflicts" << std::endl;
+  d_solver->limit("conflicts", resource == 0 ? -1 : resource);
+  uint64_t conflictsBefore = d_statistics.d_numConflicts.get();
+  SatValue res = solve();
+  resource = d_statistics.d_numConflicts.get() - conflictsBefore;
+  Trace("limit") << "SatSolver::solve(): it took " << resource << " conflicts"
+                 << std::endl;
+  return res;
+}
+
+void CadicalCDCLTSolver::interrupt() { d_solver->terminate(); }
+
+SatValue CadicalCDCLTSolver::value(SatLiteral l)
+{
+  return d_propagator->value(l);
+}
+
+SatValue CadicalCDCLTSolver::modelValue(SatLiteral l)
+{
+  if (d_lastResult != SAT_VALUE_TRUE)
+  {
+    return SAT_VALUE_UNKNOWN;
+  }
+  return toSatValueLit(d_solver->val(toCadicalLit(l)));
+}
+
+unsigned CadicalCDCLTSolver::getAssertionLevel() const
+{
+  return d_activationLits.size();
+}
+
+bool CadicalCDCLTSolver::ok() const { return d_ok; }
+
+void CadicalCDCLTSolver::push()
+{
+  Assert(!d_inSearch);
+  d_propagator->resetTrail();
+  d_okStack.push_back(d_ok);
+  d_varsLim.push_back(d_nextVarIdx);
+  // the activation literal itself belongs to the level below
+  int act = toCadicalVar(newVar());
+  d_activationLits.push_back(act);
+  d_propagator->setActivationLit(act);
+  d_context->push();  // SAT context for CVC4
+}
+
+void CadicalCDCLTSolver::pop()
+{
+  Assert(!d_inSearch);
+  Assert(!d_activationLits.empty());
+  d_propagator->resetTrail();
+  d_context->pop();  // SAT context for CVC4
+
+  // disable the clauses of the popped level for good
+  int act = d_activationLits.back();
+  d_activationLits.pop_back();
+  d_solver->add(-act);
+  d_solver->add(0);
+  d_propagator->setActivationLit(
+      d_activationLits.empty() ? 0 : d_activationLits.back());
+
+  // the variables created at the popped level are dead
+  for (SatVariable var = d_varsLim.back() + 1; var < d_nextVarIdx; ++var)
+  {
+    d_propagator->removeVar(var);
+  }
+  d_varsLim.pop_back();
+
+  d_ok = d_okStack.back();
+  d_okStack.pop_back();
+  d_lastResult = SAT_VALUE_UNKNOWN;
+}
+
+void CadicalCDCLTSolver::resetTrail() { d_propagator->resetTrail(); }
+
+bool CadicalCDCLTSolver::properExplanation(SatLiteral lit,
+                                           SatLiteral expl) const
+{
+  return true;
+}
+
+void CadicalCDCLTSolver::requirePhase(SatLiteral lit)
+{
+  d_solver->phase(toCadicalLit(lit));
+}
+
+bool CadicalCDCLTSolver::isDecision(SatVariable decn) const
+{
+  return d_solver->is_decision(toCadicalVar(decn));
+}
+
+std::shared_ptr<ProofNode> CadicalCDCLTSolver::getProof()
+{
+  Unreachable() << "CaDiCaL as the DPLL(T) SAT solver does not support proofs";
+}
+
+CadicalCDCLTSolver::Statistics::Statistics(StatisticsRegistry* registry)
+    : d_registry(registry),
+      d_numSatCalls("sat::cadical::calls_to_solve", 0),
+      d_numVariables("sat::cadical::variables", 0),
+      d_numClauses("sat::cadical::clauses", 0),
+      d_numLemmas("sat::cadical::lemmas", 0),
+      d_numTheoryPropagations("sat::cadical::theory_propagations", 0),
+      d_numBacktracks("sat::cadical::backtracks", 0),
+      d_numConflicts("sat::cadical::conflicts", 0),
+      d_solveTime("sat::cadical::solve_time")
+{
+  d_registry->registerStat(&d_numSatCalls);
+  d_registry->registerStat(&d_numVariables);
+  d_registry->registerStat(&d_numClauses);
+  d_registry->registerStat(&d_numLemmas);
+  d_registry->registerStat(&d_numTheoryPropagations);
+  d_registry->registerStat(&d_numBacktracks);
+  d_registry->registerStat(&d_numConflicts);
+  d_registry->registerStat(&d_solveTime);
+}
+
+CadicalCDCLTSolver::Statistics::~Statistics()
+{
+  d_registry->unregisterStat(&d_numSatCalls);
+  d_registry->unregisterStat(&d_numVariables);
+  d_registry->unregisterStat(&d_numClauses);
+  d_registry->unregisterStat(&d_numLemmas);
+  d_registry->unregisterStat(&d_numTheoryPropagations);
+  d_registry->unregisterStat(&d_numBacktracks);
+  d_registry->unregisterStat(&d_numConflicts);
+  d_registry->unregisterStat(&d_solveTime);
+}
+
+#endif  // CVC4_USE_CADICAL_PROPAGATOR
+
 }  // namespace prop
 }  // namespace CVC5
 
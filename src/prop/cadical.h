@@ -21,6 +21,7 @@
 
 #ifdef CVC4_USE_CADICAL
 
+#include "prop/drat_writer.h"
 #include "prop/sat_solver.h"
 #include "util/stats_timer.h"
 
@@ -76,12 +77,20 @@ class CadicalSolver : public SatSolver
    */
   void init();
 
+  /** Add an input clause to the formula file of the DRAT proof */
+  void addDratInput(const SatClause& clause);
+
   std::unique_ptr<CaDiCaL::Solver> d_solver;
   /**
    * Stores the current set of assumptions provided via solve() and is used to
    * query the solver if a given assumption is false.
    */
   std::vector<SatLiteral> d_assumptions;
+  /**
+   * The formula file of the DRAT proof, if any. CaDiCaL writes the proof
+   * itself.
+   */
+  std::unique_ptr<DratWriter> d_drat;
 
   unsigned d_nextVarIdx;
   bool d_inSatMode;
@@ -102,6 +111,129 @@ class CadicalSolver : public SatSolver
   Statistics d_statistics;
 };
 
+#ifdef CVC4_USE_CADICAL_PROPAGATOR
+
+class CadicalPropagator;
+
+/**
+ * CaDiCaL as the SAT solver of the DPLL(T) search.
+ *
+ * The theories are hooked into the search of CaDiCaL through its external
+ * propagator interface (IPASIR-UP), see CadicalPropagator: assignments are
+ * asserted to the theories through the TheoryProxy, the SAT context is pushed
+ * and popped with the decision levels of CaDiCaL, and theory propagations,
+ * explanations, lemmas and decision requests are handed back to CaDiCaL from
+ * its callbacks.
+ *
+ * User-level push and pop are implemented with activation literals: every
+ * clause added at user level k > 0 contains the negation of the activation
+ * literal of level k, which is assumed in each call to solve() and asserted
+ * false when level k is popped.  Variables created at a popped user level are
+ * never reused.
+ *
+ * Proofs and unsat cores are not supported.
+ */
+class CadicalCDCLTSolver : public CDCLTSatSolverInterface
+{
+  friend class SatSolverFactory;
+
+ public:
+  ~CadicalCDCLTSolver() override;
+
+  void initialize(context::Context* context,
+                  TheoryProxy* theoryProxy,
+                  context::UserContext* userContext,
+                  ProofNodeManager* pnm) override;
+
+  ClauseId addClause(SatClause& clause, bool removable) override;
+
+  ClauseId addXorClause(SatClause& clause, bool rhs, bool removable) override;
+
+  SatVariable newVar(bool isTheoryAtom = false,
+                     bool preRegister = false,
+                     bool canErase = true) override;
+
+  SatVariable trueVar() override;
+
+  SatVariable falseVar() override;
+
+  SatValue solve() override;
+  SatValue solve(long unsigned int& resource) override;
+
+  void interrupt() override;
+
+  SatValue value(SatLiteral l) override;
+
+  SatValue modelValue(SatLiteral l) override;
+
+  unsigned getAssertionLevel() const override;
+
+  bool ok() const override;
+
+  void push() override;
+
+  void pop() override;
+
+  void resetTrail() override;
+
+  bool properExplanation(SatLiteral lit, SatLiteral expl) const override;
+
+  void requirePhase(SatLiteral lit) override;
+
+  bool isDecision(SatVariable decn) const override;
+
+  std::shared_ptr<ProofNode> getProof() override;
+
+  struct Statistics
+  {
+    StatisticsRegistry* d_registry;
+    IntStat d_numSatCalls;
+    IntStat d_numVariables;
+    IntStat d_numClauses;
+    IntStat d_numLemmas;
+    IntStat d_numTheoryPropagations;
+    IntStat d_numBacktracks;
+    IntStat d_numConflicts;
+    TimerStat d_solveTime;
+    Statistics(StatisticsRegistry* registry);
+    ~Statistics();
+  };
+
+ private:
+  /**
+   * Private to disallow creation outside of SatSolverFactory.
+   * Function initialize() must be called after creation.
+   */
+  CadicalCDCLTSolver(StatisticsRegistry* registry);
+
+  std::unique_ptr<CaDiCaL::Solver> d_solver;
+  std::unique_ptr<CadicalPropagator> d_propagator;
+
+  /** The SAT context, pushed and popped by the propagator */
+  context::Context* d_context;
+
+  /** The activation literal of each user level above 0 */
+  std::vector<int> d_activationLits;
+  /** The value of d_ok at each user push */
+  std::vector<bool> d_okStack;
+  /** The first variable created at each user level above 0 */
+  std::vector<SatVariable> d_varsLim;
+
+  unsigned d_nextVarIdx;
+  /** Whether we are inside a call to solve() of CaDiCaL */
+  bool d_inSearch;
+  /** False if the problem is unsatisfiable at the current user level */
+  bool d_ok;
+  /** The result of the last call to solve() */
+  SatValue d_lastResult;
+  SatVariable d_true;
+  SatVariable d_false;
+
+  Statistics d_statistics;
+};
+
+#endif  // CVC4_USE_CADICAL_PROPAGATOR
+
 }  // namespace prop
 }  // namespace CVC5
 
@@ -17,6 +17,7 @@
  **/
 #include "prop/cnf_stream.h"
 
+#include <algorithm>
 #include <queue>
 
 #include "base/check.h"
@@ -36,10 +37,21 @@
 #include "smt/smt_engine_scope.h"
 #include "theory/theory.h"
 #include "theory/theory_engine.h"
+#include "util/hash.h"
 
 namespace CVC5 {
 namespace prop {
 
+size_t GateSignatureHashFunction::operator()(const GateSignature& s) const
+{
+  uint64_t hash = fnv1a::fnv1a_64(static_cast<uint64_t>(s.d_kind));
+  for (const SatLiteral& lit : s.d_children)
+  {
+    hash = fnv1a::fnv1a_64(lit.hash(), hash);
+  }
+  return static_cast<size_t>(hash);
+}
+
 CnfStream::CnfStream(SatSolver* satSolver,
                      Registrar* registrar,
                      context::Context* context,
@@ -53,6 +65,10 @@ CnfStream::CnfStream(SatSolver* satSolver,
       d_notifyFormulas(context),
       d_nodeToLiteralMap(context),
       d_literalToNodeMap(context),
+      d_gateToLiteralMap(context),
+      d_definedSides(context),
+      d_polarityEncoding(false),
+      d_structuralHashing(false),
       d_flitPolicy(flpol),
       d_registrar(registrar),
       d_name(name),
@@ -151,6 +167,13 @@ void CnfStream::ensureLiteral(TNode n)
   Trace("cnf") << "ensureLiteral(" << n << ")\n";
   if (hasLiteral(n))
   {
+    if (d_polarityEncoding)
+    {
+      // the literal may only be defined on one side, while its value must be
+      // meaningful for both
+      d_removable = false;
+      toCNF(n, false, POL_BOTH);
+    }
     ensureMappingForLiteral(n);
     return;
   }
@@ -282,6 +305,17 @@ bool CnfStream::isNotifyFormula(TNode node) const
 void CnfStream::setProof(CnfProof* proof) {
   Assert(d_cnfProof == NULL);
   d_cnfProof = proof;
+  // clauses must be attributable to the formulas they define
+  d_polarityEncoding = false;
+  d_structuralHashing = false;
+}
+
+void CnfStream::setEncoding(bool polarity, bool structuralHashing)
+{
+  bool supported = d_cnfProof == nullptr
+                   && d_flitPolicy != FormulaLitPolicy::TRACK_AND_NOTIFY;
+  d_polarityEncoding = polarity && supported;
+  d_structuralHashing = structuralHashing && supported;
 }
 
 SatLiteral CnfStream::convertAtom(TNode node)
@@ -324,229 +358,383 @@ SatLiteral CnfStream::getLiteral(TNode node) {
   return literal;
 }
 
-SatLiteral CnfStream::handleXor(TNode xorNode)
+void CnfStream::collectChildren(TNode node, std::vector<TNode>& children)
+{
+  for (TNode child : node)
+  {
+    // a nested gate that has no literal yet is inlined rather than given a
+    // literal of its own
+    if (d_structuralHashing && child.getKind() == node.getKind()
+        && !hasLiteral(child))
+    {
+      collectChildren(child, children);
+    }
+    else
+    {
+      children.push_back(child);
+    }
+  }
+}
+
+uint8_t CnfStream::getDefinedSides(SatLiteral lit) const
+{
+  if (!d_polarityEncoding)
+  {
+    return POL_BOTH;
+  }
+  context::CDHashMap<SatVariable, uint8_t>::const_iterator it =
+      d_definedSides.find(lit.getSatVariable());
+  return it == d_definedSides.end() ? POL_BOTH : (*it).second;
+}
+
+SatLiteral CnfStream::gateLiteral(TNode node,
+                                  std::vector<SatLiteral>& children,
+                                  uint8_t& pol)
+{
+  Kind k = node.getKind();
+  if (d_structuralHashing)
+  {
+    if (k == kind::ITE)
+    {
+      // (ite (not c) t e) is (ite c e t)
+      if (children[0].isNegated())
+      {
+        children[0] = ~children[0];
+        std::swap(children[1], children[2]);
+      }
+    }
+    else if (k != kind::IMPLIES)
+    {
+      std::sort(children.begin(), children.end());
+      if (k == kind::AND || k == kind::OR)
+      {
+        children.erase(std::unique(children.begin(), children.end()),
+                       children.end());
+      }
+    }
+  }
+
+  SatLiteral lit;
+  bool isNew = false;
+  if (hasLiteral(node))
+  {
+    // we are asserting the missing side of a definition
+    lit = getLiteral(node);
+  }
+  else if (d_structuralHashing)
+  {
+    GateSignature sig{k, children};
+    GateToLiteralMap::const_iterator it = d_gateToLiteralMap.find(sig);
+    if (it != d_gateToLiteralMap.end())
+    {
+      lit = (*it).second;
+      Trace("cnf") << "gateLiteral(" << node << "): shared literal " << lit
+                   << "\n";
+      d_nodeToLiteralMap.insert(node, lit);
+      d_nodeToLiteralMap.insert(node.notNode(), ~lit);
+    }
+    else
+    {
+      lit = newLiteral(node);
+      isNew = true;
+      d_gateToLiteralMap.insert(sig, lit);
+    }
+  }
+  else
+  {
+    lit = newLiteral(node);
+    isNew = true;
+  }
+  Assert(!lit.isNegated()) << "gate literals are positive";
+
+  uint8_t defined = isNew ? POL_NONE : getDefinedSides(lit);
+  pol &= ~defined;
+  if (d_polarityEncoding && pol != POL_NONE)
+  {
+    d_definedSides[lit.getSatVariable()] = defined | pol;
+  }
+  return lit;
+}
+
+SatLiteral CnfStream::handleXor(TNode xorNode, uint8_t pol)
 {
-  Assert(!hasLiteral(xorNode)) << "Atom already mapped!";
   Assert(xorNode.getKind() == kind::XOR) << "Expecting an XOR expression!";
   Assert(xorNode.getNumChildren() == 2) << "Expecting exactly 2 children!";
   Assert(!d_removable) << "Removable clauses can not contain Boolean structure";
   Trace("cnf") << "CnfStream::handleXor(" << xorNode << ")\n";
 
-  SatLiteral a = toCNF(xorNode[0]);
-  SatLiteral b = toCNF(xorNode[1]);
-
-  SatLiteral xorLit = newLiteral(xorNode);
+  std::vector<SatLiteral> children{toCNF(xorNode[0]), toCNF(xorNode[1])};
+  SatLiteral xorLit = gateLiteral(xorNode, children, pol);
+  SatLiteral a = children[0];
+  SatLiteral b = children[1];
 
-  assertClause(xorNode.negate(), a, b, ~xorLit);
-  assertClause(xorNode.negate(), ~a, ~b, ~xorLit);
-  assertClause(xorNode, a, ~b, xorLit);
-  assertClause(xorNode, ~a, b, xorLit);
+  if (pol & POL_POS)
+  {
+    assertClause(xorNode.negate(), a, b, ~xorLit);
+    assertClause(xorNode.negate(), ~a, ~b, ~xorLit);
+  }
+  if (pol & POL_NEG)
+  {
+    assertClause(xorNode, a, ~b, xorLit);
+    assertClause(xorNode, ~a, b, xorLit);
+  }
 
   return xorLit;
 }
 
-SatLiteral CnfStream::handleOr(TNode orNode)
+SatLiteral CnfStream::handleOr(TNode orNode, uint8_t pol)
 {
-  Assert(!hasLiteral(orNode)) << "Atom already mapped!";
   Assert(orNode.getKind() == kind::OR) << "Expecting an OR expression!";
   Assert(orNode.getNumChildren() > 1) << "Expecting more then 1 child!";
   Assert(!d_removable) << "Removable clauses can not contain Boolean structure";
   Trace("cnf") << "CnfStream::handleOr(" << orNode << ")\n";
 
-  // Number of children
-  unsigned n_children = orNode.getNumChildren();
-
   // Transform all the children first
-  TNode::const_iterator node_it = orNode.begin();
-  TNode::const_iterator node_it_end = orNode.end();
-  SatClause clause(n_children + 1);
-  for(int i = 0; node_it != node_it_end; ++node_it, ++i) {
-    clause[i] = toCNF(*node_it);
+  std::vector<TNode> children;
+  collectChildren(orNode, children);
+  std::vector<SatLiteral> lits;
+  for (TNode child : children)
+  {
+    lits.push_back(toCNF(child, false, pol));
   }
 
   // Get the literal for this node
-  SatLiteral orLit = newLiteral(orNode);
+  SatLiteral orLit = gateLiteral(orNode, lits, pol);
+  unsigned n_children = lits.size();
 
-  // lit <- (a_1 | a_2 | a_3 | ... | a_n)
-  // lit | ~(a_1 | a_2 | a_3 | ... | a_n)
-  // (lit | ~a_1) & (lit | ~a_2) & (lit & ~a_3) & ... & (lit & ~a_n)
-  for(unsigned i = 0; i < n_children; ++i) {
-    assertClause(orNode, orLit, ~clause[i]);
+  if (pol & POL_NEG)
+  {
+    // lit <- (a_1 | a_2 | a_3 | ... | a_n)
+    // lit | ~(a_1 | a_2 | a_3 | ... | a_n)
+    // (lit | ~a_1) & (lit | ~a_2) & (lit & ~a_3) & ... & (lit & ~a_n)
+    for (unsigned i = 0; i < n_children; ++i)
+    {
+      assertClause(orNode, orLit, ~lits[i]);
+    }
   }
 
-  // lit -> (a_1 | a_2 | a_3 | ... | a_n)
-  // ~lit | a_1 | a_2 | a_3 | ... | a_n
-  clause[n_children] = ~orLit;
-  // This needs to go last, as the clause might get modified by the SAT solver
-  assertClause(orNode.negate(), clause);
+  if (pol & POL_POS)
+  {
+    // lit -> (a_1 | a_2 | a_3 | ... | a_n)
+    // ~lit | a_1 | a_2 | a_3 | ... | a_n
+    SatClause clause(lits.begin(), lits.end());
+    clause.push_back(~orLit);
+    // This needs to go last, as the clause might get modified by the SAT
+    // solver
+    assertClause(orNode.negate(), clause);
+  }
 
   // Return the literal
   return orLit;
 }
 
-SatLiteral CnfStream::handleAnd(TNode andNode)
+SatLiteral CnfStream::handleAnd(TNode andNode, uint8_t pol)
 {
-  Assert(!hasLiteral(andNode)) << "Atom already mapped!";
   Assert(andNode.getKind() == kind::AND) << "Expecting an AND expression!";
   Assert(andNode.getNumChildren() > 1) << "Expecting more than 1 child!";
   Assert(!d_removable) << "Removable clauses can not contain Boolean structure";
   Trace("cnf") << "handleAnd(" << andNode << ")\n";
 
-  // Number of children
-  unsigned n_children = andNode.getNumChildren();
-
-  // Transform all the children first (remembering the negation)
-  TNode::const_iterator node_it = andNode.begin();
-  TNode::const_iterator node_it_end = andNode.end();
-  SatClause clause(n_children + 1);
-  for(int i = 0; node_it != node_it_end; ++node_it, ++i) {
-    clause[i] = ~toCNF(*node_it);
+  // Transform all the children first
+  std::vector<TNode> children;
+  collectChildren(andNode, children);
+  std::vector<SatLiteral> lits;
+  for (TNode child : children)
+  {
+    lits.push_back(toCNF(child, false, pol));
   }
 
   // Get the literal for this node
-  SatLiteral andLit = newLiteral(andNode);
+  SatLiteral andLit = gateLiteral(andNode, lits, pol);
+  unsigned n_children = lits.size();
 
-  // lit -> (a_1 & a_2 & a_3 & ... & a_n)
-  // ~lit | (a_1 & a_2 & a_3 & ... & a_n)
-  // (~lit | a_1) & (~lit | a_2) & ... & (~lit | a_n)
-  for(unsigned i = 0; i < n_children; ++i) {
-    assertClause(andNode.negate(), ~andLit, ~clause[i]);
+  if (pol & POL_POS)
+  {
+    // lit -> (a_1 & a_2 & a_3 & ... & a_n)
+    // ~lit | (a_1 & a_2 & a_3 & ... & a_n)
+    // (~lit | a_1) & (~lit | a_2) & ... & (~lit | a_n)
+    for (unsigned i = 0; i < n_children; ++i)
+    {
+      assertClause(andNode.negate(), ~andLit, lits[i]);
+    }
   }
 
-  // lit <- (a_1 & a_2 & a_3 & ... a_n)
-  // lit | ~(a_1 & a_2 & a_3 & ... & a_n)
-  // lit | ~a_1 | ~a_2 | ~a_3 | ... | ~a_n
-  clause[n_children] = andLit;
-  // This needs to go last, as the clause might get modified by the SAT solver
-  assertClause(andNode, clause);
+  if (pol & POL_NEG)
+  {
+    // lit <- (a_1 & a_2 & a_3 & ... a_n)
+    // lit | ~(a_1 & a_2 & a_3 & ... & a_n)
+    // lit | ~a_1 | ~a_2 | ~a_3 | ... | ~a_n
+    SatClause clause(n_children + 1);
+    for (unsigned i = 0; i < n_children; ++i)
+    {
+      clause[i] = ~lits[i];
+    }
+    clause[n_children] = andLit;
+    // This needs to go last, as the clause might get modified by the SAT
+    // solver
+    assertClause(andNode, clause);
+  }
 
   return andLit;
 }
 
-SatLiteral CnfStream::handleImplies(TNode impliesNode)
+SatLiteral CnfStream::handleImplies(TNode impliesNode, uint8_t pol)
 {
-  Assert(!hasLiteral(impliesNode)) << "Atom already mapped!";
   Assert(impliesNode.getKind() == kind::IMPLIES)
       << "Expecting an IMPLIES expression!";
   Assert(impliesNode.getNumChildren() == 2) << "Expecting exactly 2 children!";
   Assert(!d_removable) << "Removable clauses can not contain Boolean structure";
   Trace("cnf") << "handleImplies(" << impliesNode << ")\n";
 
-  // Convert the children to cnf
-  SatLiteral a = toCNF(impliesNode[0]);
-  SatLiteral b = toCNF(impliesNode[1]);
-
-  SatLiteral impliesLit = newLiteral(impliesNode);
+  // Convert the children to cnf, the antecedent occurs negated
+  std::vector<SatLiteral> children{
+      toCNF(impliesNode[0], false, flipPolarity(pol)),
+      toCNF(impliesNode[1], false, pol)};
+  SatLiteral impliesLit = gateLiteral(impliesNode, children, pol);
+  SatLiteral a = children[0];
+  SatLiteral b = children[1];
 
-  // lit -> (a->b)
-  // ~lit | ~ a | b
-  assertClause(impliesNode.negate(), ~impliesLit, ~a, b);
+  if (pol & POL_POS)
+  {
+    // lit -> (a->b)
+    // ~lit | ~ a | b
+    assertClause(impliesNode.negate(), ~impliesLit, ~a, b);
+  }
 
-  // (a->b) -> lit
-  // ~(~a | b) | lit
-  // (a | l) & (~b | l)
-  assertClause(impliesNode, a, impliesLit);
-  assertClause(impliesNode, ~b, impliesLit);
+  if (pol & POL_NEG)
+  {
+    // (a->b) -> lit
+    // ~(~a | b) | lit
+    // (a | l) & (~b | l)
+    assertClause(impliesNode, a, impliesLit);
+    assertClause(impliesNode, ~b, impliesLit);
+  }
 
   return impliesLit;
 }
 
-SatLiteral CnfStream::handleIff(TNode iffNode)
+SatLiteral CnfStream::handleIff(TNode iffNode, uint8_t pol)
 {
-  Assert(!hasLiteral(iffNode)) << "Atom already mapped!";
   Assert(iffNode.getKind() == kind::EQUAL) << "Expecting an EQUAL expression!";
   Assert(iffNode.getNumChildren() == 2) << "Expecting exactly 2 children!";
   Assert(!d_removable) << "Removable clauses can not contain Boolean structure";
   Trace("cnf") << "handleIff(" << iffNode << ")\n";
 
   // Convert the children to CNF
-  SatLiteral a = toCNF(iffNode[0]);
-  SatLiteral b = toCNF(iffNode[1]);
+  std::vector<SatLiteral> children{toCNF(iffNode[0]), toCNF(iffNode[1])};
 
   // Get the now literal
-  SatLiteral iffLit = newLiteral(iffNode);
-
-  // lit -> ((a-> b) & (b->a))
-  // ~lit | ((~a | b) & (~b | a))
-  // (~a | b | ~lit) & (~b | a | ~lit)
-  assertClause(iffNode.negate(), ~a, b, ~iffLit);
-  assertClause(iffNode.negate(), a, ~b, ~iffLit);
-
-  // (a<->b) -> lit
-  // ~((a & b) | (~a & ~b)) | lit
-  // (~(a & b)) & (~(~a & ~b)) | lit
-  // ((~a | ~b) & (a | b)) | lit
-  // (~a | ~b | lit) & (a | b | lit)
-  assertClause(iffNode, ~a, ~b, iffLit);
-  assertClause(iffNode, a, b, iffLit);
+  SatLiteral iffLit = gateLiteral(iffNode, children, pol);
+  SatLiteral a = children[0];
+  SatLiteral b = children[1];
+
+  if (pol & POL_POS)
+  {
+    // lit -> ((a-> b) & (b->a))
+    // ~lit | ((~a | b) & (~b | a))
+    // (~a | b | ~lit) & (~b | a | ~lit)
+    assertClause(iffNode.negate(), ~a, b, ~iffLit);
+    assertClause(iffNode.negate(), a, ~b, ~iffLit);
+  }
+
+  if (pol & POL_NEG)
+  {
+    // (a<->b) -> lit
+    // ~((a & b) | (~a & ~b)) | lit
+    // (~(a & b)) & (~(~a & ~b)) | lit
+    // ((~a | ~b) & (a | b)) | lit
+    // (~a | ~b | lit) & (a | b | lit)
+    assertClause(iffNode, ~a, ~b, iffLit);
+    assertClause(iffNode, a, b, iffLit);
+  }
 
   return iffLit;
 }
 
-SatLiteral CnfStream::handleIte(TNode iteNode)
+SatLiteral CnfStream::handleIte(TNode iteNode, uint8_t pol)
 {
-  Assert(!hasLiteral(iteNode)) << "Atom already mapped!";
   Assert(iteNode.getKind() == kind::ITE);
   Assert(iteNode.getNumChildren() == 3);
   Assert(!d_removable) << "Removable clauses can not contain Boolean structure";
   Trace("cnf") << "handleIte(" << iteNode[0] << " " << iteNode[1] << " "
                << iteNode[2] << ")\n";
 
-  SatLiteral condLit = toCNF(iteNode[0]);
-  SatLiteral thenLit = toCNF(iteNode[1]);
-  SatLiteral elseLit = toCNF(iteNode[2]);
-
-  SatLiteral iteLit = newLiteral(iteNode);
-
-  // If ITE is true then one of the branches is true and the condition
-  // implies which one
-  // lit -> (ite b t e)
-  // lit -> (t | e) & (b -> t) & (!b -> e)
-  // lit -> (t | e) & (!b | t) & (b | e)
-  // (!lit | t | e) & (!lit | !b | t) & (!lit | b | e)
-  assertClause(iteNode.negate(), ~iteLit, thenLit, elseLit);
-  assertClause(iteNode.negate(), ~iteLit, ~condLit, thenLit);
-  assertClause(iteNode.negate(), ~iteLit, condLit, elseLit);
-
-  // If ITE is false then one of the branches is false and the condition
-  // implies which one
-  // !lit -> !(ite b t e)
-  // !lit -> (!t | !e) & (b -> !t) & (!b -> !e)
-  // !lit -> (!t | !e) & (!b | !t) & (b | !e)
-  // (lit | !t | !e) & (lit | !b | !t) & (lit | b | !e)
-  assertClause(iteNode, iteLit, ~thenLit, ~elseLit);
-  assertClause(iteNode, iteLit, ~condLit, ~thenLit);
-  assertClause(iteNode, iteLit, condLit, ~elseLit);
+  std::vector<SatLiteral> children{toCNF(iteNode[0]),
+                                   toCNF(iteNode[1], false, pol),
+                                   toCNF(iteNode[2], false, pol)};
+  SatLiteral iteLit = gateLiteral(iteNode, children, pol);
+  SatLiteral condLit = children[0];
+  SatLiteral thenLit = children[1];
+  SatLiteral elseLit = children[2];
+
+  if (pol & POL_POS)
+  {
+    // If ITE is true then one of the branches is true and the condition
+    // implies which one
+    // lit -> (ite b t e)
+    // lit -> (t | e) & (b -> t) & (!b -> e)
+    // lit -> (t | e) & (!b | t) & (b | e)
+    // (!lit | t | e) & (!lit | !b | t) & (!lit | b | e)
+    assertClause(iteNode.negate(), ~iteLit, thenLit, elseLit);
+    assertClause(iteNode.negate(), ~iteLit, ~condLit, thenLit);
+    assertClause(iteNode.negate(), ~iteLit, condLit, elseLit);
+  }
+
+  if (pol & POL_NEG)
+  {
+    // If ITE is false then one of the branches is false and the condition
+    // implies which one
+    // !lit -> !(ite b t e)
+    // !lit -> (!t | !e) & (b -> !t) & (!b -> !e)
+    // !lit -> (!t | !e) & (!b | !t) & (b | !e)
+    // (lit | !t | !e) & (lit | !b | !t) & (lit | b | !e)
+    assertClause(iteNode, iteLit, ~thenLit, ~elseLit);
+    assertClause(iteNode, iteLit, ~condLit, ~thenLit);
+    assertClause(iteNode, iteLit, condLit, ~elseLit);
+  }
 
   return iteLit;
 }
 
-SatLiteral CnfStream::toCNF(TNode node, bool negated)
+SatLiteral CnfStream::toCNF(TNode node, bool negated, uint8_t pol)
 {
   Trace("cnf") << "toCNF(" << node
                << ", negated = " << (negated ? "true" : "false") << ")\n";
+  if (!d_polarityEncoding)
+  {
+    pol = POL_BOTH;
+  }
+  else if (node.getKind() == kind::NOT)
+  {
+    // the sides of the definition of the child are swapped
+    return toCNF(node[0], !negated, flipPolarity(pol));
+  }
   SatLiteral nodeLit;
   Node negatedNode = node.notNode();
 
   // If the non-negated node has already been translated, get the translation
   if(hasLiteral(node)) {
-    Trace("cnf") << "toCNF(): already translated\n";
     nodeLit = getLiteral(node);
-    // Return the (maybe negated) literal
-    return !negated ? nodeLit : ~nodeLit;
+    if ((pol & ~getDefinedSides(nodeLit)) == POL_NONE)
+    {
+      Trace("cnf") << "toCNF(): already translated\n";
+      // Return the (maybe negated) literal
+      return !negated ? nodeLit : ~nodeLit;
+    }
+    Trace("cnf") << "toCNF(): asserting missing side of definition\n";
   }
   // Handle each Boolean operator case
   switch (node.getKind())
   {
     case kind::NOT: nodeLit = ~toCNF(node[0]); break;
-    case kind::XOR: nodeLit = handleXor(node); break;
-    case kind::ITE: nodeLit = handleIte(node); break;
-    case kind::IMPLIES: nodeLit = handleImplies(node); break;
-    case kind::OR: nodeLit = handleOr(node); break;
-    case kind::AND: nodeLit = handleAnd(node); break;
+    case kind::XOR: nodeLit = handleXor(node, pol); break;
+    case kind::ITE: nodeLit = handleIte(node, pol); break;
+    case kind::IMPLIES: nodeLit = handleImplies(node, pol); break;
+    case kind::OR: nodeLit = handleOr(node, pol); break;
+    case kind::AND: nodeLit = handleAnd(node, pol); break;
     case kind::EQUAL:
-      nodeLit =
-          node[0].getType().isBoolean() ? handleIff(node) : convertAtom(node);
+      nodeLit = node[0].getType().isBoolean() ? handleIff(node, pol)
+                                              : convertAtom(node);
       break;
     default:
     {
@@ -578,7 +766,7 @@ void CnfStream::convertAndAssertAnd(TNode node, bool negated)
     TNode::const_iterator disjunct = node.begin();
     for(int i = 0; i < nChildren; ++ disjunct, ++ i) {
       Assert(disjunct != node.end());
-      clause[i] = toCNF(*disjunct, true);
+      clause[i] = toCNF(*disjunct, true, POL_NEG);
     }
     Assert(disjunct == node.end());
     assertClause(node.negate(), clause);
@@ -597,7 +785,7 @@ void CnfStream::convertAndAssertOr(TNode node, bool negated)
     TNode::const_iterator disjunct = node.begin();
     for(int i = 0; i < nChildren; ++ disjunct, ++ i) {
       Assert(disjunct != node.end());
-      clause[i] = toCNF(*disjunct, false);
+      clause[i] = toCNF(*disjunct, false, POL_POS);
     }
     Assert(disjunct == node.end());
     assertClause(node, clause);
@@ -685,8 +873,8 @@ void CnfStream::convertAndAssertImplies(TNode node, bool negated)
                << ", negated = " << (negated ? "true" : "false") << ")\n";
   if (!negated) {
     // p => q
-    SatLiteral p = toCNF(node[0], false);
-    SatLiteral q = toCNF(node[1], false);
+    SatLiteral p = toCNF(node[0], false, POL_NEG);
+    SatLiteral q = toCNF(node[1], false, POL_POS);
     // Construct the clause ~p || q
     SatClause clause(2);
     clause[0] = ~p;
@@ -706,8 +894,8 @@ void CnfStream::convertAndAssertIte(TNode node, bool negated)
                << ", negated = " << (negated ? "true" : "false") << ")\n";
   // ITE(p, q, r)
   SatLiteral p = toCNF(node[0], false);
-  SatLiteral q = toCNF(node[1], negated);
-  SatLiteral r = toCNF(node[2], negated);
+  SatLiteral q = toCNF(node[1], negated, polarityOf(negated));
+  SatLiteral r = toCNF(node[2], negated, polarityOf(negated));
   // Construct the clauses:
   // (p => q) and (!p => r)
   //
@@ -781,7 +969,7 @@ void CnfStream::convertAndAssert(TNode node, bool negated)
         nnode = node.negate();
       }
       // Atoms
-      assertClause(nnode, toCNF(node, negated));
+      assertClause(nnode, toCNF(node, negated, polarityOf(negated)));
   }
     break;
   }
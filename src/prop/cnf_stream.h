@@ -25,6 +25,9 @@
 #ifndef CVC4__PROP__CNF_STREAM_H
 #define CVC4__PROP__CNF_STREAM_H
 
+#include <vector>
+
+#include "context/cdhashmap.h"
 #include "context/cdhashset.h"
 #include "context/cdinsert_hashmap.h"
 #include "context/cdlist.h"
@@ -55,6 +58,26 @@ enum class FormulaLitPolicy : uint32_t
   INTERNAL,
 };
 
+/**
+ * The signature of a gate for structural hashing: its kind and the literals
+ * of its (possibly flattened) children, sorted for commutative kinds.
+ */
+struct GateSignature
+{
+  Kind d_kind;
+  std::vector<SatLiteral> d_children;
+
+  bool operator==(const GateSignature& s) const
+  {
+    return d_kind == s.d_kind && d_children == s.d_children;
+  }
+};
+
+struct GateSignatureHashFunction
+{
+  size_t operator()(const GateSignature& s) const;
+};
+
 /**
  * Implements the following recursive algorithm
  * http://people.inf.ethz.ch/daniekro/classes/251-0247-00/f2007/readings/Tseitin70.pdf
@@ -63,6 +86,15 @@ enum class FormulaLitPolicy : uint32_t
  * The general idea is to introduce a new literal that will be equivalent to
  * each subexpression in the constructed equi-satisfiable formula, then
  * substitute the new literal for the formula, and so on, recursively.
+ *
+ * Two optional refinements of the encoding are available, see setEncoding().
+ * With the polarity-aware (Plaisted-Greenbaum) encoding, only the sides of
+ * the definition of a gate literal that are needed by the polarities in
+ * which the gate occurs are asserted; the missing side is added when the gate
+ * later occurs with the other polarity. With structural hashing, gates with
+ * the same kind and the same child literals (up to permutation, for
+ * commutative kinds) share a single literal, and nested AND/OR gates are
+ * flattened into n-ary ones.
  */
 class CnfStream {
   friend PropEngine;
@@ -77,6 +109,11 @@ class CnfStream {
   typedef context::CDInsertHashMap<Node, SatLiteral, NodeHashFunction>
       NodeToLiteralMap;
 
+  /** Cache of the literals of gates, for structural hashing. */
+  typedef context::
+      CDInsertHashMap<GateSignature, SatLiteral, GateSignatureHashFunction>
+          GateToLiteralMap;
+
   /**
    * Constructs a CnfStream that performs equisatisfiable CNF transformations
    * and sends the generated clauses and to the given SAT solver. This does not
@@ -166,7 +203,43 @@ class CnfStream {
 
   void setProof(CnfProof* proof);
 
+  /**
+   * Configure the encoding of Boolean structure. Both refinements are only
+   * used if formula literals are not notified (see FormulaLitPolicy) and no
+   * proof is set, since they break the one-to-one correspondence between
+   * formulas and their definitional clauses.
+   *
+   * @param polarity whether to only define the sides of gates that are
+   * needed by the polarities in which they occur
+   * @param structuralHashing whether to share the literals of structurally
+   * equal gates and to flatten nested AND/OR gates
+   */
+  void setEncoding(bool polarity, bool structuralHashing);
+
  protected:
+  /**
+   * The sides of the definition of a gate literal. POL_POS is the side
+   * lit -> gate, needed where the gate occurs positively, and POL_NEG the
+   * side gate -> lit, needed where it occurs negatively.
+   */
+  enum Polarity : uint8_t
+  {
+    POL_NONE = 0,
+    POL_POS = 1,
+    POL_NEG = 2,
+    POL_BOTH = 3
+  };
+  /** The polarity of a literal that occurs negated (or not) in a clause */
+  static uint8_t polarityOf(bool negated)
+  {
+    return negated ? POL_NEG : POL_POS;
+  }
+  /** Swap the sides in pol, for a gate under a negation */
+  static uint8_t flipPolarity(uint8_t pol)
+  {
+    return ((pol & POL_POS) << 1) | ((pol & POL_NEG) >> 1);
+  }
+
   /**
    * Same as above, except that uses the saved d_removable flag. It calls the
    * dedicated converter for the possible formula kinds.
@@ -190,20 +263,45 @@ class CnfStream {
    *
    * @param node the formula to transform
    * @param negated whether the literal is negated
+   * @param pol the sides of the definition of node that are required; this
+   * is only relevant for the polarity-aware encoding
    * @return the literal representing the root of the formula
    */
-  SatLiteral toCNF(TNode node, bool negated = false);
+  SatLiteral toCNF(TNode node, bool negated = false, uint8_t pol = POL_BOTH);
 
   /** Specific clausifiers, based on the formula kinds, that clausify a formula,
    * by calling toCNF into each of the formula's children under the respective
-   * kind, and introduce a literal definitionally equal to it. */
+   * kind, and introduce a literal definitionally equal to it. Only the sides
+   * of the definition in pol that are not asserted yet are asserted. */
   SatLiteral handleNot(TNode node);
-  SatLiteral handleXor(TNode node);
-  SatLiteral handleImplies(TNode node);
-  SatLiteral handleIff(TNode node);
-  SatLiteral handleIte(TNode node);
-  SatLiteral handleAnd(TNode node);
-  SatLiteral handleOr(TNode node);
+  SatLiteral handleXor(TNode node, uint8_t pol);
+  SatLiteral handleImplies(TNode node, uint8_t pol);
+  SatLiteral handleIff(TNode node, uint8_t pol);
+  SatLiteral handleIte(TNode node, uint8_t pol);
+  SatLiteral handleAnd(TNode node, uint8_t pol);
+  SatLiteral handleOr(TNode node, uint8_t pol);
+
+  /**
+   * Collect the children of the AND/OR node into children, flattening
+   * nested gates of the same kind that have no literal yet if structural
+   * hashing is enabled.
+   */
+  void collectChildren(TNode node, std::vector<TNode>& children);
+  /**
+   * Get the literal of the gate node whose children have the given literals,
+   * reusing the literal of a structurally equal gate if structural hashing is
+   * enabled, or making a new one otherwise. For commutative kinds, the
+   * children are sorted (and, for AND/OR, deduplicated) in place.
+   *
+   * On return, pol contains the sides of the definition that the caller
+   * must assert, i.e., those that were requested but not asserted yet. They
+   * are recorded as asserted.
+   */
+  SatLiteral gateLiteral(TNode node,
+                         std::vector<SatLiteral>& children,
+                         uint8_t& pol);
+  /** Get the sides of the definition of lit that have been asserted */
+  uint8_t getDefinedSides(SatLiteral lit) const;
 
   /** Stores the literal of the given node in d_literalToNodeMap.
    *
@@ -229,6 +327,17 @@ class CnfStream {
 
   /** Map from literals to nodes */
   LiteralToNodeMap d_literalToNodeMap;
+  /** Map from gate signatures to their literals, for structural hashing */
+  GateToLiteralMap d_gateToLiteralMap;
+  /**
+   * The asserted sides of the definitions of gate literals, for the
+   * polarity-aware encoding. Variables not in this map are fully defined.
+   */
+  context::CDHashMap<SatVariable, uint8_t> d_definedSides;
+  /** Whether to use the polarity-aware encoding */
+  bool d_polarityEncoding;
+  /** Whether to use structural hashing and flattening of gates */
+  bool d_structuralHashing;
 
   /**
    * True if the lit-to-Node map should be kept for all lits, not just
@@ -0,0 +1,206 @@
+/*********************                                                        */
+/*! \file drat_writer.cpp
+ ** \verbatim
+ ** This file is part of the CVC4 project.
+ ** Copyright (c) 2009-2021 by the authors listed in the file AUTHORS
+ ** in the top-level source directory and their institutional affiliations.
+ ** All rights reserved.  See the file COPYING in the top-level source
+ ** directory for licensing information.\endverbatim
+ **
+ ** \brief Streaming DRAT proofs of the SAT solvers
+ **
+ ** Streaming output of DRAT proofs of the SAT solvers, together with the
+ ** clauses they were given.
+ **/
+
+#include "prop/drat_writer.h"
+
+#include <atomic>
+
+#include "base/check.h"
+#include "base/output.h"
+#include "options/option_exception.h"
+#include "options/prop_options.h"
+
+namespace CVC5 {
+namespace prop {
+
+namespace {
+
+/** The width of the header line of the formula file, without the newline */
+constexpr size_t HEADER_WIDTH = 48;
+
+/** The number of writers created so far, for naming the files */
+std::atomic<uint32_t> s_numWriters(0);
+
+/** Get the DIMACS variable of a literal in the Minisat encoding */
+uint64_t dimacsVar(int lit) { return (static_cast<uint64_t>(lit) >> 1) + 1; }
+
+}  // namespace
+
+std::unique_ptr<DratWriter> DratWriter::create(const std::string& name,
+                                               bool withProof)
+{
+  if (options::dratFile().empty())
+  {
+    return nullptr;
+  }
+  uint32_t id = s_numWriters++;
+  std::string path = options::dratFile();
+  if (id > 0)
+  {
+    path += "." + std::to_string(id);
+  }
+  Notice() << "DratWriter: writing the DRAT proof of " << name << " to "
+           << path << std::endl;
+  return std::unique_ptr<DratWriter>(
+      new DratWriter(path, name, withProof, options::dratBinary()));
+}
+
+DratWriter::DratWriter(const std::string& path,
+                       const std::string& name,
+                       bool withProof,
+                       bool binary)
+    : d_proofPath(path),
+      d_binary(binary),
+      d_numVars(0),
+      d_numInputs(0),
+      d_done(false)
+{
+  d_formula.open(path + ".cnf");
+  if (!d_formula)
+  {
+    throw OptionException("cannot open DRAT formula file " + path + ".cnf");
+  }
+  if (withProof)
+  {
+    d_proof.open(path, binary ? std::ios::binary : std::ios::out);
+    if (!d_proof)
+    {
+      throw OptionException("cannot open DRAT proof file " + path);
+    }
+  }
+  d_formula << "c clauses given to the SAT solver " << name << "\n";
+  d_headerPos = d_formula.tellp();
+  writeHeader();
+}
+
+DratWriter::~DratWriter() { writeHeader(); }
+
+void DratWriter::writeHeader()
+{
+  std::string header =
+      "p cnf " + std::to_string(d_numVars) + " " + std::to_string(d_numInputs);
+  Assert(header.size() <= HEADER_WIDTH);
+  header.resize(HEADER_WIDTH, ' ');
+  std::streampos end = d_formula.tellp();
+  d_formula.seekp(d_headerPos);
+  d_formula << header << "\n";
+  if (end > d_formula.tellp())
+  {
+    d_formula.seekp(end);
+  }
+}
+
+void DratWriter::addInputLiteral(int lit)
+{
+  uint64_t var = dimacsVar(lit);
+  d_numVars = std::max(d_numVars, var);
+  if (lit & 1)
+  {
+    d_formula << '-';
+  }
+  d_formula << var << ' ';
+}
+
+void DratWriter::endInput()
+{
+  d_formula << "0\n";
+  ++d_numInputs;
+}
+
+void DratWriter::startStep(char kind)
+{
+  if (!d_proof.is_open())
+  {
+    return;
+  }
+  if (d_binary)
+  {
+    d_proof.put(kind);
+  }
+  else if (kind == 'd')
+  {
+    d_proof << "d ";
+  }
+}
+
+void DratWriter::addProofLiteral(int lit)
+{
+  if (!d_proof.is_open())
+  {
+    return;
+  }
+  uint64_t var = dimacsVar(lit);
+  d_numVars = std::max(d_numVars, var);
+  if (d_binary)
+  {
+    // variable-length encoding of 2 * var + sign, 7 bits at a time
+    uint64_t u = 2 * var + (lit & 1);
+    while (u > 0x7f)
+    {
+      d_proof.put(static_cast<char>((u & 0x7f) | 0x80));
+      u >>= 7;
+    }
+    d_proof.put(static_cast<char>(u));
+  }
+  else
+  {
+    if (lit & 1)
+    {
+      d_proof << '-';
+    }
+    d_proof << var << ' ';
+  }
+}
+
+void DratWriter::endStep()
+{
+  if (!d_proof.is_open())
+  {
+    return;
+  }
+  if (d_binary)
+  {
+    d_proof.put(0);
+  }
+  else
+  {
+    d_proof << "0\n";
+  }
+}
+
+void DratWriter::addEmpty()
+{
+  if (d_done)
+  {
+    return;
+  }
+  d_done = true;
+  startStep('a');
+  endStep();
+  flush();
+}
+
+void DratWriter::flush()
+{
+  writeHeader();
+  d_formula.flush();
+  if (d_proof.is_open())
+  {
+    d_proof.flush();
+  }
+}
+
+}  // namespace prop
+}  // namespace CVC5
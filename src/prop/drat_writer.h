@@ -0,0 +1,177 @@
+/*********************                                                        */
+/*! \file drat_writer.h
+ ** \verbatim
+ ** This file is part of the CVC4 project.
+ ** Copyright (c) 2009-2021 by the authors listed in the file AUTHORS
+ ** in the top-level source directory and their institutional affiliations.
+ ** All rights reserved.  See the file COPYING in the top-level source
+ ** directory for licensing information.\endverbatim
+ **
+ ** \brief Streaming DRAT proofs of the SAT solvers
+ **
+ ** Streaming output of DRAT proofs of the SAT solvers, together with the
+ ** clauses they were given.
+ **/
+
+#include "cvc4_private.h"
+
+#ifndef CVC4__PROP__DRAT_WRITER_H
+#define CVC4__PROP__DRAT_WRITER_H
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+
+namespace CVC5 {
+namespace prop {
+
+/** Literals that are already in the Minisat encoding */
+inline int toInt(int lit) { return lit; }
+
+/**
+ * Writes the DRAT proof of a SAT solver to a file while the solver runs, so
+ * that no part of the proof is kept in memory.
+ *
+ * The clauses given to the solver, i.e., input clauses and theory lemmas and
+ * explanations, are trusted. They are written in DIMACS format to a second
+ * file, the formula file, against which standard checkers can check the
+ * proof, e.g.:
+ *
+ *   drat-trim FILE.cnf FILE
+ *
+ * The proof is a refutation of the formula file if it ends with the empty
+ * clause, i.e., if the solver found the clauses unsatisfiable without
+ * assumptions.
+ *
+ * Literals are given in the Minisat encoding 2 * var + sign, with variables
+ * numbered from 0, and clauses as anything with size() and operator[] on
+ * literals for which toInt() gives that encoding, e.g., vectors of ints.
+ */
+class DratWriter
+{
+ public:
+  /**
+   * Create a writer for a new SAT solver if --drat-file=FILE is set, and
+   * return nullptr otherwise. The first writer writes to FILE and FILE.cnf,
+   * later ones to FILE.N and FILE.N.cnf.
+   *
+   * @param name the name of the SAT solver, written to the formula file
+   * @param withProof whether to write the proof; false for SAT solvers that
+   * write their own proof to getProofPath()
+   */
+  static std::unique_ptr<DratWriter> create(const std::string& name,
+                                            bool withProof = true);
+
+  /** Writes the final header of the formula file */
+  ~DratWriter();
+
+  /** Get the path of the proof file */
+  const std::string& getProofPath() const { return d_proofPath; }
+  /** Return true if the proof is to be written in binary format */
+  bool isBinary() const { return d_binary; }
+
+  /** Add an input clause (or a trusted theory lemma) to the formula */
+  template <class Clause>
+  void addInput(const Clause& c)
+  {
+    for (int i = 0, size = c.size(); i < size; ++i)
+    {
+      addInputLiteral(toInt(c[i]));
+    }
+    endInput();
+  }
+
+  /** Add a clause derived by the solver to the proof */
+  template <class Clause>
+  void addDerived(const Clause& c)
+  {
+    addStep(c, 'a');
+  }
+
+  /** Add a unit clause derived by the solver to the proof */
+  void addDerivedUnit(int lit)
+  {
+    startStep('a');
+    addProofLiteral(lit);
+    endStep();
+  }
+
+  /** Add a clause derived by the solver with the literal lit removed */
+  template <class Clause, class Lit>
+  void addStrengthened(const Clause& c, Lit lit)
+  {
+    startStep('a');
+    for (int i = 0, size = c.size(); i < size; ++i)
+    {
+      if (c[i] != lit)
+      {
+        addProofLiteral(toInt(c[i]));
+      }
+    }
+    endStep();
+  }
+
+  /** Delete a clause in the proof */
+  template <class Clause>
+  void deleteClause(const Clause& c)
+  {
+    addStep(c, 'd');
+  }
+
+  /** Add the empty clause, which concludes the proof */
+  void addEmpty();
+
+  /**
+   * Flush both files, and update the header of the formula file. Called at
+   * the end of each satisfiability check.
+   */
+  void flush();
+
+ private:
+  DratWriter(const std::string& path,
+             const std::string& name,
+             bool withProof,
+             bool binary);
+
+  template <class Clause>
+  void addStep(const Clause& c, char kind)
+  {
+    startStep(kind);
+    for (int i = 0, size = c.size(); i < size; ++i)
+    {
+      addProofLiteral(toInt(c[i]));
+    }
+    endStep();
+  }
+
+  void addInputLiteral(int lit);
+  void endInput();
+  void startStep(char kind);
+  void addProofLiteral(int lit);
+  void endStep();
+  /** Write the header of the formula file with the current counts */
+  void writeHeader();
+
+  /** The path of the proof file */
+  std::string d_proofPath;
+  /** Whether to write the proof in binary format */
+  bool d_binary;
+  /** The formula file */
+  std::ofstream d_formula;
+  /** The proof file, if it is written */
+  std::ofstream d_proof;
+  /** The position of the header in the formula file */
+  std::streampos d_headerPos;
+  /** The number of variables in the formula and the proof */
+  uint64_t d_numVars;
+  /** The number of clauses in the formula */
+  uint64_t d_numInputs;
+  /** Whether the empty clause has been added */
+  bool d_done;
+}; /* class DratWriter */
+
+}  // namespace prop
+}  // namespace CVC5
+
+#endif /* CVC4__PROP__DRAT_WRITER_H */
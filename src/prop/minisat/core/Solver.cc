@@ -173,6 +173,11 @@ Solver::Solver(CVC5::prop::TheoryProxy* proxy,
       rnd_pol(false),
       rnd_init_act(opt_rnd_init_act),
       garbage_frac(opt_garbage_frac),
+      chrono_threshold(-1),
+      inprocess_interval(-1),
+      inprocess_effort(0.1),
+      core_lbd(-1),
+      tier2_lbd(6),
       restart_first(opt_restart_first),
       restart_inc(opt_restart_inc)
 
@@ -202,19 +207,36 @@ Solver::Solver(CVC5::prop::TheoryProxy* proxy,
       clauses_literals(0),
       learnts_literals(0),
       max_literals(0),
-      tot_literals(0)
+      tot_literals(0),
+      chrono_backtracks(0),
+      inprocess_rounds(0),
+      inprocess_propagations(0),
+      vivified_clauses(0),
+      vivified_literals(0),
+      subsumed_clauses(0),
+      strengthened_clauses(0),
+      inprocess_eliminated_vars(0),
+      tier_promotions(0),
+      tier_demotions(0),
+      reduced_learnts(0),
+      reduced_lemmas(0),
+      lemma_uses(0)
 
       ,
       ok(true),
       cla_inc(1),
       var_inc(1),
       watches(WatcherDeleted(ca)),
+      watches_bin(WatcherDeleted(ca)),
       qhead(0),
       simpDB_assigns(-1),
       simpDB_props(0),
       order_heap(VarOrderLt(activity)),
       progress_estimate(0),
-      remove_satisfied(!enableIncremental)
+      remove_satisfied(!enableIncremental),
+      next_inprocess(0),
+      inprocess_props(0),
+      lbd_counter(0)
 
       // Resource constraints:
       //
@@ -267,6 +289,8 @@ Var Solver::newVar(bool sign, bool dvar, bool isTheoryAtom, bool preRegister, bo
 
     watches  .init(mkLit(v, false));
     watches  .init(mkLit(v, true ));
+    watches_bin.init(mkLit(v, false));
+    watches_bin.init(mkLit(v, true ));
     assigns  .push(l_Undef);
     vardata  .push(VarData(CRef_Undef, -1, -1, assertionLevel, -1));
     activity .push(rnd_init_act ? drand(random_seed) * 0.00001 : 0);
@@ -301,6 +325,7 @@ void Solver::resizeVars(int newSize) {
 
     // Resize watches up to the negated last literal
     watches.resizeTo(mkLit(newSize-1, true));
+    watches_bin.resizeTo(mkLit(newSize-1, true));
 
     // Resize all info arrays
     assigns.shrink(shrinkSize);
@@ -355,6 +380,10 @@ CRef Solver::reason(Var x) {
                               explanation_cl);
   vec<Lit> explanation;
   MinisatSatSolver::toMinisatClause(explanation_cl, explanation);
+  if (d_drat)
+  {
+    d_drat->addInput(explanation);
+  }
 
   Trace("pf::sat") << "Solver::reason: explanation_cl = " << explanation_cl
                    << std::endl;
@@ -366,6 +395,7 @@ CRef Solver::reason(Var x) {
 
   // Compute the assertion level for this clause
   int explLevel = 0;
+  bool simplified = false;
   if (assertionLevelOnly())
   {
     explLevel = assertionLevel;
@@ -406,6 +436,7 @@ CRef Solver::reason(Var x) {
         prev = explanation[j++] = explanation[i];
       }
       explanation.shrink(i - j);
+      simplified = i != j || j == 1;
 
       Trace("pf::sat") << "Solver::reason: explanation = ";
       for (int k = 0; k < explanation.size(); ++k)
@@ -422,8 +453,14 @@ CRef Solver::reason(Var x) {
       }
     }
 
+    if (d_drat && simplified)
+    {
+      d_drat->addDerived(explanation);
+    }
+
     // Construct the reason
-    CRef real_reason = ca.alloc(explLevel, explanation, true);
+    CRef real_reason = ca.alloc(
+        explLevel, explanation, true, ClauseAllocator::REGION_LEMMA);
     // FIXME: at some point will need more information about where this explanation
     // came from (ie. the theory/sharing)
     Trace("pf::sat") << "Minisat::Solver registering a THEORY_LEMMA (1)"
@@ -445,6 +482,7 @@ CRef Solver::reason(Var x) {
     vardata[x] = VarData(real_reason, level(x), user_level(x), intro_level(x), trail_index(x));
     clauses_removable.push(real_reason);
     attachClause(real_reason);
+    if (core_lbd >= 0) initTier(ca[real_reason]);
 
     return real_reason;
 }
@@ -502,6 +540,10 @@ bool Solver::addClause_(vec<Lit>& ps, bool removable, ClauseId& id)
 
     // Fit to size
     ps.shrink(i - j);
+    if (d_drat && i != j)
+    {
+      d_drat->addDerived(ps);
+    }
 
     // If we are in solve_ or propagate
     if (minisat_busy)
@@ -571,7 +613,7 @@ bool Solver::addClause_(vec<Lit>& ps, bool removable, ClauseId& id)
         lemma_lt lt(*this);
         sort(ps, lt);
 
-        cr = ca.alloc(clauseLevel, ps, false);
+        cr = ca.alloc(clauseLevel, ps, false, ClauseAllocator::REGION_INPUT);
         clauses_persistent.push(cr);
         attachClause(cr);
 
@@ -694,8 +736,10 @@ void Solver::attachClause(CRef cr) {
       Debug("minisat") << ", level " << c.level() << "\n";
     }
     Assert(c.size() > 1);
-    watches[~c[0]].push(Watcher(cr, c[1]));
-    watches[~c[1]].push(Watcher(cr, c[0]));
+    OccLists<Lit, vec<Watcher>, WatcherDeleted>& ws =
+        c.size() == 2 ? watches_bin : watches;
+    ws[~c[0]].push(Watcher(cr, c[1]));
+    ws[~c[1]].push(Watcher(cr, c[0]));
     if (c.removable()) learnts_literals += c.size();
     else            clauses_literals += c.size();
 }
@@ -721,13 +765,15 @@ void Solver::detachClause(CRef cr, bool strict) {
       ProofManager::getSatProof()->markDeleted(cr);
     }
 
+    OccLists<Lit, vec<Watcher>, WatcherDeleted>& ws =
+        c.size() == 2 ? watches_bin : watches;
     if (strict){
-        remove(watches[~c[0]], Watcher(cr, c[1]));
-        remove(watches[~c[1]], Watcher(cr, c[0]));
+        remove(ws[~c[0]], Watcher(cr, c[1]));
+        remove(ws[~c[1]], Watcher(cr, c[0]));
     }else{
         // Lazy detaching: (NOTE! Must clean all watcher lists before garbage collecting this clause)
-        watches.smudge(~c[0]);
-        watches.smudge(~c[1]);
+        ws.smudge(~c[0]);
+        ws.smudge(~c[1]);
     }
 
     if (c.removable()) learnts_literals -= c.size();
@@ -768,8 +814,17 @@ void Solver::removeClause(CRef cr) {
         }
         d_pfManager->endResChain(c[0]);
       }
+      if (d_drat && level(var(c[0])) == 0)
+      {
+        // keep the propagated literal in the proof
+        d_drat->addDerivedUnit(toInt(c[0]));
+      }
       vardata[var(c[0])].d_reason = CRef_Undef;
     }
+    if (d_drat)
+    {
+      d_drat->deleteClause(c);
+    }
     c.mark(1);
     ca.free(cr);
 }
@@ -788,10 +843,8 @@ void Solver::cancelUntil(int level) {
     Debug("minisat") << "minisat::cancelUntil(" << level << ")" << std::endl;
 
     if (decisionLevel() > level){
-        // Pop the SMT context
-        for (int l = trail_lim.size() - level; l > 0; --l) {
-          d_context->pop();
-        }
+        // Pop the SMT context, all levels at once
+        d_context->popto(d_context->getLevel() - (trail_lim.size() - level));
         for (int c = trail.size()-1; c >= trail_lim[level]; c--){
             Var      x  = var(trail[c]);
             assigns [x] = l_Undef;
@@ -823,6 +876,27 @@ void Solver::cancelUntil(int level) {
 
 void Solver::resetTrail() { cancelUntil(0); }
 
+int Solver::lookaheadDecide(Lit p)
+{
+  Assert(value(p) == l_Undef);
+  newDecisionLevel();
+  int start = trail.size();
+  uncheckedEnqueue(p);
+  // the theory literals enqueued here are popped with the SAT context
+  if (propagateBool() != CRef_Undef)
+  {
+    cancelUntil(decisionLevel() - 1);
+    return -1;
+  }
+  return trail.size() - start;
+}
+
+void Solver::lookaheadBacktrack()
+{
+  Assert(decisionLevel() > 0);
+  cancelUntil(decisionLevel() - 1);
+}
+
 //=================================================================================================
 // Major methods:
 
@@ -1017,7 +1091,19 @@ int Solver::analyze(CRef confl, vec<Lit>& out_learnt, int& out_btlevel)
         Clause& c = ca[confl];
         max_resolution_level = std::max(max_resolution_level, c.level());
 
-        if (c.removable()) claBumpActivity(c);
+        if (c.removable())
+        {
+          claBumpActivity(c);
+          if (core_lbd >= 0)
+          {
+            c.bumpUsed();
+            if (c.tier() != Clause::TIER_CORE) updateTier(c);
+            if (ClauseAllocator::region(confl) == ClauseAllocator::REGION_LEMMA)
+            {
+              lemma_uses++;
+            }
+          }
+        }
       }
 
         if (Trace.isOn("pf::sat"))
@@ -1408,6 +1494,19 @@ void Solver::propagateTheory() {
     Lit p = propagatedLiterals[i];
     if (value(p) == l_Undef) {
       uncheckedEnqueue(p, CRef_Lazy);
+      // Literals at level 0 are not explained in conflict analysis, so their
+      // explanations must be in the DRAT proof when they are used
+      if (d_drat && decisionLevel() == 0)
+      {
+        reason(var(p));
+      }
+      // Theory facts at level 0 are shared like learnt units
+      if (decisionLevel() == 0 && d_proxy->getSharedClauseSize() > 0)
+      {
+        SatClause unit;
+        unit.push_back(MinisatSatSolver::toSatLiteral(p));
+        d_proxy->notifyLearnedClause(unit);
+      }
     } else {
       if (value(p) == l_False) {
         Debug("minisat") << "Conflict in theory propagation" << std::endl;
@@ -1460,6 +1559,7 @@ CRef Solver::propagateBool()
     CRef    confl     = CRef_Undef;
     int     num_props = 0;
     watches.cleanAll();
+    watches_bin.cleanAll();
 
     while (qhead < trail.size()){
         Lit            p   = trail[qhead++];     // 'p' is enqueued fact to propagate.
@@ -1473,6 +1573,27 @@ CRef Solver::propagateBool()
           dtviewBoolPropagationHelper(decisionLevel(), p, d_proxy);
         }
 
+        // Binary clauses first: the blocker is the other literal, so the
+        // clause is only looked at when it propagates, and its watchers
+        // never move.
+        vec<Watcher>& wbin = watches_bin[p];
+        for (int k = 0; k < wbin.size(); k++){
+            Lit imp = wbin[k].blocker;
+            if (value(imp) == l_True) continue;
+            CRef cr = wbin[k].cref;
+            if (value(imp) == l_False){
+                confl = cr;
+                break; }
+            // The propagated literal must be the first one of its reason:
+            Clause& c = ca[cr];
+            if (c[0] != imp)
+                c[1] = c[0], c[0] = imp;
+            uncheckedEnqueue(imp, cr);
+        }
+        if (confl != CRef_Undef){
+            qhead = trail.size();
+            break; }
+
         for (i = j = (Watcher*)ws, end = i + ws.size();  i != end;){
             // Try to avoid inspecting the clause:
             Lit blocker = i->blocker;
@@ -1531,6 +1652,8 @@ CRef Solver::propagateBool()
 |  Description:
 |    Remove half of the learnt clauses, minus the clauses locked by the current assignment. Locked
 |    clauses are clauses that are reason to some assignment. Binary clauses are never removed.
+|
+|    With tiers ('core_lbd >= 0'), see 'reduceDBTiered()'.
 |________________________________________________________________________________________________@*/
 struct reduceDB_lt {
     ClauseAllocator& ca;
@@ -1540,6 +1663,10 @@ struct reduceDB_lt {
 };
 void Solver::reduceDB()
 {
+    if (core_lbd >= 0){
+        reduceDBTiered();
+        return; }
+
     int     i, j;
     double  extra_lim = cla_inc / clauses_removable.size();    // Remove any clause below this activity
 
@@ -1548,9 +1675,13 @@ void Solver::reduceDB()
     // and clauses with activity smaller than 'extra_lim':
     for (i = j = 0; i < clauses_removable.size(); i++){
         Clause& c = ca[clauses_removable[i]];
-        if (c.size() > 2 && !locked(c) && (i < clauses_removable.size() / 2 || c.activity() < extra_lim))
+        if (c.size() > 2 && !locked(c) && (i < clauses_removable.size() / 2 || c.activity() < extra_lim)){
+            if (ClauseAllocator::region(clauses_removable[i]) == ClauseAllocator::REGION_LEMMA)
+                reduced_lemmas++;
+            else
+                reduced_learnts++;
             removeClause(clauses_removable[i]);
-        else
+        }else
             clauses_removable[j++] = clauses_removable[i];
     }
     clauses_removable.shrink(i - j);
@@ -1558,6 +1689,72 @@ void Solver::reduceDB()
 }
 
 
+/*_________________________________________________________________________________________________
+|
+|  reduceDBTiered : ()  ->  [void]
+|
+|  Description:
+|    Reduce the learnt clauses according to their tier and their usefulness counter, which counts
+|    the conflicts the clause took part in and is halved here:
+|      - core clauses (LBD <= 'core_lbd') are never removed,
+|      - tier2 clauses (LBD <= 'tier2_lbd') are kept while they are used, and moved to the local
+|        tier once their counter has decayed to zero,
+|      - local conflict clauses are reduced by activity, as in 'reduceDB()',
+|      - local theory lemmas and explanations (in the lemma region) are added at a much higher
+|        rate than conflict clauses, and most of them are never used: they are removed as soon as
+|        their counter has decayed to zero, which leaves new lemmas one reduction to be used.
+|    Binary and locked clauses are never removed. The LBDs are recomputed when the clauses are
+|    used in conflicts, which promotes them to better tiers (see 'updateTier()').
+|________________________________________________________________________________________________@*/
+void Solver::reduceDBTiered()
+{
+    int       i, j;
+    double    extra_lim = cla_inc / clauses_removable.size();    // Remove any local conflict clause below this activity
+    vec<CRef> local;
+
+    for (i = j = 0; i < clauses_removable.size(); i++){
+        CRef    cr   = clauses_removable[i];
+        Clause& c    = ca[cr];
+        int     used = c.used();
+        c.used(used >> 1);
+        if (c.size() == 2 || c.tier() == Clause::TIER_CORE || locked(c)){
+            clauses_removable[j++] = cr;
+            continue; }
+        if (c.tier() == Clause::TIER_TIER2){
+            if (used > 0){
+                clauses_removable[j++] = cr;
+                continue; }
+            c.tier(Clause::TIER_LOCAL);
+            tier_demotions++; }
+        if (ClauseAllocator::region(cr) != ClauseAllocator::REGION_LEMMA)
+            local.push(cr);
+        else if (used > 0)
+            clauses_removable[j++] = cr;
+        else{
+            removeClause(cr);
+            reduced_lemmas++; }
+    }
+    clauses_removable.shrink(i - j);
+
+    // Remove half of the local conflict clauses, and those with an activity below 'extra_lim':
+    sort(local, reduceDB_lt(ca));
+    for (i = 0; i < local.size(); i++){
+        if (i < local.size() / 2 || ca[local[i]].activity() < extra_lim){
+            removeClause(local[i]);
+            reduced_learnts++;
+        }else
+            clauses_removable.push(local[i]);
+    }
+
+    // The clauses kept are used or of a small LBD, raise the limit rather than reducing them
+    // again right away:
+    if (clauses_removable.size() - nAssigns() >= max_learnts)
+        max_learnts = (clauses_removable.size() - nAssigns()) * learntsize_inc;
+
+    checkGarbage();
+}
+
+
 void Solver::removeSatisfied(vec<CRef>& cs)
 {
     int i, j;
@@ -1636,6 +1833,296 @@ bool Solver::simplify()
 }
 
 
+/*_________________________________________________________________________________________________
+|
+|  inprocess : [void]  ->  [bool]
+|
+|  Description:
+|    Simplify the learnt clauses (conflict clauses and removable theory lemmas) at level 0, by
+|    vivification, subsumption and self-subsuming resolution. All of these only use Boolean
+|    propagation and resolution on clauses, so theory atoms are treated like any other literal.
+|    The clauses of the resolution proofs and unsat cores cannot be changed in place, so nothing
+|    is done when they are produced. Returns FALSE if the clauses are found unsatisfiable.
+|________________________________________________________________________________________________@*/
+bool Solver::inprocess()
+{
+  Assert(decisionLevel() == 0);
+
+  if (options::unsatCores() || isProofEnabled())
+  {
+    return true;
+  }
+  if (propagateBool() != CRef_Undef)
+  {
+    return ok = false;
+  }
+
+  Debug("minisat") << "Solver::inprocess(): " << clauses_removable.size()
+                   << " learnt clauses" << std::endl;
+  inprocess_rounds++;
+  uint64_t props = propagations;
+
+  vivifyLearnts();
+  if (ok)
+  {
+    subsumeLearnts();
+  }
+
+  // Forget the clauses removed above
+  int i, j;
+  for (i = j = 0; i < clauses_removable.size(); i++)
+  {
+    if (ca[clauses_removable[i]].mark() == 0)
+    {
+      clauses_removable[j++] = clauses_removable[i];
+    }
+  }
+  clauses_removable.shrink(i - j);
+  checkGarbage();
+
+  // The shortened clauses may propagate at level 0
+  if (ok && propagateBool() != CRef_Undef)
+  {
+    ok = false;
+  }
+
+  inprocess_propagations += propagations - props;
+  inprocess_props = propagations;
+  return ok;
+}
+
+struct vivify_lt {
+    ClauseAllocator& ca;
+    vivify_lt(ClauseAllocator& ca_) : ca(ca_) {}
+    bool operator () (CRef x, CRef y) { return ca[x].activity() > ca[y].activity(); }
+};
+
+void Solver::vivifyLearnts()
+{
+  // The most active clauses first, until the budget of propagations is spent
+  uint64_t limit =
+      propagations + (uint64_t)((propagations - inprocess_props) * inprocess_effort);
+  vec<CRef> cs;
+  clauses_removable.copyTo(cs);
+  sort(cs, vivify_lt(ca));
+
+  vec<Lit> lits;
+  for (int i = 0; i < cs.size() && propagations < limit; i++)
+  {
+    CRef cr = cs[i];
+    Clause& c = ca[cr];
+    // Clauses at lower user levels would outlive the clauses they are
+    // vivified with
+    if (c.size() <= 2 || c.level() != assertionLevel || satisfied(c))
+    {
+      continue;
+    }
+
+    // Propagate the negations of the literals of c, without c itself, until
+    // the remaining literals are implied
+    detachClause(cr, true);
+    lits.clear();
+    newDecisionLevel();
+    for (int k = 0; k < c.size(); k++)
+    {
+      lbool val = value(c[k]);
+      if (val == l_False)
+      {
+        // implied by the literals before it
+        continue;
+      }
+      lits.push(c[k]);
+      if (val == l_True)
+      {
+        break;
+      }
+      uncheckedEnqueue(~c[k]);
+      if (propagateBool() != CRef_Undef)
+      {
+        break;
+      }
+    }
+    cancelUntil(0);
+    Assert(lits.size() > 0);
+
+    if (lits.size() < c.size())
+    {
+      vivified_clauses++;
+      vivified_literals += c.size() - lits.size();
+      if (d_drat)
+      {
+        d_drat->addDerived(lits);
+      }
+      if (lits.size() == 1)
+      {
+        attachClause(cr);
+        removeClause(cr);
+        uncheckedEnqueue(lits[0]);
+        // Propagate the unit at level 0 before the next clause opens level 1
+        if (propagateBool() != CRef_Undef)
+        {
+          ok = false;
+          return;
+        }
+        continue;
+      }
+      if (d_drat)
+      {
+        d_drat->deleteClause(c);
+      }
+      for (int k = 0; k < lits.size(); k++)
+      {
+        c[k] = lits[k];
+      }
+      c.shrink(c.size() - lits.size());
+    }
+    attachClause(cr);
+  }
+}
+
+struct subsume_lt {
+    ClauseAllocator& ca;
+    subsume_lt(ClauseAllocator& ca_) : ca(ca_) {}
+    bool operator () (CRef x, CRef y) { return ca[x].size() < ca[y].size(); }
+};
+
+void Solver::subsumeLearnts()
+{
+  vec<CRef> cs;
+  for (int i = 0; i < clauses_removable.size(); i++)
+  {
+    const Clause& c = ca[clauses_removable[i]];
+    if (c.mark() == 0 && !satisfied(c))
+    {
+      cs.push(clauses_removable[i]);
+    }
+  }
+  sort(cs, subsume_lt(ca));
+
+  vec<vec<CRef> > occs;
+  occs.growTo(2 * nVars());
+  for (int i = 0; i < cs.size(); i++)
+  {
+    const Clause& c = ca[cs[i]];
+    for (int k = 0; k < c.size(); k++)
+    {
+      occs[toInt(c[k])].push(cs[i]);
+    }
+  }
+
+  // Check each clause, shortest first, against the clauses that contain its
+  // least frequent variable. The budget bounds the literals visited.
+  int64_t budget = 10 * (int64_t)learnts_literals;
+  for (int i = 0; i < cs.size() && budget > 0; i++)
+  {
+    CRef cr = cs[i];
+    const Clause& c = ca[cr];
+    if (c.mark() != 0)
+    {
+      continue;
+    }
+    Lit best = c[0];
+    for (int k = 1; k < c.size(); k++)
+    {
+      if (occs[toInt(c[k])].size() + occs[toInt(~c[k])].size()
+          < occs[toInt(best)].size() + occs[toInt(~best)].size())
+      {
+        best = c[k];
+      }
+    }
+    for (int k = 0; k < c.size(); k++)
+    {
+      seen[var(c[k])] = sign(c[k]) ? 2 : 1;
+    }
+
+    for (int p = 0; p < 2; p++)
+    {
+      const vec<CRef>& ds = occs[toInt(p == 0 ? best : ~best)];
+      for (int l = 0; l < ds.size() && budget > 0; l++)
+      {
+        CRef dr = ds[l];
+        const Clause& d = ca[dr];
+        // A clause at a higher user level would be popped before the clauses
+        // it is used to remove or strengthen
+        if (dr == cr || d.mark() != 0 || d.size() < c.size()
+            || c.level() > d.level())
+        {
+          continue;
+        }
+        budget -= d.size();
+        // d contains all the literals of c, except for at most one that it
+        // contains negated
+        Lit negated = lit_Undef;
+        int found = 0;
+        for (int k = 0; k < d.size() && found >= 0; k++)
+        {
+          char s = seen[var(d[k])];
+          if (s == 0)
+          {
+            continue;
+          }
+          if (s == (sign(d[k]) ? 2 : 1))
+          {
+            found++;
+          }
+          else if (negated == lit_Undef)
+          {
+            negated = d[k];
+            found++;
+          }
+          else
+          {
+            found = -1;
+          }
+        }
+        if (found != c.size() || locked(d))
+        {
+          continue;
+        }
+        if (negated == lit_Undef)
+        {
+          subsumed_clauses++;
+          removeClause(dr);
+        }
+        else if (d.size() > 2)
+        {
+          strengthened_clauses++;
+          strengthenLearnt(dr, negated);
+        }
+      }
+    }
+
+    for (int k = 0; k < c.size(); k++)
+    {
+      seen[var(c[k])] = 0;
+    }
+  }
+}
+
+void Solver::strengthenLearnt(CRef cr, Lit p)
+{
+  Clause& c = ca[cr];
+  Assert(c.size() > 2);
+  if (d_drat)
+  {
+    d_drat->addStrengthened(c, p);
+    d_drat->deleteClause(c);
+  }
+  detachClause(cr, true);
+  // Clause::strengthen() would overwrite the activity with an abstraction
+  for (int k = 0; k < c.size(); k++)
+  {
+    if (c[k] == p)
+    {
+      c[k] = c.last();
+      c.pop();
+      break;
+    }
+  }
+  attachClause(cr);
+}
+
+
 /*_________________________________________________________________________________________________
 |
 |  search : (nof_conflicts : int) (params : const SearchParams&)  ->  [lbool]
@@ -1692,7 +2179,32 @@ lbool Solver::search(int nof_conflicts)
       // Analyze the conflict
       learnt_clause.clear();
       int max_level = analyze(confl, learnt_clause, backtrack_level);
+
+      // Chronological backtracking: rather than undoing many levels of
+      // (theory) work, only pop the conflict level.  The learnt clause is
+      // still unit there, and its asserting literal is put on the trail at
+      // that level, so the trail stays ordered by levels.  Unit clauses are
+      // not stored, so they are always asserted at level 0.
+      if (learnt_clause.size() > 1 && useChrono(backtrack_level))
+      {
+        backtrack_level = decisionLevel() - 1;
+        chrono_backtracks++;
+      }
       cancelUntil(backtrack_level);
+      if (d_drat)
+      {
+        d_drat->addDerived(learnt_clause);
+      }
+      if (static_cast<unsigned>(learnt_clause.size())
+          <= d_proxy->getSharedClauseSize())
+      {
+        SatClause clause;
+        for (int i = 0; i < learnt_clause.size(); ++i)
+        {
+          clause.push_back(MinisatSatSolver::toSatLiteral(learnt_clause[i]));
+        }
+        d_proxy->notifyLearnedClause(clause);
+      }
 
       // Assert the conflict clause and the asserting literal
       if (learnt_clause.size() == 1)
@@ -1711,10 +2223,12 @@ lbool Solver::search(int nof_conflicts)
       {
         CRef cr = ca.alloc(assertionLevelOnly() ? assertionLevel : max_level,
                            learnt_clause,
-                           true);
+                           true,
+                           ClauseAllocator::REGION_LEARNT);
         clauses_removable.push(cr);
         attachClause(cr);
         claBumpActivity(ca[cr]);
+        if (core_lbd >= 0) initTier(ca[cr]);
         uncheckedEnqueue(learnt_clause[0], cr);
         if (options::unsatCores() && !isProofEnabled())
         {
@@ -1800,6 +2314,17 @@ lbool Solver::search(int nof_conflicts)
         return l_Undef;
       }
 
+      // Simplify the learnt clauses from time to time:
+      if (decisionLevel() == 0 && inprocess_interval >= 0
+          && conflicts >= next_inprocess)
+      {
+        next_inprocess = conflicts + inprocess_interval;
+        if (!inprocess())
+        {
+          return l_False;
+        }
+      }
+
       // Simplify the set of problem clauses:
       if (decisionLevel() == 0 && !simplify())
       {
@@ -1912,12 +2437,18 @@ lbool Solver::solve_()
     d_conflict.clear();
     if (!ok){
       minisat_busy = false;
+      if (d_drat)
+      {
+        d_drat->addEmpty();
+      }
       return l_False;
     }
 
     solves++;
 
     max_learnts               = nClauses() * learntsize_factor;
+    next_inprocess            = conflicts + inprocess_interval;
+    inprocess_props           = propagations;
     learntsize_adjust_confl   = learntsize_adjust_start_confl;
     learntsize_adjust_cnt     = (int)learntsize_adjust_confl;
     lbool   status            = l_Undef;
@@ -1957,6 +2488,15 @@ lbool Solver::solve_()
     else if (status == l_False && d_conflict.size() == 0)
       ok = false;
 
+    if (d_drat)
+    {
+      if (!ok)
+      {
+        d_drat->addEmpty();
+      }
+      d_drat->flush();
+    }
+
     return status;
 }
 
@@ -2050,6 +2590,7 @@ void Solver::relocAll(ClauseAllocator& to)
     //
     // for (int i = 0; i < watches.size(); i++)
     watches.cleanAll();
+    watches_bin.cleanAll();
     for (int v = 0; v < nVars(); v++)
         for (int s = 0; s < 2; s++){
             Lit p = mkLit(v, s);
@@ -2063,6 +2604,15 @@ void Solver::relocAll(ClauseAllocator& to)
                            ? ProofManager::getSatProof()
                            : nullptr);
             }
+            vec<Watcher>& wbin = watches_bin[p];
+            for (int j = 0; j < wbin.size(); j++)
+            {
+              ca.reloc(wbin[j].cref,
+                       to,
+                       (options::unsatCores() && !isProofEnabled())
+                           ? ProofManager::getSatProof()
+                           : nullptr);
+            }
         }
 
     // All reasons:
@@ -2107,17 +2657,36 @@ void Solver::relocAll(ClauseAllocator& to)
 }
 
 
-void Solver::garbageCollect()
+void Solver::checkGarbage(double gf)
 {
-    // Initialize the next region to a size corresponding to the estimated utilization degree. This
-    // is not precise but should avoid some unnecessary reallocations for the new region:
-    ClauseAllocator to(ca.size() - ca.wasted());
+    if (ca.wasted() <= ca.size() * gf) return;
+
+    // Only compact the regions that are wasteful on their own; at least one
+    // of them is. The old SAT proof re-keys the ids of all clauses on each
+    // collection, so it needs all regions to be collected.
+    uint32_t regions = ClauseAllocator::ALL_REGIONS;
+    if (!options::unsatCores() || isProofEnabled())
+    {
+        regions = 0;
+        for (int r = 0; r < ClauseAllocator::NUM_REGIONS; r++)
+            if (ca.wasted(r) > ca.size(r) * gf)
+                regions |= 1 << r;
+    }
+    garbageCollect(regions);
+}
+
+void Solver::garbageCollect(uint32_t regions)
+{
+    // Initialize the next regions to a size corresponding to the estimated utilization degree. This
+    // is not precise but should avoid some unnecessary reallocations for the new regions:
+    ClauseAllocator to(ca, regions);
 
     relocAll(to);
+    uint32_t before = ca.size();
+    to.moveTo(ca);
     if (verbosity >= 2)
         printf("|  Garbage collection:   %12d bytes => %12d bytes             |\n",
-               ca.size()*ClauseAllocator::Unit_Size, to.size()*ClauseAllocator::Unit_Size);
-    to.moveTo(ca);
+               before*ClauseAllocator::Unit_Size, ca.size()*ClauseAllocator::Unit_Size);
 }
 
 void Solver::push()
@@ -2230,6 +2799,20 @@ CRef Solver::updateLemmas() {
         int currentBacktrackLevel = lemma.size() == 1 ? 0 : level(var(lemma[1]));
         // Even if the first literal is true, we should propagate it at this level (unless it's set at a lower level)
         if (value(lemma[0]) != l_True || level(var(lemma[0])) > currentBacktrackLevel) {
+          if (lemma.size() > 1 && useChrono(currentBacktrackLevel))
+          {
+            // Chronological backtracking: a true or unassigned first literal
+            // does not require backtracking, a false one only requires
+            // undoing its level
+            int chronoLevel = value(lemma[0]) == l_False
+                                  ? level(var(lemma[0])) - 1
+                                  : decisionLevel();
+            if (chronoLevel > currentBacktrackLevel)
+            {
+              currentBacktrackLevel = chronoLevel;
+              chrono_backtracks++;
+            }
+          }
           if (currentBacktrackLevel < backtrackLevel) {
             backtrackLevel = currentBacktrackLevel;
           }
@@ -2269,7 +2852,11 @@ CRef Solver::updateLemmas() {
         }
       }
 
-      lemma_ref = ca.alloc(clauseLevel, lemma, removable);
+      lemma_ref = ca.alloc(clauseLevel,
+                           lemma,
+                           removable,
+                           removable ? ClauseAllocator::REGION_LEMMA
+                                     : ClauseAllocator::REGION_INPUT);
       if (options::unsatCores() && !isProofEnabled())
       {
         TNode cnf_assertion = lemmas_cnf_assertion[j];
@@ -2282,6 +2869,7 @@ CRef Solver::updateLemmas() {
       }
       if (removable) {
         clauses_removable.push(lemma_ref);
+        if (core_lbd >= 0) initTier(ca[lemma_ref]);
       } else {
         clauses_persistent.push(lemma_ref);
       }
@@ -2352,12 +2940,14 @@ void ClauseAllocator::reloc(CRef& cr,
   Debug("minisat") << "ClauseAllocator::reloc: cr " << cr << std::endl;
   // FIXME what is this CRef_lazy
   if (cr == CRef_Lazy) return;
+  // Clauses of the regions that are not collected stay in place
+  if (!to.collects(region(cr))) return;
 
   CRef old = cr;  // save the old reference
   Clause& c = operator[](cr);
   if (c.reloced()) { cr = c.relocation(); return; }
 
-  cr = to.alloc(c.level(), c, c.removable());
+  cr = to.alloc(c.level(), c, c.removable(), region(cr));
   c.relocate(cr);
   if (proof)
   {
@@ -2366,6 +2956,9 @@ void ClauseAllocator::reloc(CRef& cr,
   // Copy extra data-fields:
   // (This could be cleaned-up. Generalize Clause-constructor to be applicable here instead?)
   to[cr].mark(c.mark());
+  to[cr].lbd(c.lbd());
+  to[cr].tier(c.tier());
+  to[cr].used(c.used());
   if (to[cr].removable())         to[cr].activity() = c.activity();
   else if (to[cr].has_extra()) to[cr].calcAbstraction();
 }
@@ -2397,5 +2990,20 @@ std::shared_ptr<ProofNode> Solver::getProof()
 
 bool Solver::isProofEnabled() const { return d_pfManager != nullptr; }
 
+void Solver::setDratWriter(std::unique_ptr<CVC5::prop::DratWriter> drat)
+{
+  Assert(clauses_persistent.size() == 0 && clauses_removable.size() == 0);
+  d_drat = std::move(drat);
+  if (d_drat)
+  {
+    // the constants are asserted without clauses
+    vec<Lit> unit;
+    unit.push(mkLit(varTrue, false));
+    d_drat->addInput(unit);
+    unit[0] = mkLit(varFalse, true);
+    d_drat->addInput(unit);
+  }
+}
+
 }  // namespace Minisat
 }  // namespace CVC5
@@ -29,6 +29,7 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 #include "cvc4_private.h"
 #include "expr/proof_node_manager.h"
 #include "proof/clause_id.h"
+#include "prop/drat_writer.h"
 #include "prop/minisat/core/SolverTypes.h"
 #include "prop/minisat/mtl/Alg.h"
 #include "prop/minisat/mtl/Heap.h"
@@ -90,6 +91,9 @@ class Solver {
   /** The resolution proof manager */
   std::unique_ptr<CVC5::prop::SatProofManager> d_pfManager;
 
+  /** The writer of the streaming DRAT proof, if any */
+  std::unique_ptr<CVC5::prop::DratWriter> d_drat;
+
  public:
   /** Returns the current user assertion level */
   int getAssertionLevel() const { return assertionLevel; }
@@ -161,6 +165,12 @@ public:
  /** Is proof enabled? */
  bool isProofEnabled() const;
 
+ /**
+  * Stream a DRAT proof with the given writer from now on. Must be called
+  * before any clause is added.
+  */
+ void setDratWriter(std::unique_ptr<CVC5::prop::DratWriter> drat);
+
  // Less than for literals in a lemma
  struct lemma_lt
  {
@@ -207,6 +217,17 @@ public:
      * level.
      */
     void resetTrail();
+
+    /*
+     * Decide p at a new decision level and propagate it, without the theories,
+     * for lookahead. Returns the number of literals assigned at the new level,
+     * or -1 on a conflict, in which case the level is undone.
+     */
+    int lookaheadDecide(Lit p);
+
+    /* Undo the level of the last successful lookaheadDecide(). */
+    void lookaheadBacktrack();
+
     // addClause returns the ClauseId corresponding to the clause added in the
     // reference parameter id.
     bool    addClause (const vec<Lit>& ps, bool removable, ClauseId& id);  // Add a clause to the solver.
@@ -257,6 +278,7 @@ public:
     int     nVars      ()      const;       // The current number of variables.
     int     nFreeVars  ()      const;
     bool    isDecision (Var x) const;       // is the given var a decision?
+    double  getActivity(Var x) const;       // The activity of a variable.
 
     // Debugging SMT explanations
     //
@@ -272,7 +294,9 @@ public:
 
     // Memory managment:
     //
-    virtual void garbageCollect();
+    // Compact the given regions (a mask of ClauseAllocator::Region bits) of
+    // the clause arena:
+    virtual void garbageCollect(uint32_t regions = ClauseAllocator::ALL_REGIONS);
     void    checkGarbage(double gf);
     void    checkGarbage();
 
@@ -297,6 +321,11 @@ public:
     bool      rnd_init_act;       // Initialize variable activities with a small random value.
     double    garbage_frac;       // The fraction of wasted memory allowed before a garbage collection is triggered.
 
+    int       chrono_threshold;   // Backtrack chronologically after conflicts whose backjump would undo more levels (-1=never).
+    int       inprocess_interval; // Run 'inprocess()' at the first restart after this many conflicts since the last run (-1=never).
+    double    inprocess_effort;   // The fraction of the propagations since the last run that vivification may spend.
+    int       core_lbd;           // Learnt clauses with an LBD up to this are never removed by 'reduceDB()' (-1=no tiers).
+    int       tier2_lbd;          // Learnt clauses with an LBD up to this are kept by 'reduceDB()' while they are used.
     int       restart_first;      // The initial restart limit.                                                                (default 100)
     double    restart_inc;        // The factor with which the restart limit is multiplied in each restart.                    (default 1.5)
     double    learntsize_factor;  // The intitial limit for learnt clauses is a factor of the original clauses.                (default 1 / 3)
@@ -309,6 +338,10 @@ public:
     //
     uint64_t solves, starts, decisions, rnd_decisions, propagations, conflicts, resources_consumed;
     uint64_t dec_vars, clauses_literals, learnts_literals, max_literals, tot_literals;
+    uint64_t chrono_backtracks;
+    uint64_t inprocess_rounds, inprocess_propagations, vivified_clauses, vivified_literals;
+    uint64_t subsumed_clauses, strengthened_clauses, inprocess_eliminated_vars;
+    uint64_t tier_promotions, tier_demotions, reduced_learnts, reduced_lemmas, lemma_uses;
 
 protected:
 
@@ -370,6 +403,8 @@ protected:
     double              var_inc;            // Amount to bump next variable with.
     OccLists<Lit, vec<Watcher>, WatcherDeleted>
                         watches;            // 'watches[lit]' is a list of constraints watching 'lit' (will go there if literal becomes true).
+    OccLists<Lit, vec<Watcher>, WatcherDeleted>
+                        watches_bin;        // As 'watches', for binary clauses; the blocker of a watcher is the other literal of its clause.
     vec<lbool>          assigns;            // The current assignments.
     vec<int>            assigns_lim;        // The size by levels of the current assignment
     vec<char>           polarity;           // The preferred polarity of each variable (bit 0) and whether it's locked (bit 1).
@@ -386,6 +421,8 @@ protected:
     Heap<VarOrderLt>    order_heap;         // A priority queue of variables ordered with respect to the variable activity.
     double              progress_estimate;  // Set by 'search()'.
     bool                remove_satisfied;   // Indicates whether possibly inefficient linear scan for satisfied clauses should be performed in 'simplify'.
+    uint64_t            next_inprocess;     // Number of conflicts after which 'inprocess()' runs next.
+    uint64_t            inprocess_props;    // Number of propagations at the end of the last run of 'inprocess()'.
 
     ClauseAllocator     ca;
 
@@ -415,6 +452,8 @@ protected:
     vec<Lit>            analyze_stack;
     vec<Lit>            analyze_toclear;
     vec<Lit>            add_tmp;
+    vec<uint64_t>       lbd_stamp;          // The last 'lbd_counter' at which each decision level was counted by 'computeLbd()'.
+    uint64_t            lbd_counter;
 
     double              max_learnts;
     double              learntsize_adjust_confl;
@@ -448,9 +487,17 @@ protected:
     lbool    search           (int nof_conflicts);                                     // Search for a given number of conflicts.
     lbool    solve_           ();                                                      // Main solve method (assumptions given in 'assumptions').
     void     reduceDB         ();                                                      // Reduce the set of learnt clauses.
+    void     reduceDBTiered   ();                                                      // Reduce the set of learnt clauses by tiers (see 'reduceDB()').
     void     removeSatisfied  (vec<CRef>& cs);                                         // Shrink 'cs' to contain only non-satisfied clauses.
     void     rebuildOrderHeap ();
 
+    // Inprocessing, at level 0 between two searches:
+    //
+    virtual bool inprocess    ();                                                      // Simplify the clauses. Returns FALSE if they are found unsatisfiable.
+    void     vivifyLearnts    ();                                                      // Shorten the learnt clauses by propagating the negations of their literals.
+    void     subsumeLearnts   ();                                                      // Remove subsumed learnt clauses, and strengthen them by self-subsuming resolution.
+    void     strengthenLearnt (CRef cr, Lit p);                                        // Remove 'p' from the learnt clause 'cr' (of size > 2).
+
     // Maintaining Variable/Clause activity:
     //
     void     varDecayActivity ();                      // Decay all variables with the specified factor. Implemented by increasing the 'bump' value instead.
@@ -459,6 +506,14 @@ protected:
     void     claDecayActivity ();                      // Decay all clauses with the specified factor. Implemented by increasing the 'bump' value instead.
     void     claBumpActivity  (Clause& c);             // Increase a clause with the current 'bump' value.
 
+    // Maintaining the tiers of the learnt clauses:
+    //
+    template<class V>
+    int      computeLbd       (const V& c);            // The number of decision levels of 'c' (each unassigned literal counts as a level).
+    int      tierOf           (int lbd) const;         // The tier of a learnt clause of the given LBD.
+    void     initTier         (Clause& c);             // Set the LBD and the tier of a new learnt clause.
+    void     updateTier       (Clause& c);             // Recompute the LBD of a clause used in a conflict, and promote it if it decreased.
+
     // Operations on clauses:
     //
     void     attachClause     (CRef cr);               // Attach a clause to watcher lists.
@@ -473,6 +528,7 @@ protected:
     //
     int      decisionLevel    ()      const; // Gives the current decisionlevel.
     uint32_t abstractLevel    (Var x) const; // Used to represent an abstraction of sets of decision levels.
+    bool     useChrono        (int backjump_level) const; // Backtrack chronologically rather than to 'backjump_level'?
     CRef     reason           (Var x); // Get the reason of the variable (non const as it might create the explanation on the fly)
     bool     hasReasonClause  (Var x) const; // Does the variable have a reason
     bool     isPropagated     (Var x) const; // Does the variable have a propagated variables
@@ -533,6 +589,12 @@ inline bool Solver::isDecision(Var x) const
   return vardata[x].d_reason == CRef_Undef && level(x) > 0;
 }
 
+inline double Solver::getActivity(Var x) const
+{
+  Assert(x < activity.size());
+  return activity[x];
+}
+
 inline int Solver::level(Var x) const
 {
   Assert(x < vardata.size());
@@ -583,15 +645,46 @@ inline void Solver::claBumpActivity (Clause& c) {
                 ca[clauses_removable[i]].activity() *= 1e-20;
             cla_inc *= 1e-20; } }
 
+template<class V>
+inline int Solver::computeLbd(const V& c) {
+    lbd_stamp.growTo(decisionLevel() + 1, 0);
+    lbd_counter++;
+    int lbd = 0;
+    for (int i = 0; i < c.size() && lbd < Clause::MAX_LBD; i++){
+        if (value(c[i]) == l_Undef){
+            lbd++;
+            continue; }
+        int l = level(var(c[i]));
+        if (lbd_stamp[l] != lbd_counter){
+            lbd_stamp[l] = lbd_counter;
+            lbd++; } }
+    return lbd; }
+inline int  Solver::tierOf(int lbd) const {
+    return lbd <= core_lbd ? Clause::TIER_CORE : lbd <= tier2_lbd ? Clause::TIER_TIER2 : Clause::TIER_LOCAL; }
+inline void Solver::initTier(Clause& c) {
+    c.lbd(computeLbd(c));
+    c.tier(tierOf(c.lbd())); }
+inline void Solver::updateTier(Clause& c) {
+    int lbd = computeLbd(c);
+    if (lbd < c.lbd()){
+        c.lbd(lbd);
+        if (tierOf(lbd) < c.tier()){
+            c.tier(tierOf(lbd));
+            tier_promotions++; } } }
+
 inline void Solver::checkGarbage(void){ return checkGarbage(garbage_frac); }
-inline void Solver::checkGarbage(double gf){
-    if (ca.wasted() > ca.size() * gf)
-        garbageCollect(); }
 
 // NOTE: enqueue does not set the ok flag! (only public methods do)
 inline bool     Solver::enqueue         (Lit p, CRef from)      { return value(p) != l_Undef ? value(p) != l_False : (uncheckedEnqueue(p, from), true); }
 inline bool     Solver::addClause       (const vec<Lit>& ps, bool removable, ClauseId& id)
-                                                                { ps.copyTo(add_tmp); return addClause_(add_tmp, removable, id); }
+{
+  if (d_drat)
+  {
+    d_drat->addInput(ps);
+  }
+  ps.copyTo(add_tmp);
+  return addClause_(add_tmp, removable, id);
+}
 inline bool     Solver::addEmptyClause  (bool removable)        { add_tmp.clear(); ClauseId tmp; return addClause_(add_tmp, removable, tmp); }
 inline bool     Solver::addClause       (Lit p, bool removable, ClauseId& id)
                                                                 { add_tmp.clear(); add_tmp.push(p); return addClause_(add_tmp, removable, id); }
@@ -609,6 +702,11 @@ inline void Solver::newDecisionLevel()
 
 inline int      Solver::decisionLevel ()      const   { return trail_lim.size(); }
 inline uint32_t Solver::abstractLevel (Var x) const   { return 1 << (level(x) & 31); }
+inline bool     Solver::useChrono     (int backjump_level) const
+{
+  return chrono_threshold >= 0
+         && decisionLevel() - backjump_level > chrono_threshold;
+}
 inline lbool Solver::value(Var x) const
 {
   Assert(x < nVars());
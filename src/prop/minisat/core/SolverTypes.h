@@ -198,7 +198,10 @@ class Clause {
         unsigned has_extra : 1;
         unsigned reloced   : 1;
         unsigned size      : 27;
-        unsigned level     : 32; }                            header;
+        unsigned level     : 22;
+        unsigned lbd       : 5;
+        unsigned tier      : 2;
+        unsigned used      : 3; }                             header;
     union { Lit lit; float act; uint32_t abs; CRef rel; } data[0];
 
     friend class ClauseAllocator;
@@ -206,12 +209,17 @@ class Clause {
     // NOTE: This constructor cannot be used directly (doesn't allocate enough memory).
     template<class V>
     Clause(const V& ps, bool use_extra, bool removable, int level) {
+        AlwaysAssert(level >= 0 && level < (1 << 22))
+            << "user level " << level << " does not fit in a clause header";
         header.mark      = 0;
         header.removable = removable;
         header.has_extra = use_extra;
         header.reloced   = 0;
         header.size      = ps.size();
         header.level     = level;
+        header.lbd       = MAX_LBD;
+        header.tier      = TIER_LOCAL;
+        header.used      = 1;
 
         for (int i = 0; i < ps.size(); i++) data[i].lit = ps[i];
 
@@ -224,6 +232,10 @@ class Clause {
     }
 
 public:
+    // The tiers of the learnt clauses, see 'Solver::reduceDB()':
+    enum { TIER_CORE = 0, TIER_TIER2 = 1, TIER_LOCAL = 2 };
+    enum { MAX_LBD = 31, MAX_USED = 7 };
+
     void calcAbstraction() {
       Assert(header.has_extra);
       uint32_t abstraction = 0;
@@ -247,6 +259,17 @@ public:
     void         mark        (uint32_t m)    { header.mark = m; }
     const Lit&   last        ()      const   { return data[header.size-1].lit; }
 
+    // The literal block distance (capped at MAX_LBD), the tier and the usefulness counter (capped
+    // at MAX_USED) of a learnt clause. The counter is bumped each time the clause takes part in a
+    // conflict analysis, and halved by each reduction of the learnt clauses.
+    int          lbd         ()      const   { return header.lbd; }
+    void         lbd         (int l)         { header.lbd = l < MAX_LBD ? l : MAX_LBD; }
+    int          tier        ()      const   { return header.tier; }
+    void         tier        (int t)         { header.tier = t; }
+    int          used        ()      const   { return header.used; }
+    void         used        (int u)         { header.used = u; }
+    void         bumpUsed    ()              { if (header.used < MAX_USED) header.used++; }
+
     bool         reloced     ()      const   { return header.reloced; }
     CRef         relocation  ()      const   { return data[0].rel; }
     void         relocate    (CRef c)        { header.reloced = 1; data[0].rel = c; }
@@ -279,51 +302,147 @@ public:
 
 const CRef CRef_Undef = RegionAllocator<uint32_t>::Ref_Undef;
 const CRef CRef_Lazy  = RegionAllocator<uint32_t>::Ref_Undef - 1;
-class ClauseAllocator : public RegionAllocator<uint32_t>
+
+/**
+ * The clause arena.  Clauses are stored with their literals inline, in one of
+ * three regions, according to how long they are expected to live:
+ * - REGION_INPUT holds the problem clauses and the non-removable lemmas,
+ *   which are rarely deleted,
+ * - REGION_LEARNT holds the conflict clauses learnt by the solver, and
+ * - REGION_LEMMA holds the removable theory lemmas and the explanations of
+ *   theory propagations, which are added and deleted at a much higher rate.
+ *
+ * The region of a clause is encoded in the two most significant bits of its
+ * CRef.  Each region keeps its own count of wasted memory and can be
+ * compacted on its own (see the ClauseAllocator(const ClauseAllocator&,
+ * uint32_t) constructor), so that the churn of theory lemmas does not cause
+ * the input clauses to be copied on every garbage collection.
+ */
+class ClauseAllocator
 {
     static int clauseWord32Size(int size, bool has_extra){
         return (sizeof(Clause) + (sizeof(Lit) * (size + (int)has_extra))) / sizeof(uint32_t); }
  public:
+    typedef RegionAllocator<uint32_t>::Ref Ref;
+    enum { Unit_Size = RegionAllocator<uint32_t>::Unit_Size };
+
+    enum Region
+    {
+        REGION_INPUT = 0,
+        REGION_LEARNT = 1,
+        REGION_LEMMA = 2,
+        NUM_REGIONS = 3
+    };
+    /** The mask of regions that contains all regions */
+    static constexpr uint32_t ALL_REGIONS = (1 << NUM_REGIONS) - 1;
+
     bool extra_clause_field;
 
-    ClauseAllocator(uint32_t start_cap) : RegionAllocator<uint32_t>(start_cap), extra_clause_field(false){}
-    ClauseAllocator() : extra_clause_field(false){}
+    /**
+     * Create an arena with room for start_cap words of input clauses and a
+     * quarter of that for each of the other regions.
+     */
+    explicit ClauseAllocator(uint32_t start_cap = 1024 * 1024)
+        : extra_clause_field(false), d_collect(ALL_REGIONS)
+    {
+        d_regions[REGION_INPUT].reserve(start_cap);
+        d_regions[REGION_LEARNT].reserve(start_cap / 4);
+        d_regions[REGION_LEMMA].reserve(start_cap / 4);
+    }
+
+    /**
+     * Create an arena into which the given regions of from are compacted
+     * (see reloc()).  Only the clauses of these regions are copied; moveTo()
+     * then replaces these regions of from and leaves the others in place.
+     */
+    ClauseAllocator(const ClauseAllocator& from, uint32_t regions)
+        : extra_clause_field(from.extra_clause_field), d_collect(regions)
+    {
+        for (int r = 0; r < NUM_REGIONS; r++)
+            if (collects(r))
+                d_regions[r].reserve(from.size(r) - from.wasted(r));
+    }
+
+    ClauseAllocator(const ClauseAllocator&) = delete;
+    ClauseAllocator& operator=(const ClauseAllocator&) = delete;
 
     void moveTo(ClauseAllocator& to){
         to.extra_clause_field = extra_clause_field;
-        RegionAllocator<uint32_t>::moveTo(to); }
+        for (int r = 0; r < NUM_REGIONS; r++)
+            if (collects(r))
+                d_regions[r].moveTo(to.d_regions[r]);
+    }
 
     template<class Lits>
-    CRef alloc(int level, const Lits& ps, bool removable = false)
+    CRef alloc(int level, const Lits& ps, bool removable = false, Region region = REGION_INPUT)
     {
       Assert(sizeof(Lit) == sizeof(uint32_t));
       Assert(sizeof(float) == sizeof(uint32_t));
       bool use_extra = removable | extra_clause_field;
 
-      CRef cid = RegionAllocator<uint32_t>::alloc(
-          clauseWord32Size(ps.size(), use_extra));
+      RegionAllocator<uint32_t>& ra = d_regions[region];
+      uint32_t offset = ra.alloc(clauseWord32Size(ps.size(), use_extra));
+      if (ra.size() > OFFSET_MASK) throw OutOfMemoryException();
+      CRef cid = (uint32_t(region) << OFFSET_BITS) | offset;
       new (lea(cid)) Clause(ps, use_extra, removable, level);
 
       return cid;
     }
 
-    // Deref, Load Effective Address (LEA), Inverse of LEA (AEL):
-    Clause&       operator[](Ref r)       { return (Clause&)RegionAllocator<uint32_t>::operator[](r); }
-    const Clause& operator[](Ref r) const { return (Clause&)RegionAllocator<uint32_t>::operator[](r); }
-    Clause*       lea       (Ref r)       { return (Clause*)RegionAllocator<uint32_t>::lea(r); }
-    const Clause* lea       (Ref r) const { return (Clause*)RegionAllocator<uint32_t>::lea(r); }
-    Ref           ael       (const Clause* t){ return RegionAllocator<uint32_t>::ael((uint32_t*)t); }
+    /** The region of the clause cr */
+    static Region region(CRef cr) { return Region(cr >> OFFSET_BITS); }
+
+    /** The total size (in words) of all regions */
+    uint32_t size() const
+    {
+        return size(REGION_INPUT) + size(REGION_LEARNT) + size(REGION_LEMMA);
+    }
+    /** The total size (in words) of the freed clauses of all regions */
+    uint32_t wasted() const
+    {
+        return wasted(REGION_INPUT) + wasted(REGION_LEARNT)
+               + wasted(REGION_LEMMA);
+    }
+    uint32_t size(int r) const { return d_regions[r].size(); }
+    uint32_t wasted(int r) const { return d_regions[r].wasted(); }
+
+    // Deref, Load Effective Address (LEA):
+    Clause&       operator[](Ref r)       { return *lea(r); }
+    const Clause& operator[](Ref r) const { return *lea(r); }
+    Clause* lea(Ref r)
+    {
+        return (Clause*)d_regions[r >> OFFSET_BITS].lea(r & OFFSET_MASK);
+    }
+    const Clause* lea(Ref r) const
+    {
+        return (const Clause*)d_regions[r >> OFFSET_BITS].lea(r & OFFSET_MASK);
+    }
 
     void free(CRef cid)
     {
         Clause& c = operator[](cid);
-        RegionAllocator<uint32_t>::free(clauseWord32Size(c.size(), c.has_extra()));
+        d_regions[region(cid)].free(clauseWord32Size(c.size(), c.has_extra()));
     }
 
+    /**
+     * Relocate the clause cr into the arena to, if to collects its region;
+     * otherwise cr stays where it is.
+     */
     void reloc(CRef& cr,
                ClauseAllocator& to,
                CVC5::TSatProof<Solver>* proof = NULL);
     // Implementation moved to Solver.cc.
+
+ private:
+    enum { OFFSET_BITS = 30 };
+    static constexpr uint32_t OFFSET_MASK = (uint32_t(1) << OFFSET_BITS) - 1;
+
+    /** Return true if this arena collects the region r */
+    bool collects(int r) const { return (d_collect >> r) & 1; }
+
+    RegionAllocator<uint32_t> d_regions[NUM_REGIONS];
+    /** The mask of regions moved by moveTo() */
+    uint32_t d_collect;
 };
 
 
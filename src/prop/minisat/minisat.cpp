@@ -124,6 +124,8 @@ void MinisatSatSolver::initialize(context::Context* context,
       options::incrementalSolving()
           || options::decisionMode() != options::DecisionMode::INTERNAL);
 
+  d_minisat->setDratWriter(DratWriter::create("prop::minisat"));
+
   d_statistics.init(d_minisat);
 }
 
@@ -147,6 +149,12 @@ void MinisatSatSolver::setupOptions() {
   d_minisat->clause_decay = options::satClauseDecay();
   d_minisat->restart_first = options::satRestartFirst();
   d_minisat->restart_inc = options::satRestartInc();
+  d_minisat->chrono_threshold =
+      options::satChrono() ? options::satChronoThreshold() : -1;
+  d_minisat->inprocess_interval =
+      options::satInprocess() ? options::satInprocessInterval() : -1;
+  d_minisat->core_lbd = options::satTiers() ? options::satTiersCoreLbd() : -1;
+  d_minisat->tier2_lbd = options::satTiersTier2Lbd();
 }
 
 ClauseId MinisatSatSolver::addClause(SatClause& clause, bool removable) {
@@ -225,6 +233,21 @@ bool MinisatSatSolver::isDecision(SatVariable decn) const {
   return d_minisat->isDecision( decn );
 }
 
+double MinisatSatSolver::getActivity(SatVariable var) const
+{
+  return d_minisat->getActivity(var);
+}
+
+int64_t MinisatSatSolver::lookaheadDecide(SatLiteral lit)
+{
+  return d_minisat->lookaheadDecide(toMinisatLit(lit));
+}
+
+void MinisatSatSolver::lookaheadBacktrack()
+{
+  d_minisat->lookaheadBacktrack();
+}
+
 SatProofManager* MinisatSatSolver::getProofManager()
 {
   return d_minisat->getProofManager();
@@ -263,7 +286,20 @@ MinisatSatSolver::Statistics::Statistics(StatisticsRegistry* registry) :
     d_statClausesLiterals("sat::clauses_literals"),
     d_statLearntsLiterals("sat::learnts_literals"),
     d_statMaxLiterals("sat::max_literals"),
-    d_statTotLiterals("sat::tot_literals")
+    d_statTotLiterals("sat::tot_literals"),
+    d_statChronoBacktracks("sat::chrono_backtracks"),
+    d_statInprocessRounds("sat::inprocess_rounds"),
+    d_statInprocessPropagations("sat::inprocess_propagations"),
+    d_statVivifiedClauses("sat::vivified_clauses"),
+    d_statVivifiedLiterals("sat::vivified_literals"),
+    d_statSubsumedClauses("sat::subsumed_clauses"),
+    d_statStrengthenedClauses("sat::strengthened_clauses"),
+    d_statInprocessEliminatedVars("sat::inprocess_eliminated_vars"),
+    d_statTierPromotions("sat::tier_promotions"),
+    d_statTierDemotions("sat::tier_demotions"),
+    d_statReducedLearnts("sat::reduced_learnts"),
+    d_statReducedLemmas("sat::reduced_lemmas"),
+    d_statLemmaUses("sat::lemma_uses")
 {
   d_registry->registerStat(&d_statStarts);
   d_registry->registerStat(&d_statDecisions);
@@ -274,6 +310,19 @@ MinisatSatSolver::Statistics::Statistics(StatisticsRegistry* registry) :
   d_registry->registerStat(&d_statLearntsLiterals);
   d_registry->registerStat(&d_statMaxLiterals);
   d_registry->registerStat(&d_statTotLiterals);
+  d_registry->registerStat(&d_statChronoBacktracks);
+  d_registry->registerStat(&d_statInprocessRounds);
+  d_registry->registerStat(&d_statInprocessPropagations);
+  d_registry->registerStat(&d_statVivifiedClauses);
+  d_registry->registerStat(&d_statVivifiedLiterals);
+  d_registry->registerStat(&d_statSubsumedClauses);
+  d_registry->registerStat(&d_statStrengthenedClauses);
+  d_registry->registerStat(&d_statInprocessEliminatedVars);
+  d_registry->registerStat(&d_statTierPromotions);
+  d_registry->registerStat(&d_statTierDemotions);
+  d_registry->registerStat(&d_statReducedLearnts);
+  d_registry->registerStat(&d_statReducedLemmas);
+  d_registry->registerStat(&d_statLemmaUses);
 }
 
 MinisatSatSolver::Statistics::~Statistics() {
@@ -286,6 +335,19 @@ MinisatSatSolver::Statistics::~Statistics() {
   d_registry->unregisterStat(&d_statLearntsLiterals);
   d_registry->unregisterStat(&d_statMaxLiterals);
   d_registry->unregisterStat(&d_statTotLiterals);
+  d_registry->unregisterStat(&d_statChronoBacktracks);
+  d_registry->unregisterStat(&d_statInprocessRounds);
+  d_registry->unregisterStat(&d_statInprocessPropagations);
+  d_registry->unregisterStat(&d_statVivifiedClauses);
+  d_registry->unregisterStat(&d_statVivifiedLiterals);
+  d_registry->unregisterStat(&d_statSubsumedClauses);
+  d_registry->unregisterStat(&d_statStrengthenedClauses);
+  d_registry->unregisterStat(&d_statInprocessEliminatedVars);
+  d_registry->unregisterStat(&d_statTierPromotions);
+  d_registry->unregisterStat(&d_statTierDemotions);
+  d_registry->unregisterStat(&d_statReducedLearnts);
+  d_registry->unregisterStat(&d_statReducedLemmas);
+  d_registry->unregisterStat(&d_statLemmaUses);
 }
 
 void MinisatSatSolver::Statistics::init(Minisat::SimpSolver* minisat){
@@ -298,6 +360,19 @@ void MinisatSatSolver::Statistics::init(Minisat::SimpSolver* minisat){
   d_statLearntsLiterals.set(minisat->learnts_literals);
   d_statMaxLiterals.set(minisat->max_literals);
   d_statTotLiterals.set(minisat->tot_literals);
+  d_statChronoBacktracks.set(minisat->chrono_backtracks);
+  d_statInprocessRounds.set(minisat->inprocess_rounds);
+  d_statInprocessPropagations.set(minisat->inprocess_propagations);
+  d_statVivifiedClauses.set(minisat->vivified_clauses);
+  d_statVivifiedLiterals.set(minisat->vivified_literals);
+  d_statSubsumedClauses.set(minisat->subsumed_clauses);
+  d_statStrengthenedClauses.set(minisat->strengthened_clauses);
+  d_statInprocessEliminatedVars.set(minisat->inprocess_eliminated_vars);
+  d_statTierPromotions.set(minisat->tier_promotions);
+  d_statTierDemotions.set(minisat->tier_demotions);
+  d_statReducedLearnts.set(minisat->reduced_learnts);
+  d_statReducedLemmas.set(minisat->reduced_lemmas);
+  d_statLemmaUses.set(minisat->lemma_uses);
 }
 
 }  // namespace prop
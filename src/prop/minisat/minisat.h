@@ -82,6 +82,12 @@ class MinisatSatSolver : public CDCLTSatSolverInterface
 
   bool isDecision(SatVariable decn) const override;
 
+  double getActivity(SatVariable var) const override;
+
+  int64_t lookaheadDecide(SatLiteral lit) override;
+
+  void lookaheadBacktrack() override;
+
   /** Retrieve a pointer to the unerlying solver. */
   Minisat::SimpSolver* getSolver() { return d_minisat; }
 
@@ -108,7 +114,16 @@ class MinisatSatSolver : public CDCLTSatSolverInterface
     ReferenceStat<uint64_t> d_statRndDecisions, d_statPropagations;
     ReferenceStat<uint64_t> d_statConflicts, d_statClausesLiterals;
     ReferenceStat<uint64_t> d_statLearntsLiterals,  d_statMaxLiterals;
-    ReferenceStat<uint64_t> d_statTotLiterals;
+    ReferenceStat<uint64_t> d_statTotLiterals, d_statChronoBacktracks;
+    ReferenceStat<uint64_t> d_statInprocessRounds, d_statInprocessPropagations;
+    ReferenceStat<uint64_t> d_statVivifiedClauses, d_statVivifiedLiterals;
+    ReferenceStat<uint64_t> d_statSubsumedClauses, d_statStrengthenedClauses;
+    ReferenceStat<uint64_t> d_statInprocessEliminatedVars;
+    ReferenceStat<uint64_t> d_statTierPromotions;
+    ReferenceStat<uint64_t> d_statTierDemotions;
+    ReferenceStat<uint64_t> d_statReducedLearnts;
+    ReferenceStat<uint64_t> d_statReducedLemmas;
+    ReferenceStat<uint64_t> d_statLemmaUses;
   public:
     Statistics(StatisticsRegistry* registry);
     ~Statistics();
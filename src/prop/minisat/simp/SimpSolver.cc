@@ -154,8 +154,16 @@ lbool SimpSolver::solve_(bool do_simp, bool turn_off_simp)
 
     if (result == l_True)
         result = Solver::solve_();
-    else if (verbosity >= 1)
-        printf("===============================================================================\n");
+    else
+    {
+        if (verbosity >= 1)
+            printf("===============================================================================\n");
+        if (d_drat)
+        {
+            // simplification found the clauses unsatisfiable
+            d_drat->addEmpty();
+        }
+    }
 
     if (result == l_True)
         extendModel();
@@ -170,6 +178,24 @@ lbool SimpSolver::solve_(bool do_simp, bool turn_off_simp)
 
 
 
+bool SimpSolver::inprocess()
+{
+    if (!Solver::inprocess())
+        return false;
+    if (!use_simplification || !use_elim)
+        return true;
+
+    // Eliminate the variables whose clauses changed since the last run. Theory
+    // atoms and the variables that cannot be erased are frozen.
+    int      elim  = eliminated_vars;
+    uint64_t props = propagations;
+    bool     res   = eliminate(false);
+    inprocess_eliminated_vars += eliminated_vars - elim;
+    inprocess_propagations    += propagations - props;
+    return res;
+}
+
+
 bool SimpSolver::addClause_(vec<Lit>& ps, bool removable, ClauseId& id)
 {
 #ifdef CVC4_ASSERTIONS
@@ -237,10 +263,18 @@ bool SimpSolver::strengthenClause(CRef cr, Lit l)
     // if (!find(subsumption_queue, &c))
     subsumption_queue.insert(cr);
 
+    if (d_drat)
+    {
+      d_drat->addStrengthened(c, l);
+    }
     if (c.size() == 2){
         removeClause(cr);
         c.strengthen(l);
     }else{
+        if (d_drat)
+        {
+          d_drat->deleteClause(c);
+        }
         detachClause(cr, true);
         c.strengthen(l);
         attachClause(cr);
@@ -569,11 +603,21 @@ bool SimpSolver::eliminateVar(Var v)
     mkElimClause(elimclauses, ~mkLit(v));
   }
 
+    // Produce clauses in cross product:
+    vec<Lit>& resolvent = add_tmp;
+    if (d_drat)
+    {
+      // the resolvents must be in the proof before their antecedents are
+      // deleted
+      for (int i = 0; i < pos.size(); i++)
+        for (int j = 0; j < neg.size(); j++)
+          if (merge(ca[pos[i]], ca[neg[j]], v, resolvent))
+            d_drat->addDerived(resolvent);
+    }
+
     for (int i = 0; i < cls.size(); i++) removeClause(cls[i]);
 
     ClauseId id = ClauseIdUndef;
-    // Produce clauses in cross product:
-    vec<Lit>& resolvent = add_tmp;
     for (int i = 0; i < pos.size(); i++)
         for (int j = 0; j < neg.size(); j++) {
             bool removable = ca[pos[i]].removable() && ca[pos[neg[j]]].removable();
@@ -589,6 +633,8 @@ bool SimpSolver::eliminateVar(Var v)
     // Free watchers lists for this variable, if possible:
     if (watches[ mkLit(v)].size() == 0) watches[ mkLit(v)].clear(true);
     if (watches[~mkLit(v)].size() == 0) watches[~mkLit(v)].clear(true);
+    if (watches_bin[ mkLit(v)].size() == 0) watches_bin[ mkLit(v)].clear(true);
+    if (watches_bin[~mkLit(v)].size() == 0) watches_bin[~mkLit(v)].clear(true);
 
     return backwardSubsumptionCheck();
 }
@@ -617,6 +663,10 @@ bool SimpSolver::substitute(Var v, Lit x)
       Lit p = c[j];
       subst_clause.push(var(p) == v ? x ^ sign(p) : p);
     }
+    if (d_drat)
+    {
+      d_drat->addDerived(subst_clause);
+    }
 
     removeClause(cls[i]);
     ClauseId id = ClauseIdUndef;
@@ -776,21 +826,22 @@ void SimpSolver::relocAll(ClauseAllocator& to)
 }
 
 
-void SimpSolver::garbageCollect()
+void SimpSolver::garbageCollect(uint32_t regions)
 {
-    // Initialize the next region to a size corresponding to the estimated utilization degree. This
-    // is not precise but should avoid some unnecessary reallocations for the new region:
-    ClauseAllocator to(ca.size() - ca.wasted());
+    // Initialize the next regions to a size corresponding to the estimated utilization degree. This
+    // is not precise but should avoid some unnecessary reallocations for the new regions:
+    ClauseAllocator to(ca, regions);
 
     cleanUpClauses();
     to.extra_clause_field = ca.extra_clause_field; // NOTE: this is important to keep (or lose) the extra fields.
     relocAll(to);
     Solver::relocAll(to);
+    uint32_t before = ca.size();
+    to.moveTo(ca);
     if (verbosity >= 2)
       printf(
           "|  Garbage collection:   %12d bytes => %12d bytes             |\n",
-          ca.size() * ClauseAllocator::Unit_Size,
-          to.size() * ClauseAllocator::Unit_Size);
-    to.moveTo(ca);
+          before * ClauseAllocator::Unit_Size,
+          ca.size() * ClauseAllocator::Unit_Size);
     // TODO: proof.finalizeUpdateId();
 }
@@ -98,7 +98,8 @@ class SimpSolver : public Solver {
 
   // Memory managment:
   //
-  void garbageCollect() override;
+  void garbageCollect(
+      uint32_t regions = ClauseAllocator::ALL_REGIONS) override;
 
   // Generate a (possibly simplified) DIMACS file:
   //
@@ -179,6 +180,7 @@ class SimpSolver : public Solver {
     // Main internal methods:
     //
     lbool         solve_                   (bool do_simp = true, bool turn_off_simp = false);
+    bool          inprocess                () override;
     bool          asymm                    (Var v, CRef cr);
     bool          asymmVar                 (Var v);
     void          updateElimHeap           (Var v);
@@ -211,7 +213,14 @@ inline void SimpSolver::updateElimHeap(Var v) {
 }
 
 inline bool SimpSolver::addClause(const vec<Lit>& ps, bool removable, ClauseId& id)
-{ ps.copyTo(add_tmp); return addClause_(add_tmp, removable, id); }
+{
+  if (d_drat)
+  {
+    d_drat->addInput(ps);
+  }
+  ps.copyTo(add_tmp);
+  return addClause_(add_tmp, removable, id);
+}
 inline bool SimpSolver::addEmptyClause(bool removable)    { add_tmp.clear(); ClauseId id=-1; return addClause_(add_tmp, removable, id); }
 inline bool SimpSolver::addClause    (Lit p, bool removable, ClauseId& id)
                                                                              { add_tmp.clear(); add_tmp.push(p); return addClause_(add_tmp, removable, id); }
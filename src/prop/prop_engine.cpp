@@ -28,6 +28,7 @@
 #include "options/main_options.h"
 #include "options/options.h"
 #include "options/proof_options.h"
+#include "options/prop_options.h"
 #include "options/smt_options.h"
 #include "proof/proof_manager.h"
 #include "prop/cnf_stream.h"
@@ -72,6 +73,7 @@ PropEngine::PropEngine(TheoryEngine* te,
                        OutputManager& outMgr,
                        ProofNodeManager* pnm)
     : d_inCheckSat(false),
+      d_inLemmaBatch(false),
       d_theoryEngine(te),
       d_context(satContext),
       d_theoryProxy(nullptr),
@@ -89,7 +91,14 @@ PropEngine::PropEngine(TheoryEngine* te,
   d_decisionEngine.reset(new DecisionEngine(satContext, userContext, rm));
   d_decisionEngine->init();  // enable appropriate strategies
 
-  d_satSolver = SatSolverFactory::createCDCLTMinisat(smtStatisticsRegistry());
+  if (options::cdcltSatSolver() == options::CDCLTSatSolverMode::CADICAL)
+  {
+    d_satSolver = SatSolverFactory::createCDCLTCadical(smtStatisticsRegistry());
+  }
+  else
+  {
+    d_satSolver = SatSolverFactory::createCDCLTMinisat(smtStatisticsRegistry());
+  }
 
   // CNF stream and theory proxy required pointers to each other, make the
   // theory proxy first
@@ -127,6 +136,11 @@ PropEngine::PropEngine(TheoryEngine* te,
   {
     ProofManager::currentPM()->initCnfProof(d_cnfStream, userContext);
   }
+  else
+  {
+    d_cnfStream->setEncoding(options::cnfPolarity(),
+                             options::cnfStructHash());
+  }
 }
 
 void PropEngine::finishInit()
@@ -229,10 +243,61 @@ void PropEngine::assertLemma(theory::TrustNode tlemma, theory::LemmaProperty p)
     }
   }
 
+  if (d_inLemmaBatch)
+  {
+    ++d_statistics.d_numBatchedLemmas;
+    if (!tplemma.isNull())
+    {
+      auto it = d_lemmaQueueIndex.find(tplemma.getProven());
+      if (it != d_lemmaQueueIndex.end())
+      {
+        // already queued, the skolem definitions are queued with it
+        QueuedLemma& ql = d_lemmaQueue[it->second];
+        ql.d_removable = ql.d_removable && removable;
+        ++d_statistics.d_numDuplicateLemmas;
+        return;
+      }
+      d_lemmaQueueIndex[tplemma.getProven()] = d_lemmaQueue.size();
+    }
+    d_lemmaQueue.push_back(QueuedLemma{
+        tplemma, std::move(ppLemmas), std::move(ppSkolems), removable});
+    return;
+  }
+
   // now, assert the lemmas
   assertLemmasInternal(tplemma, ppLemmas, ppSkolems, removable);
 }
 
+void PropEngine::beginLemmaBatch()
+{
+  d_inLemmaBatch = options::lemmaBatch();
+}
+
+void PropEngine::flushLemmas()
+{
+  // lemmas sent while asserting the queued ones (e.g., from
+  // preregistration) are asserted right away
+  d_inLemmaBatch = false;
+  if (d_lemmaQueue.empty())
+  {
+    return;
+  }
+  TimerStat::CodeTimer codeTimer(d_statistics.d_flushTime);
+  ++d_statistics.d_numBatches;
+  d_statistics.d_batchSize << d_lemmaQueue.size();
+  std::vector<QueuedLemma> queue;
+  queue.swap(d_lemmaQueue);
+  d_lemmaQueueIndex.clear();
+  // The atoms shared by the lemmas of the batch get their literals once, in
+  // the CNF stream, and the SAT solver integrates all the resulting clauses
+  // at its next propagation.
+  for (const QueuedLemma& ql : queue)
+  {
+    assertLemmasInternal(
+        ql.d_lemma, ql.d_ppLemmas, ql.d_ppSkolems, ql.d_removable);
+  }
+}
+
 void PropEngine::assertTrustedLemmaInternal(theory::TrustNode trn,
                                             bool removable)
 {
@@ -296,6 +361,13 @@ void PropEngine::assertLemmasInternal(
 void PropEngine::requirePhase(TNode n, bool phase) {
   Debug("prop") << "requirePhase(" << n << ", " << phase << ")" << std::endl;
 
+  // n may only get its literal from a queued lemma
+  if (d_inLemmaBatch)
+  {
+    flushLemmas();
+    d_inLemmaBatch = true;
+  }
+
   Assert(n.getType().isBoolean());
   SatLiteral lit = d_cnfStream->getLiteral(n);
   d_satSolver->requirePhase(phase ? lit : ~lit);
@@ -341,6 +413,9 @@ Result PropEngine::checkSat() {
     return Result(Result::SAT_UNKNOWN, Result::REQUIRES_FULL_CHECK);
   }
 
+  // Assert the lemmas left over if a theory check was interrupted
+  flushLemmas();
+
   // Reset the interrupted flag
   d_interrupted = false;
 
@@ -369,6 +444,145 @@ Result PropEngine::checkSat() {
   return Result(result == SAT_VALUE_TRUE ? Result::SAT : Result::UNSAT);
 }
 
+std::vector<std::vector<Node>> PropEngine::getCubes(uint32_t depth)
+{
+  Assert(!d_inCheckSat) << "Sat solver in solve()!";
+  std::vector<std::vector<Node>> cubes;
+  if (!d_satSolver->ok())
+  {
+    return cubes;
+  }
+  // the atoms that are not fixed yet, in the order of their conversion to CNF
+  std::vector<std::pair<SatLiteral, Node>> atoms;
+  for (const auto& entry : d_cnfStream->getTranslationCache())
+  {
+    TNode n = entry.first;
+    SatLiteral lit = entry.second;
+    switch (n.getKind())
+    {
+      case kind::NOT:
+      case kind::AND:
+      case kind::OR:
+      case kind::XOR:
+      case kind::IMPLIES:
+      case kind::ITE:
+      case kind::CONST_BOOLEAN: continue;
+      case kind::EQUAL:
+        if (n[0].getType().isBoolean())
+        {
+          continue;
+        }
+        break;
+      default: break;
+    }
+    if (d_satSolver->value(lit) == SAT_VALUE_UNKNOWN
+        && d_satSolver->isDecision(lit.getSatVariable()))
+    {
+      atoms.emplace_back(lit, n);
+    }
+  }
+  Trace("prop-cubes") << "PropEngine::getCubes: " << atoms.size()
+                      << " candidate atoms" << std::endl;
+  std::vector<Node> cube;
+  splitCube(atoms, depth, cube, cubes);
+  Trace("prop-cubes") << "PropEngine::getCubes: " << cubes.size() << " cubes"
+                      << std::endl;
+  return cubes;
+}
+
+void PropEngine::splitCube(
+    const std::vector<std::pair<SatLiteral, Node>>& atoms,
+    uint32_t depth,
+    std::vector<Node>& cube,
+    std::vector<std::vector<Node>>& cubes)
+{
+  size_t best = atoms.size();
+  uint64_t bestScore = 0;
+  // the number of failed literals added to cube
+  size_t numImplied = 0;
+  bool refuted = false;
+  bool rescan = depth > 0;
+  while (rescan)
+  {
+    rescan = false;
+    best = atoms.size();
+    bestScore = 0;
+    uint32_t numScored = 0;
+    for (size_t i = 0, size = atoms.size();
+         i < size && numScored < options::cubeLookaheadAtoms();
+         ++i)
+    {
+      SatLiteral atom = atoms[i].first;
+      if (d_satSolver->value(atom) != SAT_VALUE_UNKNOWN)
+      {
+        continue;
+      }
+      ++numScored;
+      int64_t pos = d_satSolver->lookaheadDecide(atom);
+      if (pos >= 0)
+      {
+        d_satSolver->lookaheadBacktrack();
+      }
+      int64_t neg = d_satSolver->lookaheadDecide(~atom);
+      if (neg >= 0)
+      {
+        d_satSolver->lookaheadBacktrack();
+      }
+      if (pos < 0 && neg < 0)
+      {
+        refuted = true;
+        break;
+      }
+      if (pos < 0 || neg < 0)
+      {
+        // a failed literal, the cube implies the other polarity of the atom
+        bool phase = neg < 0;
+        d_satSolver->lookaheadDecide(phase ? atom : ~atom);
+        cube.push_back(phase ? atoms[i].second : atoms[i].second.notNode());
+        ++numImplied;
+        rescan = true;
+        break;
+      }
+      // prefer atoms that propagate a lot in both polarities
+      uint64_t score = static_cast<uint64_t>(pos) * static_cast<uint64_t>(neg);
+      if (score > bestScore)
+      {
+        best = i;
+        bestScore = score;
+      }
+    }
+  }
+  if (refuted)
+  {
+    Trace("prop-cubes") << "refuted cube of size " << cube.size()
+                        << std::endl;
+  }
+  else if (best == atoms.size())
+  {
+    cubes.push_back(cube);
+  }
+  else
+  {
+    Trace("prop-cubes") << "split on " << atoms[best].second << " with score "
+                        << bestScore << std::endl;
+    for (bool phase : {true, false})
+    {
+      SatLiteral atom = atoms[best].first;
+      d_satSolver->lookaheadDecide(phase ? atom : ~atom);
+      cube.push_back(phase ? atoms[best].second
+                           : atoms[best].second.notNode());
+      splitCube(atoms, depth - 1, cube, cubes);
+      cube.pop_back();
+      d_satSolver->lookaheadBacktrack();
+    }
+  }
+  for (; numImplied > 0; --numImplied)
+  {
+    cube.pop_back();
+    d_satSolver->lookaheadBacktrack();
+  }
+}
+
 Node PropEngine::getValue(TNode node) const
 {
   Assert(node.getType().isBoolean());
@@ -492,6 +706,7 @@ Node PropEngine::getPreprocessedTerm(TNode n,
 void PropEngine::push()
 {
   Assert(!d_inCheckSat) << "Sat solver in solve()!";
+  flushLemmas();
   d_satSolver->push();
   Debug("prop") << "push()" << std::endl;
 }
@@ -499,6 +714,7 @@ void PropEngine::push()
 void PropEngine::pop()
 {
   Assert(!d_inCheckSat) << "Sat solver in solve()!";
+  flushLemmas();
   d_satSolver->pop();
   Debug("prop") << "pop()" << std::endl;
 }
@@ -615,5 +831,28 @@ std::shared_ptr<ProofNode> PropEngine::getProof()
 
 bool PropEngine::isProofEnabled() const { return d_pfCnfStream != nullptr; }
 
+PropEngine::Statistics::Statistics()
+    : d_numBatches("prop::PropEngine::lemmaBatches", 0),
+      d_numBatchedLemmas("prop::PropEngine::batchedLemmas", 0),
+      d_numDuplicateLemmas("prop::PropEngine::duplicateBatchedLemmas", 0),
+      d_batchSize("prop::PropEngine::lemmaBatchSize"),
+      d_flushTime("prop::PropEngine::lemmaBatchTime")
+{
+  smtStatisticsRegistry()->registerStat(&d_numBatches);
+  smtStatisticsRegistry()->registerStat(&d_numBatchedLemmas);
+  smtStatisticsRegistry()->registerStat(&d_numDuplicateLemmas);
+  smtStatisticsRegistry()->registerStat(&d_batchSize);
+  smtStatisticsRegistry()->registerStat(&d_flushTime);
+}
+
+PropEngine::Statistics::~Statistics()
+{
+  smtStatisticsRegistry()->unregisterStat(&d_numBatches);
+  smtStatisticsRegistry()->unregisterStat(&d_numBatchedLemmas);
+  smtStatisticsRegistry()->unregisterStat(&d_numDuplicateLemmas);
+  smtStatisticsRegistry()->unregisterStat(&d_batchSize);
+  smtStatisticsRegistry()->unregisterStat(&d_flushTime);
+}
+
 }  // namespace prop
 }  // namespace CVC5
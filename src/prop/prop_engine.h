@@ -21,11 +21,16 @@
 #ifndef CVC4__PROP_ENGINE_H
 #define CVC4__PROP_ENGINE_H
 
+#include <unordered_map>
+#include <vector>
+
 #include "context/cdlist.h"
 #include "expr/node.h"
 #include "theory/output_channel.h"
 #include "theory/trust_node.h"
 #include "util/result.h"
+#include "util/statistics_registry.h"
+#include "util/stats_timer.h"
 
 namespace CVC5 {
 
@@ -41,6 +46,7 @@ class CnfStream;
 class CDCLTSatSolverInterface;
 class ProofCnfStream;
 class PropPfManager;
+class SatLiteral;
 class TheoryProxy;
 
 /**
@@ -150,6 +156,22 @@ class PropEngine
    */
   void assertLemma(theory::TrustNode tlemma, theory::LemmaProperty p);
 
+  /**
+   * Start a batch of lemmas: if lemma batching is enabled (option
+   * --lemma-batch), the lemmas passed to assertLemma() are preprocessed
+   * right away, but only queued until the next call to flushLemmas().  Called
+   * by the theory proxy before each theory check.
+   */
+  void beginLemmaBatch();
+
+  /**
+   * Convert the queued lemmas to CNF and assert them, in the order in which
+   * they were queued, and end the current batch.  Lemmas that are queued
+   * more than once in a batch are asserted once.  Called by the theory proxy
+   * after each theory check.
+   */
+  void flushLemmas();
+
   /**
    * If ever n is decided upon, it must be in the given phase.  This
    * occurs *globally*, i.e., even if the literal is untranslated by
@@ -174,6 +196,17 @@ class PropEngine
    */
   Result checkSat();
 
+  /**
+   * Split the current assertions into cubes by lookahead. Each split decides
+   * the atom whose two polarities propagate the most literals, as measured by
+   * Boolean propagation in the SAT solver, up to depth splits along each
+   * branch. Cubes that propagation refutes are dropped, so the assertions are
+   * equivalent to the disjunction of the returned cubes, which are
+   * conjunctions of literals. No cube is returned if the assertions are
+   * unsatisfiable by propagation.
+   */
+  std::vector<std::vector<Node>> getCubes(uint32_t depth);
+
   /**
    * Get the value of a boolean variable.
    *
@@ -301,6 +334,16 @@ class PropEngine
   /** Dump out the satisfying assignment (after SAT result) */
   void printSatisfyingAssignment();
 
+  /**
+   * Add the cubes that extend cube by up to depth splits on atoms, given with
+   * their SAT literals, to cubes, see getCubes(). The literals of cube are
+   * decided in the SAT solver.
+   */
+  void splitCube(const std::vector<std::pair<SatLiteral, Node>>& atoms,
+                 uint32_t depth,
+                 std::vector<Node>& cube,
+                 std::vector<std::vector<Node>>& cubes);
+
   /**
    * Converts the given formula to CNF and asserts the CNF to the SAT solver.
    * The formula can be removed by the SAT solver after backtracking lower
@@ -336,12 +379,48 @@ class PropEngine
                             const std::vector<Node>& ppSkolems,
                             bool removable);
 
+  /** A lemma queued in a batch, see beginLemmaBatch() */
+  struct QueuedLemma
+  {
+    /** The preprocessed lemma */
+    theory::TrustNode d_lemma;
+    /** The skolem definitions from preprocessing the lemma */
+    std::vector<theory::TrustNode> d_ppLemmas;
+    /** The skolems of d_ppLemmas */
+    std::vector<Node> d_ppSkolems;
+    bool d_removable;
+  };
+
+  /** Statistics on lemma batches */
+  struct Statistics
+  {
+    /** The number of non-empty batches */
+    IntStat d_numBatches;
+    /** The number of lemmas queued in batches */
+    IntStat d_numBatchedLemmas;
+    /** The number of lemmas dropped since they were queued before */
+    IntStat d_numDuplicateLemmas;
+    /** The average number of lemmas per non-empty batch */
+    AverageStat d_batchSize;
+    /** The time spent converting and asserting batches */
+    TimerStat d_flushTime;
+    Statistics();
+    ~Statistics();
+  };
+
   /**
    * Indicates that the SAT solver is currently solving something and we should
    * not mess with it's internal state.
    */
   bool d_inCheckSat;
 
+  /** Whether lemmas are queued rather than asserted, see beginLemmaBatch() */
+  bool d_inLemmaBatch;
+  /** The lemmas of the current batch */
+  std::vector<QueuedLemma> d_lemmaQueue;
+  /** The index in d_lemmaQueue of the (proven) lemmas of the current batch */
+  std::unordered_map<Node, size_t, NodeHashFunction> d_lemmaQueueIndex;
+
   /** The theory engine we will be using */
   TheoryEngine* d_theoryEngine;
 
@@ -378,6 +457,8 @@ class PropEngine
 
   /** Reference to the output manager of the smt engine */
   OutputManager& d_outMgr;
+
+  Statistics d_statistics;
 };
 
 }  // namespace prop
@@ -169,8 +169,31 @@ class CDCLTSatSolverInterface : public SatSolver
 
   virtual bool isDecision(SatVariable decn) const = 0;
 
+  /**
+   * Get the activity of var in the decision heuristic of the solver, or 0 if
+   * the solver does not keep activities.
+   */
+  virtual double getActivity(SatVariable var) const { return 0; }
+
   virtual std::shared_ptr<ProofNode> getProof() = 0;
 
+  /**
+   * Decide lit at a new decision level and propagate it without the theories,
+   * for lookahead. Returns the number of literals assigned at the new level,
+   * including lit, or -1 on a conflict, in which case the level is undone.
+   */
+  virtual int64_t lookaheadDecide(SatLiteral lit)
+  {
+    Unimplemented() << "Lookahead not implemented";
+    return -1;
+  }
+
+  /** Undo the level of the last successful lookaheadDecide(). */
+  virtual void lookaheadBacktrack()
+  {
+    Unimplemented() << "Lookahead not implemented";
+  }
+
 }; /* class CDCLTSatSolverInterface */
 
 inline std::ostream& operator <<(std::ostream& out, prop::SatLiteral lit) {
@@ -39,6 +39,17 @@ MinisatSatSolver* SatSolverFactory::createCDCLTMinisat(
   return new MinisatSatSolver(registry);
 }
 
+CDCLTSatSolverInterface* SatSolverFactory::createCDCLTCadical(
+    StatisticsRegistry* registry)
+{
+#ifdef CVC4_USE_CADICAL_PROPAGATOR
+  return new CadicalCDCLTSolver(registry);
+#else
+  Unreachable() << "CVC4 was not compiled with support for the CaDiCaL "
+                   "external propagator.";
+#endif
+}
+
 SatSolver* SatSolverFactory::createCryptoMinisat(StatisticsRegistry* registry,
                                                  const std::string& name)
 {
@@ -0,0 +1,195 @@
+/*********************                                                        */
+/*! \file shared_clause_channel.cpp
+ ** \verbatim
+ ** This file is part of the CVC4 project.
+ ** Copyright (c) 2009-2021 by the authors listed in the file AUTHORS
+ ** in the top-level source directory and their institutional affiliations.
+ ** All rights reserved.  See the file COPYING in the top-level source
+ ** directory for licensing information.\endverbatim
+ **
+ ** \brief A bounded channel for clauses shared by portfolio workers
+ **
+ ** A bounded channel in shared memory through which the worker processes of
+ ** the portfolio mode exchange short learned clauses.
+ **/
+
+#include "prop/shared_clause_channel.h"
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif /* _WIN32 */
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+
+#include "base/check.h"
+
+namespace CVC5 {
+namespace prop {
+
+/**
+ * The header of the shared memory. Positions count the messages sent so far,
+ * the message at position pos is in slot pos % capacity.
+ */
+struct SharedClauseChannel::Header
+{
+  /** The position of the next message to send */
+  std::atomic<uint64_t> d_writePos;
+};
+
+/**
+ * A message slot. Its sequence number is pos + 1 while it holds the message
+ * at position pos, and 0 while a worker writes it, so that readers can detect
+ * messages that were overwritten while they were reading them.
+ */
+struct SharedClauseChannel::Slot
+{
+  /** Taken by the worker that writes the slot */
+  std::atomic<uint32_t> d_lock;
+  /** The size of the message */
+  uint32_t d_size;
+  /** The sequence number */
+  std::atomic<uint64_t> d_seq;
+  /** The index of the worker that sent the message */
+  uint32_t d_worker;
+  /** The message */
+  char d_data[MAX_MESSAGE_SIZE];
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free
+                  && std::atomic<uint32_t>::is_always_lock_free,
+              "atomics in shared memory must be lock-free");
+
+namespace {
+
+/** The channel of this process */
+std::unique_ptr<SharedClauseChannel> s_channel;
+
+}  // namespace
+
+void SharedClauseChannel::create(uint32_t capacity)
+{
+  Assert(s_channel == nullptr);
+  Assert(capacity > 0);
+  size_t size = sizeof(Header) + capacity * sizeof(Slot);
+#ifndef _WIN32
+  // anonymous shared memory is zero-initialized, i.e., all slots are empty
+  void* memory = mmap(nullptr,
+                      size,
+                      PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_ANONYMOUS,
+                      -1,
+                      0);
+  AlwaysAssert(memory != MAP_FAILED)
+      << "cannot allocate shared memory for the portfolio";
+  s_channel.reset(new SharedClauseChannel(memory, size, capacity));
+#else  /* _WIN32 */
+  Unimplemented() << "the portfolio mode is not supported on Windows";
+#endif /* _WIN32 */
+}
+
+void SharedClauseChannel::attach(uint32_t worker, uint64_t boundary)
+{
+  Assert(s_channel != nullptr && !s_channel->d_attached);
+  s_channel->d_worker = worker;
+  s_channel->d_boundary = boundary;
+  s_channel->d_attached = true;
+  s_channel->d_readPos =
+      static_cast<Header*>(s_channel->d_memory)->d_writePos.load();
+}
+
+SharedClauseChannel* SharedClauseChannel::current()
+{
+  return s_channel != nullptr && s_channel->d_attached ? s_channel.get()
+                                                       : nullptr;
+}
+
+SharedClauseChannel::SharedClauseChannel(void* memory,
+                                         size_t size,
+                                         uint32_t capacity)
+    : d_memory(memory),
+      d_size(size),
+      d_capacity(capacity),
+      d_worker(0),
+      d_boundary(0),
+      d_attached(false),
+      d_readPos(0)
+{
+}
+
+SharedClauseChannel::~SharedClauseChannel()
+{
+#ifndef _WIN32
+  munmap(d_memory, d_size);
+#endif /* _WIN32 */
+}
+
+SharedClauseChannel::Slot& SharedClauseChannel::getSlot(uint64_t pos)
+{
+  Slot* slots = reinterpret_cast<Slot*>(static_cast<Header*>(d_memory) + 1);
+  return slots[pos % d_capacity];
+}
+
+bool SharedClauseChannel::send(const std::string& msg)
+{
+  Assert(d_attached);
+  if (msg.size() > MAX_MESSAGE_SIZE)
+  {
+    return false;
+  }
+  uint64_t pos = static_cast<Header*>(d_memory)->d_writePos.fetch_add(1);
+  Slot& slot = getSlot(pos);
+  // a slot is only written by two workers at once if the channel wrapped
+  // around while one of them was writing it
+  while (slot.d_lock.exchange(1, std::memory_order_acquire) != 0)
+  {
+  }
+  slot.d_seq.store(0, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slot.d_worker = d_worker;
+  slot.d_size = msg.size();
+  std::memcpy(slot.d_data, msg.data(), msg.size());
+  slot.d_seq.store(pos + 1, std::memory_order_release);
+  slot.d_lock.store(0, std::memory_order_release);
+  return true;
+}
+
+bool SharedClauseChannel::receive(std::string& msg)
+{
+  Assert(d_attached);
+  uint64_t writePos = static_cast<Header*>(d_memory)->d_writePos.load();
+  while (d_readPos < writePos)
+  {
+    if (writePos - d_readPos > d_capacity)
+    {
+      // the messages we have not read yet were overwritten
+      d_readPos = writePos - d_capacity;
+    }
+    Slot& slot = getSlot(d_readPos);
+    uint64_t seq = slot.d_seq.load(std::memory_order_acquire);
+    if (seq < d_readPos + 1)
+    {
+      // the message is still being written, try again later
+      return false;
+    }
+    if (seq == d_readPos + 1 && slot.d_worker != d_worker)
+    {
+      uint32_t size = std::min<uint32_t>(slot.d_size, MAX_MESSAGE_SIZE);
+      msg.assign(slot.d_data, size);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (slot.d_seq.load(std::memory_order_relaxed) == seq)
+      {
+        ++d_readPos;
+        return true;
+      }
+    }
+    // our own message, or one that was overwritten while we read it
+    ++d_readPos;
+  }
+  return false;
+}
+
+}  // namespace prop
+}  // namespace CVC5
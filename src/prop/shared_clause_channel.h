@@ -0,0 +1,118 @@
+/*********************                                                        */
+/*! \file shared_clause_channel.h
+ ** \verbatim
+ ** This file is part of the CVC4 project.
+ ** Copyright (c) 2009-2021 by the authors listed in the file AUTHORS
+ ** in the top-level source directory and their institutional affiliations.
+ ** All rights reserved.  See the file COPYING in the top-level source
+ ** directory for licensing information.\endverbatim
+ **
+ ** \brief A bounded channel for clauses shared by portfolio workers
+ **
+ ** A bounded channel in shared memory through which the worker processes of
+ ** the portfolio mode exchange short learned clauses.
+ **/
+
+#include "cvc4_private_library.h"
+
+#ifndef CVC4__PROP__SHARED_CLAUSE_CHANNEL_H
+#define CVC4__PROP__SHARED_CLAUSE_CHANNEL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "cvc4_export.h"
+
+namespace CVC5 {
+namespace prop {
+
+/**
+ * A ring buffer of messages in memory that is shared between the worker
+ * processes of the portfolio mode. The driver creates the channel before
+ * forking the workers, and each worker attaches to it as soon as it is forked.
+ *
+ * The channel is bounded: a message overwrites the oldest one once the buffer
+ * is full, and a worker that falls behind skips the messages it has missed.
+ * Sending and receiving never block on other workers.
+ *
+ * The messages are opaque to the channel, the theory proxy encodes clauses
+ * in them (see TheoryProxy::notifyLearnedClause()).
+ */
+class CVC4_EXPORT SharedClauseChannel
+{
+ public:
+  /** The maximal size of a message, in bytes */
+  static constexpr size_t MAX_MESSAGE_SIZE = 240;
+
+  /**
+   * Create the channel of this process, in memory that is shared with the
+   * processes forked from it later.
+   *
+   * @param capacity the number of messages the channel holds
+   */
+  static void create(uint32_t capacity = 4096);
+
+  /**
+   * Attach the current process, forked after create(), to the channel.
+   *
+   * @param worker the index of the worker
+   * @param boundary the nodes with ids below boundary were created before the
+   * fork, and have the same ids in all workers
+   */
+  static void attach(uint32_t worker, uint64_t boundary);
+
+  /**
+   * Get the channel of the current process, or nullptr if it is not a
+   * portfolio worker.
+   */
+  static SharedClauseChannel* current();
+
+  ~SharedClauseChannel();
+
+  /** Get the index of the worker of this process */
+  uint32_t getWorker() const { return d_worker; }
+  /** Get the boundary of the node ids that are the same in all workers */
+  uint64_t getBoundary() const { return d_boundary; }
+
+  /**
+   * Send a message to the other workers. Returns false if the message is
+   * longer than MAX_MESSAGE_SIZE, in which case it is not sent.
+   */
+  bool send(const std::string& msg);
+
+  /**
+   * Receive the next message sent by another worker. Returns false if there
+   * is none.
+   */
+  bool receive(std::string& msg);
+
+ private:
+  struct Header;
+  struct Slot;
+
+  SharedClauseChannel(void* memory, size_t size, uint32_t capacity);
+
+  /** Get the slot of the message at position pos */
+  Slot& getSlot(uint64_t pos);
+
+  /** The shared memory */
+  void* d_memory;
+  /** The size of the shared memory */
+  size_t d_size;
+  /** The number of messages the channel holds */
+  uint32_t d_capacity;
+  /** The index of the worker of this process */
+  uint32_t d_worker;
+  /** The node id boundary, see attach() */
+  uint64_t d_boundary;
+  /** Whether this process is attached */
+  bool d_attached;
+  /** The position of the next message to receive */
+  uint64_t d_readPos;
+}; /* class SharedClauseChannel */
+
+}  // namespace prop
+}  // namespace CVC5
+
+#endif /* CVC4__PROP__SHARED_CLAUSE_CHANNEL_H */
@@ -16,13 +16,18 @@
  **/
 #include "prop/theory_proxy.h"
 
+#include <cctype>
+#include <sstream>
+
 #include "context/context.h"
 #include "decision/decision_engine.h"
 #include "options/decision_options.h"
+#include "options/prop_options.h"
 #include "options/smt_options.h"
 #include "proof/cnf_proof.h"
 #include "prop/cnf_stream.h"
 #include "prop/prop_engine.h"
+#include "prop/shared_clause_channel.h"
 #include "smt/smt_statistics_registry.h"
 #include "theory/rewriter.h"
 #include "theory/theory_engine.h"
@@ -42,9 +47,23 @@ TheoryProxy::TheoryProxy(PropEngine* propEngine,
       d_decisionEngine(decisionEngine),
       d_theoryEngine(theoryEngine),
       d_queue(context),
+      d_channel(nullptr),
+      d_sharedClauseSize(0),
       d_tpp(*theoryEngine, userContext, pnm),
       d_skdm(new SkolemDefManager(context, userContext))
 {
+  // Shared clauses are asserted without proofs, and are only consequences of
+  // the assertions of a single check.
+  if (options::portfolioShareSize() > 0 && !options::produceProofs()
+      && !options::unsatCores() && !options::incrementalSolving())
+  {
+    d_channel = SharedClauseChannel::current();
+  }
+  if (d_channel != nullptr)
+  {
+    d_sharedClauseSize = options::portfolioShareSize();
+    d_statistics.reset(new Statistics());
+  }
 }
 
 TheoryProxy::~TheoryProxy() {
@@ -86,7 +105,13 @@ void TheoryProxy::theoryCheck(theory::Theory::Effort effort) {
     d_queue.pop();
     d_theoryEngine->assertFact(assertion);
   }
+  d_propEngine->beginLemmaBatch();
   d_theoryEngine->check(effort);
+  if (d_channel != nullptr)
+  {
+    importSharedClauses();
+  }
+  d_propEngine->flushLemmas();
 }
 
 void TheoryProxy::theoryPropagate(std::vector<SatLiteral>& output) {
@@ -230,7 +255,168 @@ void TheoryProxy::getSkolems(TNode node,
   }
 }
 
-void TheoryProxy::preRegister(Node n) { d_theoryEngine->preRegister(n); }
+void TheoryProxy::preRegister(Node n)
+{
+  d_theoryEngine->preRegister(n);
+  if (d_channel != nullptr && d_sharedKeys.find(n) == d_sharedKeys.end())
+  {
+    std::unordered_map<TNode, std::string, TNodeHashFunction> keys;
+    std::string key = getSharedKey(n, keys);
+    if (!key.empty())
+    {
+      d_sharedKeys[n] = key;
+      d_sharedAtoms[key] = n;
+    }
+  }
+}
+
+std::string TheoryProxy::getSharedKey(
+    TNode n, std::unordered_map<TNode, std::string, TNodeHashFunction>& keys)
+{
+  auto it = keys.find(n);
+  if (it != keys.end())
+  {
+    return it->second;
+  }
+  std::stringstream ss;
+  if (n.getId() < d_channel->getBoundary())
+  {
+    ss << '#' << n.getId();
+  }
+  else if (n.isConst())
+  {
+    std::stringstream value;
+    value << n << ' ' << n.getType();
+    ss << 'c' << value.str().size() << ':' << value.str();
+  }
+  else if (n.getNumChildren() > 0)
+  {
+    ss << '(' << n.getKind();
+    if (n.getMetaKind() == kind::metakind::PARAMETERIZED)
+    {
+      std::string key = getSharedKey(n.getOperator(), keys);
+      if (key.empty())
+      {
+        keys[n] = key;
+        return key;
+      }
+      ss << ' ' << key;
+    }
+    for (TNode child : n)
+    {
+      std::string key = getSharedKey(child, keys);
+      if (key.empty())
+      {
+        keys[n] = key;
+        return key;
+      }
+      ss << ' ' << key;
+    }
+    ss << ')';
+  }
+  std::string key = ss.str();
+  // keys that do not fit into a message are not useful
+  if (key.size() > SharedClauseChannel::MAX_MESSAGE_SIZE)
+  {
+    key.clear();
+  }
+  keys[n] = key;
+  return key;
+}
+
+void TheoryProxy::notifyLearnedClause(const SatClause& clause)
+{
+  if (d_channel == nullptr || clause.size() > d_sharedClauseSize)
+  {
+    return;
+  }
+  // a literal is encoded as its sign followed by the length and the key of
+  // its atom
+  std::stringstream msg;
+  std::vector<Node> lits;
+  for (const SatLiteral& lit : clause)
+  {
+    Node n = d_cnfStream->getNode(lit);
+    bool negated = n.getKind() == kind::NOT;
+    auto it = d_sharedKeys.find(negated ? n[0] : n);
+    if (it == d_sharedKeys.end())
+    {
+      return;
+    }
+    msg << (negated ? '-' : '+') << it->second.size() << ':' << it->second;
+    lits.push_back(n);
+  }
+  Node lemma = lits.size() == 1
+                   ? lits[0]
+                   : NodeManager::currentNM()->mkNode(kind::OR, lits);
+  if (d_shared.insert(lemma).second && d_channel->send(msg.str()))
+  {
+    Trace("portfolio") << "export " << lemma << std::endl;
+    ++d_statistics->d_numExported;
+  }
+}
+
+void TheoryProxy::importSharedClauses()
+{
+  std::string msg;
+  while (d_channel->receive(msg))
+  {
+    std::vector<Node> lits;
+    size_t pos = 0;
+    while (pos < msg.size())
+    {
+      bool negated = msg[pos] == '-';
+      size_t size = 0;
+      size_t colon = pos + 1;
+      for (; colon < msg.size() && std::isdigit(msg[colon]); ++colon)
+      {
+        size = 10 * size + (msg[colon] - '0');
+      }
+      if ((!negated && msg[pos] != '+') || colon == pos + 1
+          || colon >= msg.size() || msg[colon] != ':'
+          || size > msg.size() - colon - 1)
+      {
+        break;
+      }
+      auto it = d_sharedAtoms.find(msg.substr(colon + 1, size));
+      if (it == d_sharedAtoms.end())
+      {
+        // we do not have the atom
+        break;
+      }
+      lits.push_back(negated ? it->second.notNode() : it->second);
+      pos = colon + 1 + size;
+    }
+    if (pos != msg.size() || lits.empty() || lits.size() > d_sharedClauseSize)
+    {
+      continue;
+    }
+    Node lemma = lits.size() == 1
+                     ? lits[0]
+                     : NodeManager::currentNM()->mkNode(kind::OR, lits);
+    if (d_shared.insert(lemma).second)
+    {
+      Trace("portfolio") << "import " << lemma << std::endl;
+      ++d_statistics->d_numImported;
+      d_propEngine->assertLemma(theory::TrustNode::mkTrustLemma(lemma),
+                                theory::LemmaProperty::REMOVABLE);
+    }
+  }
+}
+
+TheoryProxy::Statistics::Statistics()
+    : d_numExported("prop::TheoryProxy::portfolioExportedClauses", 0),
+      d_numImported("prop::TheoryProxy::portfolioImportedClauses", 0)
+{
+  smtStatisticsRegistry()->registerStat(&d_numExported);
+  smtStatisticsRegistry()->registerStat(&d_numImported);
+}
+
+TheoryProxy::Statistics::~Statistics()
+{
+  smtStatisticsRegistry()->unregisterStat(&d_numExported);
+  smtStatisticsRegistry()->unregisterStat(&d_numImported);
+}
 
 }  // namespace prop
 }  // namespace CVC5
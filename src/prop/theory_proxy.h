@@ -23,6 +23,8 @@
 // Optional blocks below will be unconditionally included
 #define CVC4_USE_MINISAT
 
+#include <string>
+#include <unordered_map>
 #include <unordered_set>
 
 #include "context/cdqueue.h"
@@ -34,6 +36,7 @@
 #include "theory/theory_preprocessor.h"
 #include "theory/trust_node.h"
 #include "util/resource_manager.h"
+#include "util/statistics_registry.h"
 
 namespace CVC5 {
 
@@ -44,6 +47,7 @@ namespace prop {
 
 class PropEngine;
 class CnfStream;
+class SharedClauseChannel;
 
 /**
  * The proxy class that allows the SatSolver to communicate with the theories
@@ -136,7 +140,47 @@ class TheoryProxy : public Registrar
   /** Preregister term */
   void preRegister(Node n) override;
 
+  /**
+   * Get the maximal size of the learned clauses that are shared with the
+   * other workers of the portfolio, 0 if this is not a portfolio worker.
+   */
+  unsigned getSharedClauseSize() const { return d_sharedClauseSize; }
+
+  /**
+   * Notify a clause learned by the SAT solver, or a unit theory fact at level
+   * 0, which is shared with the other workers of the portfolio if all its
+   * atoms are shared atoms (see getSharedKey()).
+   */
+  void notifyLearnedClause(const SatClause& clause);
+
  private:
+  /**
+   * Get the key of the shared atom n, or the empty string if n is not
+   * shared. The clauses of the portfolio workers refer to atoms by their
+   * keys: the workers are forked after parsing, so the nodes created before
+   * (with ids below SharedClauseChannel::getBoundary()) have the same ids in
+   * all workers. The key of a node is its id if it was created before the
+   * fork, its printed value for constants, and otherwise built from its kind
+   * and the keys of its operator and children. Nodes with fresh symbols, such
+   * as skolems, do not have a key.
+   */
+  std::string getSharedKey(
+      TNode n, std::unordered_map<TNode, std::string, TNodeHashFunction>& keys);
+
+  /** Assert the clauses shared by the other workers as lemmas */
+  void importSharedClauses();
+
+  /** Statistics on the clauses shared in the portfolio */
+  struct Statistics
+  {
+    /** The number of clauses sent to the other workers */
+    IntStat d_numExported;
+    /** The number of clauses of the other workers asserted as lemmas */
+    IntStat d_numImported;
+    Statistics();
+    ~Statistics();
+  };
+
   /** The prop engine we are using. */
   PropEngine* d_propEngine;
 
@@ -158,6 +202,21 @@ class TheoryProxy : public Registrar
    */
   std::unordered_set<Node, NodeHashFunction> d_shared;
 
+  /** The portfolio channel, or nullptr if clauses are not shared */
+  SharedClauseChannel* d_channel;
+
+  /** The maximal size of shared clauses, see getSharedClauseSize() */
+  unsigned d_sharedClauseSize;
+
+  /** The keys of the shared atoms */
+  std::unordered_map<Node, std::string, NodeHashFunction> d_sharedKeys;
+
+  /** The shared atoms by their keys */
+  std::unordered_map<std::string, Node> d_sharedAtoms;
+
+  /** The statistics */
+  std::unique_ptr<Statistics> d_statistics;
+
   /** The theory preprocessor */
   theory::TheoryPreprocessor d_tpp;
 
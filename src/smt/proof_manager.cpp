@@ -14,6 +14,8 @@
 
 #include "smt/proof_manager.h"
 
+#include <sstream>
+
 #include "expr/proof_checker.h"
 #include "expr/proof_node_algorithm.h"
 #include "expr/proof_node_manager.h"
@@ -57,6 +59,7 @@ PfManager::PfManager(context::UserContext* u, SmtEngine* smte)
       }
     }
   }
+  d_pnm->setHashConsing(options::proofHashCons());
   d_false = NodeManager::currentNM()->mkConst(false);
 }
 
@@ -106,6 +109,12 @@ void PfManager::setFinalProof(std::shared_ptr<ProofNode> pfn,
   Assert(d_pfpp != nullptr);
   d_pfpp->process(pfn);
 
+  if (options::proofCompact())
+  {
+    Trace("smt-proof") << "SmtEngine::setFinalProof(): compact...\n";
+    d_pnm->compact(pfn);
+  }
+
   Trace("smt-proof") << "SmtEngine::setFinalProof(): make scope...\n";
 
   // Now make the final scope, which ensures that the only open leaves
@@ -143,6 +152,17 @@ void PfManager::checkProof(std::shared_ptr<ProofNode> pfn,
   std::shared_ptr<ProofNode> fp = getFinalProof(pfn, as, df);
   Trace("smt-proof-debug") << "PfManager::checkProof: returned " << *fp.get()
                            << std::endl;
+  // the steps were checked when they were constructed; in addition, check
+  // the final proof as a whole, on several threads if requested
+  if (options::proofCheckThreads() > 0)
+  {
+    std::stringstream ss;
+    if (!d_pchecker->checkProof(fp.get(), options::proofCheckThreads(), ss))
+    {
+      InternalError() << "PfManager::checkProof: proof is invalid, "
+                      << ss.str();
+    }
+  }
 }
 
 ProofChecker* PfManager::getProofChecker() const { return d_pchecker.get(); }
@@ -81,6 +81,28 @@ void setDefaults(LogicInfo& logic, bool isInternalSubsolver)
     Notice() << "SmtEngine: setting proof" << std::endl;
     options::produceProofs.set(true);
   }
+  if (options::cdcltSatSolver() == options::CDCLTSatSolverMode::CADICAL
+      && (options::produceProofs() || options::unsatCores()))
+  {
+    throw OptionException(
+        "CaDiCaL as the main SAT solver does not support proofs or unsat "
+        "cores. Try --sat-solver=minisat");
+  }
+  if (!options::dratFile().empty())
+  {
+    if (options::incrementalSolving())
+    {
+      throw OptionException(
+          "DRAT proofs are not supported in incremental mode, since clauses "
+          "are removed when popping user contexts");
+    }
+    if (options::cdcltSatSolver() == options::CDCLTSatSolverMode::CADICAL)
+    {
+      throw OptionException(
+          "DRAT proofs are not supported with CaDiCaL as the main SAT solver. "
+          "Try --sat-solver=minisat");
+    }
+  }
   if (options::bitvectorAigSimplifications.wasSetByUser())
   {
     Notice() << "SmtEngine: setting bitvectorAig" << std::endl;
@@ -894,6 +916,22 @@ void setDefaults(LogicInfo& logic, bool isInternalSubsolver)
     options::decisionMode.set(decMode);
     options::decisionStopOnly.set(stoponly);
   }
+  // the justification heuristic relies on the values of gate literals, which
+  // are only meaningful with full CNF definitions
+  if (options::cnfPolarity()
+      && options::decisionMode() != options::DecisionMode::INTERNAL)
+  {
+    if (options::decisionMode.wasSetByUser())
+    {
+      throw OptionException(std::string(
+          "The polarity-aware CNF encoding is not supported with the "
+          "justification heuristic. Try --decision=internal"));
+    }
+    Notice() << "SmtEngine: setting decision mode to internal to support the "
+             << "polarity-aware CNF encoding" << std::endl;
+    options::decisionMode.set(options::DecisionMode::INTERNAL);
+    options::decisionStopOnly.set(false);
+  }
   if (options::incrementalSolving())
   {
     // disable modes not supported by incremental
@@ -24,10 +24,12 @@
 #include "expr/bound_var_manager.h"
 #include "expr/node.h"
 #include "options/base_options.h"
+#include "options/expr_options.h"
 #include "options/language.h"
 #include "options/main_options.h"
 #include "options/printer_options.h"
 #include "options/proof_options.h"
+#include "options/prop_options.h"
 #include "options/smt_options.h"
 #include "options/theory_options.h"
 #include "printer/printer.h"
@@ -56,6 +58,7 @@
 #include "smt/smt_engine_state.h"
 #include "smt/smt_engine_stats.h"
 #include "smt/smt_solver.h"
+#include "smt/smt_statistics_registry.h"
 #include "smt/sygus_solver.h"
 #include "smt/unsat_core_manager.h"
 #include "theory/quantifiers/instantiation_list.h"
@@ -128,7 +131,11 @@ SmtEngine::SmtEngine(NodeManager* nm, Options* optr)
   // listen to resource out
   getResourceManager()->registerListener(d_routListener.get());
   // make statistics
-  d_stats.reset(new SmtEngineStatistics());
+  d_stats.reset(
+      new SmtEngineStatistics(getNodeManager()->getNodeValueAllocator(),
+                              *getContext()->getCMM(),
+                              *getUserContext()->getCMM()));
+  getNodeManager()->registerStatistics(smtStatisticsRegistry());
   // reset the preprocessor
   d_pp.reset(new smt::Preprocessor(
       *this, getUserContext(), *d_absValues.get(), *d_stats));
@@ -213,6 +220,26 @@ void SmtEngine::finishInit()
   // based on our heuristics.
   d_optm->finishInit(d_env->d_logic, d_isInternalSubsolver);
 
+  if (!d_isInternalSubsolver && options::gcBudget() > 0)
+  {
+    // reclaim garbage nodes incrementally, with bounded pauses. This is a
+    // setting of the node manager, which internal subsolvers share with the
+    // solver that owns it, so only the latter sets it.
+    getNodeManager()->setZombieReclamationBudget(options::gcBudget());
+  }
+  if (!d_isInternalSubsolver && options::attrDenseThreshold() > 0)
+  {
+    getNodeManager()->setDenseAttributeThreshold(
+        options::attrDenseThreshold());
+  }
+  // configure the memory managers of the contexts
+  std::vector<context::Context*> contexts = {getContext(), getUserContext()};
+  for (context::Context* c : contexts)
+  {
+    c->getCMM()->setMaxFreeBytes(options::contextMemoryMaxFree() * 1024);
+    c->getCMM()->setHugePages(options::contextMemoryHugePages());
+  }
+
   ProofNodeManager* pnm = nullptr;
   if (options::produceProofs())
   {
@@ -341,6 +368,7 @@ SmtEngine::~SmtEngine()
     d_smtSolver.reset(nullptr);
 
     d_stats.reset(nullptr);
+    getNodeManager()->unregisterStatistics(smtStatisticsRegistry());
     getNodeManager()->unsubscribeEvents(d_snmListener.get());
     d_snmListener.reset(nullptr);
     d_routListener.reset(nullptr);
@@ -1145,6 +1173,21 @@ Node SmtEngine::simplify(const Node& ex)
   return d_pp->simplify(ex);
 }
 
+std::vector<std::vector<Node>> SmtEngine::getCubes(uint32_t depth)
+{
+  SmtScope smts(this);
+  finishInit();
+  d_state->doPendingPops();
+  if (options::cdcltSatSolver() != options::CDCLTSatSolverMode::MINISAT)
+  {
+    throw ModalException(
+        "Cannot generate cubes unless the SAT solver is minisat.");
+  }
+  // ensure we've processed assertions
+  d_smtSolver->processAssertions(*d_asserts);
+  return getPropEngine()->getCubes(depth);
+}
+
 Node SmtEngine::expandDefinitions(const Node& ex, bool expandOnly)
 {
   getResourceManager()->spendResource(
@@ -510,6 +510,16 @@ class CVC4_EXPORT SmtEngine
    */
   Node simplify(const Node& e);
 
+  /**
+   * Split the current assertions into up to 2^depth cubes by lookahead in
+   * the SAT solver, see prop::PropEngine::getCubes(). The assertions are
+   * equivalent to the disjunction of the returned cubes, each of which is a
+   * conjunction of literals over the preprocessed assertions, and are
+   * unsatisfiable if no cube is returned. The cubes are meant to be solved as
+   * assumptions of checkSat(). Requires the minisat SAT solver.
+   */
+  std::vector<std::vector<Node>> getCubes(uint32_t depth);
+
   /**
    * Expand the definitions in a term or formula.
    *
@@ -14,12 +14,17 @@
 
 #include "smt/smt_engine_stats.h"
 
+#include "context/context_mm.h"
+#include "expr/node_value_allocator.h"
 #include "smt/smt_statistics_registry.h"
 
 namespace CVC5 {
 namespace smt {
 
-SmtEngineStatistics::SmtEngineStatistics()
+SmtEngineStatistics::SmtEngineStatistics(
+    const expr::NodeValueAllocator& nva,
+    const context::ContextMemoryManager& satCmm,
+    const context::ContextMemoryManager& userCmm)
     : d_definitionExpansionTime("smt::SmtEngine::definitionExpansionTime"),
       d_numConstantProps("smt::SmtEngine::numConstantProps", 0),
       d_cnfConversionTime("smt::SmtEngine::cnfConversionTime"),
@@ -33,7 +38,28 @@ SmtEngineStatistics::SmtEngineStatistics()
       d_simplifiedToFalse("smt::SmtEngine::simplifiedToFalse", 0),
       d_driverFilename("driver::filename", ""),
       d_driverResult("driver::sat/unsat", ""),
-      d_driverTotalTime("driver::totalTime", 0.0)
+      d_driverTotalTime("driver::totalTime", 0.0),
+      d_nvSlabBytes("expr::NodeManager::slabBytes", nva.getTotalSlabBytes()),
+      d_nvSlabSlots("expr::NodeManager::slabSlots", nva.getTotalCapacity()),
+      d_nvSlabLive("expr::NodeManager::slabLiveNodeValues",
+                   nva.getTotalLive()),
+      d_satCmmActiveBytes("context::SatContext::memoryActiveBytes",
+                          satCmm.getActiveBytes()),
+      d_satCmmHighWaterBytes("context::SatContext::memoryHighWaterBytes",
+                             satCmm.getHighWaterBytes()),
+      d_satCmmFreeBytes("context::SatContext::memoryFreeBytes",
+                        satCmm.getFreeBytes()),
+      d_satCmmChunkAllocations("context::SatContext::memoryChunkAllocations",
+                               satCmm.getNumChunkAllocations()),
+      d_userCmmActiveBytes("context::UserContext::memoryActiveBytes",
+                           userCmm.getActiveBytes()),
+      d_userCmmHighWaterBytes("context::UserContext::memoryHighWaterBytes",
+                              userCmm.getHighWaterBytes()),
+      d_userCmmFreeBytes("context::UserContext::memoryFreeBytes",
+                         userCmm.getFreeBytes()),
+      d_userCmmChunkAllocations(
+          "context::UserContext::memoryChunkAllocations",
+          userCmm.getNumChunkAllocations())
 {
   smtStatisticsRegistry()->registerStat(&d_definitionExpansionTime);
   smtStatisticsRegistry()->registerStat(&d_numConstantProps);
@@ -49,6 +75,17 @@ SmtEngineStatistics::SmtEngineStatistics()
   smtStatisticsRegistry()->registerStat(&d_driverFilename);
   smtStatisticsRegistry()->registerStat(&d_driverResult);
   smtStatisticsRegistry()->registerStat(&d_driverTotalTime);
+  smtStatisticsRegistry()->registerStat(&d_nvSlabBytes);
+  smtStatisticsRegistry()->registerStat(&d_nvSlabSlots);
+  smtStatisticsRegistry()->registerStat(&d_nvSlabLive);
+  smtStatisticsRegistry()->registerStat(&d_satCmmActiveBytes);
+  smtStatisticsRegistry()->registerStat(&d_satCmmHighWaterBytes);
+  smtStatisticsRegistry()->registerStat(&d_satCmmFreeBytes);
+  smtStatisticsRegistry()->registerStat(&d_satCmmChunkAllocations);
+  smtStatisticsRegistry()->registerStat(&d_userCmmActiveBytes);
+  smtStatisticsRegistry()->registerStat(&d_userCmmHighWaterBytes);
+  smtStatisticsRegistry()->registerStat(&d_userCmmFreeBytes);
+  smtStatisticsRegistry()->registerStat(&d_userCmmChunkAllocations);
 }
 
 SmtEngineStatistics::~SmtEngineStatistics()
@@ -67,6 +104,17 @@ SmtEngineStatistics::~SmtEngineStatistics()
   smtStatisticsRegistry()->unregisterStat(&d_driverFilename);
   smtStatisticsRegistry()->unregisterStat(&d_driverResult);
   smtStatisticsRegistry()->unregisterStat(&d_driverTotalTime);
+  smtStatisticsRegistry()->unregisterStat(&d_nvSlabBytes);
+  smtStatisticsRegistry()->unregisterStat(&d_nvSlabSlots);
+  smtStatisticsRegistry()->unregisterStat(&d_nvSlabLive);
+  smtStatisticsRegistry()->unregisterStat(&d_satCmmActiveBytes);
+  smtStatisticsRegistry()->unregisterStat(&d_satCmmHighWaterBytes);
+  smtStatisticsRegistry()->unregisterStat(&d_satCmmFreeBytes);
+  smtStatisticsRegistry()->unregisterStat(&d_satCmmChunkAllocations);
+  smtStatisticsRegistry()->unregisterStat(&d_userCmmActiveBytes);
+  smtStatisticsRegistry()->unregisterStat(&d_userCmmHighWaterBytes);
+  smtStatisticsRegistry()->unregisterStat(&d_userCmmFreeBytes);
+  smtStatisticsRegistry()->unregisterStat(&d_userCmmChunkAllocations);
 }
 
 }  // namespace smt
@@ -21,11 +21,22 @@
 #include "util/stats_timer.h"
 
 namespace CVC5 {
+
+namespace context {
+class ContextMemoryManager;
+}
+
+namespace expr {
+class NodeValueAllocator;
+}
+
 namespace smt {
 
 struct SmtEngineStatistics
 {
-  SmtEngineStatistics();
+  SmtEngineStatistics(const expr::NodeValueAllocator& nva,
+                      const context::ContextMemoryManager& satCmm,
+                      const context::ContextMemoryManager& userCmm);
   ~SmtEngineStatistics();
   /** time spent in definition-expansion */
   TimerStat d_definitionExpansionTime;
@@ -57,6 +68,30 @@ struct SmtEngineStatistics
   BackedStat<std::string> d_driverResult;
   /** Total time of the current run */
   BackedStat<double> d_driverTotalTime;
+
+  /** Bytes held in the NodeValue slabs of the node manager */
+  ReferenceStat<uint64_t> d_nvSlabBytes;
+  /** Number of NodeValue slots in the slabs of the node manager */
+  ReferenceStat<uint64_t> d_nvSlabSlots;
+  /** Number of live NodeValues in the slabs of the node manager */
+  ReferenceStat<uint64_t> d_nvSlabLive;
+
+  /** Bytes in context memory chunks in use by the SAT context */
+  ReferenceStat<uint64_t> d_satCmmActiveBytes;
+  /** Maximum of d_satCmmActiveBytes so far */
+  ReferenceStat<uint64_t> d_satCmmHighWaterBytes;
+  /** Bytes in context memory chunks kept for reuse by the SAT context */
+  ReferenceStat<uint64_t> d_satCmmFreeBytes;
+  /** Number of context memory chunks allocated by the SAT context */
+  ReferenceStat<uint64_t> d_satCmmChunkAllocations;
+  /** Bytes in context memory chunks in use by the user context */
+  ReferenceStat<uint64_t> d_userCmmActiveBytes;
+  /** Maximum of d_userCmmActiveBytes so far */
+  ReferenceStat<uint64_t> d_userCmmHighWaterBytes;
+  /** Bytes in context memory chunks kept for reuse by the user context */
+  ReferenceStat<uint64_t> d_userCmmFreeBytes;
+  /** Number of context memory chunks allocated by the user context */
+  ReferenceStat<uint64_t> d_userCmmChunkAllocations;
 }; /* struct SmtEngineStatistics */
 
 }  // namespace smt
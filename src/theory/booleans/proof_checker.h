@@ -33,6 +33,8 @@ class BoolProofRuleChecker : public ProofRuleChecker
 
   /** Register all rules owned by this rule checker into pc. */
   void registerTo(ProofChecker* pc) override;
+  /** The rules of this checker only construct nodes */
+  bool isReentrant() const override { return true; }
 
  protected:
   /** Return the conclusion of the given proof step, or null if it is invalid */
@@ -157,14 +157,7 @@ void SubstitutionMap::addSubstitution(TNode x, TNode t, bool invalidateCache)
   Assert(x != t) << "cannot substitute a term for itself";
 
   d_substitutions[x] = t;
-
-  // Also invalidate the cache if necessary
-  if (invalidateCache) {
-    d_cacheInvalidated = true;
-  }
-  else {
-    d_substitutionCache[x] = d_substitutions[x];
-  }
+  notifyNewSubstitution(x, invalidateCache);
 }
 
 
@@ -175,25 +168,100 @@ void SubstitutionMap::addSubstitutions(SubstitutionMap& subMap, bool invalidateC
   for (; it != it_end; ++ it) {
     Assert(d_substitutions.find((*it).first) == d_substitutions.end());
     d_substitutions[(*it).first] = (*it).second;
-    if (!invalidateCache) {
-      d_substitutionCache[(*it).first] = d_substitutions[(*it).first];
-    }
-  }
-  if (invalidateCache) {
-    d_cacheInvalidated = true;
+    notifyNewSubstitution((*it).first, invalidateCache);
   }
 }
 
-Node SubstitutionMap::apply(TNode t, bool doRewrite) {
-
-  Debug("substitution") << "SubstitutionMap::apply(" << t << ")" << endl;
+void SubstitutionMap::notifyNewSubstitution(TNode x, bool invalidateCache)
+{
+  if (!invalidateCache)
+  {
+    d_substitutionCache[x] = d_substitutions[x];
+  }
+  else if (!d_cacheInvalidated && !d_substitutionCache.empty())
+  {
+    d_pendingVars.push_back(x);
+  }
+}
 
-  // Setup the cache
+void SubstitutionMap::updateCache()
+{
   if (d_cacheInvalidated) {
     d_substitutionCache.clear();
+    d_pendingVars.clear();
     d_cacheInvalidated = false;
     Debug("substitution") << "-- reset the cache" << endl;
+    return;
+  }
+  if (d_pendingVars.empty())
+  {
+    return;
+  }
+  // The cached results are in normal form w.r.t. the previous
+  // substitutions, so only those containing one of the new variables are
+  // stale.  Find them with one traversal of the cached results, memoizing
+  // which subterms contain a new variable.
+  std::unordered_map<TNode, bool, TNodeHashFunction> contains;
+  for (const Node& x : d_pendingVars)
+  {
+    contains[x] = true;
+  }
+  std::vector<TNode> visit;
+  for (NodeCache::iterator it = d_substitutionCache.begin();
+       it != d_substitutionCache.end();)
+  {
+    visit.push_back(it->second);
+    do
+    {
+      TNode cur = visit.back();
+      std::unordered_map<TNode, bool, TNodeHashFunction>::iterator itc =
+          contains.find(cur);
+      if (itc == contains.end())
+      {
+        // pre-visit: mark as not containing, and visit the children
+        contains[cur] = false;
+        if (cur.getMetaKind() == kind::metakind::PARAMETERIZED)
+        {
+          visit.push_back(cur.getOperator());
+        }
+        visit.insert(visit.end(), cur.begin(), cur.end());
+        continue;
+      }
+      visit.pop_back();
+      if (!itc->second && cur.getNumChildren() > 0)
+      {
+        // post-visit (or a revisit, which recomputes the same value)
+        bool c = cur.getMetaKind() == kind::metakind::PARAMETERIZED
+                 && contains[cur.getOperator()];
+        for (const Node& cn : cur)
+        {
+          c = c || contains[cn];
+        }
+        itc = contains.find(cur);
+        itc->second = c;
+      }
+    } while (!visit.empty());
+    if (contains[it->second])
+    {
+      it = d_substitutionCache.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
   }
+  Debug("substitution") << "-- updated the cache for " << d_pendingVars.size()
+                        << " new substitution(s), " << d_substitutionCache.size()
+                        << " entries left" << endl;
+  d_pendingVars.clear();
+}
+
+Node SubstitutionMap::apply(TNode t, bool doRewrite) {
+
+  Debug("substitution") << "SubstitutionMap::apply(" << t << ")" << endl;
+
+  // Setup the cache
+  updateCache();
 
   // Perform the substitution
   Node result = internalSubstitute(t, d_substitutionCache);
@@ -207,6 +275,19 @@ Node SubstitutionMap::apply(TNode t, bool doRewrite) {
   return result;
 }
 
+void SubstitutionMap::apply(std::vector<Node>& ts, bool doRewrite)
+{
+  updateCache();
+  for (Node& t : ts)
+  {
+    t = internalSubstitute(t, d_substitutionCache);
+    if (doRewrite)
+    {
+      t = Rewriter::rewrite(t);
+    }
+  }
+}
+
 void SubstitutionMap::print(ostream& out) const {
   NodeMap::const_iterator it = d_substitutions.begin();
   NodeMap::const_iterator it_end = d_substitutions.end();
@@ -66,9 +66,28 @@ private:
   /** Has the cache been invalidated? */
   bool d_cacheInvalidated;
 
+  /**
+   * The variables added since the last apply() whose substitution may
+   * invalidate some of the entries of the cache.
+   */
+  std::vector<Node> d_pendingVars;
+
   /** Internal method that performs substitution */
   Node internalSubstitute(TNode t, NodeCache& cache);
 
+  /**
+   * Bring the cache up to date: clear it if it was invalidated, otherwise
+   * remove the entries that are stale because of d_pendingVars.
+   */
+  void updateCache();
+
+  /**
+   * Record that x now has a substitution.  If invalidateCache is true, the
+   * cached results that contain x are removed before the next apply(),
+   * otherwise x is mapped to its substitution in the cache.
+   */
+  void notifyNewSubstitution(TNode x, bool invalidateCache);
+
   /** Helper class to invalidate cache on user pop */
   class CacheInvalidator : public context::ContextNotifyObj {
     bool& d_cacheInvalidated;
@@ -142,6 +161,15 @@ public:
     return const_cast<SubstitutionMap*>(this)->apply(t, doRewrite);
   }
 
+  /**
+   * Apply the substitutions to each node of ts, in place.  All nodes share
+   * the cache, so common subterms are substituted once.
+   */
+  void apply(std::vector<Node>& ts, bool doRewrite = false);
+
+  /** Get the number of entries of the substitution cache */
+  size_t getCacheSize() const { return d_substitutionCache.size(); }
+
   iterator begin() {
     return d_substitutions.begin();
   }
@@ -275,7 +275,7 @@ void TheoryUF::preRegisterTerm(TNode node)
         d_equalityEngine->addTerm(node);
       }
       // Remember the function and predicate terms
-      d_functionsTerms.push_back(node);
+      d_functionsTerms.push_back(NodeManager::currentNM()->mkHandle(node));
     }
     break;
   case kind::CARDINALITY_CONSTRAINT:
@@ -603,8 +603,10 @@ void TheoryUF::computeCareGraph() {
   std::map<Node, TNodeTrie> index;
   std::map<TypeNode, TNodeTrie> hoIndex;
   std::map<Node, size_t> arity;
-  for (TNode app : d_functionsTerms)
+  NodeManager* nm = NodeManager::currentNM();
+  for (NodeHandle h : d_functionsTerms)
   {
+    TNode app = nm->getNode(h);
     std::vector<TNode> reps;
     bool has_trigger_arg = false;
     for (const Node& j : app)
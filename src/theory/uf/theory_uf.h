@@ -80,8 +80,11 @@ private:
   /** node for true */
   Node d_true;
 
-  /** All the function terms that the theory has seen */
-  context::CDList<TNode> d_functionsTerms;
+  /**
+   * All the function terms that the theory has seen, as handles, which take
+   * half the memory of TNodes
+   */
+  context::CDList<NodeHandle> d_functionsTerms;
 
   /** Symmetry analyzer */
   SymmetryBreaker d_symb;
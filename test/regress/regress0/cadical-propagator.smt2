@@ -0,0 +1,26 @@
+; REQUIRES: cadical-propagator
+; COMMAND-LINE: --sat-solver=cadical --incremental --no-check-proofs
+; EXPECT: sat
+; EXPECT: unsat
+; EXPECT: sat
+; EXPECT: unsat
+(set-logic QF_UF)
+(declare-sort U 0)
+(declare-fun a () U)
+(declare-fun b () U)
+(declare-fun c () U)
+(declare-fun f (U) U)
+(declare-fun p (U) Bool)
+(assert (or (= a b) (= a c)))
+(assert (or (p a) (p b)))
+(check-sat)
+(push 1)
+(assert (not (= (f a) (f b))))
+(assert (not (= (f a) (f c))))
+(check-sat)
+(pop 1)
+(assert (not (= b c)))
+(assert (not (p c)))
+(check-sat)
+(assert (not (p b)))
+(check-sat)
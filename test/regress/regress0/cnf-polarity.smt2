@@ -0,0 +1,27 @@
+; COMMAND-LINE: --incremental --cnf-polarity --cnf-struct-hash
+; EXPECT: sat
+; EXPECT: unsat
+; EXPECT: sat
+; EXPECT: unsat
+(set-logic QF_UF)
+(declare-sort U 0)
+(declare-const a Bool)
+(declare-const b Bool)
+(declare-const c Bool)
+(declare-const d Bool)
+(declare-const x U)
+(declare-const y U)
+(declare-const z U)
+(push 1)
+(assert (or (and a b (= x y)) (and c d)))
+(assert (or (and b (and a (= x y))) (not (ite a c d))))
+(check-sat)
+; the gates above only occurred positively so far
+(assert (not (and (= x y) a b)))
+(assert (not (and d c)))
+(check-sat)
+(pop 1)
+(assert (and a (or b c) (ite d (= x z) (= y z))))
+(check-sat)
+(assert (xor (or b c) (or c b)))
+(check-sat)
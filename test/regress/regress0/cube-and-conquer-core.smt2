@@ -0,0 +1,14 @@
+; COMMAND-LINE: --cube-depth=2 --portfolio-jobs=2
+; EXPECT: unsat
+; EXPECT: (
+; EXPECT: a1
+; EXPECT: )
+(set-logic QF_UF)
+(set-option :produce-unsat-cores true)
+(declare-fun p () Bool)
+(declare-fun q () Bool)
+(declare-fun r () Bool)
+(assert (! (or p q r) :named a0))
+(assert (! (and q (not q)) :named a1))
+(check-sat)
+(get-unsat-core)
@@ -0,0 +1,12 @@
+; COMMAND-LINE: --cube-depth=2 --portfolio-jobs=2
+; EXPECT: unsat
+(set-logic QF_LIA)
+(declare-fun x () Int)
+(declare-fun y () Int)
+(declare-fun z () Int)
+(assert (or (> x 5) (< y 0)))
+(assert (or (<= x 5) (> z 10)))
+(assert (or (<= z 10) (>= y 0)))
+(assert (or (< y 0) (<= z 10)))
+(assert (or (> x 5) (>= y 0)))
+(check-sat)
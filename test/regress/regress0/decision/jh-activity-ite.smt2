@@ -0,0 +1,16 @@
+; COMMAND-LINE: --decision=justification --decision-use-activity
+; COMMAND-LINE: --decision=justification
+; EXPECT: sat
+(set-logic QF_LIA)
+(declare-fun x () Int)
+(declare-fun y () Int)
+(declare-fun z () Int)
+(declare-fun a () Bool)
+(declare-fun b () Bool)
+(declare-fun c () Bool)
+(assert (or (and a (> x (ite b y z))) (and (not a) (< (+ x (ite c y 3)) 0))))
+(assert (= (ite (> y 0) (+ z 1) (- z 1)) (ite (xor a b) x (+ x 2))))
+(assert (or (not c) (> (ite a (+ y z) (- y z)) 5)))
+(assert (=> b (and c (< z (ite (> x 0) x (- x))))))
+(assert (or (= x (+ y 2)) (= x (- z 4)) (not (= a c))))
+(check-sat)
@@ -0,0 +1,14 @@
+; COMMAND-LINE: --incremental --lemma-batch
+; EXPECT: sat
+; EXPECT: unsat
+(set-logic UFLIA)
+(declare-fun f (Int) Int)
+(declare-fun x () Int)
+(declare-fun y () Int)
+(assert (forall ((z Int)) (> (f z) z)))
+(assert (> (* 3 x) 1))
+(assert (< (* 3 x) 5))
+(assert (= y (f x)))
+(check-sat)
+(assert (< (f 3) 2))
+(check-sat)
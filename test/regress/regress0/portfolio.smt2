@@ -0,0 +1,16 @@
+; COMMAND-LINE: --portfolio-jobs=3
+; EXPECT: unsat
+(set-logic QF_UF)
+(declare-sort U 0)
+(declare-fun f (U) U)
+(declare-fun a () U)
+(declare-fun b () U)
+(declare-fun c () U)
+(declare-fun d () U)
+(assert (or (= a b) (= a c)))
+(assert (or (= b d) (= c d)))
+(assert (or (= (f a) (f d)) (= a d)))
+(assert (distinct (f a) (f b)))
+(assert (distinct (f a) (f c)))
+(assert (= b c))
+(check-sat)
@@ -0,0 +1,28 @@
+; COMMAND-LINE: --incremental --sat-chrono --sat-chrono-threshold=0
+; EXPECT: sat
+; EXPECT: unsat
+; EXPECT: sat
+(set-logic QF_UF)
+(declare-sort U 0)
+(declare-fun c1 () U)
+(declare-fun c2 () U)
+(declare-fun c3 () U)
+(declare-fun a1 () U)
+(declare-fun a2 () U)
+(declare-fun a3 () U)
+(declare-fun a4 () U)
+(declare-fun f (U) U)
+(assert (distinct c1 c2 c3))
+(assert (or (= a1 c1) (= a1 c2) (= a1 c3)))
+(assert (or (= a2 c1) (= a2 c2) (= a2 c3)))
+(assert (or (= a3 c1) (= a3 c2) (= a3 c3)))
+(assert (or (= a4 c1) (= a4 c2) (= a4 c3)))
+(assert (distinct (f a1) (f a2) (f a3)))
+(check-sat)
+(push 1)
+; four pigeons, three holes
+(assert (distinct (f a1) (f a2) (f a3) (f a4)))
+(check-sat)
+(pop 1)
+(assert (distinct (f a2) (f a3) (f a4)))
+(check-sat)
@@ -0,0 +1,74 @@
+; COMMAND-LINE: --sat-inprocess --sat-inprocess-interval=20
+; EXPECT: unsat
+(set-logic QF_LIA)
+(declare-fun p0h0 () Bool)
+(declare-fun p0h1 () Bool)
+(declare-fun p0h2 () Bool)
+(declare-fun p0h3 () Bool)
+(declare-fun p1h0 () Bool)
+(declare-fun p1h1 () Bool)
+(declare-fun p1h2 () Bool)
+(declare-fun p1h3 () Bool)
+(declare-fun p2h0 () Bool)
+(declare-fun p2h1 () Bool)
+(declare-fun p2h2 () Bool)
+(declare-fun p2h3 () Bool)
+(declare-fun p3h0 () Bool)
+(declare-fun p3h1 () Bool)
+(declare-fun p3h2 () Bool)
+(declare-fun p3h3 () Bool)
+(declare-fun p4h0 () Bool)
+(declare-fun p4h1 () Bool)
+(declare-fun p4h2 () Bool)
+(declare-fun p4h3 () Bool)
+(declare-fun x () Int)
+(assert (or p0h0 p0h1 p0h2 p0h3))
+(assert (or p1h0 p1h1 p1h2 p1h3))
+(assert (or p2h0 p2h1 p2h2 p2h3))
+(assert (or p3h0 p3h1 p3h2 p3h3))
+(assert (or p4h0 p4h1 p4h2 p4h3))
+(assert (or (not p0h0) (not p1h0)))
+(assert (or (not p0h0) (not p2h0)))
+(assert (or (not p0h0) (not p3h0)))
+(assert (or (not p0h0) (not p4h0)))
+(assert (or (not p1h0) (not p2h0)))
+(assert (or (not p1h0) (not p3h0)))
+(assert (or (not p1h0) (not p4h0)))
+(assert (or (not p2h0) (not p3h0)))
+(assert (or (not p2h0) (not p4h0)))
+(assert (or (not p3h0) (not p4h0)))
+(assert (or (not p0h1) (not p1h1)))
+(assert (or (not p0h1) (not p2h1)))
+(assert (or (not p0h1) (not p3h1)))
+(assert (or (not p0h1) (not p4h1)))
+(assert (or (not p1h1) (not p2h1)))
+(assert (or (not p1h1) (not p3h1)))
+(assert (or (not p1h1) (not p4h1)))
+(assert (or (not p2h1) (not p3h1)))
+(assert (or (not p2h1) (not p4h1)))
+(assert (or (not p3h1) (not p4h1)))
+(assert (or (not p0h2) (not p1h2)))
+(assert (or (not p0h2) (not p2h2)))
+(assert (or (not p0h2) (not p3h2)))
+(assert (or (not p0h2) (not p4h2)))
+(assert (or (not p1h2) (not p2h2)))
+(assert (or (not p1h2) (not p3h2)))
+(assert (or (not p1h2) (not p4h2)))
+(assert (or (not p2h2) (not p3h2)))
+(assert (or (not p2h2) (not p4h2)))
+(assert (or (not p3h2) (not p4h2)))
+(assert (or (not p0h3) (not p1h3)))
+(assert (or (not p0h3) (not p2h3)))
+(assert (or (not p0h3) (not p3h3)))
+(assert (or (not p0h3) (not p4h3)))
+(assert (or (not p1h3) (not p2h3)))
+(assert (or (not p1h3) (not p3h3)))
+(assert (or (not p1h3) (not p4h3)))
+(assert (or (not p2h3) (not p3h3)))
+(assert (or (not p2h3) (not p4h3)))
+(assert (or (not p3h3) (not p4h3)))
+(assert (= p0h0 (> x 0)))
+(assert (= p0h1 (> x 1)))
+(assert (= p0h2 (> x 2)))
+(assert (= p0h3 (> x 3)))
+(check-sat)
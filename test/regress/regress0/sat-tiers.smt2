@@ -0,0 +1,51 @@
+; COMMAND-LINE: --incremental --sat-tiers --sat-tiers-tier2-lbd=4
+; EXPECT: unsat
+; EXPECT: sat
+; EXPECT: unsat
+(set-logic QF_LIA)
+(declare-fun p0h0 () Bool)
+(declare-fun p0h1 () Bool)
+(declare-fun p0h2 () Bool)
+(declare-fun p0h3 () Bool)
+(declare-fun p1h0 () Bool)
+(declare-fun p1h1 () Bool)
+(declare-fun p1h2 () Bool)
+(declare-fun p1h3 () Bool)
+(declare-fun p2h0 () Bool)
+(declare-fun p2h1 () Bool)
+(declare-fun p2h2 () Bool)
+(declare-fun p2h3 () Bool)
+(declare-fun p3h0 () Bool)
+(declare-fun p3h1 () Bool)
+(declare-fun p3h2 () Bool)
+(declare-fun p3h3 () Bool)
+(declare-fun p4h0 () Bool)
+(declare-fun p4h1 () Bool)
+(declare-fun p4h2 () Bool)
+(declare-fun p4h3 () Bool)
+(assert (or p0h0 p0h1 p0h2 p0h3))
+(assert (or p1h0 p1h1 p1h2 p1h3))
+(assert (or p2h0 p2h1 p2h2 p2h3))
+(assert (or p3h0 p3h1 p3h2 p3h3))
+(assert (or p4h0 p4h1 p4h2 p4h3))
+(push 1)
+(assert (<= (+ (ite p0h0 1 0) (ite p1h0 1 0) (ite p2h0 1 0) (ite p3h0 1 0) (ite p4h0 1 0)) 1))
+(assert (<= (+ (ite p0h1 1 0) (ite p1h1 1 0) (ite p2h1 1 0) (ite p3h1 1 0) (ite p4h1 1 0)) 1))
+(assert (<= (+ (ite p0h2 1 0) (ite p1h2 1 0) (ite p2h2 1 0) (ite p3h2 1 0) (ite p4h2 1 0)) 1))
+(assert (<= (+ (ite p0h3 1 0) (ite p1h3 1 0) (ite p2h3 1 0) (ite p3h3 1 0) (ite p4h3 1 0)) 1))
+(check-sat)
+(pop 1)
+(push 1)
+(assert (<= (+ (ite p0h0 1 0) (ite p1h0 1 0) (ite p2h0 1 0) (ite p3h0 1 0) (ite p4h0 1 0)) 2))
+(assert (<= (+ (ite p0h1 1 0) (ite p1h1 1 0) (ite p2h1 1 0) (ite p3h1 1 0) (ite p4h1 1 0)) 2))
+(assert (<= (+ (ite p0h2 1 0) (ite p1h2 1 0) (ite p2h2 1 0) (ite p3h2 1 0) (ite p4h2 1 0)) 2))
+(assert (<= (+ (ite p0h3 1 0) (ite p1h3 1 0) (ite p2h3 1 0) (ite p3h3 1 0) (ite p4h3 1 0)) 2))
+(check-sat)
+(pop 1)
+(push 1)
+(assert (<= (+ (ite p0h0 1 0) (ite p1h0 1 0) (ite p2h0 1 0) (ite p3h0 1 0) (ite p4h0 1 0)) 1))
+(assert (<= (+ (ite p0h1 1 0) (ite p1h1 1 0) (ite p2h1 1 0) (ite p3h1 1 0) (ite p4h1 1 0)) 1))
+(assert (<= (+ (ite p0h2 1 0) (ite p1h2 1 0) (ite p2h2 1 0) (ite p3h2 1 0) (ite p4h2 1 0)) 1))
+(assert (<= (+ (ite p0h3 1 0) (ite p1h3 1 0) (ite p2h3 1 0) (ite p3h3 1 0) (ite p4h3 1 0)) 1))
+(check-sat)
+(pop 1)
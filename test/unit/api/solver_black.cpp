@@ -1762,6 +1762,31 @@ TEST_F(TestApiBlackSolver, blockModelValues5)
   ASSERT_NO_THROW(d_solver.blockModelValues({x}));
 }
 
+TEST_F(TestApiBlackSolver, getCubes)
+{
+  d_solver.setOption("incremental", "true");
+  Sort boolSort = d_solver.getBooleanSort();
+  Term a = d_solver.mkConst(boolSort, "a");
+  Term b = d_solver.mkConst(boolSort, "b");
+  Term c = d_solver.mkConst(boolSort, "c");
+  d_solver.assertFormula(d_solver.mkTerm(OR, a, b));
+  d_solver.assertFormula(d_solver.mkTerm(OR, a.notTerm(), c));
+  std::vector<std::vector<Term>> cubes;
+  ASSERT_NO_THROW(cubes = d_solver.getCubes(2));
+  ASSERT_FALSE(cubes.empty());
+  ASSERT_LE(cubes.size(), 4);
+  bool sat = false;
+  for (const std::vector<Term>& cube : cubes)
+  {
+    sat = d_solver.checkSatAssuming(cube).isSat() || sat;
+  }
+  ASSERT_TRUE(sat);
+  d_solver.assertFormula(a);
+  d_solver.assertFormula(c.notTerm());
+  ASSERT_NO_THROW(cubes = d_solver.getCubes(2));
+  ASSERT_TRUE(cubes.empty());
+}
+
 TEST_F(TestApiBlackSolver, setInfo)
 {
   ASSERT_THROW(d_solver.setInfo("cvc4-lagic", "QF_BV"), CVC4ApiException);
@@ -0,0 +1,337 @@
+/*********************                                                        */
+/*! \file cdflat_hashmap_black.cpp
+ ** \verbatim
+ ** This file is part of the CVC4 project.
+ ** Copyright (c) 2009-2021 by the authors listed in the file AUTHORS
+ ** in the top-level source directory and their institutional affiliations.
+ ** All rights reserved.  See the file COPYING in the top-level source
+ ** directory for licensing information.\endverbatim
+ **
+ ** \brief Black box testing of CVC5::context::CDFlatHashMap<>.
+ **
+ ** Black box testing of CVC5::context::CDFlatHashMap<>, including
+ ** micro-benchmarks against CDHashMap<>.
+ **/
+
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "base/check.h"
+#include "context/cdflat_hashmap.h"
+#include "context/cdhashmap.h"
+#include "test_context.h"
+
+namespace CVC5 {
+namespace test {
+
+using CVC5::context::BacktrackMode;
+using CVC5::context::CDFlatHashMap;
+using CVC5::context::CDHashMap;
+using CVC5::context::Context;
+
+class TestContextBlackCDFlatHashMap : public TestContext
+{
+ protected:
+  /** Returns the elements in a map. */
+  template <class Map>
+  static std::map<int32_t, int32_t> get_elements(const Map& map)
+  {
+    return std::map<int32_t, int32_t>{map.begin(), map.end()};
+  }
+
+  /**
+   * Returns true if the elements in map are the same as expected, and the
+   * size of the map is consistent with them.
+   */
+  static bool elements_are(const CDFlatHashMap<int32_t, int32_t>& map,
+                           const std::map<int32_t, int32_t>& expected)
+  {
+    return get_elements(map) == expected && map.size() == expected.size();
+  }
+};
+
+TEST_F(TestContextBlackCDFlatHashMap, simple_sequence)
+{
+  CDFlatHashMap<int32_t, int32_t> map(d_context.get());
+  ASSERT_TRUE(elements_are(map, {}));
+
+  map.insert(3, 4);
+  ASSERT_TRUE(elements_are(map, {{3, 4}}));
+
+  {
+    d_context->push();
+    ASSERT_TRUE(elements_are(map, {{3, 4}}));
+
+    map.insert(5, 6);
+    map.insert(9, 8);
+    ASSERT_TRUE(elements_are(map, {{3, 4}, {5, 6}, {9, 8}}));
+
+    {
+      d_context->push();
+      map.insert(1, 2);
+      ASSERT_TRUE(elements_are(map, {{1, 2}, {3, 4}, {5, 6}, {9, 8}}));
+
+      {
+        d_context->push();
+        map.insertAtContextLevelZero(23, 317);
+        map.insert(1, 45);
+        ASSERT_TRUE(elements_are(
+            map, {{1, 45}, {3, 4}, {5, 6}, {9, 8}, {23, 317}}));
+
+        map.insert(23, 324);
+        ASSERT_TRUE(elements_are(
+            map, {{1, 45}, {3, 4}, {5, 6}, {9, 8}, {23, 324}}));
+        d_context->pop();
+      }
+
+      ASSERT_TRUE(
+          elements_are(map, {{1, 2}, {3, 4}, {5, 6}, {9, 8}, {23, 317}}));
+      d_context->pop();
+    }
+
+    ASSERT_TRUE(elements_are(map, {{3, 4}, {5, 6}, {9, 8}, {23, 317}}));
+    d_context->pop();
+  }
+
+  ASSERT_TRUE(elements_are(map, {{3, 4}, {23, 317}}));
+}
+
+TEST_F(TestContextBlackCDFlatHashMap, operator_brackets)
+{
+  CDFlatHashMap<int32_t, int32_t> map(d_context.get());
+  map[1] = 2;
+  ASSERT_EQ(map[1].get(), 2);
+  d_context->push();
+  map[1] = 3;
+  map[2] = 4;
+  int32_t one = map[1];
+  ASSERT_EQ(one, 3);
+  ASSERT_TRUE(elements_are(map, {{1, 3}, {2, 4}}));
+  // a new key gets the default value
+  ASSERT_EQ(map[5].get(), 0);
+  ASSERT_TRUE(elements_are(map, {{1, 3}, {2, 4}, {5, 0}}));
+  d_context->pop();
+  ASSERT_TRUE(elements_are(map, {{1, 2}}));
+}
+
+TEST_F(TestContextBlackCDFlatHashMap, insertion_order)
+{
+  CDFlatHashMap<int32_t, int32_t> map(d_context.get());
+  std::vector<int32_t> keys;
+  for (int32_t i = 0; i < 100; ++i)
+  {
+    keys.push_back((i * 7919) % 1000);
+    map.insert(keys.back(), i);
+  }
+  std::vector<int32_t> order;
+  for (const auto& p : map)
+  {
+    order.push_back(p.first);
+  }
+  ASSERT_EQ(order, keys);
+}
+
+TEST_F(TestContextBlackCDFlatHashMap, erase)
+{
+  CDFlatHashMap<int32_t, int32_t> map(d_context.get());
+  map.insert(1, 10);
+  map.insert(2, 20);
+  map.insert(3, 30);
+  {
+    d_context->push();
+    ASSERT_EQ(map.erase(2), 1);
+    ASSERT_EQ(map.erase(2), 0);
+    ASSERT_EQ(map.erase(7), 0);
+    ASSERT_EQ(map.count(2), 0);
+    ASSERT_TRUE(map.find(2) == map.end());
+    ASSERT_TRUE(elements_are(map, {{1, 10}, {3, 30}}));
+    {
+      d_context->push();
+      // reinserting an erased key revives its entry
+      ASSERT_TRUE(map.insert(2, 21));
+      ASSERT_FALSE(map.insert(2, 22));
+      ASSERT_EQ(map.erase(1), 1);
+      ASSERT_TRUE(elements_are(map, {{2, 22}, {3, 30}}));
+      d_context->pop();
+    }
+    ASSERT_TRUE(elements_are(map, {{1, 10}, {3, 30}}));
+    d_context->pop();
+  }
+  ASSERT_TRUE(elements_are(map, {{1, 10}, {2, 20}, {3, 30}}));
+
+  // at level 0, erasing is for good
+  ASSERT_EQ(map.erase(1), 1);
+  ASSERT_TRUE(elements_are(map, {{2, 20}, {3, 30}}));
+  d_context->push();
+  d_context->pop();
+  ASSERT_TRUE(elements_are(map, {{2, 20}, {3, 30}}));
+  ASSERT_TRUE(map.insert(1, 11));
+  ASSERT_TRUE(elements_are(map, {{1, 11}, {2, 20}, {3, 30}}));
+}
+
+TEST_F(TestContextBlackCDFlatHashMap, insert_at_context_level_zero)
+{
+  CDFlatHashMap<int32_t, int32_t> map(d_context.get());
+  map.insert(3, 4);
+  d_context->push();
+  map.insert(5, 6);
+  map.insertAtContextLevelZero(23, 317);
+  ASSERT_DEATH(map.insertAtContextLevelZero(5, 0), "Check failure");
+  map.insert(7, 8);
+  d_context->push();
+  map.insert(23, 1);
+  d_context->popto(0);
+  ASSERT_TRUE(elements_are(map, {{3, 4}, {23, 317}}));
+  ASSERT_DEATH(map.insertAtContextLevelZero(23, 0), "Check failure");
+}
+
+TEST_F(TestContextBlackCDFlatHashMap, clear_and_destroy_at_depth)
+{
+  CDFlatHashMap<int32_t, std::string> map(d_context.get());
+  map.insert(1, "one");
+  d_context->push();
+  map.insert(1, "uno");
+  map.insert(2, "two");
+  {
+    CDFlatHashMap<int32_t, std::string> tmp(d_context.get());
+    d_context->push();
+    tmp.insert(3, "three");
+    tmp.insert(3, "drei");
+  }
+  map.clear();
+  ASSERT_TRUE(map.empty());
+  map.insert(4, "four");
+  d_context->popto(0);
+  ASSERT_TRUE(map.empty());
+  ASSERT_EQ(d_context->getUndoLogSize(), 0);
+}
+
+TEST_F(TestContextBlackCDFlatHashMap, same_as_cdhashmap)
+{
+  // random inserts (also at level zero), erases and push/pops; erase is
+  // mirrored in the CDHashMap by mapping the key to -1
+  std::mt19937 rng(42);
+  CDFlatHashMap<int32_t, int32_t> flat(d_context.get());
+  CDHashMap<int32_t, int32_t> ref(d_context.get());
+  for (size_t i = 0; i < 100000; ++i)
+  {
+    uint32_t r = rng() % 100;
+    int32_t key = rng() % 500;
+    if (r < 5 && d_context->getLevel() < 50)
+    {
+      d_context->push();
+    }
+    else if (r < 8 && d_context->getLevel() > 0)
+    {
+      d_context->popto(rng() % d_context->getLevel());
+    }
+    else if (r < 15)
+    {
+      size_t live = ref.count(key) > 0 && ref[key].get() != -1;
+      ASSERT_EQ(flat.erase(key), live);
+      if (live)
+      {
+        ref.insert(key, -1);
+      }
+    }
+    else if (r < 18 && ref.count(key) == 0)
+    {
+      flat.insertAtContextLevelZero(key, 1000);
+      ref.insertAtContextLevelZero(key, 1000);
+    }
+    else
+    {
+      int32_t val = rng() % 1000;
+      flat.insert(key, val);
+      ref.insert(key, val);
+    }
+    if (i % 1000 == 0)
+    {
+      std::map<int32_t, int32_t> expected;
+      for (const auto& p : ref)
+      {
+        if (p.second != -1)
+        {
+          expected.insert(p);
+        }
+      }
+      ASSERT_TRUE(elements_are(flat, expected));
+    }
+  }
+  d_context->popto(0);
+}
+
+// A timing benchmark, which checks nothing and is only run on request, with
+// --gtest_also_run_disabled_tests
+TEST_F(TestContextBlackCDFlatHashMap, DISABLED_benchmark)
+{
+  using Clock = std::chrono::steady_clock;
+  const int32_t nkeys = 100000;
+  const int nrounds = 20;
+  std::vector<int32_t> keys;
+  std::mt19937 rng(7);
+  for (int32_t i = 0; i < nkeys; ++i)
+  {
+    keys.push_back(rng());
+  }
+
+  // each round inserts all keys at a fresh level, looks them up, iterates
+  // over the map and pops the level again
+  auto run = [&](auto& map) {
+    int64_t sum = 0;
+    for (int round = 0; round < nrounds; ++round)
+    {
+      d_context->push();
+      for (int32_t i = 0; i < nkeys; ++i)
+      {
+        map.insert(keys[i], i);
+      }
+      for (int32_t i = 0; i < nkeys; ++i)
+      {
+        sum += map.count(keys[nkeys - 1 - i]);
+      }
+      for (const auto& p : map)
+      {
+        sum += p.second;
+      }
+      d_context->pop();
+    }
+    return sum;
+  };
+  auto ms = [](Clock::duration d) {
+    return std::chrono::duration<double, std::milli>(d).count();
+  };
+
+  Clock::time_point start = Clock::now();
+  int64_t flatSum;
+  {
+    CDFlatHashMap<int32_t, int32_t> map(d_context.get());
+    flatSum = run(map);
+  }
+  Clock::time_point flatDone = Clock::now();
+  int64_t sum;
+  {
+    CDHashMap<int32_t, int32_t> map(d_context.get());
+    sum = run(map);
+  }
+  Clock::time_point done = Clock::now();
+  {
+    CDHashMap<int32_t, int32_t> map(d_context.get(), BacktrackMode::UNDO_LOG);
+    ASSERT_EQ(run(map), sum);
+  }
+  Clock::time_point undoDone = Clock::now();
+  ASSERT_EQ(flatSum, sum);
+
+  std::cout << "CDFlatHashMap:            " << nrounds << " x " << nkeys
+            << " keys " << ms(flatDone - start) << " ms" << std::endl;
+  std::cout << "CDHashMap (save/restore): " << nrounds << " x " << nkeys
+            << " keys " << ms(done - flatDone) << " ms" << std::endl;
+  std::cout << "CDHashMap (undo log):     " << nrounds << " x " << nkeys
+            << " keys " << ms(undoDone - done) << " ms" << std::endl;
+}
+}  // namespace test
+}  // namespace CVC5
@@ -14,7 +14,9 @@
  ** Black box testing of CVC5::context::Context.
  **/
 
+#include <deque>
 #include <iostream>
+#include <random>
 #include <vector>
 
 #include "base/exception.h"
@@ -199,6 +201,156 @@ TEST_F(TestContextBlack, pre_post_notify)
   d_context.reset(nullptr);
 }
 
+/** A ContextObj that counts its restores and discarded saved copies */
+class CountingContextObj : public ContextObj
+{
+ public:
+  CountingContextObj(Context* context, bool canDiscard)
+      : ContextObj(context),
+        d_value(0),
+        d_nrestores(0),
+        d_ndiscards(0),
+        d_canDiscard(canDiscard)
+  {
+  }
+
+  ~CountingContextObj() override { destroy(); }
+
+  void set(int32_t value)
+  {
+    makeCurrent();
+    d_value = value;
+  }
+
+  int32_t d_value;
+  int32_t d_nrestores;
+  int32_t d_ndiscards;
+
+ protected:
+  ContextObj* save(ContextMemoryManager* pcmm) override
+  {
+    return new (pcmm) CountingContextObj(*this);
+  }
+
+  void restore(ContextObj* contextObj) override
+  {
+    ++d_nrestores;
+    d_value = static_cast<CountingContextObj*>(contextObj)->d_value;
+  }
+
+  bool discard(ContextObj* contextObj) override
+  {
+    if (d_canDiscard)
+    {
+      ++d_ndiscards;
+    }
+    return d_canDiscard;
+  }
+
+ private:
+  CountingContextObj(const CountingContextObj& other) = default;
+
+  bool d_canDiscard;
+};
+
+TEST_F(TestContextBlack, popto)
+{
+  MyContextNotifyObj pre(d_context.get(), true), post(d_context.get(), false);
+  CountingContextObj x(d_context.get(), true);
+  CountingContextObj y(d_context.get(), false);
+  CDO<int32_t> z(d_context.get(), 0);
+  CDList<int32_t> l(d_context.get());
+  x.set(1);
+  y.set(1);
+  for (int32_t i = 2; i <= 10; ++i)
+  {
+    d_context->push();
+    // leave some levels empty
+    if (i % 3 != 0)
+    {
+      x.set(i);
+      y.set(i);
+      z = i;
+      l.push_back(i);
+    }
+  }
+  d_context->popto(4);
+  ASSERT_EQ(d_context->getLevel(), 4);
+  ASSERT_EQ(x.d_value, 5);
+  ASSERT_EQ(y.d_value, 5);
+  ASSERT_EQ(z.get(), 5);
+  ASSERT_EQ(l.size(), 3);
+  // x changed at levels 6, 7 and 9: it is restored once, from the copy of
+  // its state at level 4, skipping the two other copies; y is restored from
+  // each copy in turn
+  ASSERT_EQ(x.d_nrestores, 1);
+  ASSERT_EQ(x.d_ndiscards, 2);
+  ASSERT_EQ(y.d_nrestores, 3);
+  // the notify objects are notified once per popped level
+  ASSERT_EQ(pre.d_ncalls, 5);
+  ASSERT_EQ(post.d_ncalls, 5);
+
+  d_context->popto(0);
+  ASSERT_EQ(x.d_value, 1);
+  ASSERT_EQ(y.d_value, 1);
+  ASSERT_EQ(z.get(), 0);
+  ASSERT_EQ(l.size(), 0);
+  ASSERT_EQ(x.d_nrestores, 2);
+  ASSERT_EQ(y.d_nrestores, 6);
+}
+
+TEST_F(TestContextBlack, popto_same_as_pop)
+{
+  // the same random changes on two contexts, one popped level by level
+  Context other;
+  std::vector<Context*> contexts = {d_context.get(), &other};
+  std::deque<CDO<int32_t>> cdos;
+  std::deque<CDList<int32_t>> lists;
+  for (Context* c : contexts)
+  {
+    for (int32_t i = 0; i < 10; ++i)
+    {
+      cdos.emplace_back(c, 0);
+      lists.emplace_back(c);
+    }
+  }
+  std::mt19937 rng(1);
+  for (uint32_t step = 0; step < 20000; ++step)
+  {
+    uint32_t r = rng() % 10;
+    uint32_t i = rng() % 10;
+    int32_t v = rng() % 100;
+    if (r < 3 && d_context->getLevel() < 30)
+    {
+      d_context->push();
+      other.push();
+    }
+    else if (r < 4 && d_context->getLevel() > 0)
+    {
+      int level = rng() % d_context->getLevel();
+      d_context->popto(level);
+      while (other.getLevel() > level)
+      {
+        other.pop();
+      }
+    }
+    else
+    {
+      cdos[i] = v;
+      cdos[10 + i] = v;
+      lists[i].push_back(v);
+      lists[10 + i].push_back(v);
+    }
+    for (size_t j = 0; j < 10; ++j)
+    {
+      ASSERT_EQ(cdos[j].get(), cdos[10 + j].get());
+      ASSERT_EQ(lists[j].size(), lists[10 + j].size());
+    }
+  }
+  d_context->popto(0);
+  other.popto(0);
+}
+
 // TODO: reenable after #2607 is merged in (issue 6047)
 #if 0
 TEST_F(TestContextBlack, top_scope_context_obj)
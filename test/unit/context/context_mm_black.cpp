@@ -103,5 +103,93 @@ TEST_F(TestContextBlackMM, push_pop)
 #endif
 }
 
+TEST_F(TestContextBlackMM, adaptive_chunks)
+{
+#ifndef CVC4_DEBUG_CONTEXT_MEMORY_MANAGER
+  // keep all the freed chunks, to check that they are reused below
+  d_cmm->setMaxFreeBytes(64 * 1024 * 1024);
+  // Deep pushes with big saved objects: 1024 levels of 8 KB each
+  uint32_t levels = 1024;
+  uint32_t len = 8192;
+  for (uint32_t p = 0; p < levels; ++p)
+  {
+    d_cmm->push();
+    memset(d_cmm->newData(len), 'a', len);
+  }
+  ASSERT_GE(d_cmm->getActiveBytes(), levels * len);
+  // chunks grow, so there are much fewer chunks than with fixed 16 KB chunks
+  ASSERT_LT(d_cmm->getNumChunkAllocations(), levels / 4);
+  uint64_t highWater = d_cmm->getHighWaterBytes();
+  ASSERT_EQ(highWater, d_cmm->getActiveBytes());
+  for (uint32_t p = 0; p < levels; ++p)
+  {
+    d_cmm->pop();
+  }
+  ASSERT_EQ(d_cmm->getHighWaterBytes(), highWater);
+  ASSERT_LT(d_cmm->getActiveBytes(), highWater);
+
+  // the same again reuses the retained chunks
+  uint64_t allocations = d_cmm->getNumChunkAllocations();
+  for (uint32_t p = 0; p < levels; ++p)
+  {
+    d_cmm->push();
+    memset(d_cmm->newData(len), 'b', len);
+  }
+  ASSERT_EQ(d_cmm->getNumChunkAllocations(), allocations);
+  for (uint32_t p = 0; p < levels; ++p)
+  {
+    d_cmm->pop();
+  }
+
+  // retained memory is capped
+  ASSERT_GT(d_cmm->getFreeBytes(), 0);
+  d_cmm->setMaxFreeBytes(65536);
+  ASSERT_LE(d_cmm->getFreeBytes(), 65536);
+  d_cmm->setMaxFreeBytes(0);
+  ASSERT_EQ(d_cmm->getFreeBytes(), 0);
+#endif
+}
+
+TEST_F(TestContextBlackMM, big_requests)
+{
+  d_cmm->setHugePages(true);
+  d_cmm->push();
+  // requests bigger than any chunk get a chunk of their own
+  uint32_t len = 5 * 1024 * 1024;
+  char* big = static_cast<char*>(d_cmm->newData(len));
+  memset(big, 'a', len);
+  char* small = static_cast<char*>(d_cmm->newData(16));
+  memset(small, 'b', 16);
+  ASSERT_EQ(big[len - 1], 'a');
+  d_cmm->pop();
+#ifndef CVC4_DEBUG_CONTEXT_MEMORY_MANAGER
+  ASSERT_GE(d_cmm->getHighWaterBytes(), len);
+#endif
+}
+
+TEST_F(TestContextBlackMM, reuse_free_chunks)
+{
+#ifndef CVC4_DEBUG_CONTEXT_MEMORY_MANAGER
+  d_cmm->setMaxFreeBytes(16 * 1024 * 1024);
+  uint32_t len = 5 * 1024 * 1024;
+  d_cmm->push();
+  // fill the first chunk, start a small chunk, then a big one
+  d_cmm->newData(16384);
+  d_cmm->newData(16);
+  d_cmm->newData(len);
+  d_cmm->pop();
+
+  // the big chunk is found behind the small one, which was freed last
+  uint64_t allocations = d_cmm->getNumChunkAllocations();
+  d_cmm->push();
+  memset(d_cmm->newData(len), 'a', len);
+  ASSERT_EQ(d_cmm->getNumChunkAllocations(), allocations);
+  // and the small one is still reused
+  d_cmm->newData(16384);
+  ASSERT_EQ(d_cmm->getNumChunkAllocations(), allocations);
+  d_cmm->pop();
+#endif
+}
+
 }  // namespace test
 }  // namespace CVC5
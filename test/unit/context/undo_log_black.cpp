@@ -0,0 +1,296 @@
+/*********************                                                        */
+/*! \file undo_log_black.cpp
+ ** \verbatim
+ ** This file is part of the CVC4 project.
+ ** Copyright (c) 2009-2021 by the authors listed in the file AUTHORS
+ ** in the top-level source directory and their institutional affiliations.
+ ** All rights reserved.  See the file COPYING in the top-level source
+ ** directory for licensing information.\endverbatim
+ **
+ ** \brief Black box testing of context-dependent objects backtracked with
+ ** the undo log.
+ **
+ ** Black box testing of CDO, CDList and CDHashMap with
+ ** BacktrackMode::UNDO_LOG, including a micro-benchmark of push/pop on a
+ ** SAT-search-like trace against BacktrackMode::SAVE_RESTORE.
+ **/
+
+#include <chrono>
+#include <deque>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "context/cdhashmap.h"
+#include "context/cdlist.h"
+#include "context/cdo.h"
+#include "test_context.h"
+
+namespace CVC5 {
+
+using namespace context;
+
+namespace test {
+
+class TestContextBlackUndoLog : public TestContext
+{
+ protected:
+  /** An operation of a trace, see mkTrace() */
+  struct Op
+  {
+    enum
+    {
+      PUSH,
+      POPTO,
+      SET,
+      APPEND,
+      INSERT
+    } d_kind;
+    int d_arg;
+    int d_val;
+  };
+
+  /**
+   * Make a trace of a SAT-like search over nvars variables: decisions push
+   * a level, each level assigns a few variables (SET), records them on the
+   * trail (APPEND) and in a map (INSERT), and conflicts backjump (POPTO)
+   * a random number of levels.
+   */
+  static std::vector<Op> mkTrace(size_t nops, int nvars, int maxLevel)
+  {
+    std::mt19937 rng(42);
+    std::vector<Op> trace;
+    int level = 0;
+    while (trace.size() < nops)
+    {
+      uint32_t r = rng() % 16;
+      if (r == 0 && level < maxLevel)
+      {
+        trace.push_back({Op::PUSH, 0, 0});
+        ++level;
+      }
+      else if (r == 1 && level > 0)
+      {
+        int to = level - 1 - static_cast<int>(rng() % (level < 8 ? level : 8));
+        trace.push_back({Op::POPTO, to, 0});
+        level = to;
+      }
+      else
+      {
+        int var = static_cast<int>(rng() % nvars);
+        int val = static_cast<int>(rng() % 1000);
+        trace.push_back({Op::SET, var, val});
+        if (r < 8)
+        {
+          trace.push_back({Op::APPEND, var, val});
+        }
+        else
+        {
+          trace.push_back({Op::INSERT, var, val});
+        }
+      }
+    }
+    return trace;
+  }
+
+  /** The context-dependent state a trace works on */
+  struct State
+  {
+    State(Context* c, int nvars, BacktrackMode mode)
+        : d_trail(c, mode), d_map(c, mode)
+    {
+      for (int i = 0; i < nvars; ++i)
+      {
+        d_vars.emplace_back(c, 0, mode);
+      }
+    }
+    std::deque<CDO<int>> d_vars;
+    CDList<int> d_trail;
+    CDHashMap<int, int> d_map;
+  };
+
+  /** Run trace on state, calling check after every POPTO */
+  template <class F>
+  void run(const std::vector<Op>& trace, State& state, F check)
+  {
+    for (const Op& op : trace)
+    {
+      switch (op.d_kind)
+      {
+        case Op::PUSH: d_context->push(); break;
+        case Op::POPTO:
+          d_context->popto(op.d_arg);
+          check();
+          break;
+        case Op::SET: state.d_vars[op.d_arg].set(op.d_val); break;
+        case Op::APPEND: state.d_trail.push_back(op.d_val); break;
+        case Op::INSERT: state.d_map.insert(op.d_arg, op.d_val); break;
+      }
+    }
+    d_context->popto(0);
+  }
+};
+
+TEST_F(TestContextBlackUndoLog, cdo)
+{
+  CDO<int> a(d_context.get(), 5, BacktrackMode::UNDO_LOG);
+  CDO<std::string> s(d_context.get(), "a", BacktrackMode::UNDO_LOG);
+  ASSERT_EQ(d_context->getUndoLogSize(), 0u);
+  d_context->push();
+  a = 10;
+  a = 11;
+  s = "b";
+  // one record per object and level
+  ASSERT_EQ(d_context->getUndoLogSize(), 2u);
+  d_context->push();
+  a = 20;
+  ASSERT_EQ(a.get(), 20);
+  d_context->pop();
+  ASSERT_EQ(a.get(), 11);
+  ASSERT_EQ(s.get(), "b");
+  d_context->push();
+  s = "c";
+  d_context->popto(0);
+  ASSERT_EQ(a.get(), 5);
+  ASSERT_EQ(s.get(), "a");
+  ASSERT_EQ(d_context->getUndoLogSize(), 0u);
+}
+
+TEST_F(TestContextBlackUndoLog, cdo_destroyed_at_depth)
+{
+  CDO<int> a(d_context.get(), 1, BacktrackMode::UNDO_LOG);
+  d_context->push();
+  a = 2;
+  {
+    CDO<std::string> s(d_context.get(), BacktrackMode::UNDO_LOG);
+    s = "x";
+    d_context->push();
+    s = "y";
+  }
+  // the records of s are released, those of a are kept
+  d_context->popto(0);
+  ASSERT_EQ(a.get(), 1);
+}
+
+TEST_F(TestContextBlackUndoLog, cdlist)
+{
+  CDList<int> list(d_context.get(), BacktrackMode::UNDO_LOG);
+  list.push_back(1);
+  d_context->push();
+  list.push_back(2);
+  list.push_back(3);
+  d_context->push();
+  list.push_back(4);
+  ASSERT_EQ(list.size(), 4u);
+  d_context->pop();
+  ASSERT_EQ(list.size(), 3u);
+  ASSERT_EQ(list.back(), 3);
+  d_context->pop();
+  ASSERT_EQ(list.size(), 1u);
+  ASSERT_EQ(list[0], 1);
+}
+
+TEST_F(TestContextBlackUndoLog, cdhashmap)
+{
+  CDHashMap<int, std::string> map(d_context.get(), BacktrackMode::UNDO_LOG);
+  map.insert(1, "a");
+  d_context->push();
+  map.insert(2, "b");
+  map.insert(1, "c");
+  map.insertAtContextLevelZero(3, "d");
+  d_context->push();
+  map[2] = "e";
+  map.insert(4, "f");
+  map.insert(3, "g");
+  ASSERT_EQ(map.size(), 4u);
+  d_context->pop();
+  ASSERT_EQ(map.size(), 3u);
+  ASSERT_EQ(map.find(2)->second, "b");
+  ASSERT_EQ(map.find(3)->second, "d");
+  ASSERT_EQ(map.count(4), 0u);
+  d_context->pop();
+  ASSERT_EQ(map.size(), 2u);
+  ASSERT_EQ(map.find(1)->second, "a");
+  ASSERT_EQ(map.find(3)->second, "d");
+  size_t count = 0;
+  for (CDHashMap<int, std::string>::iterator it = map.begin(); it != map.end();
+       ++it)
+  {
+    ++count;
+  }
+  ASSERT_EQ(count, 2u);
+
+  // clear at depth is permanent
+  d_context->push();
+  map.insert(5, "h");
+  map.clear();
+  d_context->pop();
+  ASSERT_TRUE(map.empty());
+}
+
+TEST_F(TestContextBlackUndoLog, same_as_save_restore)
+{
+  const int nvars = 50;
+  std::vector<Op> trace = mkTrace(20000, nvars, 40);
+  State saved(d_context.get(), nvars, BacktrackMode::SAVE_RESTORE);
+  State logged(d_context.get(), nvars, BacktrackMode::UNDO_LOG);
+  // run the trace on both states at once
+  for (const Op& op : trace)
+  {
+    switch (op.d_kind)
+    {
+      case Op::PUSH: d_context->push(); break;
+      case Op::POPTO:
+        d_context->popto(op.d_arg);
+        for (int i = 0; i < nvars; ++i)
+        {
+          ASSERT_EQ(saved.d_vars[i].get(), logged.d_vars[i].get());
+        }
+        ASSERT_EQ(saved.d_trail.size(), logged.d_trail.size());
+        ASSERT_EQ(saved.d_map.size(), logged.d_map.size());
+        for (const std::pair<const int, const int>& p : saved.d_map)
+        {
+          ASSERT_EQ(logged.d_map.find(p.first)->second, p.second);
+        }
+        break;
+      case Op::SET:
+        saved.d_vars[op.d_arg].set(op.d_val);
+        logged.d_vars[op.d_arg].set(op.d_val);
+        break;
+      case Op::APPEND:
+        saved.d_trail.push_back(op.d_val);
+        logged.d_trail.push_back(op.d_val);
+        break;
+      case Op::INSERT:
+        saved.d_map.insert(op.d_arg, op.d_val);
+        logged.d_map.insert(op.d_arg, op.d_val);
+        break;
+    }
+  }
+  d_context->popto(0);
+  ASSERT_EQ(d_context->getUndoLogSize(), 0u);
+}
+
+// A timing benchmark, which checks nothing and is only run on request, with
+// --gtest_also_run_disabled_tests
+TEST_F(TestContextBlackUndoLog, DISABLED_benchmark)
+{
+  using Clock = std::chrono::steady_clock;
+  const int nvars = 2000;
+  std::vector<Op> trace = mkTrace(2000000, nvars, 200);
+  for (BacktrackMode mode :
+       {BacktrackMode::SAVE_RESTORE, BacktrackMode::UNDO_LOG})
+  {
+    State state(d_context.get(), nvars, mode);
+    Clock::time_point start = Clock::now();
+    run(trace, state, []() {});
+    std::chrono::duration<double, std::milli> ms = Clock::now() - start;
+    std::cout << (mode == BacktrackMode::UNDO_LOG ? "undo log:     "
+                                                   : "save/restore: ")
+              << trace.size() << " operations " << ms.count() << " ms"
+              << std::endl;
+  }
+}
+}  // namespace test
+}  // namespace CVC5
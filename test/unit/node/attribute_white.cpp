@@ -14,7 +14,10 @@
  ** White box testing of Node attributes.
  **/
 
+#include <chrono>
+#include <iostream>
 #include <string>
+#include <vector>
 
 #include "base/check.h"
 #include "expr/attribute.h"
@@ -26,9 +29,12 @@
 #include "smt/smt_engine.h"
 #include "smt/smt_engine_scope.h"
 #include "test_node.h"
+#include "test_smt.h"
+#include "theory/rewriter.h"
 #include "theory/theory.h"
 #include "theory/theory_engine.h"
 #include "theory/uf/theory_uf.h"
+#include "util/rational.h"
 
 namespace CVC5 {
 
@@ -46,6 +52,7 @@ struct Test4;
 struct Test5;
 
 typedef Attribute<Test1, std::string> TestStringAttr1;
+typedef Attribute<Test1, Node> TestNodeAttr1;
 typedef Attribute<Test2, std::string> TestStringAttr2;
 
 using TestFlag1 = Attribute<Test1, bool>;
@@ -65,6 +72,10 @@ class TestNodeWhiteAttribute : public TestNode
   std::unique_ptr<TypeNode> d_booleanType;
 };
 
+class TestSmtWhiteAttribute : public TestSmt
+{
+};
+
 TEST_F(TestNodeWhiteAttribute, attribute_ids)
 {
   // Test that IDs for (a subset of) attributes in the system are
@@ -444,5 +455,100 @@ TEST_F(TestNodeWhiteAttribute, attributes)
 
   ASSERT_FALSE(unnamed.hasAttribute(VarNameAttr()));
 }
+
+TEST_F(TestNodeWhiteAttribute, dense_storage)
+{
+  AttributeManager& am = *d_nodeManager->d_attrManager;
+  std::vector<Node> vars;
+  for (uint32_t i = 0; i < 100; ++i)
+  {
+    vars.push_back(d_nodeManager->mkVar(*d_booleanType));
+    vars.back().setAttribute(TestNodeAttr1(), vars[i / 2]);
+    vars.back().setAttribute(TestFlag1(), i % 2 == 0);
+  }
+  vars[0].setAttribute(TestStringAttr1(), "foo");
+  ASSERT_FALSE(am.d_nodes.isDense(TestNodeAttr1::s_id));
+  ASSERT_FALSE(am.d_bools.isDense());
+
+  // frequently used attributes move to dense columns, values are kept
+  d_nodeManager->setDenseAttributeThreshold(64);
+  ASSERT_TRUE(am.d_nodes.isDense(TestNodeAttr1::s_id));
+  ASSERT_TRUE(am.d_bools.isDense());
+  ASSERT_FALSE(am.d_strings.isDense(TestStringAttr1::s_id));
+  for (uint32_t i = 0; i < vars.size(); ++i)
+  {
+    ASSERT_EQ(vars[i].getAttribute(TestNodeAttr1()), vars[i / 2]);
+    ASSERT_EQ(vars[i].getAttribute(TestFlag1()), i % 2 == 0);
+    ASSERT_FALSE(vars[i].getAttribute(TestFlag2()));
+  }
+  ASSERT_EQ(vars[0].getAttribute(TestStringAttr1()), "foo");
+  ASSERT_FALSE(vars[1].hasAttribute(TestStringAttr1()));
+
+  // attributes set after the switch
+  Node x = d_nodeManager->mkVar(*d_booleanType);
+  ASSERT_FALSE(x.hasAttribute(TestNodeAttr1()));
+  x.setAttribute(TestNodeAttr1(), vars[7]);
+  x.setAttribute(TestFlag2(), true);
+  ASSERT_EQ(x.getAttribute(TestNodeAttr1()), vars[7]);
+  ASSERT_TRUE(x.getAttribute(TestFlag2()));
+  ASSERT_FALSE(x.getAttribute(TestFlag1()));
+
+  // the attributes of reclaimed nodes are removed
+  size_t size = am.d_nodes.size();
+  x = Node::null();
+  d_nodeManager->reclaimZombies();
+  ASSERT_EQ(am.d_nodes.size(), size - 1);
+}
+
+// A timing benchmark, which checks nothing and is only run on request, with
+// --gtest_also_run_disabled_tests
+TEST_F(TestSmtWhiteAttribute, DISABLED_rewriter_cache_benchmark)
+{
+  using Clock = std::chrono::steady_clock;
+  TypeNode intType = d_nodeManager->integerType();
+  std::vector<Node> vars;
+  for (uint32_t i = 0; i < 100; ++i)
+  {
+    vars.push_back(d_nodeManager->mkVar(intType));
+  }
+  std::vector<Node> terms;
+  for (uint32_t i = 0; i < 20000; ++i)
+  {
+    Node a = vars[i % vars.size()];
+    Node b = vars[(i / vars.size()) % vars.size()];
+    Node c = d_nodeManager->mkConst(Rational(i));
+    terms.push_back(d_nodeManager->mkNode(
+        kind::LEQ, d_nodeManager->mkNode(kind::PLUS, a, b), c));
+  }
+  std::vector<Node> results;
+  for (const Node& t : terms)
+  {
+    results.push_back(theory::Rewriter::rewrite(t));
+  }
+
+  // all further rewrites are answered from the rewrite caches
+  const uint32_t rounds = 20;
+  auto run = [&]() {
+    Clock::time_point start = Clock::now();
+    for (uint32_t r = 0; r < rounds; ++r)
+    {
+      for (size_t i = 0; i < terms.size(); ++i)
+      {
+        EXPECT_EQ(theory::Rewriter::rewrite(terms[i]), results[i]);
+      }
+    }
+    return std::chrono::duration<double, std::milli>(Clock::now() - start)
+        .count();
+  };
+  double hashMs = run();
+  d_nodeManager->setDenseAttributeThreshold(64);
+  double denseMs = run();
+
+  size_t lookups = rounds * terms.size();
+  std::cout << "rewriter cache hits, hash tables:    " << lookups << " in "
+            << hashMs << " ms" << std::endl;
+  std::cout << "rewriter cache hits, dense columns:  " << lookups << " in "
+            << denseMs << " ms" << std::endl;
+}
 }  // namespace test
 }  // namespace CVC5
@@ -15,6 +15,8 @@
  **/
 
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "expr/node_manager.h"
 #include "test_node.h"
@@ -80,5 +82,245 @@ TEST_F(TestNodeWhiteNodeManager, topological_sort)
     ASSERT_EQ(NodeManager::TopologicalSort(roots), result);
   }
 }
+
+TEST_F(TestNodeWhiteNodeManager, slab_allocation)
+{
+  const NodeValueAllocator& nva = d_nodeManager->getNodeValueAllocator();
+  TypeNode boolType = d_nodeManager->booleanType();
+  Node i = d_nodeManager->mkSkolem("i", boolType);
+  Node j = d_nodeManager->mkSkolem("j", boolType);
+  d_nodeManager->reclaimZombies();
+
+  uint64_t live = nva.getTotalLive();
+  uint64_t live2 = nva.getNumLive(2);
+  NodeValue* nv;
+  {
+    Node n = d_nodeManager->mkNode(kind::AND, i, j);
+    nv = n.d_nv;
+    ASSERT_EQ(nva.getTotalLive(), live + 1);
+    ASSERT_EQ(nva.getNumLive(2), live2 + 1);
+    ASSERT_LE(nva.getNumLive(2), nva.getCapacity(2));
+  }
+  d_nodeManager->reclaimZombies();
+  ASSERT_EQ(nva.getTotalLive(), live);
+  ASSERT_EQ(nva.getNumLive(2), live2);
+
+  // the freed slot is reused for the next node of the same size class
+  Node m = d_nodeManager->mkNode(kind::OR, i, j);
+  ASSERT_EQ(m.d_nv, nv);
+
+  // nodes with many children are not slab-allocated
+  std::vector<Node> children(NodeValueAllocator::NUM_SIZE_CLASSES, i);
+  Node big = d_nodeManager->mkNode(kind::AND, children);
+  ASSERT_EQ(nva.getTotalLive(), live + 1);
+}
+
+TEST_F(TestNodeWhiteNodeManager, incremental_reclamation)
+{
+  TypeNode boolType = d_nodeManager->booleanType();
+  Node x = d_nodeManager->mkSkolem("x", boolType);
+  Node old = d_nodeManager->mkNode(kind::NOT, x);
+  d_nodeManager->setZombieReclamationBudget(100);
+  d_nodeManager->reclaimZombies();
+
+  size_t pool = d_nodeManager->poolSize();
+  {
+    // a node created before the last reclamation is old
+    Node tmp = old;
+    old = Node::null();
+  }
+  ASSERT_EQ(d_nodeManager->d_zombies.size(), 1u);
+  ASSERT_TRUE(d_nodeManager->d_youngZombies.empty());
+
+  // nodes created since then are young; stay below the threshold of 500
+  // young zombies at which reclamation is triggered automatically
+  std::vector<Node> nodes;
+  for (uint32_t i = 0; i < 400; ++i)
+  {
+    Node y = d_nodeManager->mkSkolem("y", boolType);
+    nodes.push_back(d_nodeManager->mkNode(kind::AND, x, y));
+  }
+  nodes.clear();
+  ASSERT_EQ(d_nodeManager->d_youngZombies.size(), 400u);
+
+  // each step reclaims at most the budget, and only young zombies; the
+  // reclaimed conjunctions release their (young) skolems
+  d_nodeManager->reclaimZombiesIncrementally();
+  ASSERT_EQ(d_nodeManager->d_youngZombies.size(), 400u);
+  ASSERT_EQ(d_nodeManager->d_zombies.size(), 1u);
+  while (!d_nodeManager->d_youngZombies.empty())
+  {
+    d_nodeManager->reclaimZombiesIncrementally();
+  }
+  ASSERT_EQ(d_nodeManager->d_zombies.size(), 1u);
+  ASSERT_EQ(d_nodeManager->poolSize(), pool);
+
+  // a full reclamation takes care of all generations
+  d_nodeManager->reclaimZombies();
+  ASSERT_FALSE(d_nodeManager->hasZombies());
+  ASSERT_EQ(d_nodeManager->poolSize(), pool - 1);
+}
+
+TEST_F(TestNodeWhiteNodeManager, node_handles)
+{
+  TypeNode boolType = d_nodeManager->booleanType();
+  Node x = d_nodeManager->mkSkolem("x", boolType);
+  Node y = d_nodeManager->mkSkolem("y", boolType);
+  size_t handles = d_nodeManager->numHandles();
+
+  ASSERT_TRUE(d_nodeManager->mkHandle(Node::null()).isNull());
+  ASSERT_EQ(d_nodeManager->getNode(NodeHandle()), Node::null());
+
+  NodeHandle hx = d_nodeManager->mkHandle(x);
+  NodeHandle hy = d_nodeManager->mkHandle(y);
+  ASSERT_NE(hx, hy);
+  ASSERT_EQ(d_nodeManager->mkHandle(x), hx);
+  ASSERT_EQ(d_nodeManager->getNode(hx), x);
+  ASSERT_EQ(d_nodeManager->getNode(hy), y);
+  ASSERT_EQ(d_nodeManager->numHandles(), handles + 2);
+
+  ASSERT_EQ(hx.getIndex(), x.getId());
+
+  // the handle of a collected node is released, and since node ids are not
+  // reused, it is not given to another node
+  NodeHandle hz;
+  {
+    Node z = d_nodeManager->mkNode(kind::AND, x, y);
+    hz = d_nodeManager->mkHandle(z);
+    ASSERT_EQ(d_nodeManager->numHandles(), handles + 3);
+  }
+  d_nodeManager->reclaimZombies();
+  ASSERT_EQ(d_nodeManager->numHandles(), handles + 2);
+  Node w = d_nodeManager->mkNode(kind::OR, x, y);
+  NodeHandle hw = d_nodeManager->mkHandle(w);
+  ASSERT_NE(hw, hz);
+  ASSERT_EQ(d_nodeManager->getNode(hw), w);
+
+  // the table grows by buckets as node ids grow
+  std::vector<Node> vars;
+  std::vector<NodeHandle> varHandles;
+  for (uint32_t i = 0; i < 5000; ++i)
+  {
+    vars.push_back(d_nodeManager->mkSkolem("v", boolType));
+    varHandles.push_back(d_nodeManager->mkHandle(vars.back()));
+  }
+  for (uint32_t i = 0; i < 5000; ++i)
+  {
+    ASSERT_EQ(d_nodeManager->getNode(varHandles[i]), vars[i]);
+  }
+  ASSERT_EQ(d_nodeManager->numHandles(), handles + 5003);
+}
+
+TEST_F(TestNodeWhiteNodeManager, concurrent_mode)
+{
+  NodeManager nm;
+  std::vector<Node> vars;
+  {
+    NodeManagerScope nms(&nm);
+    nm.enableConcurrentMode();
+    ASSERT_TRUE(nm.isConcurrent());
+    for (uint32_t i = 0; i < 8; ++i)
+    {
+      vars.push_back(nm.mkVar("v", nm.integerType()));
+    }
+  }
+
+  // every thread builds the same terms; hash-consing must yield the same
+  // node values in all of them
+  const uint32_t nthreads = 4;
+  std::vector<std::vector<Node>> results(nthreads);
+  std::vector<std::thread> threads;
+  for (uint32_t t = 0; t < nthreads; ++t)
+  {
+    threads.emplace_back([&nm, &vars, &results, t]() {
+      NodeManagerScope nms(&nm);
+      for (uint32_t i = 0; i < 500; ++i)
+      {
+        Node c = nm.mkConst(Rational(i));
+        Node sum = nm.mkNode(kind::PLUS, vars[i % vars.size()], c);
+        Node atom = nm.mkNode(kind::GEQ, sum, vars[(i / 8) % vars.size()]);
+        // type checking reads and writes attributes
+        atom.getType(true);
+        results[t].push_back(atom);
+      }
+    });
+  }
+  for (std::thread& thread : threads)
+  {
+    thread.join();
+  }
+  for (uint32_t t = 1; t < nthreads; ++t)
+  {
+    ASSERT_EQ(results[t].size(), results[0].size());
+    for (size_t i = 0; i < results[0].size(); ++i)
+    {
+      ASSERT_EQ(results[t][i].d_nv, results[0][i].d_nv);
+    }
+  }
+
+  // zombies are reclaimed once no thread is inside the node manager
+  size_t pool;
+  {
+    NodeManagerScope nms(&nm);
+    pool = nm.poolSize();
+    results.clear();
+    ASSERT_TRUE(nm.hasZombies());
+    ASSERT_EQ(nm.poolSize(), pool);
+  }
+  NodeManagerScope nms(&nm);
+  ASSERT_FALSE(nm.hasZombies());
+  ASSERT_LT(nm.poolSize(), pool);
+  vars.clear();
+}
+
+TEST_F(TestNodeWhiteNodeManager, concurrent_reclamation)
+{
+  NodeManager nm;
+  std::vector<Node> vars;
+  {
+    NodeManagerScope nms(&nm);
+    nm.enableConcurrentMode();
+    vars.push_back(nm.mkVar("x", nm.integerType()));
+    vars.push_back(nm.mkVar("y", nm.integerType()));
+    nm.mkNode(kind::GEQ, vars[0], vars[1]).getType(true);
+  }
+  size_t pool;
+  {
+    NodeManagerScope nms(&nm);
+    pool = nm.poolSize();
+  }
+
+  {
+    // the threads build terms that die right away and share some of them;
+    // while this thread is inside the node manager, they may be revived by
+    // any thread and are not reclaimed
+    NodeManagerScope nms(&nm);
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < 4; ++t)
+    {
+      threads.emplace_back([&nm, &vars, t]() {
+        NodeManagerScope tnms(&nm);
+        for (uint32_t i = 0; i < 1000; ++i)
+        {
+          Node c = nm.mkConst(Rational(i % 2 == 0 ? i : 1000 * t + i));
+          Node sum = nm.mkNode(kind::PLUS, vars[i % 2], c);
+          nm.mkNode(kind::GEQ, sum, vars[(i + 1) % 2]).getType(true);
+        }
+      });
+    }
+    for (std::thread& thread : threads)
+    {
+      thread.join();
+    }
+    ASSERT_TRUE(nm.hasZombies());
+    ASSERT_GT(nm.poolSize(), pool);
+  }
+
+  // this thread left last and reclaimed all zombies
+  NodeManagerScope nms(&nm);
+  ASSERT_FALSE(nm.hasZombies());
+  ASSERT_EQ(nm.poolSize(), pool);
+  vars.clear();
+}
 }  // namespace test
 }  // namespace CVC5
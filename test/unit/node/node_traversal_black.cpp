@@ -13,13 +13,17 @@
  **/
 
 #include <algorithm>
+#include <chrono>
 #include <cstddef>
+#include <iostream>
 #include <iterator>
 #include <sstream>
 #include <string>
+#include <unordered_set>
 #include <vector>
 
 #include "expr/node.h"
+#include "expr/node_algorithm.h"
 #include "expr/node_builder.h"
 #include "expr/node_manager.h"
 #include "expr/node_traversal.h"
@@ -40,6 +44,35 @@ class TestNodeBlackNodeTraversalPreorder : public TestNode
 {
 };
 
+class TestNodeBlackNodeVisitMarker : public TestNode
+{
+ protected:
+  /**
+   * Make a DAG of the given depth in which each level has width nodes, each
+   * with two children on the level below, so that the number of paths is
+   * exponential in the depth.
+   */
+  Node mkDag(size_t width, size_t depth)
+  {
+    std::vector<Node> level;
+    for (size_t i = 0; i < width; ++i)
+    {
+      level.push_back(d_nodeManager->mkSkolem("x", *d_boolTypeNode));
+    }
+    for (size_t d = 0; d < depth; ++d)
+    {
+      std::vector<Node> next;
+      for (size_t i = 0; i < width; ++i)
+      {
+        next.push_back(d_nodeManager->mkNode(
+            d % 2 == 0 ? AND : OR, level[i], level[(i + 1) % width]));
+      }
+      level = next;
+    }
+    return d_nodeManager->mkNode(AND, level);
+  }
+};
+
 TEST_F(TestNodeBlackNodeTraversalPostorder, preincrement_iteration)
 {
   const Node tb = d_nodeManager->mkConst(true);
@@ -292,5 +325,118 @@ TEST_F(TestNodeBlackNodeTraversalPreorder, skip_if)
   std::copy(traversal.begin(), traversal.end(), std::back_inserter(actual));
   ASSERT_EQ(actual, expected);
 }
+
+TEST_F(TestNodeBlackNodeVisitMarker, marks)
+{
+  Node x = d_nodeManager->mkSkolem("x", *d_boolTypeNode);
+  Node y = d_nodeManager->mkSkolem("y", *d_boolTypeNode);
+  NodeVisitMarker marker;
+  ASSERT_FALSE(marker.isVisited(x));
+  ASSERT_TRUE(marker.markVisited(x));
+  ASSERT_FALSE(marker.markVisited(x));
+  ASSERT_TRUE(marker.isVisited(x));
+  ASSERT_FALSE(marker.isPostVisited(x));
+  marker.markPostVisited(x);
+  ASSERT_TRUE(marker.isPostVisited(x));
+  ASSERT_FALSE(marker.isVisited(y));
+
+  {
+    // nested markers are independent
+    NodeVisitMarker nested;
+    ASSERT_FALSE(nested.isVisited(x));
+    ASSERT_TRUE(nested.markVisited(y));
+    ASSERT_FALSE(marker.isVisited(y));
+
+    // copies keep the marks and the stack
+    marker.getStack().push_back(y);
+    NodeVisitMarker copy(marker);
+    ASSERT_TRUE(copy.isPostVisited(x));
+    ASSERT_FALSE(copy.isVisited(y));
+    ASSERT_EQ(copy.getStack(), marker.getStack());
+    ASSERT_TRUE(copy.markVisited(y));
+    ASSERT_FALSE(marker.isVisited(y));
+  }
+
+  marker.clear();
+  ASSERT_FALSE(marker.isVisited(x));
+  ASSERT_TRUE(marker.getStack().empty());
+
+  // the workspaces of finished markers are recycled
+  size_t pooled = NodeVisitMarker::getNumPooledWorkspaces();
+  {
+    NodeVisitMarker m;
+    ASSERT_EQ(NodeVisitMarker::getNumPooledWorkspaces() + 1, pooled);
+    ASSERT_FALSE(m.isVisited(x));
+  }
+  ASSERT_EQ(NodeVisitMarker::getNumPooledWorkspaces(), pooled);
+}
+
+// A timing benchmark, which checks nothing and is only run on request, with
+// --gtest_also_run_disabled_tests
+TEST_F(TestNodeBlackNodeVisitMarker, DISABLED_benchmark)
+{
+  using Clock = std::chrono::steady_clock;
+  Node dag = mkDag(100, 1000);
+  const size_t rounds = 20;
+
+  auto ms = [](Clock::duration d) {
+    return std::chrono::duration<double, std::milli>(d).count();
+  };
+
+  // a traversal with a fresh hash set and stack per call, as before
+  Clock::time_point start = Clock::now();
+  size_t count = 0;
+  for (size_t r = 0; r < rounds; ++r)
+  {
+    std::unordered_set<TNode, TNodeHashFunction> visited;
+    std::vector<TNode> visit;
+    visit.push_back(dag);
+    do
+    {
+      TNode cur = visit.back();
+      visit.pop_back();
+      if (visited.insert(cur).second)
+      {
+        ++count;
+        visit.insert(visit.end(), cur.begin(), cur.end());
+      }
+    } while (!visit.empty());
+  }
+  Clock::time_point hashed = Clock::now();
+
+  size_t markedCount = 0;
+  for (size_t r = 0; r < rounds; ++r)
+  {
+    NodeVisitMarker visited;
+    std::vector<TNode>& visit = visited.getStack();
+    visit.push_back(dag);
+    do
+    {
+      TNode cur = visit.back();
+      visit.pop_back();
+      if (visited.markVisited(cur))
+      {
+        ++markedCount;
+        visit.insert(visit.end(), cur.begin(), cur.end());
+      }
+    } while (!visit.empty());
+  }
+  Clock::time_point marked = Clock::now();
+  ASSERT_EQ(count, markedCount);
+
+  // the ported helpers agree with the definition
+  std::unordered_set<Node, NodeHashFunction> syms;
+  expr::getSymbols(dag, syms);
+  ASSERT_EQ(syms.size(), 100u);
+  ASSERT_TRUE(expr::hasSubterm(dag, *syms.begin()));
+  ASSERT_FALSE(expr::hasSubtermKind(XOR, dag));
+
+  std::cout << "unordered_set traversal: " << rounds << " x "
+            << count / rounds << " nodes " << ms(hashed - start) << " ms"
+            << std::endl;
+  std::cout << "NodeVisitMarker traversal: " << rounds << " x "
+            << count / rounds << " nodes " << ms(marked - hashed) << " ms"
+            << std::endl;
+}
 }  // namespace test
 }  // namespace CVC5
@@ -0,0 +1,188 @@
+/*********************                                                        */
+/*! \file node_value_pool_white.cpp
+ ** \verbatim
+ ** This file is part of the CVC4 project.
+ ** Copyright (c) 2009-2021 by the authors listed in the file AUTHORS
+ ** in the top-level source directory and their institutional affiliations.
+ ** All rights reserved.  See the file COPYING in the top-level source
+ ** directory for licensing information.\endverbatim
+ **
+ ** \brief White box testing of CVC5::expr::NodeValuePool.
+ **
+ ** White box testing of CVC5::expr::NodeValuePool, including a
+ ** micro-benchmark against the std::unordered_set based pool it replaces.
+ **/
+
+#include <chrono>
+#include <iostream>
+#include <unordered_set>
+#include <vector>
+
+#include "expr/node_manager.h"
+#include "expr/node_value_pool.h"
+#include "test_node.h"
+#include "util/rational.h"
+
+namespace CVC5 {
+
+using namespace CVC5::expr;
+
+namespace test {
+
+class TestNodeWhiteNodeValuePool : public TestNode
+{
+ protected:
+  void SetUp() override
+  {
+    TestNode::SetUp();
+    for (uint32_t i = 0; i < 64; ++i)
+    {
+      d_vars.push_back(d_nodeManager->mkSkolem("x", *d_boolTypeNode));
+    }
+  }
+
+  /** Make n distinct nodes over d_vars */
+  std::vector<Node> mkNodes(size_t n)
+  {
+    std::vector<Node> nodes;
+    size_t nvars = d_vars.size();
+    for (size_t i = 0; nodes.size() < n; ++i)
+    {
+      Node a = d_vars[i % nvars];
+      Node b = d_vars[(i / nvars) % nvars];
+      Node c = d_vars[(i / (nvars * nvars)) % nvars];
+      nodes.push_back(d_nodeManager->mkNode(kind::ITE, a, b, c));
+    }
+    return nodes;
+  }
+
+  std::vector<Node> d_vars;
+};
+
+TEST_F(TestNodeWhiteNodeValuePool, insert_find_erase)
+{
+  std::vector<Node> nodes = mkNodes(10000);
+  NodeValuePool pool;
+  for (const Node& n : nodes)
+  {
+    ASSERT_EQ(pool.find(n.d_nv), nullptr);
+    pool.insert(n.d_nv);
+    ASSERT_EQ(pool.find(n.d_nv), n.d_nv);
+  }
+  ASSERT_EQ(pool.size(), nodes.size());
+  ASSERT_GE(pool.capacity(), nodes.size());
+
+  size_t count = 0;
+  pool.forEach([&count](NodeValue*) { ++count; });
+  ASSERT_EQ(count, nodes.size());
+
+  // erase every other node, then check all lookups again
+  for (size_t i = 0; i < nodes.size(); i += 2)
+  {
+    pool.erase(nodes[i].d_nv);
+  }
+  ASSERT_EQ(pool.size(), nodes.size() / 2);
+  for (size_t i = 0; i < nodes.size(); ++i)
+  {
+    ASSERT_EQ(pool.find(nodes[i].d_nv),
+              i % 2 == 0 ? nullptr : nodes[i].d_nv);
+  }
+}
+
+TEST_F(TestNodeWhiteNodeValuePool, incremental_growth)
+{
+  std::vector<Node> nodes = mkNodes(5000);
+  NodeValuePool pool;
+  size_t capacity = pool.capacity();
+  bool sawMigration = false;
+  for (size_t i = 0; i < nodes.size(); ++i)
+  {
+    pool.insert(nodes[i].d_nv);
+    if (pool.isMigrating())
+    {
+      sawMigration = true;
+      // all entries remain visible while the old table is drained
+      for (size_t j = 0; i % 16 == 0 && j <= i; ++j)
+      {
+        ASSERT_EQ(pool.find(nodes[j].d_nv), nodes[j].d_nv);
+      }
+      // erasing during a migration hits both tables
+      pool.erase(nodes[0].d_nv);
+      pool.erase(nodes[i].d_nv);
+      ASSERT_EQ(pool.find(nodes[0].d_nv), nullptr);
+      ASSERT_EQ(pool.find(nodes[i].d_nv), nullptr);
+      pool.insert(nodes[0].d_nv);
+      pool.insert(nodes[i].d_nv);
+    }
+  }
+  ASSERT_TRUE(sawMigration);
+  ASSERT_GT(pool.capacity(), capacity);
+  ASSERT_EQ(pool.size(), nodes.size());
+}
+
+TEST_F(TestNodeWhiteNodeValuePool, constants)
+{
+  NodeValuePool pool;
+  Node one = d_nodeManager->mkConst(Rational(1));
+  Node two = d_nodeManager->mkConst(Rational(2));
+  pool.insert(one.d_nv);
+  ASSERT_EQ(pool.find(one.d_nv), one.d_nv);
+  ASSERT_EQ(pool.find(two.d_nv), nullptr);
+  // the node manager's pool finds the constants it created
+  ASSERT_EQ(d_nodeManager->poolLookup(two.d_nv), two.d_nv);
+}
+
+// A timing benchmark, which checks nothing and is only run on request, with
+// --gtest_also_run_disabled_tests
+TEST_F(TestNodeWhiteNodeValuePool, DISABLED_benchmark)
+{
+  typedef std::unordered_set<NodeValue*,
+                             NodeValuePoolHashFunction,
+                             NodeValuePoolEq>
+      StdPool;
+  using Clock = std::chrono::steady_clock;
+  const size_t n = 100000;
+  std::vector<Node> nodes = mkNodes(n);
+
+  auto ms = [](Clock::duration d) {
+    return std::chrono::duration<double, std::milli>(d).count();
+  };
+
+  Clock::time_point start = Clock::now();
+  NodeValuePool pool;
+  for (const Node& node : nodes)
+  {
+    pool.insert(node.d_nv);
+  }
+  Clock::time_point inserted = Clock::now();
+  size_t found = 0;
+  for (const Node& node : nodes)
+  {
+    found += pool.find(node.d_nv) != nullptr;
+  }
+  Clock::time_point looked = Clock::now();
+  ASSERT_EQ(found, n);
+
+  StdPool stdPool;
+  for (const Node& node : nodes)
+  {
+    stdPool.insert(node.d_nv);
+  }
+  Clock::time_point stdInserted = Clock::now();
+  found = 0;
+  for (const Node& node : nodes)
+  {
+    found += stdPool.find(node.d_nv) != stdPool.end();
+  }
+  Clock::time_point stdLooked = Clock::now();
+  ASSERT_EQ(found, n);
+
+  std::cout << "NodeValuePool: " << n << " inserts "
+            << ms(inserted - start) << " ms, " << n << " lookups "
+            << ms(looked - inserted) << " ms" << std::endl;
+  std::cout << "unordered_set: " << n << " inserts "
+            << ms(stdInserted - looked) << " ms, " << n << " lookups "
+            << ms(stdLooked - stdInserted) << " ms" << std::endl;
+}
+}  // namespace test
+}  // namespace CVC5
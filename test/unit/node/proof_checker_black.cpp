@@ -0,0 +1,124 @@
+/*********************                                                        */
+/*! \file proof_checker_black.cpp
+ ** \verbatim
+ ** This file is part of the CVC4 project.
+ ** Copyright (c) 2009-2021 by the authors listed in the file AUTHORS
+ ** in the top-level source directory and their institutional affiliations.
+ ** All rights reserved.  See the file COPYING in the top-level source
+ ** directory for licensing information.\endverbatim
+ **
+ ** \brief Black box testing of CVC5::ProofChecker.
+ **
+ ** Black box testing of CVC5::ProofChecker::checkProof on one and on several
+ ** threads.
+ **/
+
+#include <memory>
+#include <sstream>
+#include <vector>
+
+#include "expr/proof_checker.h"
+#include "expr/proof_node.h"
+#include "expr/proof_node_manager.h"
+#include "test_smt.h"
+#include "theory/booleans/proof_checker.h"
+
+namespace CVC5 {
+namespace test {
+
+class TestNodeBlackProofChecker : public TestSmt
+{
+ protected:
+  void SetUp() override
+  {
+    TestSmt::SetUp();
+    d_checker.reset(new ProofChecker);
+    d_boolChecker.registerTo(d_checker.get());
+    // a rule that must be checked on the calling thread
+    d_checker->registerTrustedChecker(PfRule::ARRAYS_TRUST, nullptr, 1);
+    // the steps are not checked when they are constructed, so that invalid
+    // proofs can be built
+    d_pnm.reset(new ProofNodeManager(nullptr));
+  }
+
+  void TearDown() override
+  {
+    d_pnm.reset();
+    d_checker.reset();
+  }
+
+  /**
+   * Make a balanced tree of AND_INTRO steps over the assumptions of n fresh
+   * variables, concluded by a trusted step.  If bad is true, one of the
+   * AND_INTRO steps has a wrong conclusion.
+   */
+  std::shared_ptr<ProofNode> mkProof(size_t n, bool bad)
+  {
+    std::vector<std::shared_ptr<ProofNode>> layer;
+    for (size_t i = 0; i < n; ++i)
+    {
+      Node x = d_nodeManager->mkSkolem("x", d_nodeManager->booleanType());
+      layer.push_back(d_pnm->mkAssume(x));
+    }
+    while (layer.size() > 1)
+    {
+      std::vector<std::shared_ptr<ProofNode>> next;
+      for (size_t i = 0; i + 1 < layer.size(); i += 2)
+      {
+        Node a = layer[i]->getResult();
+        Node b = layer[i + 1]->getResult();
+        Node conc = d_nodeManager->mkNode(kind::AND, a, b);
+        if (bad && next.empty() && layer.size() == 4)
+        {
+          conc = d_nodeManager->mkNode(kind::AND, b, a);
+        }
+        next.push_back(d_pnm->mkNode(
+            PfRule::AND_INTRO, {layer[i], layer[i + 1]}, {}, conc));
+      }
+      if (layer.size() % 2 == 1)
+      {
+        next.push_back(layer.back());
+      }
+      layer.swap(next);
+    }
+    Node res = layer[0]->getResult();
+    return d_pnm->mkNode(PfRule::ARRAYS_TRUST, {layer[0]}, {res}, res);
+  }
+
+  std::unique_ptr<ProofChecker> d_checker;
+  theory::booleans::BoolProofRuleChecker d_boolChecker;
+  std::unique_ptr<ProofNodeManager> d_pnm;
+};
+
+TEST_F(TestNodeBlackProofChecker, check_proof)
+{
+  std::shared_ptr<ProofNode> pf = mkProof(1000, false);
+  for (uint32_t nthreads : {1, 2, 4})
+  {
+    std::stringstream ss;
+    ASSERT_TRUE(d_checker->checkProof(pf.get(), nthreads, ss)) << ss.str();
+    // the node manager is only in concurrent mode while checking
+    ASSERT_FALSE(d_nodeManager->isConcurrent());
+  }
+  // a shared subproof is checked once
+  Node t = d_nodeManager->mkConst(true);
+  std::shared_ptr<ProofNode> leaf = d_pnm->mkAssume(t);
+  Node tt = d_nodeManager->mkNode(kind::AND, t, t);
+  std::shared_ptr<ProofNode> dup =
+      d_pnm->mkNode(PfRule::AND_INTRO, {leaf, leaf}, {}, tt);
+  std::stringstream ss;
+  ASSERT_TRUE(d_checker->checkProof(dup.get(), 4, ss));
+}
+
+TEST_F(TestNodeBlackProofChecker, check_invalid_proof)
+{
+  std::shared_ptr<ProofNode> pf = mkProof(1000, true);
+  for (uint32_t nthreads : {1, 2, 4})
+  {
+    std::stringstream ss;
+    ASSERT_FALSE(d_checker->checkProof(pf.get(), nthreads, ss));
+    ASSERT_FALSE(ss.str().empty());
+  }
+}
+}  // namespace test
+}  // namespace CVC5
@@ -0,0 +1,86 @@
+/*********************                                                        */
+/*! \file proof_node_manager_white.cpp
+ ** \verbatim
+ ** This file is part of the CVC4 project.
+ ** Copyright (c) 2009-2021 by the authors listed in the file AUTHORS
+ ** in the top-level source directory and their institutional affiliations.
+ ** All rights reserved.  See the file COPYING in the top-level source
+ ** directory for licensing information.\endverbatim
+ **
+ ** \brief White box testing of CVC5::ProofNodeManager.
+ **
+ ** White box testing of CVC5::ProofNodeManager, in particular of
+ ** hash-consing and compaction of proof nodes.
+ **/
+
+#include <memory>
+#include <vector>
+
+#include "expr/proof_node.h"
+#include "expr/proof_node_manager.h"
+#include "test_smt.h"
+
+namespace CVC5 {
+namespace test {
+
+class TestNodeWhiteProofNodeManager : public TestSmt
+{
+ protected:
+  void SetUp() override
+  {
+    TestSmt::SetUp();
+    d_a = d_nodeManager->mkSkolem("a", d_nodeManager->booleanType());
+    d_b = d_nodeManager->mkSkolem("b", d_nodeManager->booleanType());
+    d_ab = d_nodeManager->mkNode(kind::AND, d_a, d_b);
+  }
+
+  /** Make AND_INTRO(ASSUME(a), ASSUME(b)) with fresh proof nodes */
+  std::shared_ptr<ProofNode> mkAndIntro(ProofNodeManager& pnm)
+  {
+    return pnm.mkNode(
+        PfRule::AND_INTRO, {pnm.mkAssume(d_a), pnm.mkAssume(d_b)}, {}, d_ab);
+  }
+
+  Node d_a;
+  Node d_b;
+  Node d_ab;
+};
+
+TEST_F(TestNodeWhiteProofNodeManager, hash_consing)
+{
+  ProofNodeManager pnm;
+  ASSERT_NE(pnm.mkAssume(d_a), pnm.mkAssume(d_a));
+
+  pnm.setHashConsing(true);
+  std::shared_ptr<ProofNode> pa = pnm.mkAssume(d_a);
+  ASSERT_EQ(pnm.mkAssume(d_a), pa);
+  ASSERT_NE(pnm.mkAssume(d_b), pa);
+  std::shared_ptr<ProofNode> p1 = mkAndIntro(pnm);
+  std::shared_ptr<ProofNode> p2 = mkAndIntro(pnm);
+  ASSERT_EQ(p1, p2);
+  ASSERT_EQ(p1->getChildren()[0], pa);
+
+  // an updated proof node is no longer shared
+  std::shared_ptr<ProofNode> pb = pnm.mkAssume(d_b);
+  pnm.updateNode(pb.get(), PfRule::AND_ELIM, {p1}, {});
+  ASSERT_NE(pnm.mkAssume(d_b), pb);
+}
+
+TEST_F(TestNodeWhiteProofNodeManager, compact)
+{
+  ProofNodeManager pnm;
+  std::shared_ptr<ProofNode> p1 = mkAndIntro(pnm);
+  std::shared_ptr<ProofNode> p2 = mkAndIntro(pnm);
+  Node abab = d_nodeManager->mkNode(kind::AND, d_ab, d_ab);
+  std::shared_ptr<ProofNode> root =
+      pnm.mkNode(PfRule::AND_INTRO, {p1, p2}, {}, abab);
+  ASSERT_NE(root->getChildren()[0], root->getChildren()[1]);
+
+  // p2 and its two assumptions are merged into p1 and its assumptions
+  ASSERT_EQ(pnm.compact(root), 3u);
+  ASSERT_EQ(root->getChildren()[0], root->getChildren()[1]);
+  ASSERT_EQ(root->getResult(), abab);
+  ASSERT_EQ(pnm.compact(root), 0u);
+}
+}  // namespace test
+}  // namespace CVC5
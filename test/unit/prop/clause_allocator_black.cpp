@@ -0,0 +1,157 @@
+/*********************                                                        */
+/*! \file clause_allocator_black.cpp
+ ** \verbatim
+ ** This file is part of the CVC4 project.
+ ** Copyright (c) 2009-2021 by the authors listed in the file AUTHORS
+ ** in the top-level source directory and their institutional affiliations.
+ ** All rights reserved.  See the file COPYING in the top-level source
+ ** directory for licensing information.\endverbatim
+ **
+ ** \brief Black box testing of the clause arena of the Minisat solver.
+ **
+ ** Black box testing of CVC5::Minisat::ClauseAllocator.
+ **/
+
+#include <vector>
+
+#include "prop/minisat/core/SolverTypes.h"
+#include "test.h"
+
+namespace CVC5 {
+namespace test {
+
+using Minisat::Clause;
+using Minisat::ClauseAllocator;
+using Minisat::CRef;
+using Minisat::Lit;
+using Minisat::mkLit;
+using Minisat::vec;
+
+class TestPropBlackClauseAllocator : public TestInternal
+{
+ protected:
+  /** Allocates a clause of the given size over the variables from first on. */
+  static CRef alloc(ClauseAllocator& ca,
+                    int first,
+                    int size,
+                    bool removable,
+                    ClauseAllocator::Region region,
+                    int level = 0)
+  {
+    vec<Lit> lits;
+    for (int i = 0; i < size; ++i)
+    {
+      lits.push(mkLit(first + i, i % 2 == 0));
+    }
+    return ca.alloc(level, lits, removable, region);
+  }
+
+  /** Returns true if c is the clause allocated by alloc(first, size). */
+  static bool is_clause(const Clause& c, int first, int size)
+  {
+    if (c.size() != size)
+    {
+      return false;
+    }
+    for (int i = 0; i < size; ++i)
+    {
+      if (c[i] != mkLit(first + i, i % 2 == 0))
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+};
+
+TEST_F(TestPropBlackClauseAllocator, regions)
+{
+  ClauseAllocator ca;
+  CRef in = alloc(ca, 0, 3, false, ClauseAllocator::REGION_INPUT);
+  CRef le = alloc(ca, 3, 4, true, ClauseAllocator::REGION_LEARNT, 1);
+  CRef th = alloc(ca, 7, 2, true, ClauseAllocator::REGION_LEMMA, 2);
+  ASSERT_EQ(ClauseAllocator::region(in), ClauseAllocator::REGION_INPUT);
+  ASSERT_EQ(ClauseAllocator::region(le), ClauseAllocator::REGION_LEARNT);
+  ASSERT_EQ(ClauseAllocator::region(th), ClauseAllocator::REGION_LEMMA);
+  ASSERT_NE(ClauseAllocator::region(Minisat::CRef_Undef),
+            ClauseAllocator::REGION_LEMMA);
+
+  ASSERT_TRUE(is_clause(ca[in], 0, 3));
+  ASSERT_TRUE(is_clause(ca[le], 3, 4));
+  ASSERT_TRUE(is_clause(ca[th], 7, 2));
+  ASSERT_EQ(ca[le].level(), 1);
+  ASSERT_TRUE(ca[th].removable());
+  ASSERT_FALSE(ca[in].removable());
+
+  ASSERT_EQ(ca.size(),
+            ca.size(ClauseAllocator::REGION_INPUT)
+                + ca.size(ClauseAllocator::REGION_LEARNT)
+                + ca.size(ClauseAllocator::REGION_LEMMA));
+  uint32_t lemmaSize = ca.size(ClauseAllocator::REGION_LEMMA);
+  ca.free(th);
+  ASSERT_EQ(ca.wasted(ClauseAllocator::REGION_LEMMA), lemmaSize);
+  ASSERT_EQ(ca.wasted(ClauseAllocator::REGION_INPUT), 0);
+  ASSERT_EQ(ca.wasted(), lemmaSize);
+}
+
+TEST_F(TestPropBlackClauseAllocator, partial_compaction)
+{
+  ClauseAllocator ca;
+  std::vector<CRef> inputs, lemmas;
+  for (int i = 0; i < 100; ++i)
+  {
+    inputs.push_back(alloc(ca, i, 3, false, ClauseAllocator::REGION_INPUT));
+    lemmas.push_back(alloc(ca, i, 5, true, ClauseAllocator::REGION_LEMMA));
+  }
+  // free every other lemma
+  std::vector<CRef> live;
+  for (size_t i = 0; i < lemmas.size(); ++i)
+  {
+    if (i % 2 == 0)
+    {
+      ca[lemmas[i]].mark(1);
+      ca.free(lemmas[i]);
+    }
+    else
+    {
+      live.push_back(lemmas[i]);
+    }
+  }
+  uint32_t inputSize = ca.size(ClauseAllocator::REGION_INPUT);
+  uint32_t lemmaSize = ca.size(ClauseAllocator::REGION_LEMMA);
+
+  // compact the lemma region only
+  ClauseAllocator to(ca, 1 << ClauseAllocator::REGION_LEMMA);
+  std::vector<CRef> oldInputs = inputs;
+  for (CRef& cr : inputs)
+  {
+    ca.reloc(cr, to);
+  }
+  for (CRef& cr : live)
+  {
+    ca.reloc(cr, to);
+  }
+  // a clause referenced twice is only copied once
+  CRef again = lemmas[1];
+  ca.reloc(again, to);
+  ASSERT_EQ(again, live[0]);
+  to.moveTo(ca);
+
+  ASSERT_EQ(inputs, oldInputs);
+  ASSERT_EQ(ca.size(ClauseAllocator::REGION_INPUT), inputSize);
+  ASSERT_EQ(ca.size(ClauseAllocator::REGION_LEMMA), lemmaSize / 2);
+  ASSERT_EQ(ca.wasted(), 0);
+  for (int i = 0; i < 100; ++i)
+  {
+    ASSERT_TRUE(is_clause(ca[inputs[i]], i, 3));
+  }
+  for (size_t i = 0; i < live.size(); ++i)
+  {
+    ASSERT_EQ(ClauseAllocator::region(live[i]), ClauseAllocator::REGION_LEMMA);
+    ASSERT_TRUE(is_clause(ca[live[i]], 2 * i + 1, 5));
+    ASSERT_TRUE(ca[live[i]].removable());
+  }
+}
+
+}  // namespace test
+}  // namespace CVC5
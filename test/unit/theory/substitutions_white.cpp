@@ -0,0 +1,95 @@
+/*********************                                                        */
+/*! \file substitutions_white.cpp
+ ** \verbatim
+ ** This file is part of the CVC4 project.
+ ** Copyright (c) 2009-2021 by the authors listed in the file AUTHORS
+ ** in the top-level source directory and their institutional affiliations.
+ ** All rights reserved.  See the file COPYING in the top-level source
+ ** directory for licensing information.\endverbatim
+ **
+ ** \brief White box testing of CVC5::theory::SubstitutionMap and CVC5::Subs.
+ **
+ ** White box testing of CVC5::theory::SubstitutionMap and CVC5::Subs.
+ **/
+
+#include <vector>
+
+#include "context/context.h"
+#include "expr/node.h"
+#include "expr/subs.h"
+#include "test_smt.h"
+#include "theory/substitutions.h"
+
+namespace CVC5 {
+
+using namespace theory;
+
+namespace test {
+
+class TestTheoryWhiteSubstitutions : public TestSmt
+{
+ protected:
+  void SetUp() override
+  {
+    TestSmt::SetUp();
+    for (const char* name : {"x", "y", "z", "u"})
+    {
+      d_vars.push_back(d_nodeManager->mkVar(name, d_nodeManager->integerType()));
+    }
+  }
+
+  std::vector<Node> d_vars;
+};
+
+TEST_F(TestTheoryWhiteSubstitutions, incremental_cache)
+{
+  context::Context ctx;
+  SubstitutionMap sm(&ctx);
+  Node x = d_vars[0], y = d_vars[1], z = d_vars[2], u = d_vars[3];
+  Node xy = d_nodeManager->mkNode(kind::PLUS, x, y);
+  Node zu = d_nodeManager->mkNode(kind::MULT, z, u);
+
+  sm.addSubstitution(x, z);
+  std::vector<Node> terms = {xy, zu};
+  sm.apply(terms);
+  ASSERT_EQ(terms[0], d_nodeManager->mkNode(kind::PLUS, z, y));
+  ASSERT_EQ(terms[1], zu);
+  size_t cached = sm.getCacheSize();
+  ASSERT_GT(cached, 0u);
+
+  // a new substitution only evicts the cached results that contain y
+  sm.addSubstitution(y, u);
+  ASSERT_EQ(sm.apply(zu), zu);
+  ASSERT_LT(sm.getCacheSize(), cached);
+  ASSERT_GE(sm.getCacheSize(), 3u);
+  ASSERT_EQ(sm.apply(xy), d_nodeManager->mkNode(kind::PLUS, z, u));
+
+  // substitutions are applied up to a fixed point
+  sm.addSubstitution(z, u);
+  ASSERT_EQ(sm.apply(xy), d_nodeManager->mkNode(kind::PLUS, u, u));
+  ASSERT_EQ(sm.apply(zu), d_nodeManager->mkNode(kind::MULT, u, u));
+}
+
+TEST_F(TestTheoryWhiteSubstitutions, subs_batch)
+{
+  Node x = d_vars[0], y = d_vars[1], z = d_vars[2];
+  Node xy = d_nodeManager->mkNode(kind::PLUS, x, y);
+  Node t = d_nodeManager->mkNode(kind::MULT, xy, xy);
+
+  Subs s;
+  s.add(x, z);
+  s.add(x, y);
+  std::vector<Node> ns = {xy, t, y};
+  s.apply(ns);
+  // as for Node::substitute, the first substitution for x is used
+  Node zy = d_nodeManager->mkNode(kind::PLUS, z, y);
+  ASSERT_EQ(ns[0], zy);
+  ASSERT_EQ(ns[1], d_nodeManager->mkNode(kind::MULT, zy, zy));
+  ASSERT_EQ(ns[2], y);
+  ASSERT_EQ(ns[1], s.apply(t));
+
+  s.rapply(ns);
+  ASSERT_EQ(ns[0], d_nodeManager->mkNode(kind::PLUS, x, x));
+}
+}  // namespace test
+}  // namespace CVC5